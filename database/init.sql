@@ -3,6 +3,7 @@ CREATE DATABASE IF NOT EXISTS DatabaseKnowledgeGraph;
 USE DatabaseKnowledgeGraph;
 
 -- 按照外键依赖的反向顺序删除旧表，避免报错
+DROP TABLE IF EXISTS change_log;
 DROP TABLE IF EXISTS attribute;
 DROP TABLE IF EXISTS relationship;
 DROP TABLE IF EXISTS node;
@@ -29,9 +30,18 @@ CREATE TABLE node (
                       pos_y FLOAT DEFAULT 0,
                       color VARCHAR(20) DEFAULT '#3498db',
                       properties LONGTEXT,
+                      -- properties 中的热点 JSON 键，生成列 + 索引，供属性检索直接命中
+                      -- 只保存前 255 个字符，避免严格模式下超长值写入失败；超长值检索时回退到 JSON 表达式
+                      prop_alias VARCHAR(255) GENERATED ALWAYS AS
+                          (IF(JSON_VALID(properties), LEFT(JSON_UNQUOTE(JSON_EXTRACT(properties, '$.alias')), 255), NULL)) VIRTUAL,
+                      prop_category VARCHAR(255) GENERATED ALWAYS AS
+                          (IF(JSON_VALID(properties), LEFT(JSON_UNQUOTE(JSON_EXTRACT(properties, '$.category')), 255), NULL)) VIRTUAL,
                       created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
                       FOREIGN KEY (ontology_id) REFERENCES ontology(ontology_id) ON DELETE CASCADE,
-                      UNIQUE KEY unique_node (ontology_id, name)
+                      UNIQUE KEY unique_node (ontology_id, name),
+                      KEY idx_node_type (ontology_id, node_type),
+                      KEY idx_node_alias (ontology_id, prop_alias),
+                      KEY idx_node_category (ontology_id, prop_category)
 ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4;
 
 -- 3. 关系表
@@ -45,7 +55,9 @@ CREATE TABLE relationship (
                               properties LONGTEXT,
                               FOREIGN KEY (ontology_id) REFERENCES ontology(ontology_id) ON DELETE CASCADE,
                               FOREIGN KEY (source_id) REFERENCES node(node_id) ON DELETE CASCADE,
-                              FOREIGN KEY (target_id) REFERENCES node(node_id) ON DELETE CASCADE
+                              FOREIGN KEY (target_id) REFERENCES node(node_id) ON DELETE CASCADE,
+                              -- 同一对节点间同类型的关系只保留一条，批量合并按此键去重
+                              UNIQUE KEY unique_relationship (ontology_id, source_id, target_id, relation_type)
 ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4;
 
 -- 4. 属性表
@@ -56,6 +68,7 @@ CREATE TABLE attribute (
                            attr_name VARCHAR(255) NOT NULL,
                            attr_value TEXT,
                            attr_type VARCHAR(50),
+                           KEY idx_attr_name_value (attr_name, attr_value(191)),
                            FOREIGN KEY (node_id) REFERENCES node(node_id) ON DELETE CASCADE,
                            FOREIGN KEY (relation_id) REFERENCES relationship(relation_id) ON DELETE CASCADE,
                            CONSTRAINT chk_entity_source CHECK (
@@ -64,7 +77,20 @@ CREATE TABLE attribute (
                                )
 ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4;
 
--- 5. 权限表
+-- 5. 变更日志表：仓库在写入节点/关系的同一事务内追加，客户端按 seq 增量拉取他人的修改
+CREATE TABLE change_log (
+                            seq BIGINT PRIMARY KEY AUTO_INCREMENT,
+                            ontology_id INT NOT NULL,
+                            entity_type TINYINT NOT NULL,          -- 0 节点, 1 关系
+                            entity_id INT NOT NULL,
+                            op TINYINT NOT NULL,                   -- 0 新增, 1 修改, 2 删除
+                            origin_conn BIGINT UNSIGNED NOT NULL,  -- 写入方会话的随机 ID，客户端据此跳过自己的修改
+                            changed_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+                            KEY idx_change_ontology_seq (ontology_id, seq),
+                            FOREIGN KEY (ontology_id) REFERENCES ontology(ontology_id) ON DELETE CASCADE
+) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4;
+
+-- 6. 权限表
 CREATE TABLE IF NOT EXISTS users (
                                      user_id INT PRIMARY KEY AUTO_INCREMENT,
                                      username VARCHAR(50) NOT NULL UNIQUE,
@@ -0,0 +1,19 @@
+-- 变更日志表迁移：用于已经按旧版 init.sql 建库的环境
+-- 新建库直接执行 init.sql 即可，无需运行本脚本
+USE DatabaseKnowledgeGraph;
+
+-- 仓库在写入节点/关系的同一事务内追加，客户端按 seq 增量拉取他人的修改
+CREATE TABLE IF NOT EXISTS change_log (
+    seq BIGINT PRIMARY KEY AUTO_INCREMENT,
+    ontology_id INT NOT NULL,
+    entity_type TINYINT NOT NULL,          -- 0 节点, 1 关系
+    entity_id INT NOT NULL,
+    op TINYINT NOT NULL,                   -- 0 新增, 1 修改, 2 删除
+    origin_conn BIGINT UNSIGNED NOT NULL,  -- 写入方会话的随机 ID，客户端据此跳过自己的修改
+    changed_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+    KEY idx_change_ontology_seq (ontology_id, seq),
+    FOREIGN KEY (ontology_id) REFERENCES ontology(ontology_id) ON DELETE CASCADE
+) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4;
+
+-- 日志只用于增量同步，可定期清理旧记录，例如保留 7 天：
+-- DELETE FROM change_log WHERE changed_at < NOW() - INTERVAL 7 DAY;
@@ -0,0 +1,17 @@
+-- 关系唯一键迁移：用于已经按旧版 init.sql 建库的环境
+-- 新建库直接执行 init.sql 即可，无需运行本脚本
+USE DatabaseKnowledgeGraph;
+
+-- 1. 清理重复关系，每组 (本体, 起点, 终点, 类型) 保留 relation_id 最小的一条
+--    被删除关系上的扩展属性随外键级联删除
+DELETE r1 FROM relationship r1
+    JOIN relationship r2
+      ON r1.ontology_id = r2.ontology_id
+     AND r1.source_id = r2.source_id
+     AND r1.target_id = r2.target_id
+     AND r1.relation_type = r2.relation_type
+     AND r1.relation_id > r2.relation_id;
+
+-- 2. 唯一键，供批量合并的 INSERT ... ON DUPLICATE KEY 去重
+ALTER TABLE relationship
+    ADD UNIQUE KEY unique_relationship (ontology_id, source_id, target_id, relation_type);
@@ -0,0 +1,18 @@
+-- 属性检索索引迁移：用于已经按旧版 init.sql 建库的环境
+-- 新建库直接执行 init.sql 即可，无需运行本脚本
+USE DatabaseKnowledgeGraph;
+
+-- 1. 节点类型检索 (按本体过滤后再按类型)
+ALTER TABLE node ADD KEY idx_node_type (ontology_id, node_type);
+
+-- 2. properties 中的热点 JSON 键：生成列 + 索引 (截取前 255 个字符，超长值不会让写入失败)
+ALTER TABLE node
+    ADD COLUMN prop_alias VARCHAR(255) GENERATED ALWAYS AS
+        (IF(JSON_VALID(properties), LEFT(JSON_UNQUOTE(JSON_EXTRACT(properties, '$.alias')), 255), NULL)) VIRTUAL,
+    ADD COLUMN prop_category VARCHAR(255) GENERATED ALWAYS AS
+        (IF(JSON_VALID(properties), LEFT(JSON_UNQUOTE(JSON_EXTRACT(properties, '$.category')), 255), NULL)) VIRTUAL,
+    ADD KEY idx_node_alias (ontology_id, prop_alias),
+    ADD KEY idx_node_category (ontology_id, prop_category);
+
+-- 3. 扩展属性检索 (attr_value 为 TEXT，只能建前缀索引)
+ALTER TABLE attribute ADD KEY idx_attr_name_value (attr_name, attr_value(191));
@@ -0,0 +1,451 @@
+#include "AIExtractionPipeline.h"
+#include "FuzzyNameIndex.h"
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+#include <QSslConfiguration>
+#include <QSslSocket>
+#include <QJsonDocument>
+#include <QRandomGenerator>
+#include <QTimer>
+#include <QDebug>
+
+const QString AIExtractionPipeline::kDefaultEndpoint = "https://api.siliconflow.cn/v1/chat/completions";
+const QString AIExtractionPipeline::kDefaultModel = "Qwen/Qwen2.5-7B-Instruct";
+const int AIExtractionPipeline::kPromptVersion = 1;
+
+static const char* kSystemPrompt =
+    "你是一个知识图谱专家。请从用户提供的文本中提取实体作为节点，提取实体间的关系作为连线。"
+    "你必须严格返回合法的JSON格式，且绝对不要包含Markdown代码块符号(如```json)。"
+    "JSON的格式必须为: {\"nodes\": [{\"name\":\"实体名\", \"nodeType\":\"类型(如概念/实体/方法)\", \"description\":\"一句话描述\"}], "
+    "\"edges\": [{\"sourceName\":\"起点实体名\", \"targetName\":\"终点实体名\", \"relationType\":\"关系词\"}]}";
+
+AIExtractionPipeline::AIExtractionPipeline(QObject *parent)
+    : QObject(parent), m_network(new QNetworkAccessManager(this)),
+      m_endpoint(kDefaultEndpoint), m_model(kDefaultModel),
+      m_chunkSize(1500), m_overlap(200), m_maxConcurrent(4), m_maxRetries(3), m_backoffMs(1000), m_timeoutMs(120000),
+      m_streaming(true), m_completed(0), m_failed(0), m_cacheHits(0), m_running(false),
+      m_flushTimer(new QTimer(this)), m_nodeCount(0), m_edgeCount(0) {
+    // 流式解析出的实体按 200ms 合并发出
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(200);
+    connect(m_flushTimer, &QTimer::timeout, this, &AIExtractionPipeline::flushStaged);
+}
+
+// --- 分段 ---
+
+// 超长段落按句末标点切开，找不到断句点就硬切
+static QStringList splitLongParagraph(const QString& text, int chunkSize) {
+    static const QString kBreakChars = QStringLiteral("。！？；.!?;");
+    QStringList parts;
+    int start = 0;
+    while (start < text.size()) {
+        int end = qMin(start + chunkSize, text.size());
+        if (end < text.size()) {
+            for (int i = end - 1; i > start + chunkSize / 2; --i) {
+                if (kBreakChars.contains(text[i])) {
+                    end = i + 1;
+                    break;
+                }
+            }
+        }
+        parts << text.mid(start, end - start);
+        start = end;
+    }
+    return parts;
+}
+
+QStringList AIExtractionPipeline::splitIntoChunks(const QString& text, int chunkSize, int overlap) {
+    QStringList chunks;
+    if (text.isEmpty()) return chunks;
+    if (chunkSize <= 0 || text.size() <= chunkSize) return {text};
+    overlap = qBound(0, overlap, chunkSize / 2);
+
+    // 1. 切成段落单元
+    QStringList units;
+    for (const QString& line : text.split('\n')) {
+        if (line.trimmed().isEmpty()) continue;
+        if (line.size() + 1 <= chunkSize - overlap) units << line + '\n';
+        else units << splitLongParagraph(line, chunkSize - overlap);
+    }
+
+    // 2. 按内容定界打包：分段边界由段落内容的哈希决定而不是字符偏移，
+    //    文档中间增删内容后，后续分段会重新对齐到同样的边界，抽取缓存仍能命中
+    QString current;
+    int bodySize = 0;
+    auto flush = [&]() {
+        if (bodySize == 0) return;
+        chunks << current;
+        current = current.right(overlap);
+        bodySize = 0;
+    };
+    for (const QString& unit : units) {
+        if (bodySize > 0 && current.size() + unit.size() > chunkSize) flush();
+        current += unit;
+        bodySize += unit.size();
+        if (current.size() >= chunkSize / 2 && qHash(unit, 0) % 4 == 0) flush();
+    }
+    flush();
+    return chunks;
+}
+
+bool AIExtractionPipeline::parseExtraction(const QString& content, QJsonArray& nodes, QJsonArray& edges) {
+    QString cleaned = content.trimmed();
+    // 清理可能误带的 Markdown 代码块标签
+    if (cleaned.startsWith("```json")) cleaned.remove(0, 7);
+    if (cleaned.startsWith("```")) cleaned.remove(0, 3);
+    if (cleaned.endsWith("```")) cleaned.chop(3);
+
+    QJsonDocument doc = QJsonDocument::fromJson(cleaned.toUtf8());
+    if (!doc.isObject()) return false;
+
+    nodes = doc.object().value("nodes").toArray();
+    edges = doc.object().value("edges").toArray();
+    return true;
+}
+
+// --- 调度 ---
+
+void AIExtractionPipeline::start(const QString& text) {
+    cancel();
+
+    m_jobs.clear();
+    m_pending.clear();
+    m_canonicalName.clear();
+    m_edgeKeys.clear();
+    m_pendingEdges.clear();
+    m_stagedNodes = QJsonArray();
+    m_stagedEdges = QJsonArray();
+    m_completed = m_failed = m_nodeCount = m_edgeCount = 0;
+
+    m_cacheHits = 0;
+    for (const QString& chunk : splitIntoChunks(text, m_chunkSize, m_overlap)) {
+        ChunkJob job;
+        job.text = chunk;
+        job.cacheKey = ExtractionCache::key(chunk, m_model, kPromptVersion);
+        m_pending.enqueue(m_jobs.size());
+        m_jobs.append(job);
+    }
+
+    m_running = true;
+    emit progress(0, m_jobs.size());
+    // 延后到事件循环再调度，全部命中缓存时结果也不会在 start() 返回前同步发出
+    QTimer::singleShot(0, this, [this]() {
+        if (m_jobs.isEmpty()) checkFinished();
+        else dispatch();
+    });
+}
+
+void AIExtractionPipeline::cancel() {
+    if (!m_running) return;
+    m_running = false;
+    m_pending.clear();
+    m_streams.clear();
+    m_flushTimer->stop();
+    // abort 会同步触发 finished，先取出集合再逐个中止
+    QSet<QNetworkReply*> replies = m_inFlight;
+    m_inFlight.clear();
+    for (QNetworkReply* reply : replies) {
+        reply->abort();
+        reply->deleteLater();
+    }
+}
+
+void AIExtractionPipeline::dispatch() {
+    while (m_running && m_inFlight.size() < m_maxConcurrent && !m_pending.isEmpty()) {
+        int index = m_pending.dequeue();
+
+        // 命中磁盘缓存的分段不占并发名额，也不走网络
+        QJsonArray nodes;
+        QJsonArray edges;
+        if (m_jobs[index].attempts == 0 && m_cache.lookup(m_jobs[index].cacheKey, nodes, edges)) {
+            m_cacheHits++;
+            completeChunk(index, nodes, edges);
+            continue;
+        }
+        sendChunk(index);
+    }
+}
+
+QJsonObject AIExtractionPipeline::buildRequestBody(const QString& chunk) const {
+    QJsonArray messages;
+    messages.append(QJsonObject{{"role", "system"}, {"content", QString::fromUtf8(kSystemPrompt)}});
+    messages.append(QJsonObject{{"role", "user"}, {"content", chunk}});
+
+    QJsonObject body;
+    body["model"] = m_model;
+    body["messages"] = messages;
+    body["response_format"] = QJsonObject{{"type", "json_object"}};
+    if (m_streaming) body["stream"] = true;
+    return body;
+}
+
+void AIExtractionPipeline::sendChunk(int index) {
+    QNetworkRequest request(m_endpoint);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    request.setRawHeader("Authorization", ("Bearer " + m_apiKey).toUtf8());
+
+    // 沿用原有的 SSL 兼容配置，跳过 Linux 下可能存在的本地证书校验问题
+    if (m_endpoint.scheme() == "https") {
+        QSslConfiguration sslConfig = QSslConfiguration::defaultConfiguration();
+        sslConfig.setPeerVerifyMode(QSslSocket::VerifyNone);
+        sslConfig.setProtocol(QSsl::AnyProtocol);
+        request.setSslConfiguration(sslConfig);
+    }
+
+    m_jobs[index].attempts++;
+    QNetworkReply* reply = m_network->post(request, QJsonDocument(buildRequestBody(m_jobs[index].text)).toJson());
+    m_inFlight.insert(reply);
+    if (m_streaming) m_streams.insert(reply, StreamState());
+
+    connect(reply, &QNetworkReply::readyRead, this, [this, reply]() { onReplyReadyRead(reply); });
+    connect(reply, &QNetworkReply::finished, this, [this, reply, index]() { onReplyFinished(reply, index); });
+    // 超时中止，按网络错误走重试
+    QTimer::singleShot(m_timeoutMs, reply, [reply]() {
+        if (reply->isRunning()) reply->abort();
+    });
+}
+
+static bool isEventStream(QNetworkReply* reply) {
+    return reply->header(QNetworkRequest::ContentTypeHeader).toString().contains("text/event-stream");
+}
+
+void AIExtractionPipeline::onReplyReadyRead(QNetworkReply* reply) {
+    auto it = m_streams.find(reply);
+    // 非流式响应留在 reply 缓冲区里，等 finished 时整包读取
+    if (it == m_streams.end() || !isEventStream(reply)) return;
+
+    it->buffer += reply->readAll();
+    QJsonArray nodes;
+    QJsonArray edges;
+    consumeEventLines(*it, nodes, edges);
+    stage(nodes, edges);
+}
+
+void AIExtractionPipeline::consumeEventLines(StreamState& state, QJsonArray& nodes, QJsonArray& edges) {
+    int newline;
+    while ((newline = state.buffer.indexOf('\n')) >= 0) {
+        QByteArray line = state.buffer.left(newline).trimmed();
+        state.buffer.remove(0, newline + 1);
+
+        // SSE 只关心 data: 行，空行、注释和 [DONE] 结束标记都跳过
+        if (!line.startsWith("data:")) continue;
+        QByteArray data = line.mid(5).trimmed();
+        if (data == "[DONE]") continue;
+
+        QString delta = QJsonDocument::fromJson(data).object()["choices"].toArray()[0]
+                            .toObject()["delta"].toObject()["content"].toString();
+        if (!delta.isEmpty()) {
+            int nodeBefore = nodes.size();
+            int edgeBefore = edges.size();
+            state.parser.feed(delta, nodes, edges);
+            for (int i = nodeBefore; i < nodes.size(); ++i) state.nodes.append(nodes[i]);
+            for (int i = edgeBefore; i < edges.size(); ++i) state.edges.append(edges[i]);
+        }
+    }
+}
+
+void AIExtractionPipeline::onReplyFinished(QNetworkReply* reply, int index) {
+    if (!m_inFlight.remove(reply)) return; // 已被 cancel() 接管
+    reply->deleteLater();
+
+    // 流式响应：处理末尾不带换行的残余数据，实体此前已陆续暂存
+    bool streamed = false;
+    bool streamComplete = false;
+    QJsonArray streamNodes;
+    QJsonArray streamEdges;
+    auto it = m_streams.find(reply);
+    if (it != m_streams.end()) {
+        if (isEventStream(reply)) {
+            streamed = true;
+            it->buffer += reply->readAll();
+            it->buffer += '\n';
+            QJsonArray nodes;
+            QJsonArray edges;
+            consumeEventLines(*it, nodes, edges);
+            stage(nodes, edges);
+            streamComplete = it->parser.isComplete();
+            streamNodes = it->nodes;
+            streamEdges = it->edges;
+        }
+        m_streams.erase(it);
+    }
+
+    int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    QByteArray body = streamed ? QByteArray() : reply->readAll();
+
+    // 鉴权失败对所有分段都一样，直接终止
+    if (status == 401 || status == 403) {
+        cancel();
+        emit failed(QString("接口鉴权失败 (HTTP %1)，请检查 API Key").arg(status));
+        return;
+    }
+
+    // 流在回答闭合前被断开也重试，已发出的实体会被合并去重
+    bool retryable = status == 429 || status >= 500
+                  || (status == 0 && reply->error() != QNetworkReply::NoError)
+                  || (streamed && !streamComplete);
+    if (retryable) {
+        if (m_jobs[index].attempts <= m_maxRetries) {
+            int delay = m_backoffMs * (1 << (m_jobs[index].attempts - 1))
+                      + int(QRandomGenerator::global()->bounded(250));
+            bool ok = false;
+            int retryAfter = reply->rawHeader("Retry-After").toInt(&ok);
+            if (ok && retryAfter > 0) delay = qMax(delay, retryAfter * 1000);
+            qWarning() << "AI 抽取: 分段" << index << "失败，" << delay << "ms 后重试:" << reply->errorString();
+            scheduleRetry(index, delay);
+        } else {
+            qWarning() << "AI 抽取: 分段" << index << "重试次数用尽:" << reply->errorString();
+            m_failed++;
+            emit progress(m_completed + m_failed, m_jobs.size());
+            checkFinished();
+        }
+        dispatch();
+        return;
+    }
+
+    if (streamed) {
+        m_cache.store(m_jobs[index].cacheKey, streamNodes, streamEdges);
+        completeChunk(index, QJsonArray(), QJsonArray());
+        dispatch();
+        return;
+    }
+
+    QJsonArray nodes;
+    QJsonArray edges;
+    QString content = QJsonDocument::fromJson(body).object()["choices"].toArray()[0]
+                          .toObject()["message"].toObject()["content"].toString();
+    if (reply->error() != QNetworkReply::NoError || !parseExtraction(content, nodes, edges)) {
+        qWarning() << "AI 抽取: 分段" << index << "返回内容无法解析";
+        m_failed++;
+        emit progress(m_completed + m_failed, m_jobs.size());
+        checkFinished();
+        dispatch();
+        return;
+    }
+
+    m_cache.store(m_jobs[index].cacheKey, nodes, edges);
+    completeChunk(index, nodes, edges);
+    dispatch();
+}
+
+void AIExtractionPipeline::scheduleRetry(int index, int delayMs) {
+    QTimer::singleShot(delayMs, this, [this, index]() {
+        if (!m_running) return;
+        m_pending.prepend(index);
+        dispatch();
+    });
+}
+
+void AIExtractionPipeline::completeChunk(int index, const QJsonArray& nodes, const QJsonArray& edges) {
+    Q_UNUSED(index);
+    QJsonArray newNodes;
+    QJsonArray readyEdges;
+    merge(nodes, edges, newNodes, readyEdges);
+    for (const QJsonValue& v : newNodes) m_stagedNodes.append(v);
+    for (const QJsonValue& v : readyEdges) m_stagedEdges.append(v);
+    if (!m_stagedNodes.isEmpty() || !m_stagedEdges.isEmpty()) flushStaged();
+
+    m_completed++;
+    emit progress(m_completed + m_failed, m_jobs.size());
+    checkFinished();
+}
+
+void AIExtractionPipeline::checkFinished() {
+    if (!m_running || m_completed + m_failed < m_jobs.size()) return;
+    m_running = false;
+
+    // 端点始终没在抽取结果中出现的关系也发出，由调用方对照库中已有节点决定取舍
+    for (const QJsonObject& edge : m_pendingEdges) m_stagedEdges.append(edge);
+    m_edgeCount += m_pendingEdges.size();
+    m_pendingEdges.clear();
+    flushStaged();
+    emit finished(m_nodeCount, m_edgeCount, m_failed);
+}
+
+// --- 暂存与发出 ---
+
+void AIExtractionPipeline::stage(const QJsonArray& nodes, const QJsonArray& edges) {
+    if (nodes.isEmpty() && edges.isEmpty()) return;
+
+    QJsonArray newNodes;
+    QJsonArray readyEdges;
+    merge(nodes, edges, newNodes, readyEdges);
+    for (const QJsonValue& v : newNodes) m_stagedNodes.append(v);
+    for (const QJsonValue& v : readyEdges) m_stagedEdges.append(v);
+
+    if ((!m_stagedNodes.isEmpty() || !m_stagedEdges.isEmpty()) && !m_flushTimer->isActive()) {
+        m_flushTimer->start();
+    }
+}
+
+void AIExtractionPipeline::flushStaged() {
+    m_flushTimer->stop();
+    if (m_stagedNodes.isEmpty() && m_stagedEdges.isEmpty()) return;
+
+    QJsonArray nodes = m_stagedNodes;
+    QJsonArray edges = m_stagedEdges;
+    m_stagedNodes = QJsonArray();
+    m_stagedEdges = QJsonArray();
+    emit chunkExtracted(nodes, edges);
+}
+
+// --- 合并去重 ---
+
+QString AIExtractionPipeline::entityKey(const QString& name) {
+    QString key = FuzzyNameIndex::normalize(name);
+    return key.isEmpty() ? name.trimmed().toLower() : key;
+}
+
+void AIExtractionPipeline::merge(const QJsonArray& nodes, const QJsonArray& edges,
+                                 QJsonArray& newNodes, QJsonArray& readyEdges) {
+    for (const QJsonValue& value : nodes) {
+        QJsonObject node = value.toObject();
+        QString name = node["name"].toString().trimmed();
+        if (name.isEmpty()) continue;
+
+        QString key = entityKey(name);
+        if (m_canonicalName.contains(key)) continue; // 重叠区或其他分段已抽到
+        m_canonicalName.insert(key, name);
+        node["name"] = name;
+        newNodes.append(node);
+        m_nodeCount++;
+    }
+
+    auto tryResolve = [this](QJsonObject& edge) {
+        QString src = m_canonicalName.value(entityKey(edge["sourceName"].toString()));
+        QString dst = m_canonicalName.value(entityKey(edge["targetName"].toString()));
+        if (src.isEmpty() || dst.isEmpty()) return false;
+        edge["sourceName"] = src;
+        edge["targetName"] = dst;
+        return true;
+    };
+
+    // 新节点可能让之前挂起的关系变得可连接
+    for (int i = m_pendingEdges.size() - 1; i >= 0; --i) {
+        if (tryResolve(m_pendingEdges[i])) {
+            readyEdges.append(m_pendingEdges.takeAt(i));
+            m_edgeCount++;
+        }
+    }
+
+    for (const QJsonValue& value : edges) {
+        QJsonObject edge = value.toObject();
+        QString srcName = edge["sourceName"].toString().trimmed();
+        QString dstName = edge["targetName"].toString().trimmed();
+        if (srcName.isEmpty() || dstName.isEmpty()) continue;
+
+        QString edgeKey = entityKey(srcName) + "|" + entityKey(dstName) + "|" + edge["relationType"].toString();
+        if (m_edgeKeys.contains(edgeKey)) continue;
+        m_edgeKeys.insert(edgeKey);
+
+        edge["sourceName"] = srcName;
+        edge["targetName"] = dstName;
+        if (tryResolve(edge)) {
+            readyEdges.append(edge);
+            m_edgeCount++;
+        } else {
+            m_pendingEdges.append(edge);
+        }
+    }
+}
@@ -0,0 +1,138 @@
+#ifndef AIEXTRACTIONPIPELINE_H
+#define AIEXTRACTIONPIPELINE_H
+
+#include <QObject>
+#include <QStringList>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QHash>
+#include <QSet>
+#include <QQueue>
+#include <QVector>
+#include <QUrl>
+#include "ExtractionStreamParser.h"
+#include "ExtractionCache.h"
+
+class QNetworkAccessManager;
+class QNetworkReply;
+class QTimer;
+
+/**
+ * @brief 分段并发的 AI 知识抽取流水线
+ *
+ * 长文本按段落/句子边界切成相互重叠的分段，最多 maxConcurrent 个请求同时在途；
+ * 网络错误、429 和 5xx 按指数退避重试 (优先遵守 Retry-After)。
+ * 每个分段完成后与已有结果按规范化名称合并去重，只把新出现的实体通过 chunkExtracted 发出，
+ * 调用方可以边抽取边入库。关系要等两端实体都出现后才发出，剩余的在结束前统一发出。
+ *
+ * 默认以 "stream": true 请求，按 SSE 逐段读取模型输出，实体对象一闭合就暂存，
+ * 暂存结果按短间隔合并发出，避免每个对象都触发一次入库刷新。服务端不支持流式时
+ * (响应不是 text/event-stream) 自动退回整包解析。
+ *
+ * 接口地址可配置，调试时可以指向 tools/mock_ai_server.py 提供的本地模拟服务。
+ */
+class AIExtractionPipeline : public QObject {
+    Q_OBJECT
+public:
+    static const QString kDefaultEndpoint;
+    static const QString kDefaultModel;
+    // 提示词变更时递增，供结果缓存区分
+    static const int kPromptVersion;
+
+    explicit AIExtractionPipeline(QObject *parent = nullptr);
+
+    void setEndpoint(const QUrl& endpoint) { m_endpoint = endpoint; }
+    void setApiKey(const QString& apiKey) { m_apiKey = apiKey; }
+    void setModel(const QString& model) { m_model = model; }
+    void setChunking(int chunkSize, int overlap) { m_chunkSize = chunkSize; m_overlap = overlap; }
+    void setMaxConcurrent(int maxConcurrent) { m_maxConcurrent = qMax(1, maxConcurrent); }
+    void setRetryPolicy(int maxRetries, int backoffMs) { m_maxRetries = maxRetries; m_backoffMs = backoffMs; }
+    void setTimeout(int timeoutMs) { m_timeoutMs = timeoutMs; }
+    void setStreaming(bool streaming) { m_streaming = streaming; }
+    void setCacheEnabled(bool enabled) { m_cache.setEnabled(enabled); }
+
+    void start(const QString& text);
+    void cancel();
+    bool isRunning() const { return m_running; }
+    // 本轮命中磁盘缓存、跳过网络请求的分段数
+    int cacheHits() const { return m_cacheHits; }
+
+    /**
+     * @brief 把文本切成重叠分段，边界落在段落处并由段落内容决定 (超长段落在句末标点处断开)
+     * @param chunkSize 每段最大字符数
+     * @param overlap 相邻分段重叠的字符数，避免跨段的实体关系丢失
+     */
+    static QStringList splitIntoChunks(const QString& text, int chunkSize, int overlap);
+    // 解析模型回答 (容忍 Markdown 代码块包裹)
+    static bool parseExtraction(const QString& content, QJsonArray& nodes, QJsonArray& edges);
+
+signals:
+    void chunkExtracted(QJsonArray nodes, QJsonArray edges);
+    void progress(int finishedChunks, int totalChunks);
+    void finished(int nodeCount, int edgeCount, int failedChunks);
+    void failed(const QString& error);
+
+private:
+    struct ChunkJob {
+        QString text;
+        QString cacheKey;
+        int attempts = 0;
+    };
+
+    // 单个流式响应的读取状态
+    struct StreamState {
+        QByteArray buffer;              // 尚未凑成整行的 SSE 数据
+        ExtractionStreamParser parser;
+        QJsonArray nodes;               // 本分段解析出的全部实体，成功后写入缓存
+        QJsonArray edges;
+    };
+
+    void dispatch();
+    void sendChunk(int index);
+    void onReplyReadyRead(QNetworkReply* reply);
+    void onReplyFinished(QNetworkReply* reply, int index);
+    void consumeEventLines(StreamState& state, QJsonArray& nodes, QJsonArray& edges);
+    void stage(const QJsonArray& nodes, const QJsonArray& edges);
+    void flushStaged();
+    void scheduleRetry(int index, int delayMs);
+    void completeChunk(int index, const QJsonArray& nodes, const QJsonArray& edges);
+    void checkFinished();
+    QJsonObject buildRequestBody(const QString& chunk) const;
+
+    // 合并去重：返回本段新增的节点与已可连接的关系
+    void merge(const QJsonArray& nodes, const QJsonArray& edges, QJsonArray& newNodes, QJsonArray& readyEdges);
+    static QString entityKey(const QString& name);
+
+    QNetworkAccessManager* m_network;
+    ExtractionCache m_cache;
+    QUrl m_endpoint;
+    QString m_apiKey;
+    QString m_model;
+    int m_chunkSize;
+    int m_overlap;
+    int m_maxConcurrent;
+    int m_maxRetries;
+    int m_backoffMs;
+    int m_timeoutMs;
+    bool m_streaming;
+
+    QVector<ChunkJob> m_jobs;
+    QQueue<int> m_pending;
+    QSet<QNetworkReply*> m_inFlight;
+    QHash<QNetworkReply*, StreamState> m_streams;
+    int m_completed;
+    int m_failed;
+    int m_cacheHits;
+    bool m_running;
+
+    QHash<QString, QString> m_canonicalName;   // 规范化键 -> 首次出现的名称
+    QSet<QString> m_edgeKeys;
+    QList<QJsonObject> m_pendingEdges;         // 端点尚未出现的关系
+    QJsonArray m_stagedNodes;                  // 已合并、等待发出的实体
+    QJsonArray m_stagedEdges;
+    QTimer* m_flushTimer;
+    int m_nodeCount;
+    int m_edgeCount;
+};
+
+#endif // AIEXTRACTIONPIPELINE_H
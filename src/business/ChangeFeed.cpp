@@ -0,0 +1,112 @@
+#include "ChangeFeed.h"
+#include "GraphEditor.h"
+#include "../database/ChangeLogRepository.h"
+#include "../database/NodeRepository.h"
+#include "../database/RelationshipRepository.h"
+#include "../database/MemoryGraphStore.h"
+#include <QTimer>
+#include <QHash>
+#include <QDebug>
+
+// 每次最多读取的日志行数，积压更多时立即接着拉下一页
+static const int kPageSize = 2000;
+
+ChangeFeed::ChangeFeed(GraphEditor* editor, QObject* parent)
+    : QObject(parent), m_editor(editor), m_timer(new QTimer(this)) {
+    m_timer->setInterval(3000);
+    connect(m_timer, &QTimer::timeout, this, &ChangeFeed::poll);
+}
+
+bool ChangeFeed::start(int ontologyId) {
+    stop();
+
+    if (!m_cursor.start(ontologyId)) {
+        qWarning() << "ChangeFeed: 无法读取变更日志，增量同步未开启";
+        return false;
+    }
+    m_timer->start();
+    return true;
+}
+
+void ChangeFeed::stop() {
+    m_timer->stop();
+    m_cursor.reset();
+}
+
+bool ChangeFeed::isRunning() const {
+    return m_timer->isActive();
+}
+
+void ChangeFeed::setInterval(int msec) {
+    m_timer->setInterval(msec);
+}
+
+void ChangeFeed::poll() {
+    if (m_cursor.ontologyId() <= 0) return;
+
+    // 1. 拉取新出现的日志
+    QList<ChangeLogEntry> entries;
+    bool hasMore = false;
+    if (!m_cursor.fetch(kPageSize, entries, &hasMore)) return;
+
+    // 2. 按实体归并：只关心本轮第一次出现时是否为新增，最终状态以数据库当前行为准
+    QHash<int, bool> nodeFirstInsert;
+    QHash<int, bool> edgeFirstInsert;
+    for (const auto& entry : entries) {
+        if (entry.own) continue; // 本客户端的修改已经在本地应用过
+        MemoryGraphStore::markStale();
+
+        QHash<int, bool>& firstInsert =
+            (entry.entityType == ChangeLogRepository::NodeEntity) ? nodeFirstInsert : edgeFirstInsert;
+        if (!firstInsert.contains(entry.entityId)) {
+            firstInsert.insert(entry.entityId, entry.op == ChangeLogRepository::OpInsert);
+        }
+    }
+
+    // 3. 批量取回当前状态：存在的是新增或修改，不存在的是删除
+    GraphChangeSet changes;
+    if (!nodeFirstInsert.isEmpty()) {
+        QList<int> ids = nodeFirstInsert.keys();
+        QHash<int, GraphNode> current;
+        for (const auto& node : NodeRepository::getNodesByIds(ids, Projection::Full)) current.insert(node.id, node);
+
+        for (int id : ids) {
+            bool inserted = nodeFirstInsert.value(id);
+            if (!current.contains(id)) {
+                if (!inserted) changes.recordNodeDeleted(id);
+            } else if (inserted) {
+                changes.recordNodeAdded(current.value(id));
+            } else {
+                changes.recordNodeUpdated(current.value(id));
+            }
+        }
+    }
+    if (!edgeFirstInsert.isEmpty()) {
+        QList<int> ids = edgeFirstInsert.keys();
+        QHash<int, GraphEdge> current;
+        for (const auto& edge : RelationshipRepository::getRelationshipsByIds(ids, Projection::Full)) {
+            current.insert(edge.id, edge);
+        }
+
+        for (int id : ids) {
+            bool inserted = edgeFirstInsert.value(id);
+            if (!current.contains(id)) {
+                if (!inserted) changes.recordEdgeDeleted(id);
+            } else if (inserted) {
+                changes.recordEdgeAdded(current.value(id));
+            } else {
+                changes.recordEdgeUpdated(current.value(id));
+            }
+        }
+    }
+
+    if (!changes.isEmpty()) {
+        qInfo() << "ChangeFeed: 同步其他客户端的修改" << changes.size() << "项，序号至" << m_cursor.position();
+        m_editor->publishExternalChanges(changes);
+    }
+
+    // 4. 还有积压时接着读下一页
+    if (hasMore) {
+        QTimer::singleShot(0, this, &ChangeFeed::poll);
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef CHANGEFEED_H
+#define CHANGEFEED_H
+
+#include <QObject>
+#include <QList>
+#include "GraphChangeSet.h"
+#include "../database/ChangeLogCursor.h"
+
+class GraphEditor;
+class QTimer;
+
+/**
+ * @brief 变更日志轮询器：定时拉取其他客户端对当前本体的修改并增量应用
+ *
+ * 每次只读取 seq 大于上次位置的 change_log 行，按实体归并后批量取回当前状态，
+ * 组装成 GraphChangeSet 交给 GraphEditor::publishExternalChanges，
+ * 由场景、布局、查询缓存和检索索引沿用批量编辑的增量路径处理。
+ * 序号空洞的处理见 ChangeLogCursor。
+ */
+class ChangeFeed : public QObject {
+    Q_OBJECT
+public:
+    explicit ChangeFeed(GraphEditor* editor, QObject* parent = nullptr);
+
+    // 从当前最新序号开始跟踪本体，应在全量加载之前调用，避免漏掉加载期间的修改
+    bool start(int ontologyId);
+    void stop();
+    bool isRunning() const;
+    void setInterval(int msec);
+
+public slots:
+    void poll();
+
+private:
+    GraphEditor* m_editor;
+    QTimer* m_timer;
+    ChangeLogCursor m_cursor;
+};
+
+#endif // CHANGEFEED_H
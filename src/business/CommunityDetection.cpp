@@ -0,0 +1,309 @@
+#include "CommunityDetection.h"
+#include "Parallel.h"
+#include <QPair>
+#include <algorithm>
+
+// 每个线程至少分到的节点数
+static const int kMinNodesPerThread = 4096;
+// 一轮移动的模块度提升低于此值视为收敛
+static const double kMinModularityGain = 1e-7;
+
+namespace {
+
+// 一层的加权无向图：邻接两个方向各存一次，不含自环；收缩后社区内部的权重记为自环
+struct LevelGraph {
+    QVector<int> offsets;
+    QVector<int> targets;
+    QVector<double> weights;
+    QVector<double> selfLoops;
+    QVector<double> degrees;     // 加权度数，自环计两次
+    double totalWeight = 0.0;    // m，每条边计一次
+
+    int size() const { return offsets.size() - 1; }
+};
+
+LevelGraph fromSnapshot(const GraphSnapshot& graph) {
+    int n = graph.nodeCount();
+    const QVector<GraphSnapshot::EdgeRecord>& edges = graph.edges();
+
+    LevelGraph g;
+    g.offsets.fill(0, n + 1);
+    g.selfLoops.fill(0.0, n);
+    g.degrees.fill(0.0, n);
+    for (const auto& e : edges) {
+        if (e.source == e.target) continue;
+        g.offsets[e.source + 1]++;
+        g.offsets[e.target + 1]++;
+    }
+    for (int i = 0; i < n; ++i) g.offsets[i + 1] += g.offsets[i];
+
+    g.targets.resize(g.offsets[n]);
+    g.weights.resize(g.offsets[n]);
+    QVector<int> pos = g.offsets;
+    for (const auto& e : edges) {
+        double w = e.weight > 0 ? e.weight : 1.0;
+        g.totalWeight += w;
+        if (e.source == e.target) {
+            g.selfLoops[e.source] += w;
+            g.degrees[e.source] += 2 * w;
+            continue;
+        }
+        g.targets[pos[e.source]] = e.target;
+        g.weights[pos[e.source]++] = w;
+        g.targets[pos[e.target]] = e.source;
+        g.weights[pos[e.target]++] = w;
+        g.degrees[e.source] += w;
+        g.degrees[e.target] += w;
+    }
+    return g;
+}
+
+double modularity(const LevelGraph& g, const QVector<int>& community, int communityCount) {
+    if (g.totalWeight <= 0) return 0.0;
+
+    QVector<double> internal(communityCount, 0.0);
+    QVector<double> total(communityCount, 0.0);
+    for (int i = 0; i < g.size(); ++i) {
+        int c = community[i];
+        total[c] += g.degrees[i];
+        internal[c] += g.selfLoops[i];
+        for (int k = g.offsets[i]; k < g.offsets[i + 1]; ++k) {
+            if (community[g.targets[k]] == c) internal[c] += g.weights[k] / 2;
+        }
+    }
+
+    double m = g.totalWeight;
+    double q = 0.0;
+    for (int c = 0; c < communityCount; ++c) {
+        q += internal[c] / m - (total[c] / (2 * m)) * (total[c] / (2 * m));
+    }
+    return q;
+}
+
+// 节点 i 增益最大的社区 (已把 i 从原社区中移出)，links 为复用的临时缓冲
+int bestCommunity(const LevelGraph& g, int i, const int* community, const double* total, double m2,
+                  QVector<QPair<int, double>>& links) {
+    int own = community[i];
+    double ki = g.degrees[i];
+
+    links.clear();   // (邻居社区, 连接权重)
+    for (int k = g.offsets[i]; k < g.offsets[i + 1]; ++k) {
+        links.append(qMakePair(community[g.targets[k]], g.weights[k]));
+    }
+    std::sort(links.begin(), links.end());
+
+    // 先求留在原社区的得分
+    double ownLink = 0.0;
+    for (const auto& link : links) {
+        if (link.first == own) ownLink += link.second;
+    }
+    double bestScore = ownLink - (total[own] - ki) * ki / m2;
+    int best = own;
+
+    for (int k = 0; k < links.size();) {
+        int c = links[k].first;
+        double link = 0.0;
+        for (; k < links.size() && links[k].first == c; ++k) link += links[k].second;
+        if (c == own) continue;
+
+        double score = link - total[c] * ki / m2;
+        if (score > bestScore + 1e-12) {
+            bestScore = score;
+            best = c;
+        }
+    }
+    return best;
+}
+
+// 经典的串行一轮：逐个节点按当前划分选社区并立即移动，每次移动都不降低模块度；返回移动次数
+int serialPass(const LevelGraph& g, QVector<int>& community, QVector<double>& total, QVector<int>& sizes, double m2) {
+    QVector<QPair<int, double>> links;
+    int moves = 0;
+    for (int i = 0; i < g.size(); ++i) {
+        int own = community[i];
+        int target = bestCommunity(g, i, community.constData(), total.constData(), m2, links);
+        if (target == own) continue;
+
+        total[own] -= g.degrees[i];
+        total[target] += g.degrees[i];
+        sizes[own]--;
+        sizes[target]++;
+        community[i] = target;
+        ++moves;
+    }
+    return moves;
+}
+
+// 局部移动，community 初始为每个节点自成一个社区；有提升返回 true
+bool moveNodes(const LevelGraph& g, QVector<int>& community, int maxPasses) {
+    int n = g.size();
+    if (n == 0 || g.totalWeight <= 0) return false;
+
+    double m2 = 2 * g.totalWeight;
+    QVector<double> total = g.degrees;   // 社区总度数，社区编号沿用初始节点下标
+    QVector<int> sizes(n, 1);
+    QVector<int> proposal(n);
+    int workers = Parallel::workerCount(n, kMinNodesPerThread);
+    // 只有一个线程时直接串行；并行一轮没有提升后也改为串行，直到本层收敛
+    bool serial = workers <= 1;
+
+    double q = modularity(g, community, n);
+    bool improved = false;
+
+    for (int pass = 0; pass < maxPasses; ++pass) {
+        if (serial) {
+            if (serialPass(g, community, total, sizes, m2) == 0) break;
+            double newQ = modularity(g, community, n);
+            improved = improved || newQ > q;
+            if (newQ <= q + kMinModularityGain) break;
+            q = newQ;
+            continue;
+        }
+
+        // 1. 并行选出每个节点增益最大的社区，只读本轮开始时的划分
+        const int* communityData = community.constData();
+        const double* totalData = total.constData();
+        int* proposalData = proposal.data();
+        Parallel::forRange(n, workers, [&g, m2, communityData, totalData, proposalData](int, int begin, int end) {
+            QVector<QPair<int, double>> links;
+            for (int i = begin; i < end; ++i) proposalData[i] = bestCommunity(g, i, communityData, totalData, m2, links);
+        });
+
+        // 2. 串行应用移动，同步更新社区总度数
+        QVector<int> before = community;
+        QVector<double> totalBefore = total;
+        QVector<int> sizesBefore = sizes;
+        int moves = 0;
+        for (int i = 0; i < n; ++i) {
+            int own = community[i];
+            int target = proposal[i];
+            if (target == own) continue;
+            // 两个单点社区同时想并入对方时只保留一个方向
+            if (sizes[own] == 1 && sizes[target] == 1 && target > own) continue;
+
+            total[own] -= g.degrees[i];
+            total[target] += g.degrees[i];
+            sizes[own]--;
+            sizes[target]++;
+            community[i] = target;
+            ++moves;
+        }
+        if (moves == 0) break;
+
+        // 3. 基于过期划分的移动可能互相抵消：模块度没有提升时撤销本轮，并从本轮开始时的划分改做串行移动，
+        //    而不是就此结束本层 (否则首轮失败时所有节点都停在单点社区)
+        double newQ = modularity(g, community, n);
+        if (newQ <= q + kMinModularityGain) {
+            community = before;
+            total = totalBefore;
+            sizes = sizesBefore;
+            serial = true;
+            --pass;   // 撤销的一轮不计入轮数
+            continue;
+        }
+        q = newQ;
+        improved = true;
+    }
+    return improved;
+}
+
+// 社区编号压缩为 0..count-1，返回社区数
+int renumber(QVector<int>& community) {
+    QVector<int> map(community.size(), -1);
+    int count = 0;
+    for (int& c : community) {
+        if (map[c] < 0) map[c] = count++;
+        c = map[c];
+    }
+    return count;
+}
+
+// 每个社区收缩为一个节点，社区之间的边合并、权重相加
+LevelGraph aggregate(const LevelGraph& g, const QVector<int>& community, int count) {
+    struct Link {
+        int from;
+        int to;
+        double weight;
+        bool operator<(const Link& other) const {
+            return from < other.from || (from == other.from && to < other.to);
+        }
+    };
+
+    LevelGraph coarse;
+    coarse.totalWeight = g.totalWeight;
+    coarse.selfLoops.fill(0.0, count);
+    coarse.degrees.fill(0.0, count);
+
+    QVector<Link> links;
+    links.reserve(g.targets.size());
+    for (int i = 0; i < g.size(); ++i) {
+        int ci = community[i];
+        coarse.degrees[ci] += g.degrees[i];
+        coarse.selfLoops[ci] += g.selfLoops[i];
+        for (int k = g.offsets[i]; k < g.offsets[i + 1]; ++k) {
+            int cj = community[g.targets[k]];
+            // 社区内部的边从两端各看到一次
+            if (ci == cj) coarse.selfLoops[ci] += g.weights[k] / 2;
+            else links.append({ci, cj, g.weights[k]});
+        }
+    }
+    std::sort(links.begin(), links.end());
+
+    coarse.offsets.fill(0, count + 1);
+    for (int k = 0; k < links.size();) {
+        Link merged = links[k];
+        for (++k; k < links.size() && links[k].from == merged.from && links[k].to == merged.to; ++k) {
+            merged.weight += links[k].weight;
+        }
+        coarse.targets.append(merged.to);
+        coarse.weights.append(merged.weight);
+        coarse.offsets[merged.from + 1]++;
+    }
+    for (int c = 0; c < count; ++c) coarse.offsets[c + 1] += coarse.offsets[c];
+    return coarse;
+}
+
+} // namespace
+
+CommunityDetection::Result CommunityDetection::louvain(const GraphSnapshot& graph, int maxLevels, int maxPassesPerLevel) {
+    Result result;
+    int n = graph.nodeCount();
+    if (n == 0) return result;
+
+    const LevelGraph base = fromSnapshot(graph);
+    LevelGraph g = base;
+    QVector<int> membership(n);   // 原始节点 -> 当前层节点
+    for (int i = 0; i < n; ++i) membership[i] = i;
+
+    for (int level = 0; level < maxLevels; ++level) {
+        QVector<int> community(g.size());
+        for (int i = 0; i < community.size(); ++i) community[i] = i;
+        if (!moveNodes(g, community, maxPassesPerLevel)) break;
+
+        int count = renumber(community);
+        for (int& node : membership) node = community[node];
+        result.levels++;
+
+        if (count == g.size()) break;
+        g = aggregate(g, community, count);
+    }
+
+    // 按规模降序重新编号，同规模时保持原先的相对顺序
+    int count = renumber(membership);
+    QVector<int> sizes(count, 0);
+    for (int c : membership) sizes[c]++;
+    QVector<int> order(count);
+    for (int c = 0; c < count; ++c) order[c] = c;
+    std::stable_sort(order.begin(), order.end(), [&sizes](int a, int b) { return sizes[a] > sizes[b]; });
+
+    QVector<int> rank(count);
+    result.sizes.resize(count);
+    for (int r = 0; r < count; ++r) {
+        rank[order[r]] = r;
+        result.sizes[r] = sizes[order[r]];
+    }
+    result.communityOf.resize(n);
+    for (int i = 0; i < n; ++i) result.communityOf[i] = rank[membership[i]];
+    result.modularity = modularity(base, result.communityOf, count);
+    return result;
+}
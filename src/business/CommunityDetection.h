@@ -0,0 +1,35 @@
+#ifndef COMMUNITYDETECTION_H
+#define COMMUNITYDETECTION_H
+
+#include <QVector>
+#include "../model/GraphSnapshot.h"
+
+/**
+ * @brief 社区发现：并行 Louvain 模块度优化
+ *
+ * 关系视为无向、以 weight 为权 (非正权按 1 计)。每一层先反复做局部移动：
+ * 各线程基于本轮开始时的社区划分为自己区间内的节点选出增益最大的社区 (只读，无写冲突)，
+ * 然后串行应用这些移动并更新社区总度数；两个单点社区互换时只允许移向编号更小的一方，避免来回振荡。
+ * 并行的一轮基于过期划分，移动可能互相抵消：模块度没有提升时撤销该轮，改为从该轮开始时的划分做经典的串行移动
+ * (逐个节点按当前划分移动，模块度单调不降)，直到本层收敛；随后把社区收缩为节点进入下一层，直到不再合并。
+ * 结果社区按规模降序编号，0 为最大的社区。
+ */
+class CommunityDetection {
+public:
+    struct Result {
+        QVector<int> communityOf;   // 快照节点下标 -> 社区编号
+        QVector<int> sizes;         // 社区编号 -> 节点数
+        double modularity = 0.0;
+        int levels = 0;
+
+        int communityCount() const { return sizes.size(); }
+    };
+
+    // 直接使用快照的关系记录，不要求 buildAdjacency()
+    static Result louvain(const GraphSnapshot& graph, int maxLevels = 10, int maxPassesPerLevel = 32);
+
+private:
+    CommunityDetection() = default;
+};
+
+#endif // COMMUNITYDETECTION_H
@@ -0,0 +1,69 @@
+#include "ExtractionCache.h"
+#include <QCryptographicHash>
+#include <QStandardPaths>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDebug>
+
+ExtractionCache::ExtractionCache() : m_enabled(true) {
+    m_dir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+          + "/KnowledgeGraphSystem/extraction";
+}
+
+QString ExtractionCache::key(const QString& chunkText, const QString& model, int promptVersion) {
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(QByteArray::number(promptVersion));
+    hash.addData("\0", 1);
+    hash.addData(model.toUtf8());
+    hash.addData("\0", 1);
+    hash.addData(chunkText.toUtf8());
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+QString ExtractionCache::filePath(const QString& key) const {
+    // 按前两位分桶，避免单目录文件过多
+    return m_dir + "/" + key.left(2) + "/" + key + ".json";
+}
+
+bool ExtractionCache::lookup(const QString& key, QJsonArray& nodes, QJsonArray& edges) const {
+    if (!m_enabled) return false;
+
+    QFile file(filePath(key));
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    if (!doc.isObject()) {
+        qWarning() << "抽取缓存文件损坏，忽略:" << file.fileName();
+        return false;
+    }
+    nodes = doc.object().value("nodes").toArray();
+    edges = doc.object().value("edges").toArray();
+    return true;
+}
+
+void ExtractionCache::store(const QString& key, const QJsonArray& nodes, const QJsonArray& edges) {
+    if (!m_enabled) return;
+
+    QString path = filePath(key);
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    // 先写临时文件再原子替换，中途退出不会留下半个缓存文件
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "无法写入抽取缓存:" << path;
+        return;
+    }
+    QJsonObject obj;
+    obj["nodes"] = nodes;
+    obj["edges"] = edges;
+    file.write(QJsonDocument(obj).toJson(QJsonDocument::Compact));
+    if (!file.commit()) qWarning() << "无法写入抽取缓存:" << path;
+}
+
+void ExtractionCache::clear() {
+    QDir(m_dir).removeRecursively();
+}
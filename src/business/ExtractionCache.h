@@ -0,0 +1,35 @@
+#ifndef EXTRACTIONCACHE_H
+#define EXTRACTIONCACHE_H
+
+#include <QString>
+#include <QJsonArray>
+
+/**
+ * @brief AI 抽取结果的磁盘缓存，按内容寻址
+ *
+ * 键为 SHA-256(提示词版本, 模型名, 分段文本)，值是该分段解析后的 nodes / edges，
+ * 每个键一个 JSON 文件，存放在用户缓存目录下。分段文本不变的情况下重复导入
+ * 完全不走网络；修改过的文档只有变动段落所在的分段需要重新请求。
+ */
+class ExtractionCache {
+public:
+    ExtractionCache();
+
+    void setEnabled(bool enabled) { m_enabled = enabled; }
+    bool isEnabled() const { return m_enabled; }
+    QString directory() const { return m_dir; }
+
+    static QString key(const QString& chunkText, const QString& model, int promptVersion);
+
+    bool lookup(const QString& key, QJsonArray& nodes, QJsonArray& edges) const;
+    void store(const QString& key, const QJsonArray& nodes, const QJsonArray& edges);
+    void clear();
+
+private:
+    QString filePath(const QString& key) const;
+
+    QString m_dir;
+    bool m_enabled;
+};
+
+#endif // EXTRACTIONCACHE_H
@@ -0,0 +1,65 @@
+#include "ExtractionStreamParser.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+
+void ExtractionStreamParser::reset() {
+    m_depth = 0;
+    m_inString = m_escape = m_capturing = m_complete = false;
+    m_string.clear();
+    m_currentKey.clear();
+    m_object.clear();
+}
+
+void ExtractionStreamParser::feed(const QString& fragment, QJsonArray& nodes, QJsonArray& edges) {
+    for (QChar c : fragment) {
+        if (m_complete) return;
+        if (m_capturing) m_object += c;
+
+        if (m_inString) {
+            if (m_escape) {
+                m_escape = false;
+            } else if (c == '\\') {
+                m_escape = true;
+            } else if (c == '"') {
+                m_inString = false;
+                if (m_depth == 1) m_currentKey = m_string;
+                continue;
+            }
+            if (m_depth == 1) m_string += c;
+            continue;
+        }
+
+        switch (c.unicode()) {
+        case '"':
+            m_inString = true;
+            m_string.clear();
+            break;
+        case '{':
+        case '[':
+            // 深度 2 是 nodes / edges 数组内部，这里开始的对象就是一个实体
+            if (c == '{' && m_depth == 2 && !m_capturing) {
+                m_capturing = true;
+                m_object = "{";
+            }
+            m_depth++;
+            break;
+        case '}':
+        case ']':
+            if (m_depth == 0) break;
+            m_depth--;
+            if (m_capturing && m_depth == 2) {
+                QJsonDocument doc = QJsonDocument::fromJson(m_object.toUtf8());
+                if (doc.isObject()) {
+                    if (m_currentKey == "nodes") nodes.append(doc.object());
+                    else if (m_currentKey == "edges") edges.append(doc.object());
+                }
+                m_capturing = false;
+                m_object.clear();
+            }
+            if (m_depth == 0) m_complete = true;
+            break;
+        default:
+            break;
+        }
+    }
+}
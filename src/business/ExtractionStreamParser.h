@@ -0,0 +1,35 @@
+#ifndef EXTRACTIONSTREAMPARSER_H
+#define EXTRACTIONSTREAMPARSER_H
+
+#include <QString>
+#include <QJsonArray>
+
+/**
+ * @brief 抽取结果的增量 JSON 解析器
+ *
+ * 模型以流式输出 {"nodes":[{...},...],"edges":[{...},...]} 时，输出会被切成任意长度的片段。
+ * 这里逐字符跟踪括号深度与字符串状态，顶层数组里的每个对象一闭合就解析出来，
+ * 不必等整个回答结束。顶层之前的杂项字符 (如 ```json) 会被忽略。
+ */
+class ExtractionStreamParser {
+public:
+    void reset();
+
+    // 追加一段模型输出，本次新闭合的节点、关系分别追加到 nodes / edges
+    void feed(const QString& fragment, QJsonArray& nodes, QJsonArray& edges);
+
+    // 顶层对象是否已闭合，即回答是否完整
+    bool isComplete() const { return m_complete; }
+
+private:
+    int m_depth = 0;
+    bool m_inString = false;
+    bool m_escape = false;
+    bool m_capturing = false;
+    bool m_complete = false;
+    QString m_string;      // 顶层对象中正在读取的字符串 (只可能是键)
+    QString m_currentKey;  // 最近一个顶层键，决定对象归入 nodes 还是 edges
+    QString m_object;      // 正在捕获的实体对象文本
+};
+
+#endif // EXTRACTIONSTREAMPARSER_H
@@ -45,6 +45,39 @@ void ForceDirectedLayout::clear() {
     m_displacements.clear();
 }
 
+void ForceDirectedLayout::seedByCommunity() {
+    if (m_nodes.isEmpty()) return;
+
+    // 社区编号越小规模越大，先放在中心；未知社区的节点各自成组放在最外圈
+    QMap<int, QList<VisualNode*>> groups;
+    QList<VisualNode*> loners;
+    for (VisualNode* node : m_nodes) {
+        if (node->getCommunity() >= 0) groups[node->getCommunity()].append(node);
+        else loners.append(node);
+    }
+    QList<QList<VisualNode*>> ordered = groups.values();
+    for (VisualNode* node : loners) ordered.append({node});
+
+    // 向日葵 (黄金角) 排布：社区中心到原点的距离按已放置的节点数开方增长，面积与规模成正比；
+    // 成员在各自中心附近同样按向日葵排布
+    const double goldenAngle = M_PI * (3.0 - qSqrt(5.0));
+    const double memberSpacing = m_idealLength * 0.5;
+    const double clusterSpacing = m_idealLength * 0.9;
+    int placed = 0;
+    for (int g = 0; g < ordered.size(); ++g) {
+        const QList<VisualNode*>& members = ordered[g];
+        double distance = clusterSpacing * qSqrt(placed + members.size() / 2.0);
+        QPointF center(distance * qCos(g * goldenAngle), distance * qSin(g * goldenAngle));
+
+        for (int i = 0; i < members.size(); ++i) {
+            double r = memberSpacing * qSqrt(i);
+            members[i]->setPos(center + QPointF(r * qCos(i * goldenAngle), r * qSin(i * goldenAngle)));
+            m_displacements[members[i]] = QPointF(0, 0);
+        }
+        placed += members.size();
+    }
+}
+
 void ForceDirectedLayout::calculate() {
     if (m_nodes.isEmpty()) return;
 
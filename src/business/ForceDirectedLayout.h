@@ -19,6 +19,9 @@ public:
     void removeEdge(VisualEdge* edge);
     void clear();
 
+    // 按 VisualNode::getCommunity() 重新摆放初始位置：各社区先分开成团，迭代从接近收敛的状态开始
+    void seedByCommunity();
+
     // 核心计算函数
     void calculate();
     void setStiffness(double val) { m_stiffness = val; }
@@ -0,0 +1,177 @@
+#include "FuzzyNameIndex.h"
+#include <QSet>
+#include <algorithm>
+
+// 墓碑不少于该数量且超过条目数的四分之一时压缩
+static const int kCompactMinDead = 1024;
+
+FuzzyNameIndex::FuzzyNameIndex(QObject *parent) : QObject(parent), m_ontologyId(-1), m_deadEntries(0) {}
+
+void FuzzyNameIndex::clear() {
+    m_entries.clear();
+    m_deadEntries = 0;
+    m_slotOf.clear();
+    m_postings.clear();
+}
+
+QString FuzzyNameIndex::normalize(const QString& name) {
+    QString result;
+    result.reserve(name.size());
+    for (QChar ch : name) {
+        if (ch.isLetterOrNumber()) result += ch.toLower();
+    }
+    return result;
+}
+
+QVector<QString> FuzzyNameIndex::trigrams(const QString& normalized) {
+    // 前补两个、后补一个空格，使短名称 (如两个汉字) 也能产生三元组
+    QString padded = "  " + normalized + " ";
+    QSet<QString> unique;
+    for (int i = 0; i + 3 <= padded.size(); ++i) {
+        unique.insert(padded.mid(i, 3));
+    }
+    return QVector<QString>(unique.begin(), unique.end());
+}
+
+int FuzzyNameIndex::boundedEditDistance(const QString& a, const QString& b, int maxEdits) {
+    int n = a.size();
+    int m = b.size();
+    if (qAbs(n - m) > maxEdits) return maxEdits + 1;
+
+    QVector<int> prev(m + 1);
+    QVector<int> curr(m + 1);
+    for (int j = 0; j <= m; ++j) prev[j] = j;
+
+    for (int i = 1; i <= n; ++i) {
+        curr[0] = i;
+        int rowMin = curr[0];
+        for (int j = 1; j <= m; ++j) {
+            int cost = (a[i - 1] == b[j - 1]) ? 0 : 1;
+            curr[j] = qMin(qMin(prev[j] + 1, curr[j - 1] + 1), prev[j - 1] + cost);
+            rowMin = qMin(rowMin, curr[j]);
+        }
+        // 整行都超过上界，后面只会更大
+        if (rowMin > maxEdits) return maxEdits + 1;
+        std::swap(prev, curr);
+    }
+    return qMin(prev[m], maxEdits + 1);
+}
+
+void FuzzyNameIndex::addNode(const GraphNode& node) {
+    if (node.id <= 0 || node.name.isEmpty()) return;
+    if (m_ontologyId > 0 && node.ontologyId > 0 && node.ontologyId != m_ontologyId) return;
+    if (m_slotOf.contains(node.id)) {
+        updateNode(node);
+        return;
+    }
+
+    Entry entry;
+    entry.nodeId = node.id;
+    entry.name = node.name;
+    entry.normalized = normalize(node.name);
+    QVector<QString> grams = trigrams(entry.normalized);
+    entry.trigramCount = grams.size();
+
+    int slot = m_entries.size();
+    m_entries.append(entry);
+    m_slotOf[node.id] = slot;
+    for (const QString& gram : grams) {
+        m_postings[gram].append(slot);
+    }
+}
+
+void FuzzyNameIndex::updateNode(const GraphNode& node) {
+    auto it = m_slotOf.constFind(node.id);
+    if (it != m_slotOf.constEnd() && m_entries[it.value()].name == node.name) return;
+    removeNode(node.id);
+    addNode(node);
+}
+
+void FuzzyNameIndex::removeNode(int nodeId) {
+    auto it = m_slotOf.find(nodeId);
+    if (it == m_slotOf.end()) return;
+
+    int slot = it.value();
+    Entry& entry = m_entries[slot];
+    for (const QString& gram : trigrams(entry.normalized)) {
+        auto posting = m_postings.find(gram);
+        if (posting == m_postings.end()) continue;
+
+        // 倒排表无序，与末尾交换后删除，不搬动后面的元素
+        QVector<int>& list = posting.value();
+        int index = list.indexOf(slot);
+        if (index >= 0) {
+            list[index] = list.last();
+            list.removeLast();
+        }
+        if (list.isEmpty()) m_postings.erase(posting);
+    }
+    entry.nodeId = -1;
+    entry.name.clear();
+    entry.normalized.clear();
+    m_slotOf.erase(it);
+    m_deadEntries++;
+    compactIfNeeded();
+}
+
+void FuzzyNameIndex::compactIfNeeded() {
+    if (m_deadEntries < kCompactMinDead || m_deadEntries * 4 <= m_entries.size()) return;
+
+    QVector<int> remap(m_entries.size(), -1);
+    QVector<Entry> entries;
+    entries.reserve(m_entries.size() - m_deadEntries);
+    for (int slot = 0; slot < m_entries.size(); ++slot) {
+        if (m_entries[slot].nodeId <= 0) continue;
+        remap[slot] = entries.size();
+        m_slotOf[m_entries[slot].nodeId] = entries.size();
+        entries.append(m_entries[slot]);
+    }
+
+    // 删除时已从倒排表中摘掉，这里只需改写下标
+    for (auto it = m_postings.begin(); it != m_postings.end(); ++it) {
+        for (int& slot : it.value()) slot = remap[slot];
+    }
+    m_entries = entries;
+    m_deadEntries = 0;
+}
+
+QList<FuzzyMatch> FuzzyNameIndex::lookup(const QString& name, int maxEdits, int limit) const {
+    QList<FuzzyMatch> matches;
+    QString query = normalize(name);
+    if (query.isEmpty() || maxEdits < 0) return matches;
+
+    QVector<QString> grams = trigrams(query);
+    int queryLen = query.size();
+
+    // 1. 统计每个候选与查询共享的三元组数，顺便按长度差过滤
+    QHash<int, int> shared;
+    for (const QString& gram : grams) {
+        auto it = m_postings.constFind(gram);
+        if (it == m_postings.constEnd()) continue;
+        for (int slot : it.value()) {
+            if (qAbs(m_entries[slot].normalized.size() - queryLen) > maxEdits) continue;
+            shared[slot]++;
+        }
+    }
+
+    // 2. q-gram 下界过滤后再做编辑距离校验
+    int minShared = grams.size() - 3 * maxEdits;
+    for (auto it = shared.constBegin(); it != shared.constEnd(); ++it) {
+        if (it.value() < minShared) continue;
+        const Entry& entry = m_entries[it.key()];
+        if (entry.nodeId <= 0) continue;
+
+        int distance = boundedEditDistance(query, entry.normalized, maxEdits);
+        if (distance > maxEdits) continue;
+
+        double unionSize = grams.size() + entry.trigramCount - it.value();
+        matches.append({entry.nodeId, entry.name, distance, unionSize > 0 ? it.value() / unionSize : 0.0});
+    }
+
+    std::sort(matches.begin(), matches.end(), [](const FuzzyMatch& a, const FuzzyMatch& b) {
+        if (a.distance != b.distance) return a.distance < b.distance;
+        return a.similarity > b.similarity;
+    });
+    if (limit > 0 && matches.size() > limit) matches = matches.mid(0, limit);
+    return matches;
+}
@@ -0,0 +1,68 @@
+#ifndef FUZZYNAMEINDEX_H
+#define FUZZYNAMEINDEX_H
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include <QString>
+#include "../model/GraphNode.h"
+
+/**
+ * @brief 模糊匹配结果
+ */
+struct FuzzyMatch {
+    int nodeId;
+    QString name;
+    int distance;      // 规范化后的编辑距离
+    double similarity; // 三元组 Jaccard 相似度
+};
+
+/**
+ * @brief 节点名称的三元组 (trigram) 索引，用于容错/模糊查找
+ *
+ * 查找分两步：先按共享三元组个数筛出候选 (编辑距离为 k 时至少共享 |T(q)| - 3k 个三元组)，
+ * 再对候选做带上界的编辑距离校验。名称先规范化：转小写并去掉空白和标点。
+ */
+class FuzzyNameIndex : public QObject {
+    Q_OBJECT
+public:
+    explicit FuzzyNameIndex(QObject *parent = nullptr);
+
+    void clear();
+    int ontologyId() const { return m_ontologyId; }
+    void setOntologyId(int ontologyId) { m_ontologyId = ontologyId; }
+
+    /**
+     * @brief 查找编辑距离不超过 maxEdits 的名称，按距离、相似度排序
+     */
+    QList<FuzzyMatch> lookup(const QString& name, int maxEdits, int limit = 10) const;
+
+    static QString normalize(const QString& name);
+    // 带上界的编辑距离：超过 maxEdits 时提前返回 maxEdits + 1
+    static int boundedEditDistance(const QString& a, const QString& b, int maxEdits);
+
+public slots:
+    void addNode(const GraphNode& node);
+    void updateNode(const GraphNode& node);
+    void removeNode(int nodeId);
+
+private:
+    struct Entry {
+        int nodeId;
+        QString name;
+        QString normalized;
+        int trigramCount;
+    };
+
+    static QVector<QString> trigrams(const QString& normalized);
+    // 墓碑占到一定比例时去掉空条目并重排倒排表中的下标
+    void compactIfNeeded();
+
+    int m_ontologyId;
+    QVector<Entry> m_entries;                    // 删除时置 nodeId = -1，不移动下标，直到压缩
+    int m_deadEntries;
+    QHash<int, int> m_slotOf;                    // nodeId -> m_entries 下标
+    QHash<QString, QVector<int>> m_postings;     // 三元组 -> 条目下标 (无序)
+};
+
+#endif // FUZZYNAMEINDEX_H
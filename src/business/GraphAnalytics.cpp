@@ -0,0 +1,433 @@
+#include "GraphAnalytics.h"
+#include "../database/NodeRepository.h"
+#include "../database/RelationshipRepository.h"
+#include "Parallel.h"
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+// 介数/接近度的抽样源点数，BFS 次数与之成正比
+static const int kCentralitySamples = 256;
+// 每个线程至少分到的节点数，太小时线程开销超过收益
+static const int kMinNodesPerThread = 4096;
+// 抽样中心性各线程私有数组的总内存上限 (字节)，大图时据此减少线程数
+static const qint64 kCentralityMemoryBudget = 128ll * 1024 * 1024;
+
+// 无向视角的邻居：出边的终点与入边的起点
+template <typename Visit>
+static inline void forEachNeighbor(const GraphSnapshot& graph, int v, Visit visit) {
+    const int* outOffsets = graph.outOffsets().constData();
+    const int* outEdges = graph.outEdges().constData();
+    const int* inOffsets = graph.inOffsets().constData();
+    const int* inEdges = graph.inEdges().constData();
+    const GraphSnapshot::EdgeRecord* edges = graph.edges().constData();
+
+    for (int i = outOffsets[v]; i < outOffsets[v + 1]; ++i) visit(edges[outEdges[i]].target);
+    for (int i = inOffsets[v]; i < inOffsets[v + 1]; ++i) visit(edges[inEdges[i]].source);
+}
+
+// 同上，但平行边、互逆边 (A->B 与 B->A) 只给出一次邻居：无向视角下它们是同一跳。
+// mark 为每个线程私有的标记数组，stamp 每次调用递增，回绕时清零
+template <typename Visit>
+static inline void forEachDistinctNeighbor(const GraphSnapshot& graph, int v, QVector<quint32>& mark,
+                                           quint32& stamp, Visit visit) {
+    if (++stamp == 0) {
+        mark.fill(0);
+        stamp = 1;
+    }
+    quint32* marks = mark.data();
+    const quint32 current = stamp;
+    forEachNeighbor(graph, v, [&](int u) {
+        if (marks[u] == current) return;
+        marks[u] = current;
+        visit(u);
+    });
+}
+
+// --- 缓存 ---
+
+GraphAnalytics::GraphAnalytics(QObject *parent)
+    : QObject(parent), m_serial(0), m_snapshotSerial(0), m_freshAfter(0), m_pendingSerial(0),
+      m_metricsJobSerial(0), m_metricsJobOntology(-1), m_communitiesJobSerial(0), m_communitiesJobOntology(-1),
+      m_metricsReady(false), m_communitiesReady(false), m_samples(0), m_elapsedMs(0) {}
+
+GraphAnalytics::~GraphAnalytics() {
+    for (const QPointer<QThread>& thread : m_jobs) {
+        if (!thread) continue;
+        thread->wait();
+        delete thread.data();
+    }
+}
+
+void GraphAnalytics::clear() {
+    m_snapshot.reset(-1);
+    m_pending = GraphSnapshot();
+    m_pageRank.clear();
+    m_betweenness.clear();
+    m_closeness.clear();
+    m_communities = CommunityDetection::Result();
+    m_samples = 0;
+    m_elapsedMs = 0;
+    m_metricsReady = false;
+    m_communitiesReady = false;
+    // 之前读取的快照全部作废，仍在计算的结果回来后会被丢弃
+    m_snapshotSerial = m_serial;
+    m_freshAfter = m_serial;
+}
+
+void GraphAnalytics::invalidate() {
+    m_freshAfter = m_serial;
+    m_pending = GraphSnapshot();
+}
+
+bool GraphAnalytics::readSnapshot(int ontologyId, GraphSnapshot& snapshot, quint64& serial) {
+    if (isCurrent(ontologyId)) {
+        snapshot = m_snapshot;
+        serial = m_snapshotSerial;
+        return true;
+    }
+    if (m_pendingSerial > m_freshAfter && m_pendingSerial > m_snapshotSerial && m_pending.ontologyId() == ontologyId) {
+        snapshot = m_pending;
+        serial = m_pendingSerial;
+        return true;
+    }
+
+    GraphSnapshot fresh;
+    if (!NodeRepository::fillSnapshot(ontologyId, fresh)
+        || !RelationshipRepository::fillSnapshot(ontologyId, fresh)) {
+        return false;
+    }
+    m_pending = fresh;
+    m_pendingSerial = ++m_serial;
+    snapshot = fresh;
+    serial = m_pendingSerial;
+    return true;
+}
+
+bool GraphAnalytics::adoptSnapshot(const GraphSnapshot& snapshot, quint64 serial) {
+    if (serial < m_snapshotSerial) return false;
+    if (serial == m_snapshotSerial) return snapshot.ontologyId() == m_snapshot.ontologyId();
+
+    m_snapshot = snapshot;
+    m_snapshotSerial = serial;
+    if (m_pendingSerial == serial) m_pending = GraphSnapshot();
+
+    // 旧结果按旧快照的下标存放，换快照后不能再用
+    m_pageRank.clear();
+    m_betweenness.clear();
+    m_closeness.clear();
+    m_communities = CommunityDetection::Result();
+    m_samples = 0;
+    m_elapsedMs = 0;
+    m_metricsReady = false;
+    m_communitiesReady = false;
+    return true;
+}
+
+bool GraphAnalytics::ensureSnapshot(int ontologyId) {
+    if (ontologyId <= 0) return false;
+    if (isCurrent(ontologyId)) return true;
+
+    GraphSnapshot snapshot;
+    quint64 serial = 0;
+    if (!readSnapshot(ontologyId, snapshot, serial)) {
+        clear();
+        return false;
+    }
+    adoptSnapshot(snapshot, serial);
+    return true;
+}
+
+void GraphAnalytics::startJob(const std::function<void()>& work, const std::function<void()>& done) {
+    m_jobs.removeAll(QPointer<QThread>());
+
+    QThread* thread = QThread::create(work);
+    connect(thread, &QThread::finished, this, done);
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+    m_jobs.append(thread);
+    thread->start();
+}
+
+// --- 中心性 ---
+
+GraphAnalytics::Metrics GraphAnalytics::computeMetrics(const GraphSnapshot& graph) {
+    QElapsedTimer timer;
+    timer.start();
+
+    Metrics metrics;
+    metrics.pageRank = pageRank(graph);
+    metrics.samples = qMin(kCentralitySamples, graph.nodeCount());
+    sampledCentrality(graph, metrics.samples, metrics.betweenness, metrics.closeness);
+    metrics.elapsedMs = timer.elapsed();
+    return metrics;
+}
+
+void GraphAnalytics::setMetrics(const Metrics& metrics) {
+    m_pageRank = metrics.pageRank;
+    m_betweenness = metrics.betweenness;
+    m_closeness = metrics.closeness;
+    m_samples = metrics.samples;
+    m_elapsedMs = metrics.elapsedMs;
+    m_metricsReady = true;
+    qInfo() << "GraphAnalytics: 本体" << m_snapshot.ontologyId() << "节点" << m_snapshot.nodeCount()
+            << "关系" << m_snapshot.edgeCount() << "分析耗时" << m_elapsedMs << "ms";
+}
+
+bool GraphAnalytics::refresh(int ontologyId) {
+    if (!ensureSnapshot(ontologyId)) return false;
+    if (!m_metricsReady) setMetrics(computeMetrics(m_snapshot));
+    return true;
+}
+
+bool GraphAnalytics::refreshAsync(int ontologyId) {
+    if (ontologyId <= 0) return false;
+    if (isCurrent(ontologyId) && m_metricsReady) return true;
+    if (m_metricsJobSerial > m_freshAfter && m_metricsJobOntology == ontologyId) return true;
+
+    GraphSnapshot snapshot;
+    quint64 serial = 0;
+    if (!readSnapshot(ontologyId, snapshot, serial)) return false;
+
+    // 线程各持一份快照的浅拷贝，只读访问，不受主线程随后替换 m_snapshot 的影响
+    m_metricsJobSerial = serial;
+    m_metricsJobOntology = ontologyId;
+    auto metrics = std::make_shared<Metrics>();
+    startJob([snapshot, metrics]() { *metrics = computeMetrics(snapshot); },
+             [this, snapshot, serial, metrics]() {
+        if (m_metricsJobSerial == serial) m_metricsJobSerial = 0;
+        if (!adoptSnapshot(snapshot, serial)) return;
+        setMetrics(*metrics);
+        emit metricsReady(snapshot.ontologyId());
+    });
+    return true;
+}
+
+// --- 社区 ---
+
+void GraphAnalytics::setCommunities(const CommunityDetection::Result& communities, qint64 elapsedMs) {
+    m_communities = communities;
+    m_communitiesReady = true;
+    qInfo() << "GraphAnalytics: 本体" << m_snapshot.ontologyId() << "划分出" << m_communities.communityCount()
+            << "个社区，模块度" << m_communities.modularity << "耗时" << elapsedMs << "ms";
+}
+
+bool GraphAnalytics::refreshCommunities(int ontologyId) {
+    if (!ensureSnapshot(ontologyId)) return false;
+    if (m_communitiesReady) return true;
+
+    QElapsedTimer timer;
+    timer.start();
+    CommunityDetection::Result communities = CommunityDetection::louvain(m_snapshot);
+    setCommunities(communities, timer.elapsed());
+    return true;
+}
+
+bool GraphAnalytics::refreshCommunitiesAsync(int ontologyId) {
+    if (ontologyId <= 0) return false;
+    if (isCurrent(ontologyId) && m_communitiesReady) return true;
+    if (m_communitiesJobSerial > m_freshAfter && m_communitiesJobOntology == ontologyId) return true;
+
+    GraphSnapshot snapshot;
+    quint64 serial = 0;
+    if (!readSnapshot(ontologyId, snapshot, serial)) return false;
+
+    m_communitiesJobSerial = serial;
+    m_communitiesJobOntology = ontologyId;
+    auto communities = std::make_shared<CommunityDetection::Result>();
+    auto elapsedMs = std::make_shared<qint64>(0);
+    startJob([snapshot, communities, elapsedMs]() {
+        QElapsedTimer timer;
+        timer.start();
+        *communities = CommunityDetection::louvain(snapshot);
+        *elapsedMs = timer.elapsed();
+    }, [this, snapshot, serial, communities, elapsedMs]() {
+        if (m_communitiesJobSerial == serial) m_communitiesJobSerial = 0;
+        if (!adoptSnapshot(snapshot, serial)) return;
+        setCommunities(*communities, *elapsedMs);
+        emit communitiesReady(snapshot.ontologyId());
+    });
+    return true;
+}
+
+int GraphAnalytics::communityOf(int nodeId) const {
+    int index = m_snapshot.nodeIndex(nodeId);
+    if (index < 0) return -1;
+    return m_communities.communityOf.value(index, -1);
+}
+
+const QVector<double>& GraphAnalytics::scores(Metric metric) const {
+    switch (metric) {
+    case Betweenness: return m_betweenness;
+    case Closeness: return m_closeness;
+    case PageRank: break;
+    }
+    return m_pageRank;
+}
+
+QList<int> GraphAnalytics::topNodes(Metric metric, int limit) const {
+    const QVector<double>& values = scores(metric);
+    QVector<int> order(values.size());
+    for (int i = 0; i < order.size(); ++i) order[i] = i;
+
+    int count = qBound(0, limit, order.size());
+    std::partial_sort(order.begin(), order.begin() + count, order.end(), [&values](int a, int b) {
+        return values[a] > values[b] || (values[a] == values[b] && a < b);
+    });
+    return order.mid(0, count).toList();
+}
+
+// --- PageRank ---
+
+QVector<double> GraphAnalytics::pageRank(const GraphSnapshot& graph, double damping,
+                                         int maxIterations, double tolerance) {
+    int n = graph.nodeCount();
+    if (n == 0 || !graph.hasAdjacency()) return QVector<double>();
+
+    QVector<double> rank(n, 1.0 / n);
+    QVector<double> next(n, 0.0);
+    QVector<double> share(n, 0.0);   // 每个节点沿每条出边分出的得分
+    int workers = Parallel::workerCount(n, kMinNodesPerThread);
+    QVector<double> diffs(workers, 0.0);
+
+    const int* inOffsets = graph.inOffsets().constData();
+    const int* inEdges = graph.inEdges().constData();
+    const GraphSnapshot::EdgeRecord* edges = graph.edges().constData();
+
+    for (int iter = 0; iter < maxIterations; ++iter) {
+        double dangling = 0.0;
+        for (int v = 0; v < n; ++v) {
+            int outDegree = graph.outDegree(v);
+            if (outDegree == 0) dangling += rank[v];
+            share[v] = outDegree > 0 ? rank[v] / outDegree : 0.0;
+        }
+        double base = (1.0 - damping) / n + damping * dangling / n;
+
+        // 各线程只写自己区间内的 next 和自己的 diffs 槽位
+        const double* shareData = share.constData();
+        const double* rankData = rank.constData();
+        double* nextData = next.data();
+        double* diffData = diffs.data();
+        Parallel::forRange(n, workers, [=](int w, int begin, int end) {
+            double diff = 0.0;
+            for (int v = begin; v < end; ++v) {
+                double sum = 0.0;
+                for (int i = inOffsets[v]; i < inOffsets[v + 1]; ++i) sum += shareData[edges[inEdges[i]].source];
+                nextData[v] = base + damping * sum;
+                diff += std::fabs(nextData[v] - rankData[v]);
+            }
+            diffData[w] = diff;
+        });
+
+        rank.swap(next);
+        double totalDiff = 0.0;
+        for (double d : diffs) totalDiff += d;
+        if (totalDiff < tolerance) break;
+    }
+    return rank;
+}
+
+// --- 抽样 Brandes ---
+
+void GraphAnalytics::sampledCentrality(const GraphSnapshot& graph, int samples,
+                                       QVector<double>& betweenness, QVector<double>& closeness) {
+    int n = graph.nodeCount();
+    betweenness.fill(0.0, n);
+    closeness.fill(0.0, n);
+    if (n < 2 || samples <= 0 || !graph.hasAdjacency()) return;
+
+    // 1. 选源点：固定种子的部分洗牌，同一张图每次结果相同
+    QVector<int> sources(n);
+    for (int i = 0; i < n; ++i) sources[i] = i;
+    int k = qMin(samples, n);
+    QRandomGenerator random(20240601);
+    for (int i = 0; i < k; ++i) {
+        int j = i + int(random.bounded(quint32(n - i)));
+        std::swap(sources[i], sources[j]);
+    }
+    sources.resize(k);
+
+    // 2. 每个线程处理一部分源点，累加到自己的数组；
+    //    每个线程约占 4 个 double 数组 (介数、接近度、sigma、delta) 与 2 个 32 位数组 (dist、mark)，按内存上限限制线程数
+    qint64 bytesPerWorker = qint64(n) * (4 * sizeof(double) + 2 * sizeof(int));
+    int memoryWorkers = int(qMax<qint64>(1, kCentralityMemoryBudget / bytesPerWorker));
+    int workers = qMin(Parallel::workerCount(k, 1), memoryWorkers);
+    QVector<QVector<double>> partialBetweenness(workers, QVector<double>(n, 0.0));
+    QVector<QVector<double>> partialCloseness(workers, QVector<double>(n, 0.0));
+    QVector<double*> betweennessOut(workers);
+    QVector<double*> closenessOut(workers);
+    for (int w = 0; w < workers; ++w) {
+        betweennessOut[w] = partialBetweenness[w].data();
+        closenessOut[w] = partialCloseness[w].data();
+    }
+    const int* sourceData = sources.constData();
+
+    Parallel::forRange(k, workers, [&graph, n, sourceData, &betweennessOut, &closenessOut](int w, int begin, int end) {
+        double* bc = betweennessOut[w];
+        double* cc = closenessOut[w];
+        QVector<int> dist(n, -1);
+        QVector<double> sigma(n, 0.0);   // 最短路条数
+        QVector<double> delta(n, 0.0);   // 依赖值
+        QVector<int> order;              // BFS 访问顺序，逆序即为回溯顺序
+        order.reserve(n);
+        QVector<quint32> mark(n, 0);     // 邻居去重
+        quint32 stamp = 0;
+
+        for (int si = begin; si < end; ++si) {
+            int s = sourceData[si];
+            dist[s] = 0;
+            sigma[s] = 1.0;
+            order.append(s);
+
+            for (int head = 0; head < order.size(); ++head) {
+                int v = order[head];
+                forEachDistinctNeighbor(graph, v, mark, stamp, [&](int u) {
+                    if (dist[u] < 0) {
+                        dist[u] = dist[v] + 1;
+                        order.append(u);
+                    }
+                    if (dist[u] == dist[v] + 1) sigma[u] += sigma[v];
+                });
+            }
+
+            for (int i = 1; i < order.size(); ++i) cc[order[i]] += 1.0 / dist[order[i]];
+
+            // 前驱不单独存放，回溯时按 dist 差 1 重新识别
+            for (int i = order.size() - 1; i > 0; --i) {
+                int x = order[i];
+                double coefficient = (1.0 + delta[x]) / sigma[x];
+                forEachDistinctNeighbor(graph, x, mark, stamp, [&](int v) {
+                    if (dist[v] == dist[x] - 1) delta[v] += sigma[v] * coefficient;
+                });
+                bc[x] += delta[x];
+            }
+
+            // 只重置本次访问过的节点
+            for (int v : order) {
+                dist[v] = -1;
+                sigma[v] = 0.0;
+                delta[v] = 0.0;
+            }
+            order.clear();
+        }
+    });
+
+    // 3. 合并并外推到全部源点：无向图每对节点被两端各计一次，介数再除以 2
+    double scale = double(n) / k;
+    double betweennessNorm = n > 2 ? 2.0 / (double(n - 1) * (n - 2)) : 0.0;
+    double closenessNorm = 1.0 / (n - 1);
+    for (int w = 0; w < workers; ++w) {
+        const double* bc = partialBetweenness[w].constData();
+        const double* cc = partialCloseness[w].constData();
+        for (int v = 0; v < n; ++v) {
+            betweenness[v] += bc[v];
+            closeness[v] += cc[v];
+        }
+    }
+    for (int v = 0; v < n; ++v) {
+        betweenness[v] = qMin(1.0, betweenness[v] * scale / 2.0 * betweennessNorm);
+        closeness[v] = qMin(1.0, closeness[v] * scale * closenessNorm);
+    }
+}
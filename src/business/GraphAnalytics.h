@@ -0,0 +1,126 @@
+#ifndef GRAPHANALYTICS_H
+#define GRAPHANALYTICS_H
+
+#include <QObject>
+#include <QList>
+#include <QPointer>
+#include <QThread>
+#include <QVector>
+#include <functional>
+#include "../model/GraphSnapshot.h"
+#include "CommunityDetection.h"
+
+/**
+ * @brief 图结构分析：PageRank、近似介数中心性、调和接近中心性与社区划分
+ *
+ * 在 GraphSnapshot 的 CSR 邻接上计算，按 QThread::idealThreadCount() 切分到多个线程：
+ *   - PageRank 沿关系方向，悬挂节点的得分均分给全体节点，逐节点拉取入边，线程间无写冲突
+ *   - 介数与接近度把关系视为无向，从抽样的源点做 Brandes 广度优先累积，每个线程各自累加后合并；
+ *     抽样数不小于节点数时即为精确值。两者共用同一批 BFS，结果都归一化到 [0, 1]；
+ *     平行边与互逆边只算一跳，线程数受各线程私有数组的内存上限约束
+ * 社区划分见 CommunityDetection，与中心性共用同一份快照，但各自在首次需要时才计算。
+ * 结果按本体缓存，GraphEditor 发出 graphChanged 后只标记过期，下次 refresh() 时才重新读取快照并计算。
+ * refreshAsync() / refreshCommunitiesAsync() 把计算放到后台线程：快照仍在调用线程读取 (仓库使用主线程的数据库连接与类型字典)，
+ * 计算期间上一次的结果照常可读，完成后按快照的先后顺序替换，过期的快照算完也不会覆盖更新的结果。
+ */
+class GraphAnalytics : public QObject {
+    Q_OBJECT
+public:
+    enum Metric { PageRank, Betweenness, Closeness };
+
+    explicit GraphAnalytics(QObject *parent = nullptr);
+    // 等待仍在运行的后台计算结束
+    ~GraphAnalytics();
+
+    void clear();
+    // 结果不属于该本体或已过期时重新读取快照并计算中心性，失败返回 false
+    bool refresh(int ontologyId);
+    // 同上，但只计算社区划分
+    bool refreshCommunities(int ontologyId);
+    bool isCurrent(int ontologyId) const { return m_snapshotSerial > m_freshAfter && m_snapshot.ontologyId() == ontologyId; }
+
+    // 在后台线程计算中心性，完成后发出 metricsReady()；结果已是最新或同一快照正在计算时不重复启动。
+    // 只有读取快照失败时返回 false
+    bool refreshAsync(int ontologyId);
+    // 是否有该本体的中心性结果 (可能已过期，配合 isCurrent() 判断)
+    bool hasMetrics(int ontologyId) const { return m_metricsReady && m_snapshot.ontologyId() == ontologyId; }
+    // 同上，在后台线程做社区划分，完成后发出 communitiesReady()
+    bool refreshCommunitiesAsync(int ontologyId);
+    bool hasCommunities(int ontologyId) const { return m_communitiesReady && m_snapshot.ontologyId() == ontologyId; }
+
+    // 计算所用的快照，得分按快照中的节点下标存放
+    const GraphSnapshot& snapshot() const { return m_snapshot; }
+    double score(Metric metric, int index) const { return scores(metric).value(index); }
+    // 按得分降序的前 limit 个节点下标
+    QList<int> topNodes(Metric metric, int limit) const;
+
+    // --- 社区 ---
+    // 节点所属社区 (0 为最大的社区)，未计算或节点不在快照中返回 -1；结果过期后仍可用于着色
+    int communityOf(int nodeId) const;
+    int communityCount() const { return m_communities.communityCount(); }
+    double modularity() const { return m_communities.modularity; }
+
+    int sampleCount() const { return m_samples; }
+    qint64 elapsedMs() const { return m_elapsedMs; }
+
+    // --- 算法 (可单独使用，只读访问 graph，须已 buildAdjacency) ---
+    static QVector<double> pageRank(const GraphSnapshot& graph, double damping = 0.85,
+                                    int maxIterations = 100, double tolerance = 1e-6);
+    // samples 个源点的 Brandes 抽样，同时得到介数与调和接近度
+    static void sampledCentrality(const GraphSnapshot& graph, int samples,
+                                  QVector<double>& betweenness, QVector<double>& closeness);
+
+signals:
+    void metricsReady(int ontologyId);
+    void communitiesReady(int ontologyId);
+
+public slots:
+    void invalidate();
+
+private:
+    struct Metrics {
+        QVector<double> pageRank;
+        QVector<double> betweenness;
+        QVector<double> closeness;
+        int samples = 0;
+        qint64 elapsedMs = 0;
+    };
+
+    static Metrics computeMetrics(const GraphSnapshot& graph);
+    void setMetrics(const Metrics& metrics);
+    void setCommunities(const CommunityDetection::Result& communities, qint64 elapsedMs);
+
+    const QVector<double>& scores(Metric metric) const;
+    // 快照不属于该本体或已过期时清空全部结果并重新读取
+    bool ensureSnapshot(int ontologyId);
+    // 取该本体的最新快照：当前快照未过期时直接复用，其次复用后台计算已读入但尚未采用的快照
+    bool readSnapshot(int ontologyId, GraphSnapshot& snapshot, quint64& serial);
+    // 采用计算所用的快照；比当前快照新时清空旧结果，比当前快照旧时返回 false (结果应丢弃)
+    bool adoptSnapshot(const GraphSnapshot& snapshot, quint64 serial);
+    // work 在新线程中执行，结束后在本对象所在线程调用 done
+    void startJob(const std::function<void()>& work, const std::function<void()>& done);
+
+    // 每次读取快照分配递增的序号，序号大于 m_freshAfter 的快照未过期
+    GraphSnapshot m_snapshot;
+    quint64 m_serial;
+    quint64 m_snapshotSerial;
+    quint64 m_freshAfter;
+    GraphSnapshot m_pending;
+    quint64 m_pendingSerial;
+    quint64 m_metricsJobSerial;   // 正在计算中心性的快照序号，0 表示没有
+    int m_metricsJobOntology;
+    quint64 m_communitiesJobSerial;
+    int m_communitiesJobOntology;
+    QList<QPointer<QThread>> m_jobs;
+
+    bool m_metricsReady;
+    bool m_communitiesReady;
+    CommunityDetection::Result m_communities;
+    QVector<double> m_pageRank;
+    QVector<double> m_betweenness;
+    QVector<double> m_closeness;
+    int m_samples;
+    qint64 m_elapsedMs;
+};
+
+#endif // GRAPHANALYTICS_H
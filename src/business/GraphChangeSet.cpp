@@ -0,0 +1,109 @@
+#include "GraphChangeSet.h"
+#include <algorithm>
+
+template <typename T>
+static void appendIndexed(QList<T>& list, QHash<int, int>& index, const T& item) {
+    index.insert(item.id, list.size());
+    list.append(item);
+}
+
+// 有记录时覆盖并返回 true
+template <typename T>
+static bool replaceIndexed(QList<T>& list, const QHash<int, int>& index, const T& item) {
+    auto it = index.constFind(item.id);
+    if (it == index.constEnd()) return false;
+    list[it.value()] = item;
+    return true;
+}
+
+// 与末尾元素交换后删除，只需改写被移动元素的下标
+template <typename T>
+static bool takeIndexed(QList<T>& list, QHash<int, int>& index, int id) {
+    auto it = index.find(id);
+    if (it == index.end()) return false;
+
+    int i = it.value();
+    index.erase(it);
+    int last = list.size() - 1;
+    if (i != last) {
+        list[i] = list[last];
+        index[list[i].id] = i;
+    }
+    list.removeLast();
+    return true;
+}
+
+// 批量删除后整体重建索引，删除本身已是线性的
+template <typename T, typename Pred>
+static void removeIfIndexed(QList<T>& list, QHash<int, int>& index, Pred pred) {
+    int before = list.size();
+    list.erase(std::remove_if(list.begin(), list.end(), pred), list.end());
+    if (list.size() == before) return;
+
+    index.clear();
+    for (int i = 0; i < list.size(); ++i) index.insert(list[i].id, i);
+}
+
+// --- 节点 ---
+
+void GraphChangeSet::recordNodeAdded(const GraphNode& node) {
+    appendIndexed(addedNodes, m_addedNodeIndex, node);
+}
+
+void GraphChangeSet::recordNodeUpdated(const GraphNode& node) {
+    if (replaceIndexed(addedNodes, m_addedNodeIndex, node)) return;
+    if (!replaceIndexed(updatedNodes, m_updatedNodeIndex, node)) appendIndexed(updatedNodes, m_updatedNodeIndex, node);
+}
+
+void GraphChangeSet::recordNodeDeleted(int nodeId) {
+    // 级联：与该节点相连的关系随之消失
+    auto touches = [nodeId](const GraphEdge& e) { return e.sourceId == nodeId || e.targetId == nodeId; };
+    removeIfIndexed(addedEdges, m_addedEdgeIndex, touches);
+    removeIfIndexed(updatedEdges, m_updatedEdgeIndex, touches);
+
+    if (takeIndexed(addedNodes, m_addedNodeIndex, nodeId)) return;
+    takeIndexed(updatedNodes, m_updatedNodeIndex, nodeId);
+    deletedNodeIds.append(nodeId);
+}
+
+// --- 关系 ---
+
+void GraphChangeSet::recordEdgeAdded(const GraphEdge& edge) {
+    appendIndexed(addedEdges, m_addedEdgeIndex, edge);
+}
+
+void GraphChangeSet::recordEdgeUpdated(const GraphEdge& edge) {
+    if (replaceIndexed(addedEdges, m_addedEdgeIndex, edge)) return;
+    if (!replaceIndexed(updatedEdges, m_updatedEdgeIndex, edge)) appendIndexed(updatedEdges, m_updatedEdgeIndex, edge);
+}
+
+void GraphChangeSet::recordEdgeDeleted(int edgeId) {
+    if (takeIndexed(addedEdges, m_addedEdgeIndex, edgeId)) return;
+    takeIndexed(updatedEdges, m_updatedEdgeIndex, edgeId);
+    deletedEdgeIds.append(edgeId);
+}
+
+// --- 汇总 ---
+
+bool GraphChangeSet::isEmpty() const {
+    return size() == 0;
+}
+
+int GraphChangeSet::size() const {
+    return addedNodes.size() + updatedNodes.size() + deletedNodeIds.size()
+         + addedEdges.size() + updatedEdges.size() + deletedEdgeIds.size();
+}
+
+void GraphChangeSet::clear() {
+    addedNodes.clear();
+    updatedNodes.clear();
+    deletedNodeIds.clear();
+    addedEdges.clear();
+    updatedEdges.clear();
+    deletedEdgeIds.clear();
+    external = false;
+    m_addedNodeIndex.clear();
+    m_updatedNodeIndex.clear();
+    m_addedEdgeIndex.clear();
+    m_updatedEdgeIndex.clear();
+}
@@ -0,0 +1,45 @@
+#ifndef GRAPHCHANGESET_H
+#define GRAPHCHANGESET_H
+
+#include <QList>
+#include <QHash>
+#include "../model/GraphNode.h"
+#include "../model/GraphEdge.h"
+
+/**
+ * @brief 一次批量编辑的净变更集合
+ *
+ * 记录时即做归并：批内新增后又修改的实体只出现在 added 中，新增后又删除的实体整体消失，
+ * 删除节点时一并丢弃与其相连的新增/修改关系 (数据库会级联删除)。
+ * 监听方按 删除 -> 新增 -> 修改 的顺序应用即可得到正确结果。
+ * 新增/修改列表旁各有一个 ID -> 下标 的索引，归并不必线性查找；撤掉记录时与末尾交换，列表内顺序不保证。
+ */
+struct GraphChangeSet {
+    QList<GraphNode> addedNodes;
+    QList<GraphNode> updatedNodes;
+    QList<int> deletedNodeIds;
+    QList<GraphEdge> addedEdges;
+    QList<GraphEdge> updatedEdges;
+    QList<int> deletedEdgeIds;
+    // 来自其他客户端 (ChangeFeed 回放的 change_log)，而非本机的编辑；会改变视图内容的反应可据此跳过
+    bool external = false;
+
+    void recordNodeAdded(const GraphNode& node);
+    void recordNodeUpdated(const GraphNode& node);
+    void recordNodeDeleted(int nodeId);
+    void recordEdgeAdded(const GraphEdge& edge);
+    void recordEdgeUpdated(const GraphEdge& edge);
+    void recordEdgeDeleted(int edgeId);
+
+    bool isEmpty() const;
+    int size() const;
+    void clear();
+
+private:
+    QHash<int, int> m_addedNodeIndex;
+    QHash<int, int> m_updatedNodeIndex;
+    QHash<int, int> m_addedEdgeIndex;
+    QHash<int, int> m_updatedEdgeIndex;
+};
+
+#endif // GRAPHCHANGESET_H
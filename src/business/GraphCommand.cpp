@@ -0,0 +1,185 @@
+#include "GraphCommand.h"
+
+template <typename T>
+static void appendIndexed(T& list, QHash<int, int>& index, const typename T::value_type& item) {
+    index.insert(item.id, list.size());
+    list.append(item);
+}
+
+// 与末尾元素交换后删除，只需改写被移动元素的下标
+template <typename T>
+static void removeIndexed(T& list, QHash<int, int>& index, int i) {
+    index.remove(list[i].id);
+    int last = list.size() - 1;
+    if (i != last) {
+        list[i] = list[last];
+        index[list[i].id] = i;
+    }
+    list.removeLast();
+}
+
+// 把新的字段变化并入已有记录：保留最早的前值，更新为最新的后值
+static void mergeFields(QVector<FieldDelta>& into, const QVector<FieldDelta>& fields) {
+    for (const FieldDelta& delta : fields) {
+        bool found = false;
+        for (FieldDelta& existing : into) {
+            if (existing.field == delta.field) {
+                existing.after = delta.after;
+                found = true;
+                break;
+            }
+        }
+        if (!found) into.append(delta);
+    }
+}
+
+// --- 节点 ---
+
+void GraphCommand::recordNodeInserted(const GraphNode& node) {
+    appendIndexed(insertedNodes, m_insertedNodeIndex, node);
+}
+
+void GraphCommand::recordNodeUpdated(const GraphNode& before, const GraphNode& after) {
+    QVector<FieldDelta> fields = diffNodes(before, after);
+    if (fields.isEmpty()) return;
+
+    int inserted = m_insertedNodeIndex.value(after.id, -1);
+    if (inserted >= 0) {
+        applyNodeFields(insertedNodes[inserted], fields, true);
+        return;
+    }
+    int updated = m_nodeUpdateIndex.value(after.id, -1);
+    if (updated >= 0) mergeFields(nodeUpdates[updated].fields, fields);
+    else appendIndexed(nodeUpdates, m_nodeUpdateIndex, {after.id, fields});
+}
+
+void GraphCommand::recordNodeDeleted(const GraphNode& before) {
+    int inserted = m_insertedNodeIndex.value(before.id, -1);
+    if (inserted >= 0) {
+        removeIndexed(insertedNodes, m_insertedNodeIndex, inserted);
+        return;
+    }
+
+    // 本命令里改过的节点，按命令开始前的状态记录
+    GraphNode snapshot = before;
+    int updated = m_nodeUpdateIndex.value(before.id, -1);
+    if (updated >= 0) {
+        applyNodeFields(snapshot, nodeUpdates[updated].fields, false);
+        removeIndexed(nodeUpdates, m_nodeUpdateIndex, updated);
+    }
+    deletedNodes.append(snapshot);
+}
+
+// --- 关系 ---
+
+void GraphCommand::recordEdgeInserted(const GraphEdge& edge) {
+    appendIndexed(insertedEdges, m_insertedEdgeIndex, edge);
+}
+
+void GraphCommand::recordEdgeUpdated(const GraphEdge& before, const GraphEdge& after) {
+    QVector<FieldDelta> fields = diffEdges(before, after);
+    if (fields.isEmpty()) return;
+
+    int inserted = m_insertedEdgeIndex.value(after.id, -1);
+    if (inserted >= 0) {
+        applyEdgeFields(insertedEdges[inserted], fields, true);
+        return;
+    }
+    int updated = m_edgeUpdateIndex.value(after.id, -1);
+    if (updated >= 0) mergeFields(edgeUpdates[updated].fields, fields);
+    else appendIndexed(edgeUpdates, m_edgeUpdateIndex, {after.id, fields});
+}
+
+void GraphCommand::recordEdgeDeleted(const GraphEdge& before) {
+    int inserted = m_insertedEdgeIndex.value(before.id, -1);
+    if (inserted >= 0) {
+        removeIndexed(insertedEdges, m_insertedEdgeIndex, inserted);
+        return;
+    }
+
+    GraphEdge snapshot = before;
+    int updated = m_edgeUpdateIndex.value(before.id, -1);
+    if (updated >= 0) {
+        applyEdgeFields(snapshot, edgeUpdates[updated].fields, false);
+        removeIndexed(edgeUpdates, m_edgeUpdateIndex, updated);
+    }
+    deletedEdges.append(snapshot);
+}
+
+// --- 汇总 ---
+
+bool GraphCommand::isEmpty() const {
+    return insertedNodes.isEmpty() && deletedNodes.isEmpty() && nodeUpdates.isEmpty()
+        && insertedEdges.isEmpty() && deletedEdges.isEmpty() && edgeUpdates.isEmpty();
+}
+
+void GraphCommand::clear() {
+    text.clear();
+    insertedNodes.clear();
+    deletedNodes.clear();
+    nodeUpdates.clear();
+    insertedEdges.clear();
+    deletedEdges.clear();
+    edgeUpdates.clear();
+    m_insertedNodeIndex.clear();
+    m_nodeUpdateIndex.clear();
+    m_insertedEdgeIndex.clear();
+    m_edgeUpdateIndex.clear();
+}
+
+// --- 字段差异 ---
+
+QVector<FieldDelta> GraphCommand::diffNodes(const GraphNode& before, const GraphNode& after) {
+    QVector<FieldDelta> fields;
+    if (before.nodeType != after.nodeType) fields.append({NodeTypeField, before.nodeType, after.nodeType});
+    if (before.name != after.name) fields.append({NodeNameField, before.name, after.name});
+    if (before.description != after.description) fields.append({NodeDescriptionField, before.description, after.description});
+    if (before.posX != after.posX) fields.append({NodePosXField, before.posX, after.posX});
+    if (before.posY != after.posY) fields.append({NodePosYField, before.posY, after.posY});
+    if (before.color != after.color) fields.append({NodeColorField, before.color, after.color});
+
+    // properties 按序列化字节比较，未解析的一侧不会被展开
+    QByteArray propsBefore = before.properties.toBytes();
+    QByteArray propsAfter = after.properties.toBytes();
+    if (propsBefore != propsAfter) fields.append({NodePropertiesField, propsBefore, propsAfter});
+    return fields;
+}
+
+QVector<FieldDelta> GraphCommand::diffEdges(const GraphEdge& before, const GraphEdge& after) {
+    QVector<FieldDelta> fields;
+    if (before.relationType != after.relationType) fields.append({EdgeTypeField, before.relationType, after.relationType});
+    if (before.weight != after.weight) fields.append({EdgeWeightField, before.weight, after.weight});
+
+    QByteArray propsBefore = before.properties.toBytes();
+    QByteArray propsAfter = after.properties.toBytes();
+    if (propsBefore != propsAfter) fields.append({EdgePropertiesField, propsBefore, propsAfter});
+    return fields;
+}
+
+void GraphCommand::applyNodeFields(GraphNode& node, const QVector<FieldDelta>& fields, bool useAfter) {
+    for (const FieldDelta& delta : fields) {
+        const QVariant& value = useAfter ? delta.after : delta.before;
+        switch (delta.field) {
+        case NodeTypeField:        node.nodeType = value.toString(); break;
+        case NodeNameField:        node.name = value.toString(); break;
+        case NodeDescriptionField: node.description = value.toString(); break;
+        case NodePosXField:        node.posX = value.toFloat(); break;
+        case NodePosYField:        node.posY = value.toFloat(); break;
+        case NodeColorField:       node.color = value.toString(); break;
+        case NodePropertiesField:  node.properties = JsonProperties::fromRaw(value.toByteArray()); break;
+        default: break;
+        }
+    }
+}
+
+void GraphCommand::applyEdgeFields(GraphEdge& edge, const QVector<FieldDelta>& fields, bool useAfter) {
+    for (const FieldDelta& delta : fields) {
+        const QVariant& value = useAfter ? delta.after : delta.before;
+        switch (delta.field) {
+        case EdgeTypeField:       edge.relationType = value.toString(); break;
+        case EdgeWeightField:     edge.weight = value.toFloat(); break;
+        case EdgePropertiesField: edge.properties = JsonProperties::fromRaw(value.toByteArray()); break;
+        default: break;
+        }
+    }
+}
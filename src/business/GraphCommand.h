@@ -0,0 +1,74 @@
+#ifndef GRAPHCOMMAND_H
+#define GRAPHCOMMAND_H
+
+#include <QList>
+#include <QHash>
+#include <QVector>
+#include <QVariant>
+#include <QString>
+#include "../model/GraphNode.h"
+#include "../model/GraphEdge.h"
+
+/**
+ * @brief 单个字段的前后值
+ */
+struct FieldDelta {
+    quint8 field;
+    QVariant before;
+    QVariant after;
+};
+
+/**
+ * @brief 一个实体的修改：只记录发生变化的字段
+ */
+struct EntityUpdate {
+    int id;
+    QVector<FieldDelta> fields;
+};
+
+/**
+ * @brief 一次可撤销的编辑 (单个操作或一个批次)
+ *
+ * 新增只记录新增后的实体 (重做时按原 ID 写回)，删除记录删除前的实体及级联删除的关系，
+ * 修改只记录变化的字段。记录时即做归并，同一实体在一条命令里只出现在一个类别中，
+ * 撤销/重做时按类别整体执行即可。同一实体的删除只应记录一次，由调用方保证。
+ * 新增与修改列表各带 ID -> 下标 的索引，归并时不做线性查找；撤掉记录时与末尾交换，列表内顺序不保证。
+ */
+struct GraphCommand {
+    enum NodeField : quint8 { NodeTypeField, NodeNameField, NodeDescriptionField,
+                              NodePosXField, NodePosYField, NodeColorField, NodePropertiesField };
+    enum EdgeField : quint8 { EdgeTypeField, EdgeWeightField, EdgePropertiesField };
+
+    QString text;
+    QList<GraphNode> insertedNodes;
+    QList<GraphNode> deletedNodes;
+    QVector<EntityUpdate> nodeUpdates;
+    QList<GraphEdge> insertedEdges;
+    QList<GraphEdge> deletedEdges;
+    QVector<EntityUpdate> edgeUpdates;
+
+    void recordNodeInserted(const GraphNode& node);
+    void recordNodeUpdated(const GraphNode& before, const GraphNode& after);
+    void recordNodeDeleted(const GraphNode& before);
+    void recordEdgeInserted(const GraphEdge& edge);
+    void recordEdgeUpdated(const GraphEdge& before, const GraphEdge& after);
+    void recordEdgeDeleted(const GraphEdge& before);
+
+    bool isEmpty() const;
+    void clear();
+
+    // 比较两个状态，返回变化的字段
+    static QVector<FieldDelta> diffNodes(const GraphNode& before, const GraphNode& after);
+    static QVector<FieldDelta> diffEdges(const GraphEdge& before, const GraphEdge& after);
+    // 把字段的前值 (useAfter = false) 或后值写入实体
+    static void applyNodeFields(GraphNode& node, const QVector<FieldDelta>& fields, bool useAfter);
+    static void applyEdgeFields(GraphEdge& edge, const QVector<FieldDelta>& fields, bool useAfter);
+
+private:
+    QHash<int, int> m_insertedNodeIndex;
+    QHash<int, int> m_nodeUpdateIndex;
+    QHash<int, int> m_insertedEdgeIndex;
+    QHash<int, int> m_edgeUpdateIndex;
+};
+
+#endif // GRAPHCOMMAND_H
@@ -1,12 +1,20 @@
 #include "GraphEditor.h"
 #include "../database/NodeRepository.h"
 #include "../database/RelationshipRepository.h"
+#include "../database/DatabaseConnection.h"
+#include "../model/TypeDictionary.h"
+#include <QSet>
+#include <QHash>
+#include <QStringList>
 #include <QDebug>
 
 GraphEditor::GraphEditor(QObject *parent) : QObject(parent) {}
 
 GraphEditor::~GraphEditor() = default;
 
+// 删除前读取完整状态时每批的 ID 数，与仓库的批量写入行数一致
+static const int kSnapshotBatch = 500;
+
 // --- 节点业务 ---
 
 bool GraphEditor::addNode(GraphNode& node) {
@@ -16,8 +24,11 @@ bool GraphEditor::addNode(GraphNode& node) {
     }
 
     if (NodeRepository::addNode(node)) {
-        emit nodeAdded(node);
-        emit graphChanged();
+        if (isRecording()) {
+            m_command.recordNodeInserted(node);
+            flushCommand("添加节点");
+        }
+        notifyNodeAdded(node);
         qInfo() << "GraphEditor: 节点添加成功，ID =" << node.id;
         return true;
     }
@@ -25,14 +36,70 @@ bool GraphEditor::addNode(GraphNode& node) {
 }
 
 bool GraphEditor::deleteNode(int nodeId) {
+    // 撤销需要删除前的完整状态，包括将被级联删除的关系
+    GraphNode before;
+    QList<GraphEdge> cascaded;
+    if (isRecording()) {
+        before = NodeRepository::getNodeById(nodeId);
+        cascaded = RelationshipRepository::getEdgesByNodes({nodeId}, QStringList(), Projection::Full);
+    }
+
     if (NodeRepository::deleteNode(nodeId)) {
-        emit nodeDeleted(nodeId);
-        emit graphChanged();
+        if (isRecording()) {
+            for (const auto& edge : cascaded) m_command.recordEdgeDeleted(edge);
+            m_command.recordNodeDeleted(before);
+            flushCommand("删除节点");
+        }
+        notifyNodeDeleted(nodeId);
         return true;
     }
     return false;
 }
 
+bool GraphEditor::deleteNodes(const QList<int>& nodeIds) {
+    QList<int> ids;
+    QSet<int> seen;
+    for (int id : nodeIds) {
+        if (id > 0 && !seen.contains(id)) {
+            seen.insert(id);
+            ids.append(id);
+        }
+    }
+    if (ids.isEmpty()) return true;
+
+    BatchGuard batch(this, QString("删除 %1 个节点").arg(ids.size()));
+    if (!batch.isActive()) {
+        qCritical() << "GraphEditor: 无法开启事务，批量删除中止";
+        return false;
+    }
+
+    if (isRecording()) {
+        // 按批读取删除前的状态；两端分属不同批的关系会被读到两次，只记一次
+        QSet<int> seenEdges;
+        for (int start = 0; start < ids.size(); start += kSnapshotBatch) {
+            QList<int> part = ids.mid(start, kSnapshotBatch);
+            for (const auto& edge : RelationshipRepository::getEdgesByNodes(part, QStringList(), Projection::Full)) {
+                if (seenEdges.contains(edge.id)) continue;
+                seenEdges.insert(edge.id);
+                m_command.recordEdgeDeleted(edge);
+            }
+            for (const auto& node : NodeRepository::getNodesByIds(part, Projection::Full)) {
+                m_command.recordNodeDeleted(node);
+            }
+        }
+    }
+
+    if (!NodeRepository::deleteNodes(ids)) return false;
+    for (int id : ids) notifyNodeDeleted(id);
+
+    if (!batch.commit()) {
+        qCritical() << "GraphEditor: 批量删除提交失败，已回滚";
+        return false;
+    }
+    qInfo() << "GraphEditor: 批量删除节点" << ids.size() << "个";
+    return true;
+}
+
 bool GraphEditor::updateNode(const GraphNode& oldNode, const GraphNode& newNode) {
     if (oldNode.id <= 0 || newNode.id <= 0 || oldNode.id != newNode.id) {
         qWarning() << "GraphEditor: 节点ID不匹配或无效，无法更新";
@@ -44,8 +111,11 @@ bool GraphEditor::updateNode(const GraphNode& oldNode, const GraphNode& newNode)
     }
 
     if (NodeRepository::updateNode(newNode)) {
-        emit nodeUpdated(newNode);
-        emit graphChanged();
+        if (isRecording()) {
+            m_command.recordNodeUpdated(oldNode, newNode);
+            flushCommand("修改节点");
+        }
+        notifyNodeUpdated(newNode);
         qInfo() << "GraphEditor: 节点更新成功，ID =" << newNode.id;
         return true;
     }
@@ -73,8 +143,11 @@ bool GraphEditor::addRelationship(GraphEdge& edge) {
     }
 
     if (RelationshipRepository::addRelationship(edge)) {
-        emit relationshipAdded(edge);
-        emit graphChanged();
+        if (isRecording()) {
+            m_command.recordEdgeInserted(edge);
+            flushCommand("添加关系");
+        }
+        notifyRelationshipAdded(edge);
         qInfo() << "GraphEditor: 关系添加成功，ID =" << edge.id;
         return true;
     }
@@ -87,9 +160,15 @@ bool GraphEditor::deleteRelationship(int edgeId) {
         return false;
     }
 
+    GraphEdge before;
+    if (isRecording()) before = RelationshipRepository::getRelationshipById(edgeId);
+
     if (RelationshipRepository::deleteRelationship(edgeId)) {
-        emit relationshipDeleted(edgeId);
-        emit graphChanged();
+        if (isRecording()) {
+            m_command.recordEdgeDeleted(before);
+            flushCommand("删除关系");
+        }
+        notifyRelationshipDeleted(edgeId);
         qInfo() << "GraphEditor: 关系删除成功，ID =" << edgeId;
         return true;
     }
@@ -100,10 +179,307 @@ bool GraphEditor::updateRelationship(const GraphEdge& oldEdge, const GraphEdge&
     if (oldEdge.id <= 0 || newEdge.id <= 0) return false;
 
     if (RelationshipRepository::updateRelationship(newEdge)) {
-        emit relationshipUpdated(newEdge);
-        emit graphChanged();
+        if (isRecording()) {
+            m_command.recordEdgeUpdated(oldEdge, newEdge);
+            flushCommand("修改关系");
+        }
+        notifyRelationshipUpdated(newEdge);
         qInfo() << "GraphEditor: 关系更新成功，ID =" << newEdge.id;
         return true;
     }
     return false;
-}
\ No newline at end of file
+}
+
+// --- 批量合并业务 ---
+
+bool GraphEditor::mergeEntities(int ontologyId, QList<GraphNode> nodes, const QList<NamedEdge>& edges,
+                                const QHash<QString, int>& nameAliases,
+                                QList<GraphNode>& addedNodes, QList<GraphEdge>& addedEdges) {
+    if (ontologyId <= 0) {
+        qWarning() << "GraphEditor: 无效的本体ID，无法合并";
+        return false;
+    }
+
+    // 过滤无效节点，与 addNode 的校验保持一致
+    for (int i = nodes.size() - 1; i >= 0; --i) {
+        nodes[i].name = nodes[i].name.trimmed();
+        if (nodes[i].name.isEmpty() || nodes[i].nodeType.isEmpty()) nodes.removeAt(i);
+    }
+
+    BatchGuard batch(this, "智能导入");
+    if (!batch.isActive()) {
+        qCritical() << "GraphEditor: 无法开启事务，合并中止";
+        return false;
+    }
+
+    // 1. 节点
+    QSet<int> insertedNodeIds;
+    if (!NodeRepository::upsertNodes(ontologyId, nodes, insertedNodeIds)) return false;
+
+    // 2. 解析关系端点：本批节点 -> 别名 -> 库中已有节点 (一次按名称批量查询)
+    QHash<QString, int> idByName;
+    for (const auto& node : nodes) {
+        if (node.id > 0) idByName.insert(NodeRepository::nameKey(node.name), node.id);
+    }
+    for (auto it = nameAliases.constBegin(); it != nameAliases.constEnd(); ++it) {
+        QString key = NodeRepository::nameKey(it.key());
+        if (!idByName.contains(key)) idByName.insert(key, it.value());
+    }
+
+    QStringList unresolved;
+    for (const auto& edge : edges) {
+        for (const QString& name : {edge.sourceName, edge.targetName}) {
+            if (!idByName.contains(NodeRepository::nameKey(name))) unresolved << name;
+        }
+    }
+    unresolved.removeDuplicates();
+    if (!unresolved.isEmpty() && !NodeRepository::getNodeIdsByNames(ontologyId, unresolved, idByName)) {
+        return false;
+    }
+
+    QList<GraphEdge> resolved;
+    for (const auto& named : edges) {
+        GraphEdge edge;
+        edge.ontologyId = ontologyId;
+        edge.sourceId = idByName.value(NodeRepository::nameKey(named.sourceName), -1);
+        edge.targetId = idByName.value(NodeRepository::nameKey(named.targetName), -1);
+        edge.relationType = named.relationType.trimmed();
+        if (edge.sourceId <= 0 || edge.targetId <= 0 || edge.sourceId == edge.targetId || edge.relationType.isEmpty()) {
+            continue;
+        }
+        resolved.append(edge);
+    }
+
+    // 3. 关系
+    QSet<int> insertedEdgeIds;
+    if (!RelationshipRepository::upsertRelationships(ontologyId, resolved, insertedEdgeIds)) return false;
+
+    // 同名节点、同键关系在一批里可能出现多次，新增列表里各保留一份
+    for (const auto& node : nodes) {
+        if (insertedNodeIds.remove(node.id)) {
+            addedNodes.append(node);
+            m_pending.recordNodeAdded(node);
+            if (isRecording()) m_command.recordNodeInserted(node);
+        }
+    }
+    for (const auto& edge : resolved) {
+        if (insertedEdgeIds.remove(edge.id)) {
+            addedEdges.append(edge);
+            m_pending.recordEdgeAdded(edge);
+            if (isRecording()) m_command.recordEdgeInserted(edge);
+        }
+    }
+
+    if (!batch.commit()) {
+        qCritical() << "GraphEditor: 合并提交失败，已回滚";
+        addedNodes.clear();
+        addedEdges.clear();
+        return false;
+    }
+    qInfo() << "GraphEditor: 批量合并完成，新增节点" << addedNodes.size() << "个，关系" << addedEdges.size() << "条";
+    return true;
+}
+
+// --- 批量编辑 ---
+
+bool GraphEditor::beginBatch(const QString& text) {
+    if (m_batchDepth == 0) {
+        if (!DatabaseConnection::beginTransaction()) {
+            qCritical() << "GraphEditor: 无法开启批量编辑事务";
+            return false;
+        }
+        m_pending.clear();
+        m_command.clear();
+        m_command.text = text;
+        m_batchFailed = false;
+    }
+    m_batchDepth++;
+    return true;
+}
+
+bool GraphEditor::commitBatch() {
+    if (m_batchDepth == 0) {
+        qWarning() << "GraphEditor: 没有进行中的批量编辑，无法提交";
+        return false;
+    }
+    if (--m_batchDepth > 0) return !m_batchFailed;
+
+    // 内层已失败时整个批次回滚，commitTransaction 失败时内部已回滚
+    bool committed = false;
+    if (m_batchFailed) DatabaseConnection::rollbackTransaction();
+    else committed = DatabaseConnection::commitTransaction();
+    if (!committed) {
+        qCritical() << "GraphEditor: 批量编辑提交失败，已回滚";
+        m_pending.clear();
+        m_command.clear();
+        return false;
+    }
+
+    GraphChangeSet changes = m_pending;
+    GraphCommand command = m_command;
+    m_pending.clear();
+    m_command.clear();
+    if (!changes.isEmpty()) {
+        emit changeSetCommitted(changes);
+        emit graphChanged();
+    }
+    if (!command.isEmpty()) {
+        if (command.text.isEmpty()) command.text = "批量编辑";
+        emit commandRecorded(command);
+    }
+    return true;
+}
+
+void GraphEditor::rollbackBatch() {
+    if (m_batchDepth == 0) return;
+    if (--m_batchDepth > 0) {
+        m_batchFailed = true;
+        return;
+    }
+    DatabaseConnection::rollbackTransaction();
+    m_pending.clear();
+    m_command.clear();
+}
+
+void GraphEditor::publishExternalChanges(const GraphChangeSet& changes) {
+    if (changes.isEmpty()) return;
+    GraphChangeSet marked = changes;
+    marked.external = true;
+    emit changeSetCommitted(marked);
+    emit graphChanged();
+}
+
+// 通知出去的实体类型可能刚被界面修改过，先按当前类型字符串重新解析 typeId
+void GraphEditor::notifyNodeAdded(const GraphNode& changed) {
+    GraphNode node = changed;
+    TypeDictionary::resolve(node);
+    if (inBatch()) { m_pending.recordNodeAdded(node); return; }
+    emit nodeAdded(node);
+    emit graphChanged();
+}
+
+void GraphEditor::notifyNodeUpdated(const GraphNode& changed) {
+    GraphNode node = changed;
+    TypeDictionary::resolve(node);
+    if (inBatch()) { m_pending.recordNodeUpdated(node); return; }
+    emit nodeUpdated(node);
+    emit graphChanged();
+}
+
+void GraphEditor::notifyNodeDeleted(int nodeId) {
+    if (inBatch()) { m_pending.recordNodeDeleted(nodeId); return; }
+    emit nodeDeleted(nodeId);
+    emit graphChanged();
+}
+
+void GraphEditor::notifyRelationshipAdded(const GraphEdge& changed) {
+    GraphEdge edge = changed;
+    TypeDictionary::resolve(edge);
+    if (inBatch()) { m_pending.recordEdgeAdded(edge); return; }
+    emit relationshipAdded(edge);
+    emit graphChanged();
+}
+
+void GraphEditor::notifyRelationshipUpdated(const GraphEdge& changed) {
+    GraphEdge edge = changed;
+    TypeDictionary::resolve(edge);
+    if (inBatch()) { m_pending.recordEdgeUpdated(edge); return; }
+    emit relationshipUpdated(edge);
+    emit graphChanged();
+}
+
+void GraphEditor::notifyRelationshipDeleted(int edgeId) {
+    if (inBatch()) { m_pending.recordEdgeDeleted(edgeId); return; }
+    emit relationshipDeleted(edgeId);
+    emit graphChanged();
+}
+
+// --- 撤销/重做 ---
+
+void GraphEditor::flushCommand(const QString& text) {
+    if (inBatch()) return;
+
+    GraphCommand command = m_command;
+    m_command.clear();
+    if (command.isEmpty()) return;
+    command.text = text;
+    emit commandRecorded(command);
+}
+
+bool GraphEditor::applyCommand(const GraphCommand& command, bool undo) {
+    if (command.isEmpty()) return true;
+
+    m_replaying = true;
+    bool ok = replayCommand(command, undo);
+    m_replaying = false;
+    return ok;
+}
+
+bool GraphEditor::replayCommand(const GraphCommand& command, bool undo) {
+    BatchGuard batch(this, command.text);
+    if (!batch.isActive()) {
+        qCritical() << "GraphEditor: 无法开启事务，撤销/重做中止";
+        return false;
+    }
+
+    // 撤销时移除新增的实体、恢复删除的实体，重做时相反
+    const QList<GraphNode>& removedNodes = undo ? command.insertedNodes : command.deletedNodes;
+    const QList<GraphEdge>& removedEdges = undo ? command.insertedEdges : command.deletedEdges;
+    const QList<GraphNode>& restoredNodes = undo ? command.deletedNodes : command.insertedNodes;
+    const QList<GraphEdge>& restoredEdges = undo ? command.deletedEdges : command.insertedEdges;
+
+    // 1. 移除：先关系后节点，随节点级联的关系已在列表中，显式删除后行数校验仍然成立
+    QList<int> edgeIds;
+    for (const auto& edge : removedEdges) edgeIds.append(edge.id);
+    QList<int> nodeIds;
+    for (const auto& node : removedNodes) nodeIds.append(node.id);
+
+    if (!RelationshipRepository::deleteRelationships(edgeIds)) return false;
+    if (!NodeRepository::deleteNodes(nodeIds)) return false;
+    for (int id : edgeIds) notifyRelationshipDeleted(id);
+    for (int id : nodeIds) notifyNodeDeleted(id);
+
+    // 2. 修改：在当前状态上写回前值 (撤销) 或后值 (重做)
+    if (!command.nodeUpdates.isEmpty()) {
+        QList<int> ids;
+        for (const auto& update : command.nodeUpdates) ids.append(update.id);
+
+        QHash<int, GraphNode> current;
+        for (const auto& node : NodeRepository::getNodesByIds(ids, Projection::Full)) current.insert(node.id, node);
+
+        for (const auto& update : command.nodeUpdates) {
+            auto it = current.find(update.id);
+            if (it == current.end()) {
+                qWarning() << "GraphEditor: 要还原的节点已不存在，ID =" << update.id;
+                return false;
+            }
+            GraphNode node = it.value();
+            GraphCommand::applyNodeFields(node, update.fields, !undo);
+            if (!NodeRepository::updateNode(node)) return false;
+            notifyNodeUpdated(node);
+        }
+    }
+    for (const auto& update : command.edgeUpdates) {
+        GraphEdge edge = RelationshipRepository::getRelationshipById(update.id);
+        if (edge.id <= 0) {
+            qWarning() << "GraphEditor: 要还原的关系已不存在，ID =" << update.id;
+            return false;
+        }
+        GraphCommand::applyEdgeFields(edge, update.fields, !undo);
+        if (!RelationshipRepository::updateRelationship(edge)) return false;
+        notifyRelationshipUpdated(edge);
+    }
+
+    // 3. 恢复：按原 ID 多行写回，先节点后关系
+    if (!NodeRepository::restoreNodes(restoredNodes)) return false;
+    if (!RelationshipRepository::restoreRelationships(restoredEdges)) return false;
+    for (const auto& node : restoredNodes) notifyNodeAdded(node);
+    for (const auto& edge : restoredEdges) notifyRelationshipAdded(edge);
+
+    if (!batch.commit()) {
+        qCritical() << "GraphEditor:" << (undo ? "撤销" : "重做") << "提交失败，已回滚";
+        return false;
+    }
+    qInfo() << "GraphEditor:" << (undo ? "撤销" : "重做") << command.text;
+    return true;
+}
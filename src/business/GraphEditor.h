@@ -2,8 +2,12 @@
 #define GRAPHEDITOR_H
 
 #include <QObject>
+#include <QList>
+#include <QHash>
 #include "../model/GraphNode.h"
 #include "../model/GraphEdge.h"
+#include "GraphChangeSet.h"
+#include "GraphCommand.h"
 
 /**
  * @brief 图操作业务逻辑类，负责封装数据库操作
@@ -17,6 +21,8 @@ public:
     // --- 节点操作业务接口 ---
     bool addNode(GraphNode& node);
     bool deleteNode(int nodeId);
+    // 批量删除：一个批次内按 IN 列表分批删除，适合框选后删除大量节点
+    bool deleteNodes(const QList<int>& nodeIds);
     bool updateNode(const GraphNode& oldNode, const GraphNode& newNode);
 
     // --- 关系操作业务接口 ---
@@ -24,6 +30,80 @@ public:
     bool deleteRelationship(int edgeId);
     bool updateRelationship(const GraphEdge& oldEdge, const GraphEdge& newEdge);
 
+    // --- 批量编辑 ---
+    /**
+     * 批量期间的所有修改在同一个数据库事务内完成，不再逐条发出 nodeAdded 等信号，
+     * 提交时只发出一次 changeSetCommitted 和 graphChanged。
+     * 可以嵌套，只有最外层真正提交；内层回滚会让整个批次在最外层提交时回滚。
+     * text 为撤销记录的描述，只有最外层的生效。
+     */
+    bool beginBatch(const QString& text = QString());
+    bool commitBatch();
+    void rollbackBatch();
+    bool inBatch() const { return m_batchDepth > 0; }
+
+    /**
+     * @brief 批量编辑的 RAII 守卫：构造时开始，未显式 commit() 就析构则回滚
+     */
+    class BatchGuard {
+    public:
+        explicit BatchGuard(GraphEditor* editor, const QString& text = QString())
+            : m_editor(editor), m_done(!editor->beginBatch(text)) {}
+        ~BatchGuard() { if (!m_done) m_editor->rollbackBatch(); }
+        BatchGuard(const BatchGuard&) = delete;
+        BatchGuard& operator=(const BatchGuard&) = delete;
+
+        bool isActive() const { return !m_done; }
+        bool commit() {
+            if (m_done) return false;
+            m_done = true;
+            return m_editor->commitBatch();
+        }
+
+    private:
+        GraphEditor* m_editor;
+        bool m_done;
+    };
+
+    // --- 批量合并业务接口 (AI 导入等) ---
+    // 端点按名称给出的关系，名称可以指向本批节点，也可以指向库中已有节点
+    struct NamedEdge {
+        QString sourceName;
+        QString targetName;
+        QString relationType;
+    };
+
+    /**
+     * @brief 在一个批次内按名称合并一批节点和关系，已存在的实体保持不变
+     * 新增的实体随批次的 changeSetCommitted 一次性通知，而不是逐个实体通知
+     * @param nameAliases 额外的 名称 -> 节点ID 映射 (如模糊匹配到的已有实体)
+     * @param addedNodes 输出本次新增的节点
+     * @param addedEdges 输出本次新增的关系
+     */
+    bool mergeEntities(int ontologyId, QList<GraphNode> nodes, const QList<NamedEdge>& edges,
+                       const QHash<QString, int>& nameAliases,
+                       QList<GraphNode>& addedNodes, QList<GraphEdge>& addedEdges);
+
+    /**
+     * @brief 发布其他客户端提交的变更 (来自变更日志)，走与批量提交相同的通知路径
+     * 不写数据库，也不产生撤销记录；发出的变更集 external 为 true
+     */
+    void publishExternalChanges(const GraphChangeSet& changes);
+
+    // --- 撤销/重做 ---
+    /**
+     * @brief 开启后每次编辑 (单个操作或整个批次) 完成时发出 commandRecorded
+     * 删除前会额外读取一次实体的完整状态，未开启时没有这部分开销
+     */
+    void setUndoRecording(bool enabled) { m_recordUndo = enabled; }
+
+    /**
+     * @brief 在一个批次内整体撤销 (undo = true) 或重做一条命令
+     * 删除与恢复都走仓库的批量接口，按 删除 -> 修改 -> 恢复 的顺序执行以避开唯一键冲突；
+     * 执行过程本身不会再产生撤销记录
+     */
+    bool applyCommand(const GraphCommand& command, bool undo);
+
     signals:
         // 信号：当业务层完成操作时，通知 UI 层进行同步
         void nodeAdded(const GraphNode& node);
@@ -33,8 +113,36 @@ public:
     void nodeUpdated(const GraphNode& node);
     void relationshipUpdated(const GraphEdge& edge);
 
+    // 批量编辑提交：携带整批的净变更，监听方据此一次性增量更新
+    void changeSetCommitted(const GraphChangeSet& changes);
+
+    // 一条可撤销的编辑已提交
+    void commandRecorded(const GraphCommand& command);
+
     // 通用信号：表示图数据发生了任何变动
     void graphChanged();
+
+private:
+    // 批量期间记入变更集，否则立即发出对应信号
+    void notifyNodeAdded(const GraphNode& node);
+    void notifyNodeUpdated(const GraphNode& node);
+    void notifyNodeDeleted(int nodeId);
+    void notifyRelationshipAdded(const GraphEdge& edge);
+    void notifyRelationshipUpdated(const GraphEdge& edge);
+    void notifyRelationshipDeleted(int edgeId);
+
+    bool isRecording() const { return m_recordUndo && !m_replaying; }
+    // 不在批次中时立即发出当前记录，批次中则等最外层提交
+    void flushCommand(const QString& text);
+    bool replayCommand(const GraphCommand& command, bool undo);
+
+    int m_batchDepth = 0;
+    bool m_batchFailed = false;
+    GraphChangeSet m_pending;
+
+    bool m_recordUndo = false;
+    bool m_replaying = false;
+    GraphCommand m_command;
 };
 
 #endif // GRAPHEDITOR_H
\ No newline at end of file
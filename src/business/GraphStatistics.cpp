@@ -0,0 +1,250 @@
+#include "GraphStatistics.h"
+#include "../database/NodeRepository.h"
+#include "../database/RelationshipRepository.h"
+#include "../model/TypeDictionary.h"
+#include "../model/GraphSnapshot.h"
+
+GraphStatistics::GraphStatistics(QObject *parent)
+    : QObject(parent) {
+    clear();
+}
+
+void GraphStatistics::clear() {
+    m_ontologyId = -1;
+    m_loaded = false;
+    m_hubDirty = false;
+    m_nodeTypes.clear();
+    m_edges.clear();
+    m_incident.clear();
+    m_nodeTypeCounts.clear();
+    m_edgeTypeCounts.clear();
+    m_degrees.clear();
+    m_hubId = -1;
+    m_hubDegree = 0;
+}
+
+bool GraphStatistics::refresh(int ontologyId) {
+    if (ontologyId <= 0) return false;
+    if (ontologyId != m_ontologyId) {
+        clear();
+        m_ontologyId = ontologyId;
+    }
+
+    if (!m_loaded && !load()) return false;
+    if (m_hubDirty) recomputeHub();
+    return true;
+}
+
+// --- 冷启动：拓扑快照 ---
+
+bool GraphStatistics::load() {
+    GraphSnapshot snapshot;
+    if (!NodeRepository::fillSnapshot(m_ontologyId, snapshot)
+        || !RelationshipRepository::fillSnapshot(m_ontologyId, snapshot)) {
+        return false;
+    }
+
+    const QVector<GraphSnapshot::NodeRecord>& nodes = snapshot.nodes();
+    m_nodeTypes.reserve(nodes.size());
+    for (const auto& node : nodes) {
+        m_nodeTypes.insert(node.id, node.typeId);
+        addNodeType(node.typeId, 1);
+    }
+    m_edges.reserve(snapshot.edgeCount());
+    for (const auto& edge : snapshot.edges()) {
+        insertEdge(edge.id, {edge.typeId, nodes[edge.source].id, nodes[edge.target].id});
+    }
+
+    m_loaded = true;
+    recomputeHub();
+    return true;
+}
+
+void GraphStatistics::recomputeHub() {
+    // 同度数时取 ID 最小的节点，与增量维护时的规则一致
+    m_hubId = -1;
+    m_hubDegree = 0;
+    for (auto it = m_degrees.constBegin(); it != m_degrees.constEnd(); ++it) {
+        if (it.value() > m_hubDegree || (it.value() == m_hubDegree && it.key() < m_hubId)) {
+            m_hubDegree = it.value();
+            m_hubId = it.key();
+        }
+    }
+    m_hubDirty = false;
+}
+
+// --- 读取 ---
+
+int GraphStatistics::nodeCount() const {
+    int total = 0;
+    for (int count : m_nodeTypeCounts) total += count;
+    return total;
+}
+
+int GraphStatistics::edgeCount() const {
+    int total = 0;
+    for (int count : m_edgeTypeCounts) total += count;
+    return total;
+}
+
+QMap<QString, int> GraphStatistics::nodeTypeCounts() const {
+    const TypeDictionary& types = TypeDictionary::forOntology(m_ontologyId);
+    QMap<QString, int> result;
+    for (int id = 0; id < m_nodeTypeCounts.size(); ++id) {
+        if (m_nodeTypeCounts[id] > 0) result[types.name(TypeDictionary::NodeTypes, id)] += m_nodeTypeCounts[id];
+    }
+    return result;
+}
+
+QMap<QString, int> GraphStatistics::edgeTypeCounts() const {
+    const TypeDictionary& types = TypeDictionary::forOntology(m_ontologyId);
+    QMap<QString, int> result;
+    for (int id = 0; id < m_edgeTypeCounts.size(); ++id) {
+        if (m_edgeTypeCounts[id] > 0) result[types.name(TypeDictionary::RelationTypes, id)] += m_edgeTypeCounts[id];
+    }
+    return result;
+}
+
+// --- 增量维护 ---
+
+void GraphStatistics::addNodeType(int typeId, int count) {
+    if (typeId < 0) return;
+    if (typeId >= m_nodeTypeCounts.size()) m_nodeTypeCounts.resize(typeId + 1);
+    m_nodeTypeCounts[typeId] += count;
+}
+
+void GraphStatistics::addEdgeType(int typeId, int count) {
+    if (typeId < 0) return;
+    if (typeId >= m_edgeTypeCounts.size()) m_edgeTypeCounts.resize(typeId + 1);
+    m_edgeTypeCounts[typeId] += count;
+}
+
+void GraphStatistics::addDegree(int nodeId, int delta) {
+    auto it = m_degrees.find(nodeId);
+    if (it == m_degrees.end()) it = m_degrees.insert(nodeId, 0);
+    int degree = (*it += delta);
+
+    if (delta < 0) {
+        if (degree <= 0) m_degrees.erase(it);
+        // 核心节点变小后可能被别的节点超过，留到 refresh() 时重算
+        if (nodeId == m_hubId) m_hubDirty = true;
+        return;
+    }
+    if (!m_hubDirty && (degree > m_hubDegree || (degree == m_hubDegree && nodeId < m_hubId))) {
+        m_hubDegree = degree;
+        m_hubId = nodeId;
+    }
+}
+
+void GraphStatistics::insertEdge(int edgeId, const EdgeInfo& info) {
+    if (m_edges.contains(edgeId)) return;
+    m_edges.insert(edgeId, info);
+    m_incident[info.sourceId].append(edgeId);
+    if (info.targetId != info.sourceId) m_incident[info.targetId].append(edgeId);
+    addEdgeType(info.typeId, 1);
+    addDegree(info.sourceId, 1);
+    addDegree(info.targetId, 1);
+}
+
+void GraphStatistics::detachIncident(int nodeId, int edgeId) {
+    auto it = m_incident.find(nodeId);
+    if (it == m_incident.end()) return;
+
+    // 顺序无关，与末尾交换后删除
+    QVector<int>& list = it.value();
+    int index = list.indexOf(edgeId);
+    if (index >= 0) {
+        list[index] = list.last();
+        list.removeLast();
+    }
+    if (list.isEmpty()) m_incident.erase(it);
+}
+
+void GraphStatistics::removeEdge(int edgeId) {
+    auto it = m_edges.find(edgeId);
+    if (it == m_edges.end()) return;   // 不属于当前本体
+    EdgeInfo info = it.value();
+    m_edges.erase(it);
+    detachIncident(info.sourceId, edgeId);
+    if (info.targetId != info.sourceId) detachIncident(info.targetId, edgeId);
+    addEdgeType(info.typeId, -1);
+    addDegree(info.sourceId, -1);
+    addDegree(info.targetId, -1);
+}
+
+void GraphStatistics::removeNodes(const QList<int>& nodeIds) {
+    for (int nodeId : nodeIds) {
+        auto it = m_nodeTypes.find(nodeId);
+        if (it == m_nodeTypes.end()) continue;   // 不属于当前本体
+        addNodeType(it.value(), -1);
+        m_nodeTypes.erase(it);
+
+        // 相连的关系已被外键级联删除，不会再单独收到删除信号；removeEdge 会改动列表，先取副本
+        const QVector<int> cascaded = m_incident.value(nodeId);
+        for (int edgeId : cascaded) removeEdge(edgeId);
+    }
+}
+
+void GraphStatistics::onNodeAdded(const GraphNode& node) {
+    if (!tracks(node.ontologyId) || m_nodeTypes.contains(node.id)) return;
+
+    int typeId = node.typeId;
+    if (typeId < 0) typeId = TypeDictionary::forOntology(m_ontologyId).intern(TypeDictionary::NodeTypes, node.nodeType);
+    m_nodeTypes.insert(node.id, typeId);
+    addNodeType(typeId, 1);
+}
+
+void GraphStatistics::onNodeUpdated(const GraphNode& node) {
+    if (!tracks(node.ontologyId)) return;
+    auto it = m_nodeTypes.find(node.id);
+    if (it == m_nodeTypes.end()) return;
+
+    int typeId = node.typeId;
+    if (typeId < 0) typeId = TypeDictionary::forOntology(m_ontologyId).intern(TypeDictionary::NodeTypes, node.nodeType);
+    if (typeId == it.value()) return;
+    addNodeType(it.value(), -1);
+    addNodeType(typeId, 1);
+    it.value() = typeId;
+}
+
+void GraphStatistics::onNodeDeleted(int nodeId) {
+    if (m_loaded) removeNodes({nodeId});
+}
+
+void GraphStatistics::onRelationshipAdded(const GraphEdge& edge) {
+    if (!tracks(edge.ontologyId)) return;
+
+    int typeId = edge.typeId;
+    if (typeId < 0) typeId = TypeDictionary::forOntology(m_ontologyId).intern(TypeDictionary::RelationTypes, edge.relationType);
+    insertEdge(edge.id, {typeId, edge.sourceId, edge.targetId});
+}
+
+void GraphStatistics::onRelationshipUpdated(const GraphEdge& edge) {
+    // 端点不可修改，只有类型可能改变
+    if (!tracks(edge.ontologyId)) return;
+    auto it = m_edges.find(edge.id);
+    if (it == m_edges.end()) return;
+
+    int typeId = edge.typeId;
+    if (typeId < 0) typeId = TypeDictionary::forOntology(m_ontologyId).intern(TypeDictionary::RelationTypes, edge.relationType);
+    if (typeId == it.value().typeId) return;
+    addEdgeType(it.value().typeId, -1);
+    addEdgeType(typeId, 1);
+    it.value().typeId = typeId;
+}
+
+void GraphStatistics::onRelationshipDeleted(int edgeId) {
+    if (m_loaded) removeEdge(edgeId);
+}
+
+void GraphStatistics::onChangeSetCommitted(const GraphChangeSet& changes) {
+    // 与其他监听方一致：删除 -> 新增 -> 修改
+    if (m_loaded) {
+        for (int id : changes.deletedEdgeIds) removeEdge(id);
+        removeNodes(changes.deletedNodeIds);
+    }
+    for (const auto& node : changes.addedNodes) onNodeAdded(node);
+    for (const auto& edge : changes.addedEdges) onRelationshipAdded(edge);
+    for (const auto& node : changes.updatedNodes) onNodeUpdated(node);
+    for (const auto& edge : changes.updatedEdges) onRelationshipUpdated(edge);
+}
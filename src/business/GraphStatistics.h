@@ -0,0 +1,89 @@
+#ifndef GRAPHSTATISTICS_H
+#define GRAPHSTATISTICS_H
+
+#include <QObject>
+#include <QHash>
+#include <QMap>
+#include <QVector>
+#include "../model/GraphNode.h"
+#include "../model/GraphEdge.h"
+#include "GraphChangeSet.h"
+
+/**
+ * @brief 仪表盘用的本体聚合统计：按类型的节点/关系数、节点度数与度数最高的核心节点
+ *
+ * 首次使用时以拓扑快照 (只含 ID、类型ID 与端点) 读入本体，保留节点类型与关系 (类型, 端点) 的映射，
+ * 之后随 GraphEditor 信号增量维护，不再查库：
+ *   - 新增节点/关系累加类型计数与端点度数
+ *   - 删除与修改信号只带 ID，按映射查出原先的类型和端点后扣减；映射中没有的 ID 属于其他本体，直接忽略
+ *   - 删除节点时按 节点 -> 相连关系 的索引一并扣减被级联删除的关系，不扫描全部关系
+ * 核心节点的度数被扣减后标记待重算，下次 refresh() 时扫描一遍度数表。
+ * 类型计数以 TypeDictionary 的类型ID为下标，不区分大小写的同名类型合为一项。
+ */
+class GraphStatistics : public QObject {
+    Q_OBJECT
+public:
+    explicit GraphStatistics(QObject *parent = nullptr);
+
+    void clear();
+    int ontologyId() const { return m_ontologyId; }
+
+    // 切换到指定本体，首次使用时读取快照，失败返回 false
+    bool refresh(int ontologyId);
+
+    int nodeCount() const;
+    int edgeCount() const;
+    // 类型显示名 -> 数量
+    QMap<QString, int> nodeTypeCounts() const;
+    QMap<QString, int> edgeTypeCounts() const;
+
+    // 度数最高的节点 (同度数取 ID 最小者)，没有关系时返回 -1
+    int hubNodeId() const { return m_hubId; }
+    int hubDegree() const { return m_hubDegree; }
+
+public slots:
+    void onNodeAdded(const GraphNode& node);
+    void onNodeUpdated(const GraphNode& node);
+    void onNodeDeleted(int nodeId);
+    void onRelationshipAdded(const GraphEdge& edge);
+    void onRelationshipUpdated(const GraphEdge& edge);
+    void onRelationshipDeleted(int edgeId);
+    void onChangeSetCommitted(const GraphChangeSet& changes);
+
+private:
+    struct EdgeInfo {
+        int typeId;
+        int sourceId;
+        int targetId;
+    };
+
+    bool load();
+    void recomputeHub();
+
+    void addNodeType(int typeId, int count);
+    void addEdgeType(int typeId, int count);
+    void addDegree(int nodeId, int delta);
+    void insertEdge(int edgeId, const EdgeInfo& info);
+    void removeEdge(int edgeId);
+    void detachIncident(int nodeId, int edgeId);
+    // 删除节点：扣减类型计数，并按相连关系索引扣减被级联删除的关系
+    void removeNodes(const QList<int>& nodeIds);
+
+    // 只统计当前本体，其他本体的实体 (ontologyId 有效但不同) 忽略
+    bool tracks(int ontologyId) const { return m_loaded && (ontologyId <= 0 || ontologyId == m_ontologyId); }
+
+    int m_ontologyId;
+    bool m_loaded;
+    bool m_hubDirty;
+
+    QHash<int, int> m_nodeTypes;     // node_id -> 节点类型ID
+    QHash<int, EdgeInfo> m_edges;    // relation_id -> 类型与端点
+    QHash<int, QVector<int>> m_incident;   // node_id -> 相连的 relation_id，删除节点时找出级联的关系
+    QVector<int> m_nodeTypeCounts;   // 节点类型ID -> 数量
+    QVector<int> m_edgeTypeCounts;   // 关系类型ID -> 数量
+    QHash<int, int> m_degrees;       // node_id -> 度数，只含有关系的节点
+    int m_hubId;
+    int m_hubDegree;
+};
+
+#endif // GRAPHSTATISTICS_H
@@ -0,0 +1,56 @@
+#include "GraphUndoStack.h"
+#include "GraphEditor.h"
+#include <QDebug>
+
+GraphUndoStack::GraphUndoStack(GraphEditor* editor, QObject* parent)
+    : QObject(parent), m_editor(editor), m_limit(100) {
+    m_editor->setUndoRecording(true);
+    connect(m_editor, &GraphEditor::commandRecorded, this, &GraphUndoStack::push);
+}
+
+void GraphUndoStack::push(const GraphCommand& command) {
+    m_undo.append(command);
+    m_redo.clear();
+    while (m_undo.size() > m_limit) m_undo.removeFirst();
+    emit stateChanged();
+}
+
+bool GraphUndoStack::undo() {
+    if (!canUndo()) return false;
+
+    GraphCommand command = m_undo.takeLast();
+    if (!m_editor->applyCommand(command, true)) {
+        qWarning() << "GraphUndoStack: 撤销失败，清空历史 ->" << command.text;
+        clear();
+        return false;
+    }
+    m_redo.append(command);
+    emit stateChanged();
+    return true;
+}
+
+bool GraphUndoStack::redo() {
+    if (!canRedo()) return false;
+
+    GraphCommand command = m_redo.takeLast();
+    if (!m_editor->applyCommand(command, false)) {
+        qWarning() << "GraphUndoStack: 重做失败，清空历史 ->" << command.text;
+        clear();
+        return false;
+    }
+    m_undo.append(command);
+    emit stateChanged();
+    return true;
+}
+
+void GraphUndoStack::clear() {
+    m_undo.clear();
+    m_redo.clear();
+    emit stateChanged();
+}
+
+void GraphUndoStack::setLimit(int limit) {
+    m_limit = qMax(1, limit);
+    while (m_undo.size() > m_limit) m_undo.removeFirst();
+    emit stateChanged();
+}
@@ -0,0 +1,45 @@
+#ifndef GRAPHUNDOSTACK_H
+#define GRAPHUNDOSTACK_H
+
+#include <QObject>
+#include <QList>
+#include "GraphCommand.h"
+
+class GraphEditor;
+
+/**
+ * @brief 图编辑的撤销/重做栈
+ *
+ * 接收 GraphEditor 提交的 GraphCommand，撤销/重做时交回 GraphEditor 在一个批次内整体执行。
+ * 撤销或重做失败说明数据库已被其他途径改动，历史不再可信，此时清空两个栈。
+ */
+class GraphUndoStack : public QObject {
+    Q_OBJECT
+public:
+    explicit GraphUndoStack(GraphEditor* editor, QObject* parent = nullptr);
+
+    bool undo();
+    bool redo();
+    bool canUndo() const { return !m_undo.isEmpty(); }
+    bool canRedo() const { return !m_redo.isEmpty(); }
+    QString undoText() const { return canUndo() ? m_undo.last().text : QString(); }
+    QString redoText() const { return canRedo() ? m_redo.last().text : QString(); }
+
+    void clear();
+    // 最多保留的撤销步数，超出时丢弃最早的记录
+    void setLimit(int limit);
+
+signals:
+    void stateChanged();
+
+private slots:
+    void push(const GraphCommand& command);
+
+private:
+    GraphEditor* m_editor;
+    QList<GraphCommand> m_undo;
+    QList<GraphCommand> m_redo;
+    int m_limit;
+};
+
+#endif // GRAPHUNDOSTACK_H
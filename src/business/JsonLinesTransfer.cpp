@@ -0,0 +1,600 @@
+#include "JsonLinesTransfer.h"
+#include "OntologySnapshot.h"
+#include "../database/DatabaseConnection.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QHash>
+#include <QVector>
+#include <QStringList>
+#include <QVariant>
+#include <QDebug>
+#include <functional>
+
+namespace {
+
+const int kPageSize = 2000;     // 导出时每页读取的行数
+const int kBatchSize = 500;     // 导入时每批写入的行数 (8 列 * 500 行，远低于占位符上限)
+const int kQueueCapacity = 4;   // 解析线程最多领先写库线程的批数
+
+QString connectionNameFor(const QObject* owner) {
+    return QString("KG_TRANSFER_%1").arg(reinterpret_cast<quintptr>(owner));
+}
+
+QByteArray toLine(const QJsonObject& obj) {
+    QByteArray line = QJsonDocument(obj).toJson(QJsonDocument::Compact);
+    line.append('\n');
+    return line;
+}
+
+QJsonObject parseProperties(const QVariant& raw) {
+    QJsonDocument doc = QJsonDocument::fromJson(raw.toByteArray());
+    return doc.isObject() ? doc.object() : QJsonObject();
+}
+
+// MySQL 默认排序规则不区分大小写，名称映射按同样的规则比较
+QString nameKey(const QString& name) {
+    return name.trimmed().toCaseFolded();
+}
+
+// --- 导出 ---
+
+QString exportOntology(QSqlDatabase& db, int ontologyId, QIODevice& out, const QAtomicInt& cancelled,
+                       const std::function<void(qint64, qint64)>& progress, int& nodeCount, int& edgeCount) {
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+
+    // 1. 项目元数据行
+    query.prepare("SELECT name, description, version FROM ontology WHERE ontology_id = ?");
+    query.addBindValue(ontologyId);
+    if (!query.exec() || !query.next()) return "项目不存在";
+
+    QJsonObject project;
+    project["kind"] = "project";
+    project["name"] = query.value(0).toString();
+    project["description"] = query.value(1).toString();
+    project["version"] = query.value(2).toString();
+    if (out.write(toLine(project)) < 0) return out.errorString();
+
+    // 2. 总数只用于进度显示
+    query.prepare("SELECT (SELECT COUNT(*) FROM node WHERE ontology_id = ?), "
+                  "(SELECT COUNT(*) FROM relationship WHERE ontology_id = ?)");
+    query.addBindValue(ontologyId);
+    query.addBindValue(ontologyId);
+    qint64 total = 0;
+    if (query.exec() && query.next()) {
+        total = query.value(0).toLongLong() + query.value(1).toLongLong();
+    }
+
+    // 3. 按主键分页 (keyset)，客户端每次只缓冲一页结果
+    QSqlQuery nodes(db);
+    nodes.setForwardOnly(true);
+    nodes.prepare(QString("SELECT node_id, node_type, name, description, pos_x, pos_y, color, properties "
+                          "FROM node WHERE ontology_id = ? AND node_id > ? ORDER BY node_id LIMIT %1").arg(kPageSize));
+    int lastId = 0;
+    for (;;) {
+        if (cancelled.loadAcquire()) return "已取消";
+        nodes.bindValue(0, ontologyId);
+        nodes.bindValue(1, lastId);
+        if (!nodes.exec()) return nodes.lastError().text();
+
+        int rows = 0;
+        while (nodes.next()) {
+            QJsonObject obj;
+            obj["kind"] = "node";
+            obj["id"] = nodes.value(0).toInt();
+            obj["nodeType"] = nodes.value(1).toString();
+            obj["name"] = nodes.value(2).toString();
+            obj["description"] = nodes.value(3).toString();
+            obj["posX"] = nodes.value(4).toDouble();
+            obj["posY"] = nodes.value(5).toDouble();
+            obj["color"] = nodes.value(6).toString();
+            obj["properties"] = parseProperties(nodes.value(7));
+            if (out.write(toLine(obj)) < 0) return out.errorString();
+
+            lastId = nodes.value(0).toInt();
+            ++rows;
+        }
+        nodeCount += rows;
+        progress(nodeCount, total);
+        if (rows < kPageSize) break;
+    }
+
+    QSqlQuery edges(db);
+    edges.setForwardOnly(true);
+    edges.prepare(QString("SELECT relation_id, source_id, target_id, relation_type, weight, properties "
+                          "FROM relationship WHERE ontology_id = ? AND relation_id > ? "
+                          "ORDER BY relation_id LIMIT %1").arg(kPageSize));
+    lastId = 0;
+    for (;;) {
+        if (cancelled.loadAcquire()) return "已取消";
+        edges.bindValue(0, ontologyId);
+        edges.bindValue(1, lastId);
+        if (!edges.exec()) return edges.lastError().text();
+
+        int rows = 0;
+        while (edges.next()) {
+            QJsonObject obj;
+            obj["kind"] = "edge";
+            obj["sourceId"] = edges.value(1).toInt();
+            obj["targetId"] = edges.value(2).toInt();
+            obj["relationType"] = edges.value(3).toString();
+            obj["weight"] = edges.value(4).toDouble();
+            obj["properties"] = parseProperties(edges.value(5));
+            if (out.write(toLine(obj)) < 0) return out.errorString();
+
+            lastId = edges.value(0).toInt();
+            ++rows;
+        }
+        edgeCount += rows;
+        progress(nodeCount + edgeCount, total);
+        if (rows < kPageSize) break;
+    }
+
+    return QString();
+}
+
+// --- 导入 ---
+
+struct ImportNode {
+    int oldId;
+    QString nodeType;
+    QString name;
+    QString description;
+    QString color;
+    double posX;
+    double posY;
+    QByteArray properties;
+};
+
+struct ImportEdge {
+    int oldSourceId;
+    int oldTargetId;
+    QString relationType;
+    double weight;
+    QByteArray properties;
+};
+
+struct ImportBatch {
+    QVector<ImportNode> nodes;
+    QVector<ImportEdge> edges;
+    qint64 bytesRead = 0;
+
+    bool isEmpty() const { return nodes.isEmpty() && edges.isEmpty(); }
+};
+
+/**
+ * @brief 解析线程与写库线程之间的有界队列，队列满时解析线程阻塞，内存占用因此有上界
+ */
+class BatchQueue {
+public:
+    // 返回 false 表示消费端已放弃
+    bool push(ImportBatch batch) {
+        QMutexLocker locker(&m_mutex);
+        while (m_items.size() >= kQueueCapacity && !m_closed) m_notFull.wait(&m_mutex);
+        if (m_closed) return false;
+        m_items.enqueue(std::move(batch));
+        m_notEmpty.wakeOne();
+        return true;
+    }
+
+    // 返回 false 表示生产端已结束且队列为空
+    bool pop(ImportBatch& batch) {
+        QMutexLocker locker(&m_mutex);
+        while (m_items.isEmpty() && !m_finished && !m_closed) m_notEmpty.wait(&m_mutex);
+        if (m_items.isEmpty()) return false;
+        batch = m_items.dequeue();
+        m_notFull.wakeOne();
+        return true;
+    }
+
+    void finish() {
+        QMutexLocker locker(&m_mutex);
+        m_finished = true;
+        m_notEmpty.wakeAll();
+    }
+
+    void close() {
+        QMutexLocker locker(&m_mutex);
+        m_closed = true;
+        m_items.clear();
+        m_notFull.wakeAll();
+        m_notEmpty.wakeAll();
+    }
+
+private:
+    QMutex m_mutex;
+    QWaitCondition m_notFull;
+    QWaitCondition m_notEmpty;
+    QQueue<ImportBatch> m_items;
+    bool m_finished = false;
+    bool m_closed = false;
+};
+
+QByteArray compactProperties(const QJsonObject& obj) {
+    return QJsonDocument(obj.value("properties").toObject()).toJson(QJsonDocument::Compact);
+}
+
+// 解析线程：逐行解析，每行只构建该行自己的小 DOM
+void parseLines(QFile& file, BatchQueue& queue, const QAtomicInt& cancelled, int& skippedLines) {
+    ImportBatch batch;
+    while (!file.atEnd() && !cancelled.loadAcquire()) {
+        QByteArray line = file.readLine();
+        if (line.trimmed().isEmpty()) continue;
+
+        QJsonDocument doc = QJsonDocument::fromJson(line);
+        if (!doc.isObject()) {
+            ++skippedLines;
+            continue;
+        }
+
+        QJsonObject obj = doc.object();
+        QString kind = obj.value("kind").toString();
+        if (kind == "node") {
+            ImportNode node;
+            node.oldId = obj.value("id").toInt();
+            node.nodeType = obj.value("nodeType").toString();
+            node.name = obj.value("name").toString();
+            node.description = obj.value("description").toString();
+            node.color = obj.value("color").toString("#3498db");
+            node.posX = obj.value("posX").toDouble(0);
+            node.posY = obj.value("posY").toDouble(0);
+            node.properties = compactProperties(obj);
+            if (node.name.trimmed().isEmpty() || node.nodeType.isEmpty()) {
+                ++skippedLines;
+                continue;
+            }
+            batch.nodes.append(node);
+        } else if (kind == "edge") {
+            ImportEdge edge;
+            edge.oldSourceId = obj.value("sourceId").toInt();
+            edge.oldTargetId = obj.value("targetId").toInt();
+            edge.relationType = obj.value("relationType").toString();
+            edge.weight = obj.value("weight").toDouble(1.0);
+            edge.properties = compactProperties(obj);
+            batch.edges.append(edge);
+        } else if (kind != "project") {
+            ++skippedLines;
+            continue;
+        }
+
+        if (batch.nodes.size() + batch.edges.size() >= kBatchSize) {
+            batch.bytesRead = file.pos();
+            if (!queue.push(std::move(batch))) return;
+            batch = ImportBatch();
+        }
+    }
+
+    if (!batch.isEmpty()) {
+        batch.bytesRead = file.pos();
+        queue.push(std::move(batch));
+    }
+    queue.finish();
+}
+
+// 多行 INSERT IGNORE (SQLite 为 INSERT OR IGNORE) 写入节点 (同名节点被跳过)，再按唯一键 (ontology_id, name) 取回新 ID
+bool insertNodes(QSqlDatabase& db, int ontologyId, const QVector<ImportNode>& nodes,
+                 QHash<int, int>& idMapping, int& inserted, QString& error) {
+    if (nodes.isEmpty()) return true;
+
+    QSqlQuery insert(db);
+    insert.prepare(DatabaseConnection::backend().insertIgnore() + " INTO node (ontology_id, node_type, name, description, pos_x, pos_y, color, properties) "
+                   "VALUES " + DatabaseConnection::placeholderRows(nodes.size(), 8));
+    for (const auto& node : nodes) {
+        insert.addBindValue(ontologyId);
+        insert.addBindValue(node.nodeType);
+        insert.addBindValue(node.name);
+        insert.addBindValue(node.description);
+        insert.addBindValue(node.posX);
+        insert.addBindValue(node.posY);
+        insert.addBindValue(node.color);
+        insert.addBindValue(QString::fromUtf8(node.properties));
+    }
+    if (!insert.exec()) {
+        error = insert.lastError().text();
+        return false;
+    }
+    inserted += insert.numRowsAffected();
+
+    QStringList holders;
+    for (int i = 0; i < nodes.size(); ++i) holders << "?";
+    QSqlQuery select(db);
+    select.setForwardOnly(true);
+    select.prepare(QString("SELECT node_id, name FROM node WHERE ontology_id = ? AND name IN (%1)")
+                       .arg(holders.join(",")));
+    select.addBindValue(ontologyId);
+    for (const auto& node : nodes) select.addBindValue(node.name);
+    if (!select.exec()) {
+        error = select.lastError().text();
+        return false;
+    }
+
+    QHash<QString, int> idByName;
+    while (select.next()) {
+        idByName.insert(nameKey(select.value(1).toString()), select.value(0).toInt());
+    }
+    for (const auto& node : nodes) {
+        int newId = idByName.value(nameKey(node.name), -1);
+        if (newId > 0) idMapping.insert(node.oldId, newId);
+    }
+    return true;
+}
+
+bool insertEdges(QSqlDatabase& db, int ontologyId, const QVector<ImportEdge>& edges,
+                 const QHash<int, int>& idMapping, int& inserted, QString& error) {
+    QVector<const ImportEdge*> valid;
+    valid.reserve(edges.size());
+    for (const auto& edge : edges) {
+        if (idMapping.contains(edge.oldSourceId) && idMapping.contains(edge.oldTargetId)) valid.append(&edge);
+    }
+    if (valid.isEmpty()) return true;
+
+    // 重复的关系 (unique_relationship) 跳过而不是让整批失败
+    QSqlQuery insert(db);
+    insert.prepare("INSERT INTO relationship (ontology_id, source_id, target_id, relation_type, weight, properties) "
+                   "VALUES " + DatabaseConnection::placeholderRows(valid.size(), 6)
+                   + DatabaseConnection::backend().keepExistingOnConflict("relation_id"));
+    for (const ImportEdge* edge : valid) {
+        insert.addBindValue(ontologyId);
+        insert.addBindValue(idMapping.value(edge->oldSourceId));
+        insert.addBindValue(idMapping.value(edge->oldTargetId));
+        insert.addBindValue(edge->relationType);
+        insert.addBindValue(edge->weight);
+        insert.addBindValue(QString::fromUtf8(edge->properties));
+    }
+    if (!insert.exec()) {
+        error = insert.lastError().text();
+        return false;
+    }
+    inserted += insert.numRowsAffected();
+    return true;
+}
+
+// 以不重名的名称创建目标项目
+int createOntology(QSqlDatabase& db, const QJsonObject& project, QString& finalName) {
+    QString baseName = project.value("name").toString("导入的图谱项目");
+    finalName = baseName;
+
+    QSqlQuery check(db);
+    check.prepare("SELECT COUNT(*) FROM ontology WHERE name = ?");
+    for (int counter = 1;; ++counter) {
+        check.bindValue(0, finalName);
+        if (!check.exec() || !check.next()) return -1;
+        if (check.value(0).toInt() == 0) break;
+        finalName = baseName + "_" + QString::number(counter);
+    }
+
+    QSqlQuery insert(db);
+    insert.prepare("INSERT INTO ontology (name, description, version) VALUES (?, ?, ?)");
+    insert.addBindValue(finalName);
+    insert.addBindValue(project.value("description").toString("从外部 JSON Lines 文件导入"));
+    insert.addBindValue(project.value("version").toString("1.0"));
+    if (!insert.exec()) return -1;
+    return insert.lastInsertId().toInt();
+}
+
+// 快照记录直接打包成与 JSON Lines 相同的批次写入，节点记录下标充当旧 ID
+QString importSnapshotRecords(QSqlDatabase& db, const SnapshotReader& reader, const QAtomicInt& cancelled,
+                              const std::function<void(qint64, qint64)>& progress,
+                              int& ontologyId, QString& projectName, int& nodeCount, int& edgeCount) {
+    Ontology onto = reader.ontology();
+    QJsonObject project;
+    if (!onto.name.isEmpty()) project["name"] = onto.name;
+    project["description"] = onto.description;
+    project["version"] = onto.version.isEmpty() ? QString("1.0") : onto.version;
+    ontologyId = createOntology(db, project, projectName);
+    if (ontologyId <= 0) return "在数据库中创建项目失败";
+
+    // properties 为空的记录按空对象写入，JSON 列不接受空串
+    auto properties = [&reader](quint64 offset, quint32 length) {
+        return length > 0 ? reader.rawProperties(offset, length) : QByteArray("{}");
+    };
+
+    qint64 total = qint64(reader.nodeCount()) + reader.edgeCount();
+    qint64 done = 0;
+    QString error;
+
+    QHash<int, int> idMapping;
+    idMapping.reserve(int(reader.nodeCount()));
+    QVector<ImportNode> nodes;
+    nodes.reserve(kBatchSize);
+    for (quint32 i = 0; i < reader.nodeCount(); ++i) {
+        const SnapshotNodeRecord& rec = reader.nodeRecord(i);
+        ImportNode node;
+        node.oldId = int(i);
+        node.nodeType = reader.string(rec.type);
+        node.name = reader.string(rec.name);
+        node.description = reader.string(rec.description);
+        node.color = reader.string(rec.color);
+        node.posX = rec.posX;
+        node.posY = rec.posY;
+        node.properties = properties(rec.propsOffset, rec.propsLength);
+        nodes.append(node);
+
+        if (nodes.size() < kBatchSize && i + 1 < reader.nodeCount()) continue;
+        if (cancelled.loadAcquire()) return "已取消";
+        if (!insertNodes(db, ontologyId, nodes, idMapping, nodeCount, error)) return error;
+        done += nodes.size();
+        progress(done, total);
+        nodes.clear();
+    }
+
+    QVector<ImportEdge> edges;
+    edges.reserve(kBatchSize);
+    for (quint32 k = 0; k < reader.edgeCount(); ++k) {
+        const SnapshotEdgeRecord& rec = reader.edgeRecord(k);
+        ImportEdge edge;
+        edge.oldSourceId = int(rec.source);
+        edge.oldTargetId = int(rec.target);
+        edge.relationType = reader.string(rec.type);
+        edge.weight = rec.weight;
+        edge.properties = properties(rec.propsOffset, rec.propsLength);
+        edges.append(edge);
+
+        if (edges.size() < kBatchSize && k + 1 < reader.edgeCount()) continue;
+        if (cancelled.loadAcquire()) return "已取消";
+        if (!insertEdges(db, ontologyId, edges, idMapping, edgeCount, error)) return error;
+        done += edges.size();
+        progress(done, total);
+        edges.clear();
+    }
+    return QString();
+}
+
+} // namespace
+
+// --- JsonLinesExporter ---
+
+JsonLinesExporter::JsonLinesExporter(int ontologyId, const QString& fileName, QObject *parent)
+    : QObject(parent), m_ontologyId(ontologyId), m_fileName(fileName), m_cancelled(0) {}
+
+void JsonLinesExporter::run() {
+    QString connectionName = connectionNameFor(this);
+    int nodeCount = 0;
+    int edgeCount = 0;
+    QString error;
+
+    {
+        QSqlDatabase db = DatabaseConnection::openThreadConnection(connectionName);
+        QSaveFile file(m_fileName);
+        if (!db.isOpen()) {
+            error = "无法建立后台数据库连接";
+        } else if (!file.open(QIODevice::WriteOnly)) {
+            error = file.errorString();
+        } else {
+            error = exportOntology(db, m_ontologyId, file, m_cancelled,
+                                   [this](qint64 done, qint64 total) { emit progress(done, total); },
+                                   nodeCount, edgeCount);
+            // 取消或失败时不留下半个文件
+            if (!error.isEmpty()) file.cancelWriting();
+            if (!file.commit() && error.isEmpty()) error = file.errorString();
+        }
+    }
+    DatabaseConnection::removeThreadConnection(connectionName);
+
+    emit finished(error.isEmpty(), nodeCount, edgeCount, error);
+}
+
+// --- JsonLinesImporter ---
+
+JsonLinesImporter::JsonLinesImporter(const QString& fileName, QObject *parent)
+    : QObject(parent), m_fileName(fileName), m_cancelled(0) {}
+
+void JsonLinesImporter::run() {
+    QString connectionName = connectionNameFor(this);
+    int ontologyId = -1;
+    QString projectName;
+    int nodeCount = 0;
+    int edgeCount = 0;
+    int skippedLines = 0;
+    QString error;
+
+    {
+        QSqlDatabase db = DatabaseConnection::openThreadConnection(connectionName);
+        QFile file(m_fileName);
+
+        if (!db.isOpen()) {
+            error = "无法建立后台数据库连接";
+        } else if (!file.open(QIODevice::ReadOnly)) {
+            error = file.errorString();
+        } else {
+            // 1. 首行若是项目元数据则用于建项目，否则回到文件开头当作普通数据行
+            QJsonObject project;
+            QJsonDocument first = QJsonDocument::fromJson(file.readLine());
+            if (first.isObject() && first.object().value("kind").toString() == "project") {
+                project = first.object();
+            } else {
+                file.seek(0);
+            }
+
+            ontologyId = createOntology(db, project, projectName);
+            if (ontologyId <= 0) {
+                error = "在数据库中创建项目失败";
+            } else {
+                // 2. 解析与写库流水线：解析线程填队列，当前线程逐批事务写入
+                qint64 totalBytes = file.size();
+                BatchQueue queue;
+                QThread* parser = QThread::create([&]() {
+                    parseLines(file, queue, m_cancelled, skippedLines);
+                });
+                parser->start();
+
+                QHash<int, int> idMapping;
+                ImportBatch batch;
+                while (queue.pop(batch)) {
+                    if (m_cancelled.loadAcquire()) {
+                        error = "已取消";
+                        break;
+                    }
+
+                    db.transaction();
+                    if (!insertNodes(db, ontologyId, batch.nodes, idMapping, nodeCount, error)
+                        || !insertEdges(db, ontologyId, batch.edges, idMapping, edgeCount, error)) {
+                        db.rollback();
+                        break;
+                    }
+                    db.commit();
+                    emit progress(batch.bytesRead, totalBytes);
+                }
+
+                queue.close();
+                parser->wait();
+                delete parser;
+            }
+        }
+    }
+    DatabaseConnection::removeThreadConnection(connectionName);
+
+    if (skippedLines > 0) {
+        qWarning() << "JsonLinesImporter: 跳过了" << skippedLines << "行无法识别的内容";
+    }
+    emit finished(error.isEmpty(), ontologyId, projectName, nodeCount, edgeCount, error);
+}
+
+// --- SnapshotImporter ---
+
+SnapshotImporter::SnapshotImporter(const QString& fileName, QObject *parent)
+    : QObject(parent), m_fileName(fileName), m_cancelled(0) {}
+
+void SnapshotImporter::run() {
+    QString connectionName = connectionNameFor(this);
+    int ontologyId = -1;
+    QString projectName;
+    int nodeCount = 0;
+    int edgeCount = 0;
+    QString error;
+
+    {
+        QSqlDatabase db = DatabaseConnection::openThreadConnection(connectionName);
+        SnapshotReader reader;
+        QString readError;
+
+        if (!db.isOpen()) {
+            error = "无法建立后台数据库连接";
+        } else if (!reader.open(m_fileName, &readError)) {
+            error = "无效的快照文件：" + readError;
+        } else if (!db.transaction()) {
+            error = db.lastError().text();
+        } else {
+            // 项目、节点、关系在同一个事务中写入，失败或取消时整体回滚
+            error = importSnapshotRecords(db, reader, m_cancelled,
+                                          [this](qint64 done, qint64 total) { emit progress(done, total); },
+                                          ontologyId, projectName, nodeCount, edgeCount);
+            if (error.isEmpty() && !db.commit()) error = db.lastError().text();
+            if (!error.isEmpty()) {
+                db.rollback();
+                ontologyId = -1;
+            }
+        }
+    }
+    DatabaseConnection::removeThreadConnection(connectionName);
+
+    emit finished(error.isEmpty(), ontologyId, projectName, nodeCount, edgeCount, error);
+}
@@ -0,0 +1,92 @@
+#ifndef JSONLINESTRANSFER_H
+#define JSONLINESTRANSFER_H
+
+#include <QObject>
+#include <QString>
+#include <QAtomicInt>
+
+/**
+ * 流式项目导入导出，文件为 JSON Lines (.jsonl)，每行一个实体：
+ *   {"kind":"project","name":...,"description":...,"version":...}
+ *   {"kind":"node","id":...,"name":...,"nodeType":...,"description":...,"posX":...,"posY":...,"color":...,"properties":{...}}
+ *   {"kind":"edge","sourceId":...,"targetId":...,"relationType":...,"weight":...,"properties":{...}}
+ * 节点行必须出现在引用它的关系行之前 (导出时总是先写全部节点)。
+ *
+ * 两个 worker 都应 moveToThread 到后台线程后再执行 run()，各自使用独立的数据库连接；
+ * 内存占用只与批大小有关，与文件大小无关。
+ */
+
+/**
+ * @brief 流式导出：按主键分页读取，逐行写出
+ */
+class JsonLinesExporter : public QObject {
+    Q_OBJECT
+public:
+    JsonLinesExporter(int ontologyId, const QString& fileName, QObject *parent = nullptr);
+
+    // 可从任意线程调用
+    void cancel() { m_cancelled.storeRelease(1); }
+
+public slots:
+    void run();
+
+signals:
+    void progress(qint64 done, qint64 total);
+    void finished(bool ok, int nodeCount, int edgeCount, const QString& error);
+
+private:
+    int m_ontologyId;
+    QString m_fileName;
+    QAtomicInt m_cancelled;
+};
+
+/**
+ * @brief 流式导入：解析线程逐行解析并打包成批，当前线程批量写库，两者经有界队列流水线执行
+ */
+class JsonLinesImporter : public QObject {
+    Q_OBJECT
+public:
+    explicit JsonLinesImporter(const QString& fileName, QObject *parent = nullptr);
+
+    // 可从任意线程调用，已写入的批次保留在新项目中
+    void cancel() { m_cancelled.storeRelease(1); }
+
+public slots:
+    void run();
+
+signals:
+    void progress(qint64 bytesRead, qint64 totalBytes);
+    void finished(bool ok, int ontologyId, const QString& projectName,
+                  int nodeCount, int edgeCount, const QString& error);
+
+private:
+    QString m_fileName;
+    QAtomicInt m_cancelled;
+};
+
+/**
+ * @brief 二进制快照 (.kgsnap) 导入：记录直接从映射内存打包成批，与 JSON Lines 导入共用多行写入；
+ * 整个导入在一个事务中完成，失败或取消时不留下半个项目
+ */
+class SnapshotImporter : public QObject {
+    Q_OBJECT
+public:
+    explicit SnapshotImporter(const QString& fileName, QObject *parent = nullptr);
+
+    // 可从任意线程调用
+    void cancel() { m_cancelled.storeRelease(1); }
+
+public slots:
+    void run();
+
+signals:
+    void progress(qint64 done, qint64 total);
+    void finished(bool ok, int ontologyId, const QString& projectName,
+                  int nodeCount, int edgeCount, const QString& error);
+
+private:
+    QString m_fileName;
+    QAtomicInt m_cancelled;
+};
+
+#endif // JSONLINESTRANSFER_H
@@ -0,0 +1,316 @@
+#include "OntologySnapshot.h"
+#include <QSaveFile>
+#include <QHash>
+#include <QVector>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+
+static const char kSnapshotMagic[8] = {'K', 'G', 'S', 'N', 'A', 'P', '\0', '\0'};
+static const quint32 kByteOrderMark = 0x01020304;
+
+static quint64 align8(quint64 offset) {
+    return (offset + 7) & ~quint64(7);
+}
+
+// --- 写出 ---
+
+namespace {
+
+// 去重字符串表：类型、颜色等高度重复的字符串只存一份
+class StringTable {
+public:
+    StringTable() { m_index.append(0); }
+
+    quint32 intern(const QString& text) {
+        auto it = m_ids.constFind(text);
+        if (it != m_ids.constEnd()) return it.value();
+
+        quint32 id = m_index.size() - 1;
+        m_data.append(text.toUtf8());
+        m_index.append(m_data.size());
+        m_ids.insert(text, id);
+        return id;
+    }
+
+    quint32 count() const { return m_index.size() - 1; }
+    const QVector<quint32>& index() const { return m_index; }
+    const QByteArray& data() const { return m_data; }
+
+private:
+    QHash<QString, quint32> m_ids;
+    QVector<quint32> m_index;
+    QByteArray m_data;
+};
+
+bool writePadded(QSaveFile& file, const char* data, qint64 size, quint64 alignedSize) {
+    if (size > 0 && file.write(data, size) != size) return false;
+    static const char zeros[8] = {0};
+    qint64 padding = qint64(alignedSize) - size;
+    return padding <= 0 || file.write(zeros, padding) == padding;
+}
+
+} // namespace
+
+bool SnapshotWriter::write(const QString& fileName, const Ontology& ontology,
+                           const QList<GraphNode>& nodes, const QList<GraphEdge>& edges, QString* error) {
+    StringTable strings;
+    QByteArray props;
+
+    // 1. 节点记录：数据库 ID -> 记录下标
+    QVector<SnapshotNodeRecord> nodeRecords;
+    nodeRecords.reserve(nodes.size());
+    QHash<int, quint32> indexOf;
+    indexOf.reserve(nodes.size());
+
+    for (const auto& node : nodes) {
+        SnapshotNodeRecord rec;
+        std::memset(&rec, 0, sizeof(rec));
+        rec.id = node.id;
+        rec.type = strings.intern(node.nodeType);
+        rec.name = strings.intern(node.name);
+        rec.description = strings.intern(node.description);
+        rec.color = strings.intern(node.color);
+        rec.posX = node.posX;
+        rec.posY = node.posY;
+
+        // 未修改的 properties 直接复制数据库里的原始字节
+        QByteArray bytes = node.properties.toBytes();
+        rec.propsOffset = props.size();
+        rec.propsLength = bytes.size();
+        props.append(bytes);
+
+        indexOf.insert(node.id, nodeRecords.size());
+        nodeRecords.append(rec);
+    }
+
+    // 2. 关系记录按起点下标排序，CSR 的出边区间即为记录区间
+    QVector<SnapshotEdgeRecord> edgeRecords;
+    edgeRecords.reserve(edges.size());
+    for (const auto& edge : edges) {
+        auto src = indexOf.constFind(edge.sourceId);
+        auto dst = indexOf.constFind(edge.targetId);
+        if (src == indexOf.constEnd() || dst == indexOf.constEnd()) continue;
+
+        SnapshotEdgeRecord rec;
+        std::memset(&rec, 0, sizeof(rec));
+        rec.id = edge.id;
+        rec.source = src.value();
+        rec.target = dst.value();
+        rec.type = strings.intern(edge.relationType);
+        rec.weight = edge.weight;
+
+        QByteArray bytes = edge.properties.toBytes();
+        rec.propsOffset = props.size();
+        rec.propsLength = bytes.size();
+        props.append(bytes);
+
+        edgeRecords.append(rec);
+    }
+    std::stable_sort(edgeRecords.begin(), edgeRecords.end(),
+                     [](const SnapshotEdgeRecord& a, const SnapshotEdgeRecord& b) { return a.source < b.source; });
+
+    QVector<quint32> csrOffsets(nodeRecords.size() + 1, 0);
+    QVector<quint32> csrTargets(edgeRecords.size());
+    for (int i = 0; i < edgeRecords.size(); ++i) {
+        csrOffsets[edgeRecords[i].source + 1]++;
+        csrTargets[i] = edgeRecords[i].target;
+    }
+    for (int i = 0; i < nodeRecords.size(); ++i) {
+        csrOffsets[i + 1] += csrOffsets[i];
+    }
+
+    // 3. 头部：元数据字符串也放进字符串表
+    SnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kSnapshotMagic, sizeof(header.magic));
+    header.version = kSnapshotVersion;
+    header.byteOrderMark = kByteOrderMark;
+    header.nodeCount = nodeRecords.size();
+    header.edgeCount = edgeRecords.size();
+    header.ontologyName = strings.intern(ontology.name);
+    header.ontologyDescription = strings.intern(ontology.description);
+    header.ontologyVersion = strings.intern(ontology.version);
+    header.stringCount = strings.count();
+
+    quint64 stringIndexSize = quint64(strings.index().size()) * sizeof(quint32);
+    quint64 nodeSize = quint64(nodeRecords.size()) * sizeof(SnapshotNodeRecord);
+    quint64 edgeSize = quint64(edgeRecords.size()) * sizeof(SnapshotEdgeRecord);
+    quint64 csrOffsetsSize = quint64(csrOffsets.size()) * sizeof(quint32);
+    quint64 csrTargetsSize = quint64(csrTargets.size()) * sizeof(quint32);
+
+    header.stringIndexOffset = align8(sizeof(SnapshotHeader));
+    header.stringDataOffset = align8(header.stringIndexOffset + stringIndexSize);
+    header.nodeOffset = align8(header.stringDataOffset + strings.data().size());
+    header.edgeOffset = align8(header.nodeOffset + nodeSize);
+    header.csrOffsetsOffset = align8(header.edgeOffset + edgeSize);
+    header.csrTargetsOffset = align8(header.csrOffsetsOffset + csrOffsetsSize);
+    header.propsOffset = align8(header.csrTargetsOffset + csrTargetsSize);
+    header.propsSize = props.size();
+    header.fileSize = header.propsOffset + header.propsSize;
+
+    // 4. 按区段顺序写出，QSaveFile 保证失败时不留下半个文件
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (error) *error = QString("无法写入文件: %1").arg(file.errorString());
+        return false;
+    }
+
+    bool ok = writePadded(file, reinterpret_cast<const char*>(&header), sizeof(header),
+                          header.stringIndexOffset)
+           && writePadded(file, reinterpret_cast<const char*>(strings.index().constData()), stringIndexSize,
+                          header.stringDataOffset - header.stringIndexOffset)
+           && writePadded(file, strings.data().constData(), strings.data().size(),
+                          header.nodeOffset - header.stringDataOffset)
+           && writePadded(file, reinterpret_cast<const char*>(nodeRecords.constData()), nodeSize,
+                          header.edgeOffset - header.nodeOffset)
+           && writePadded(file, reinterpret_cast<const char*>(edgeRecords.constData()), edgeSize,
+                          header.csrOffsetsOffset - header.edgeOffset)
+           && writePadded(file, reinterpret_cast<const char*>(csrOffsets.constData()), csrOffsetsSize,
+                          header.csrTargetsOffset - header.csrOffsetsOffset)
+           && writePadded(file, reinterpret_cast<const char*>(csrTargets.constData()), csrTargetsSize,
+                          header.propsOffset - header.csrTargetsOffset)
+           && writePadded(file, props.constData(), props.size(), props.size());
+
+    if (!ok || !file.commit()) {
+        if (error) *error = QString("写入快照失败: %1").arg(file.errorString());
+        return false;
+    }
+    return true;
+}
+
+// --- 读取 ---
+
+SnapshotReader::SnapshotReader()
+    : m_base(nullptr), m_header(nullptr), m_stringIndex(nullptr), m_stringData(nullptr),
+      m_nodes(nullptr), m_edges(nullptr), m_csrOffsets(nullptr), m_csrTargets(nullptr), m_props(nullptr) {}
+
+SnapshotReader::~SnapshotReader() {
+    close();
+}
+
+void SnapshotReader::close() {
+    if (m_base) {
+        m_file.unmap(const_cast<uchar*>(m_base));
+        m_base = nullptr;
+    }
+    if (m_file.isOpen()) m_file.close();
+    m_header = nullptr;
+}
+
+bool SnapshotReader::fail(QString* error, const QString& message) {
+    if (error) *error = message;
+    qWarning() << "SnapshotReader:" << message;
+    close();
+    return false;
+}
+
+bool SnapshotReader::open(const QString& fileName, QString* error) {
+    close();
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return fail(error, QString("无法打开文件: %1").arg(m_file.errorString()));
+    }
+
+    quint64 size = m_file.size();
+    if (size < sizeof(SnapshotHeader)) return fail(error, "文件过小，不是有效的快照");
+
+    m_base = m_file.map(0, size);
+    if (!m_base) return fail(error, QString("映射文件失败: %1").arg(m_file.errorString()));
+
+    m_header = reinterpret_cast<const SnapshotHeader*>(m_base);
+    const SnapshotHeader& h = *m_header;
+    if (std::memcmp(h.magic, kSnapshotMagic, sizeof(h.magic)) != 0) return fail(error, "不是图谱快照文件");
+    if (h.byteOrderMark != kByteOrderMark) return fail(error, "快照字节序与本机不一致");
+    if (h.version != kSnapshotVersion) return fail(error, QString("不支持的快照版本 %1").arg(h.version));
+    if (h.fileSize != size) return fail(error, "快照文件不完整");
+
+    // 区段边界检查：每个区段都必须对齐且落在文件内
+    auto sectionOk = [size](quint64 offset, quint64 length) {
+        return offset % 8 == 0 && offset <= size && length <= size - offset;
+    };
+    if (!sectionOk(h.stringIndexOffset, (quint64(h.stringCount) + 1) * sizeof(quint32))
+        || !sectionOk(h.nodeOffset, quint64(h.nodeCount) * sizeof(SnapshotNodeRecord))
+        || !sectionOk(h.edgeOffset, quint64(h.edgeCount) * sizeof(SnapshotEdgeRecord))
+        || !sectionOk(h.csrOffsetsOffset, (quint64(h.nodeCount) + 1) * sizeof(quint32))
+        || !sectionOk(h.csrTargetsOffset, quint64(h.edgeCount) * sizeof(quint32))
+        || !sectionOk(h.propsOffset, h.propsSize)) {
+        return fail(error, "快照区段越界");
+    }
+
+    m_stringIndex = reinterpret_cast<const quint32*>(m_base + h.stringIndexOffset);
+    m_stringData = reinterpret_cast<const char*>(m_base + h.stringDataOffset);
+    m_nodes = reinterpret_cast<const SnapshotNodeRecord*>(m_base + h.nodeOffset);
+    m_edges = reinterpret_cast<const SnapshotEdgeRecord*>(m_base + h.edgeOffset);
+    m_csrOffsets = reinterpret_cast<const quint32*>(m_base + h.csrOffsetsOffset);
+    m_csrTargets = reinterpret_cast<const quint32*>(m_base + h.csrTargetsOffset);
+    m_props = reinterpret_cast<const char*>(m_base + h.propsOffset);
+
+    if (!sectionOk(h.stringDataOffset, m_stringIndex[h.stringCount])) return fail(error, "字符串表越界");
+
+    // 遍历用到的 CSR 必须自洽，否则越界访问；记录中的字符串/properties 引用在访问时再校验
+    if (m_csrOffsets[0] != 0 || m_csrOffsets[h.nodeCount] != h.edgeCount) return fail(error, "邻接表损坏");
+    for (quint32 i = 0; i < h.nodeCount; ++i) {
+        if (m_csrOffsets[i] > m_csrOffsets[i + 1]) return fail(error, "邻接表损坏");
+    }
+    for (quint32 k = 0; k < h.edgeCount; ++k) {
+        if (m_csrTargets[k] >= h.nodeCount) return fail(error, "邻接表损坏");
+        // edge() 按下标直接取端点节点，关系记录的两端必须都在节点区段内
+        if (m_edges[k].source >= h.nodeCount || m_edges[k].target >= h.nodeCount) {
+            return fail(error, QString("关系记录 %1 的端点越界").arg(k));
+        }
+    }
+
+    return true;
+}
+
+QByteArray SnapshotReader::rawString(quint32 index) const {
+    if (!m_header || index >= m_header->stringCount) return QByteArray();
+    quint32 begin = m_stringIndex[index];
+    quint32 end = m_stringIndex[index + 1];
+    if (begin > end || end > m_stringIndex[m_header->stringCount]) return QByteArray();
+    return QByteArray::fromRawData(m_stringData + begin, end - begin);
+}
+
+QByteArray SnapshotReader::rawProperties(quint64 offset, quint32 length) const {
+    if (!m_header || offset > m_header->propsSize || length > m_header->propsSize - offset) return QByteArray();
+    return QByteArray::fromRawData(m_props + offset, length);
+}
+
+Ontology SnapshotReader::ontology() const {
+    Ontology onto;
+    if (!m_header) return onto;
+    onto.name = string(m_header->ontologyName);
+    onto.description = string(m_header->ontologyDescription);
+    onto.version = string(m_header->ontologyVersion);
+    return onto;
+}
+
+GraphNode SnapshotReader::node(quint32 index) const {
+    const SnapshotNodeRecord& rec = m_nodes[index];
+    GraphNode node;
+    node.id = rec.id;
+    node.nodeType = string(rec.type);
+    node.name = string(rec.name);
+    node.description = string(rec.description);
+    node.color = string(rec.color);
+    node.posX = rec.posX;
+    node.posY = rec.posY;
+    // fromRawData 视图指向映射内存，物化时复制一份
+    QByteArray props = rawProperties(rec.propsOffset, rec.propsLength);
+    node.properties = JsonProperties::fromRaw(QByteArray(props.constData(), props.size()));
+    return node;
+}
+
+GraphEdge SnapshotReader::edge(quint32 index) const {
+    const SnapshotEdgeRecord& rec = m_edges[index];
+    GraphEdge edge;
+    edge.id = rec.id;
+    edge.sourceId = m_nodes[rec.source].id;
+    edge.targetId = m_nodes[rec.target].id;
+    edge.relationType = string(rec.type);
+    edge.weight = rec.weight;
+    QByteArray props = rawProperties(rec.propsOffset, rec.propsLength);
+    edge.properties = JsonProperties::fromRaw(QByteArray(props.constData(), props.size()));
+    return edge;
+}
@@ -0,0 +1,136 @@
+#ifndef ONTOLOGYSNAPSHOT_H
+#define ONTOLOGYSNAPSHOT_H
+
+#include <QFile>
+#include <QString>
+#include <QList>
+#include <QByteArray>
+#include "../model/Ontology.h"
+#include "../model/GraphNode.h"
+#include "../model/GraphEdge.h"
+
+/**
+ * 本体二进制快照格式 (.kgsnap)，多字节字段按写出机器的字节序存放 (由 byteOrderMark 校验)，
+ * 各区段按 8 字节对齐：
+ *
+ *   SnapshotHeader        固定头：魔数、版本、计数、各区段偏移
+ *   string index          quint32[stringCount + 1]，字符串 i 占 data[index[i], index[i+1])
+ *   string data           去重后的 UTF-8 字符串 (类型、名称、颜色、描述等)
+ *   SnapshotNodeRecord[]  定长节点记录
+ *   SnapshotEdgeRecord[]  定长关系记录，按起点下标排序
+ *   CSR offsets           quint32[nodeCount + 1]，节点 i 的出边为 edges[offsets[i], offsets[i+1])
+ *   CSR targets           quint32[edgeCount]，与关系记录一一对应的终点下标
+ *   properties blob       各实体 properties 的原始 JSON 字节
+ *
+ * 打开时直接 mmap 整个文件，拓扑 (CSR) 与定长记录不经反序列化即可访问。
+ */
+
+static const quint32 kSnapshotVersion = 1;
+
+struct SnapshotHeader {
+    char magic[8];            // "KGSNAP\0\0"
+    quint32 version;
+    quint32 byteOrderMark;    // 0x01020304，读出值不同说明字节序不符
+    quint32 nodeCount;
+    quint32 edgeCount;
+    quint32 stringCount;
+    quint32 ontologyName;     // 以下三项为字符串表下标
+    quint32 ontologyDescription;
+    quint32 ontologyVersion;
+    quint64 stringIndexOffset;
+    quint64 stringDataOffset;
+    quint64 nodeOffset;
+    quint64 edgeOffset;
+    quint64 csrOffsetsOffset;
+    quint64 csrTargetsOffset;
+    quint64 propsOffset;
+    quint64 propsSize;
+    quint64 fileSize;
+};
+
+struct SnapshotNodeRecord {
+    qint32 id;                // 导出时的数据库 ID，仅用于对照
+    quint32 type;             // 字符串表下标
+    quint32 name;
+    quint32 description;
+    quint32 color;
+    float posX;
+    float posY;
+    quint32 propsLength;
+    quint64 propsOffset;      // 相对 properties 区起点
+};
+
+struct SnapshotEdgeRecord {
+    qint32 id;
+    quint32 source;           // 节点记录下标 (不是数据库 ID)
+    quint32 target;
+    quint32 type;
+    float weight;
+    quint32 propsLength;
+    quint64 propsOffset;
+};
+
+static_assert(sizeof(SnapshotHeader) == 112, "SnapshotHeader 布局变化需要提升版本号");
+static_assert(sizeof(SnapshotNodeRecord) == 40, "SnapshotNodeRecord 布局变化需要提升版本号");
+static_assert(sizeof(SnapshotEdgeRecord) == 32, "SnapshotEdgeRecord 布局变化需要提升版本号");
+
+/**
+ * @brief 快照写出：一次性按区段顺序写文件，不构建 JSON DOM
+ */
+class SnapshotWriter {
+public:
+    static bool write(const QString& fileName, const Ontology& ontology,
+                      const QList<GraphNode>& nodes, const QList<GraphEdge>& edges, QString* error);
+};
+
+/**
+ * @brief 快照读取：mmap 打开，记录和 CSR 直接指向映射内存
+ *
+ * 返回的指针与 QByteArray::fromRawData 视图只在 close() 之前有效。
+ */
+class SnapshotReader {
+public:
+    SnapshotReader();
+    ~SnapshotReader();
+
+    bool open(const QString& fileName, QString* error);
+    void close();
+    bool isOpen() const { return m_base != nullptr; }
+
+    quint32 nodeCount() const { return m_header->nodeCount; }
+    quint32 edgeCount() const { return m_header->edgeCount; }
+
+    const SnapshotNodeRecord& nodeRecord(quint32 index) const { return m_nodes[index]; }
+    const SnapshotEdgeRecord& edgeRecord(quint32 index) const { return m_edges[index]; }
+
+    // CSR 出边：节点 index 的出边下标为 [edgeBegin, edgeEnd)，终点为 targets()[k]
+    quint32 edgeBegin(quint32 index) const { return m_csrOffsets[index]; }
+    quint32 edgeEnd(quint32 index) const { return m_csrOffsets[index + 1]; }
+    const quint32* targets() const { return m_csrTargets; }
+
+    // 字符串表与 properties 的零拷贝视图
+    QByteArray rawString(quint32 index) const;
+    QString string(quint32 index) const { return QString::fromUtf8(rawString(index)); }
+    QByteArray rawProperties(quint64 offset, quint32 length) const;
+
+    Ontology ontology() const;
+    // 物化为模型对象 (复制字符串和 properties 字节，可在 close() 后继续使用)
+    GraphNode node(quint32 index) const;
+    GraphEdge edge(quint32 index) const;
+
+private:
+    bool fail(QString* error, const QString& message);
+
+    QFile m_file;
+    const uchar* m_base;
+    const SnapshotHeader* m_header;
+    const quint32* m_stringIndex;
+    const char* m_stringData;
+    const SnapshotNodeRecord* m_nodes;
+    const SnapshotEdgeRecord* m_edges;
+    const quint32* m_csrOffsets;
+    const quint32* m_csrTargets;
+    const char* m_props;
+};
+
+#endif // ONTOLOGYSNAPSHOT_H
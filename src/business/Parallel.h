@@ -0,0 +1,46 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <QList>
+#include <QThread>
+#include <functional>
+
+/**
+ * @brief 图算法共用的简单数据并行：把 [0, count) 均分成若干连续段，每段一个线程
+ *
+ * 只用于 CPU 密集、各段互不写同一位置的循环；线程在调用返回前全部结束，调用方无需同步。
+ */
+namespace Parallel {
+
+// 按工作量决定线程数：每个线程至少 minChunk 项，不超过 CPU 核数
+inline int workerCount(int count, int minChunk) {
+    int byWork = count / qMax(1, minChunk);
+    return qBound(1, byWork, qMax(1, QThread::idealThreadCount()));
+}
+
+// body(段号, 起, 止)；workers <= 1 时在当前线程直接执行
+inline void forRange(int count, int workers, const std::function<void(int, int, int)>& body) {
+    if (workers <= 1) {
+        body(0, 0, count);
+        return;
+    }
+
+    int chunk = (count + workers - 1) / workers;
+    QList<QThread*> threads;
+    for (int w = 0; w < workers; ++w) {
+        int begin = w * chunk;
+        int end = qMin(count, begin + chunk);
+        if (begin >= end) break;
+        QThread* thread = QThread::create(body, w, begin, end);
+        thread->start();
+        threads.append(thread);
+    }
+    for (QThread* thread : threads) {
+        thread->wait();
+        delete thread;
+    }
+}
+
+} // namespace Parallel
+
+#endif // PARALLEL_H
@@ -0,0 +1,676 @@
+#include "PatternQuery.h"
+#include "../database/DatabaseConnection.h"
+#include "../database/NodeRepository.h"
+#include "../database/RelationshipRepository.h"
+#include "../model/TypeDictionary.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QHash>
+#include <QSet>
+#include <QDebug>
+#include <functional>
+
+// =================== 词法分析 ===================
+
+namespace {
+
+struct Token {
+    enum Kind { Ident, String, Number, Symbol, End };
+    Kind kind;
+    QString text;
+    int pos;
+};
+
+bool lex(const QString& text, QList<Token>& tokens, QString* error) {
+    int i = 0;
+    while (i < text.size()) {
+        QChar ch = text[i];
+        if (ch.isSpace()) { ++i; continue; }
+
+        if (ch == '\'' || ch == '"') {
+            QChar quote = ch;
+            int start = i++;
+            QString value;
+            while (i < text.size() && text[i] != quote) {
+                if (text[i] == '\\' && i + 1 < text.size()) ++i;
+                value += text[i++];
+            }
+            if (i >= text.size()) {
+                if (error) *error = QString("第 %1 个字符处的字符串没有闭合").arg(start + 1);
+                return false;
+            }
+            ++i;
+            tokens.append({Token::String, value, start});
+            continue;
+        }
+
+        if (ch.isDigit()) {
+            int start = i;
+            while (i < text.size() && (text[i].isDigit() || text[i] == '.')) ++i;
+            tokens.append({Token::Number, text.mid(start, i - start), start});
+            continue;
+        }
+
+        if (ch.isLetterOrNumber() || ch == '_') {
+            int start = i;
+            while (i < text.size() && (text[i].isLetterOrNumber() || text[i] == '_')) ++i;
+            tokens.append({Token::Ident, text.mid(start, i - start), start});
+            continue;
+        }
+
+        QString two = text.mid(i, 2);
+        if (two == "->" || two == "<-" || two == "!=" || two == "^=") {
+            tokens.append({Token::Symbol, two, i});
+            i += 2;
+            continue;
+        }
+        if (QString("()[]:,.|-=~").contains(ch)) {
+            tokens.append({Token::Symbol, QString(ch), i});
+            ++i;
+            continue;
+        }
+
+        if (error) *error = QString("第 %1 个字符处无法识别的符号 '%2'").arg(i + 1).arg(ch);
+        return false;
+    }
+    tokens.append({Token::End, QString(), text.size()});
+    return true;
+}
+
+// =================== 语法分析 ===================
+
+class Parser {
+public:
+    Parser(const QList<Token>& tokens, PatternQuery& out) : m_tokens(tokens), m_out(out) {}
+
+    bool parse(QString* error) {
+        m_error = error;
+        if (!parseNode()) return false;
+        while (isSymbol("-") || isSymbol("<-")) {
+            if (!parseRel() || !parseNode()) return false;
+        }
+
+        if (isKeyword("WHERE")) {
+            advance();
+            do {
+                if (!parsePredicate()) return false;
+            } while (acceptKeyword("AND"));
+        }
+
+        if (isKeyword("RETURN")) {
+            advance();
+            do {
+                if (peek().kind != Token::Ident) return fail("RETURN 后应为变量名");
+                m_out.returns << advance().text;
+            } while (acceptSymbol(","));
+        }
+
+        if (isKeyword("LIMIT")) {
+            advance();
+            if (peek().kind != Token::Number) return fail("LIMIT 后应为数字");
+            m_out.limit = advance().text.toInt();
+        }
+
+        if (peek().kind != Token::End) return fail(QString("多余的内容 '%1'").arg(peek().text));
+        return validate();
+    }
+
+private:
+    const Token& peek() const { return m_tokens[m_index]; }
+    const Token& advance() { return m_tokens[m_index++]; }
+    bool isSymbol(const char* s) const { return peek().kind == Token::Symbol && peek().text == s; }
+    bool isKeyword(const char* s) const {
+        return peek().kind == Token::Ident && peek().text.compare(s, Qt::CaseInsensitive) == 0;
+    }
+    bool acceptSymbol(const char* s) { if (!isSymbol(s)) return false; advance(); return true; }
+    bool acceptKeyword(const char* s) { if (!isKeyword(s)) return false; advance(); return true; }
+    bool expectSymbol(const char* s) {
+        if (acceptSymbol(s)) return true;
+        return fail(QString("此处应为 '%1'").arg(s));
+    }
+    bool fail(const QString& message) {
+        if (m_error) *m_error = QString("语法错误 (第 %1 个字符): %2").arg(peek().pos + 1).arg(message);
+        return false;
+    }
+
+    bool parseNode() {
+        if (!expectSymbol("(")) return false;
+        PatternNode node;
+        if (peek().kind == Token::Ident) node.variable = advance().text;
+        if (acceptSymbol(":")) {
+            if (peek().kind != Token::Ident && peek().kind != Token::String) return fail("':' 后应为节点类型");
+            node.label = advance().text;
+        }
+        if (!expectSymbol(")")) return false;
+        if (node.variable.isEmpty()) node.variable = QString("_n%1").arg(m_out.nodes.size());
+        m_out.nodes.append(node);
+        return true;
+    }
+
+    bool parseRel() {
+        bool leftArrow = acceptSymbol("<-");
+        if (!leftArrow && !expectSymbol("-")) return false;
+
+        PatternRel rel;
+        if (acceptSymbol("[")) {
+            if (peek().kind == Token::Ident) advance(); // 关系变量暂不支持引用，忽略
+            if (acceptSymbol(":")) {
+                do {
+                    if (peek().kind != Token::Ident && peek().kind != Token::String) return fail("':' 后应为关系类型");
+                    rel.types << advance().text;
+                } while (acceptSymbol("|"));
+            }
+            if (!expectSymbol("]")) return false;
+        }
+
+        bool rightArrow = false;
+        if (acceptSymbol("->")) rightArrow = true;
+        else if (!expectSymbol("-")) return false;
+
+        if (leftArrow && rightArrow) return fail("关系不能同时指向两端");
+        rel.direction = leftArrow ? PatternRel::In : (rightArrow ? PatternRel::Out : PatternRel::Both);
+        m_out.rels.append(rel);
+        return true;
+    }
+
+    bool parsePredicate() {
+        if (peek().kind != Token::Ident) return fail("条件应以变量名开头");
+        PatternPredicate pred;
+        pred.variable = advance().text;
+        if (!expectSymbol(".")) return false;
+        if (peek().kind != Token::Ident) return fail("'.' 后应为属性名");
+        pred.property = advance().text;
+
+        if (isSymbol("=") || isSymbol("!=") || isSymbol("~") || isSymbol("^=")) {
+            pred.op = advance().text;
+        } else {
+            return fail("应为运算符 = != ~ ^=");
+        }
+
+        if (peek().kind == Token::String) pred.value = advance().text;
+        else if (peek().kind == Token::Number) pred.value = advance().text;
+        else return fail("运算符后应为字符串或数字");
+
+        m_out.predicates.append(pred);
+        return true;
+    }
+
+    bool validate() {
+        for (const auto& pred : m_out.predicates) {
+            if (m_out.positionsOf(pred.variable).isEmpty()) {
+                if (m_error) *m_error = QString("WHERE 中引用了未定义的变量 '%1'").arg(pred.variable);
+                return false;
+            }
+        }
+        for (const auto& var : m_out.returns) {
+            if (m_out.positionsOf(var).isEmpty()) {
+                if (m_error) *m_error = QString("RETURN 中引用了未定义的变量 '%1'").arg(var);
+                return false;
+            }
+        }
+        if (m_out.returns.isEmpty()) {
+            for (const auto& node : m_out.nodes) {
+                if (!node.variable.startsWith("_n") && !m_out.returns.contains(node.variable)) {
+                    m_out.returns << node.variable;
+                }
+            }
+            // 全部匿名时返回所有位置
+            if (m_out.returns.isEmpty()) {
+                for (const auto& node : m_out.nodes) {
+                    if (!m_out.returns.contains(node.variable)) m_out.returns << node.variable;
+                }
+            }
+        }
+        if (m_out.limit <= 0) m_out.limit = 1000;
+        return true;
+    }
+
+    const QList<Token>& m_tokens;
+    PatternQuery& m_out;
+    int m_index = 0;
+    QString* m_error = nullptr;
+};
+
+} // namespace
+
+QList<int> PatternQuery::positionsOf(const QString& variable) const {
+    QList<int> positions;
+    for (int i = 0; i < nodes.size(); ++i) {
+        if (nodes[i].variable == variable) positions << i;
+    }
+    return positions;
+}
+
+QList<PatternPredicate> PatternQuery::predicatesOf(const QString& variable) const {
+    QList<PatternPredicate> result;
+    for (const auto& pred : predicates) {
+        if (pred.variable == variable) result << pred;
+    }
+    return result;
+}
+
+bool PatternQuery::parse(const QString& text, PatternQuery& out, QString* error) {
+    out = PatternQuery();
+    QList<Token> tokens;
+    if (!lex(text, tokens, error)) return false;
+    Parser parser(tokens, out);
+    return parser.parse(error);
+}
+
+// =================== 规划与执行 ===================
+
+namespace {
+
+struct OntologyStats {
+    double nodeCount = 0;
+    double edgeCount = 0;
+    QHash<QString, double> typeCounts;
+    QHash<QString, double> relTypeCounts;
+};
+
+OntologyStats loadStats(QSqlDatabase& db, int ontologyId) {
+    OntologyStats stats;
+    QSqlQuery query(db);
+
+    query.prepare("SELECT node_type, COUNT(*) FROM node WHERE ontology_id = ? GROUP BY node_type");
+    query.addBindValue(ontologyId);
+    if (query.exec()) {
+        while (query.next()) {
+            stats.typeCounts[query.value(0).toString()] = query.value(1).toDouble();
+            stats.nodeCount += query.value(1).toDouble();
+        }
+    }
+
+    query.prepare("SELECT relation_type, COUNT(*) FROM relationship WHERE ontology_id = ? GROUP BY relation_type");
+    query.addBindValue(ontologyId);
+    if (query.exec()) {
+        while (query.next()) {
+            stats.relTypeCounts[query.value(0).toString()] = query.value(1).toDouble();
+            stats.edgeCount += query.value(1).toDouble();
+        }
+    }
+    return stats;
+}
+
+QString columnOf(const QString& property) {
+    if (property == "id") return "node_id";
+    if (property == "name") return "name";
+    if (property == "type") return "node_type";
+    if (property == "description") return "description";
+    return QString();
+}
+
+// 生成单个节点位置的过滤条件 (类型 + WHERE 谓词)
+QStringList nodeConditions(const QString& alias, const PatternNode& node,
+                           const QList<PatternPredicate>& preds, QVariantList& binds) {
+    QStringList conds;
+    if (!node.label.isEmpty()) {
+        conds << alias + ".node_type = ?";
+        binds << node.label;
+    }
+    for (const auto& pred : preds) {
+        QString column = columnOf(pred.property);
+        QString lhs;
+        if (!column.isEmpty()) {
+            lhs = alias + "." + column;
+        } else {
+            QString key = pred.property;
+            key.replace("\\", "\\\\").replace("\"", "\\\"");
+            lhs = DatabaseConnection::backend().jsonText(alias + ".properties");
+            binds << QString("$.\"%1\"").arg(key);
+        }
+
+        QString value = pred.value.toString();
+        if (pred.op == "=") {
+            conds << lhs + " = ?";
+            binds << value;
+        } else if (pred.op == "!=") {
+            conds << lhs + " <> ?";
+            binds << value;
+        } else if (pred.op == "~") {
+            conds << lhs + " LIKE ? ESCAPE '!'";
+            binds << "%" + NodeRepository::escapeLike(value) + "%";
+        } else {
+            conds << lhs + " LIKE ? ESCAPE '!'";
+            binds << NodeRepository::escapeLike(value) + "%";
+        }
+    }
+    return conds;
+}
+
+double selectivity(const PatternPredicate& pred) {
+    if (pred.op == "!=") return 0.95;
+    if (pred.op == "~") return 0.2;
+    if (pred.op == "^=") return 0.1;
+    return 0.05;
+}
+
+// 某个位置的基数估计
+double estimateNode(const PatternQuery& q, int pos, const OntologyStats& stats) {
+    const PatternNode& node = q.nodes[pos];
+    double rows = node.label.isEmpty() ? stats.nodeCount : stats.typeCounts.value(node.label, 0);
+    for (const auto& pred : q.predicatesOf(node.variable)) {
+        if (pred.op == "=" && (pred.property == "name" || pred.property == "id")) {
+            rows = qMin(rows, 1.0); // 唯一键等值
+        } else {
+            rows *= selectivity(pred);
+        }
+    }
+    return rows;
+}
+
+// 沿一条关系扩展时每行的平均扇出
+double estimateFanout(const PatternRel& rel, const OntologyStats& stats) {
+    if (stats.nodeCount <= 0) return 0;
+    double edges = stats.edgeCount;
+    if (!rel.types.isEmpty()) {
+        edges = 0;
+        for (const auto& type : rel.types) edges += stats.relTypeCounts.value(type, 0);
+    }
+    double fanout = edges / stats.nodeCount;
+    return rel.direction == PatternRel::Both ? fanout * 2 : fanout;
+}
+
+// 从链的一端出发时各步中间结果行数之和
+double chainCost(const PatternQuery& q, const OntologyStats& stats, bool reversed) {
+    int n = q.nodes.size();
+    int start = reversed ? n - 1 : 0;
+    double rows = estimateNode(q, start, stats);
+    double total = rows;
+    for (int step = 1; step < n; ++step) {
+        int pos = reversed ? n - 1 - step : step;
+        const PatternRel& rel = q.rels[reversed ? pos : pos - 1];
+        double filter = stats.nodeCount > 0 ? estimateNode(q, pos, stats) / stats.nodeCount : 0;
+        rows = rows * estimateFanout(rel, stats) * filter;
+        total += rows;
+    }
+    return total;
+}
+
+void collectResult(const PatternQuery& q, const QList<QVector<int>>& bindings,
+                   const QHash<int, GraphEdge>& matchedEdges, PatternResult& result) {
+    QList<int> columnPos;
+    for (const auto& var : q.returns) columnPos << q.positionsOf(var).first();
+
+    QSet<int> nodeIds;
+    for (const auto& binding : bindings) {
+        QVector<int> row;
+        for (int pos : columnPos) {
+            row << binding[pos];
+            nodeIds.insert(binding[pos]);
+        }
+        result.rows.append(row);
+    }
+
+    for (const auto& edge : matchedEdges) {
+        if (nodeIds.contains(edge.sourceId) && nodeIds.contains(edge.targetId)) {
+            result.edges.append(edge);
+        }
+    }
+    result.nodes = NodeRepository::getNodesByIds(nodeIds.values(), Projection::Topology);
+}
+
+bool executeSql(QSqlDatabase& db, int ontologyId, const PatternQuery& q,
+                PatternResult& result, QString* error) {
+    int n = q.nodes.size();
+    QStringList selects;
+    QString from = "node n0";
+    QVariantList joinBinds;
+    QStringList where{"n0.ontology_id = ?"};
+    QVariantList whereBinds{ontologyId};
+
+    for (int i = 0; i < n; ++i) selects << QString("n%1.node_id").arg(i);
+    for (int i = 0; i + 1 < n; ++i) {
+        selects << QString("r%1.relation_id, r%1.source_id, r%1.target_id, r%1.relation_type, r%1.weight").arg(i);
+
+        const PatternRel& rel = q.rels[i];
+        QString r = QString("r%1").arg(i);
+        QString left = QString("n%1").arg(i);
+        QString right = QString("n%1").arg(i + 1);
+
+        QString relOn;
+        QString nodeOn;
+        switch (rel.direction) {
+        case PatternRel::Out:
+            relOn = QString("%1.source_id = %2.node_id").arg(r, left);
+            nodeOn = QString("%1.node_id = %2.target_id").arg(right, r);
+            break;
+        case PatternRel::In:
+            relOn = QString("%1.target_id = %2.node_id").arg(r, left);
+            nodeOn = QString("%1.node_id = %2.source_id").arg(right, r);
+            break;
+        case PatternRel::Both:
+            relOn = QString("(%1.source_id = %2.node_id OR %1.target_id = %2.node_id)").arg(r, left);
+            nodeOn = QString("%1.node_id = CASE WHEN %2.source_id = %3.node_id THEN %2.target_id ELSE %2.source_id END")
+                         .arg(right, r, left);
+            break;
+        }
+        if (!rel.types.isEmpty()) {
+            QStringList holders;
+            for (const auto& type : rel.types) {
+                holders << "?";
+                joinBinds << type;
+            }
+            relOn += QString(" AND %1.relation_type IN (%2)").arg(r, holders.join(","));
+        }
+        from += QString(" JOIN relationship %1 ON %2 JOIN node %3 ON %4").arg(r, relOn, right, nodeOn);
+    }
+
+    QHash<QString, int> firstPos;
+    for (int i = 0; i < n; ++i) {
+        const PatternNode& node = q.nodes[i];
+        QString alias = QString("n%1").arg(i);
+        if (firstPos.contains(node.variable)) {
+            where << QString("%1.node_id = n%2.node_id").arg(alias).arg(firstPos[node.variable]);
+            if (node.label.isEmpty()) continue;
+            where << nodeConditions(alias, node, {}, whereBinds);
+            continue;
+        }
+        firstPos[node.variable] = i;
+        where << nodeConditions(alias, node, q.predicatesOf(node.variable), whereBinds);
+    }
+
+    QString sql = QString("SELECT %1 FROM %2 WHERE %3 LIMIT %4")
+                      .arg(selects.join(", "), from, where.join(" AND "))
+                      .arg(q.limit);
+
+    QSqlQuery query(db);
+    query.prepare(sql);
+    for (const auto& v : joinBinds) query.addBindValue(v);
+    for (const auto& v : whereBinds) query.addBindValue(v);
+
+    if (!query.exec()) {
+        if (error) *error = "模式查询执行失败: " + query.lastError().text();
+        qCritical() << "PatternExecutor:" << query.lastError().text() << sql;
+        return false;
+    }
+
+    QList<QVector<int>> bindings;
+    QHash<int, GraphEdge> edges;
+    while (query.next()) {
+        QVector<int> binding(n);
+        for (int i = 0; i < n; ++i) binding[i] = query.value(i).toInt();
+        for (int i = 0; i + 1 < n; ++i) {
+            int base = n + i * 5;
+            GraphEdge edge;
+            edge.id = query.value(base).toInt();
+            edge.ontologyId = ontologyId;
+            edge.sourceId = query.value(base + 1).toInt();
+            edge.targetId = query.value(base + 2).toInt();
+            edge.relationType = query.value(base + 3).toString();
+            TypeDictionary::resolve(edge);
+            edge.weight = query.value(base + 4).toFloat();
+            edges.insert(edge.id, edge);
+        }
+        bindings.append(binding);
+    }
+
+    collectResult(q, bindings, edges, result);
+    return true;
+}
+
+bool executeInMemory(QSqlDatabase& db, int ontologyId, const PatternQuery& q, bool reversed,
+                     PatternResult& result, QString* error) {
+    int n = q.nodes.size();
+
+    // 1. 有约束的位置先用 SQL 取出候选集 (只取 ID)
+    QVector<bool> constrained(n, false);
+    QVector<QSet<int>> candidates(n);
+    for (int i = 0; i < n; ++i) {
+        const PatternNode& node = q.nodes[i];
+        QList<PatternPredicate> preds = q.predicatesOf(node.variable);
+        if (node.label.isEmpty() && preds.isEmpty()) continue;
+
+        QVariantList binds{ontologyId};
+        QStringList conds{"n.ontology_id = ?"};
+        conds << nodeConditions("n", node, preds, binds);
+
+        QSqlQuery query(db);
+        query.prepare("SELECT n.node_id FROM node n WHERE " + conds.join(" AND "));
+        for (const auto& v : binds) query.addBindValue(v);
+        if (!query.exec()) {
+            if (error) *error = "候选节点扫描失败: " + query.lastError().text();
+            return false;
+        }
+        while (query.next()) candidates[i].insert(query.value(0).toInt());
+        constrained[i] = true;
+    }
+
+    // 2. 加载拓扑 (不含 properties)，建出/入邻接表
+    QList<GraphEdge> allEdges = RelationshipRepository::getAllRelationships(ontologyId);
+    QHash<int, QVector<int>> outAdj;
+    QHash<int, QVector<int>> inAdj;
+    for (int i = 0; i < allEdges.size(); ++i) {
+        outAdj[allEdges[i].sourceId].append(i);
+        inAdj[allEdges[i].targetId].append(i);
+    }
+
+    // 各段关系的类型条件换算成类型ID，遍历时只做整数比较 (与 SQL 一样不区分大小写)
+    const TypeDictionary& types = TypeDictionary::forOntology(ontologyId);
+    QVector<QSet<int>> relTypeIds(q.rels.size());
+    for (int r = 0; r < q.rels.size(); ++r) {
+        for (const auto& type : q.rels[r].types) {
+            int typeId = types.find(TypeDictionary::RelationTypes, type);
+            if (typeId >= 0) relTypeIds[r].insert(typeId);
+        }
+    }
+
+    // 3. 遍历顺序：从代价更低的一端开始
+    QVector<int> order(n);
+    for (int i = 0; i < n; ++i) order[i] = reversed ? n - 1 - i : i;
+
+    QSet<int> startSet = candidates[order[0]];
+    if (!constrained[order[0]]) {
+        for (auto it = outAdj.constBegin(); it != outAdj.constEnd(); ++it) startSet.insert(it.key());
+        for (auto it = inAdj.constBegin(); it != inAdj.constEnd(); ++it) startSet.insert(it.key());
+    }
+
+    QVector<int> binding(n, -1);
+    QVector<int> edgeBinding(qMax(0, n - 1), -1);
+    QList<QVector<int>> bindings;
+    QHash<int, GraphEdge> matched;
+
+    // 同名变量已在其他位置绑定时，当前位置必须取相同节点
+    auto consistent = [&](int pos, int nodeId) {
+        if (constrained[pos] && !candidates[pos].contains(nodeId)) return false;
+        for (int other : q.positionsOf(q.nodes[pos].variable)) {
+            if (other != pos && binding[other] != -1 && binding[other] != nodeId) return false;
+        }
+        return true;
+    };
+
+    std::function<void(int)> expand = [&](int step) {
+        if (bindings.size() >= q.limit) return;
+        if (step == n) {
+            bindings.append(binding);
+            for (int e : edgeBinding) matched.insert(allEdges[e].id, allEdges[e]);
+            return;
+        }
+
+        int from = order[step - 1];
+        int to = order[step];
+        int relIndex = qMin(from, to);
+        const PatternRel& rel = q.rels[relIndex];
+        bool forward = to > from;
+        int current = binding[from];
+
+        auto tryEdges = [&](const QVector<int>& list, bool fromIsSource) {
+            for (int e : list) {
+                const GraphEdge& edge = allEdges[e];
+                if (!rel.types.isEmpty() && !relTypeIds[relIndex].contains(edge.typeId)) continue;
+                int next = fromIsSource ? edge.targetId : edge.sourceId;
+                if (!consistent(to, next)) continue;
+
+                int saved = binding[to];
+                binding[to] = next;
+                edgeBinding[relIndex] = e;
+                expand(step + 1);
+                binding[to] = saved;
+                if (bindings.size() >= q.limit) return;
+            }
+        };
+
+        // Out 表示 nodes[i] -> nodes[i+1]；反向遍历时源/目标对调
+        bool followOut = rel.direction == PatternRel::Both ||
+                         (rel.direction == PatternRel::Out) == forward;
+        bool followIn = rel.direction == PatternRel::Both ||
+                        (rel.direction == PatternRel::In) == forward;
+        if (followOut) tryEdges(outAdj.value(current), true);
+        if (followIn) tryEdges(inAdj.value(current), false);
+    };
+
+    for (int start : startSet) {
+        if (bindings.size() >= q.limit) break;
+        if (!consistent(order[0], start)) continue;
+        binding.fill(-1);
+        binding[order[0]] = start;
+        expand(1);
+    }
+
+    collectResult(q, bindings, matched, result);
+    return true;
+}
+
+} // namespace
+
+PatternResult PatternExecutor::execute(int ontologyId, const PatternQuery& query, QString* error) {
+    PatternResult result;
+    result.columns = query.returns;
+
+    QSqlDatabase db = DatabaseConnection::getDatabase();
+    if (!db.isOpen() || query.nodes.isEmpty()) {
+        if (error) *error = "数据库未连接或查询为空";
+        return result;
+    }
+
+    OntologyStats stats = loadStats(db, ontologyId);
+
+    // 代价模型：SQL 每个中间行 ~1 单位 (索引回表 + 网络传输)，外加一次往返；
+    // 内存遍历需先加载全部拓扑 (每条边 ~0.3)，之后每个中间行只有 ~0.05
+    double forward = chainCost(query, stats, false);
+    double backward = chainCost(query, stats, true);
+    bool reversed = backward < forward;
+    double rows = qMin(forward, backward);
+
+    double sqlCost = 20.0 + rows;
+    double memCost = stats.edgeCount * 0.3 + rows * 0.05;
+    bool useSql = query.nodes.size() == 1 || sqlCost <= memCost;
+
+    result.strategy = useSql ? PatternResult::SqlPushdown : PatternResult::InMemoryTraversal;
+    result.plan = QString("%1 | 估计中间行数 %2 | SQL 代价 %3, 内存代价 %4%5")
+                      .arg(useSql ? "SQL 下推 (单条 JOIN)" : "内存邻接表遍历")
+                      .arg(rows, 0, 'f', 1)
+                      .arg(sqlCost, 0, 'f', 1)
+                      .arg(memCost, 0, 'f', 1)
+                      .arg(!useSql && reversed ? " | 从链尾开始匹配" : "");
+    qInfo() << "PatternExecutor:" << result.plan;
+
+    bool ok = useSql ? executeSql(db, ontologyId, query, result, error)
+                     : executeInMemory(db, ontologyId, query, reversed, result, error);
+    if (!ok) {
+        result.rows.clear();
+        result.nodes.clear();
+        result.edges.clear();
+    }
+    return result;
+}
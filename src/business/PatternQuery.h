@@ -0,0 +1,84 @@
+#ifndef PATTERNQUERY_H
+#define PATTERNQUERY_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QVector>
+#include <QVariant>
+#include "../model/GraphNode.h"
+#include "../model/GraphEdge.h"
+
+/**
+ * 图模式查询语言 (类 Cypher 的子集)，示例：
+ *   (a:Database)-[:使用]->(b) WHERE a.name ~ 'SQL' RETURN a,b LIMIT 50
+ *
+ * 支持的语法：
+ *   - 节点 (变量:类型)，变量和类型均可省略
+ *   - 关系 -[:类型|类型]->、<-[:类型]-、-[:类型]-，以及简写 -->、<--、--
+ *   - WHERE 由 AND 连接的条件：变量.属性 运算符 字面量
+ *     运算符：= 等于，!= 不等于，~ 包含(不区分大小写)，^= 前缀
+ *     属性：id/name/type/description 对应 node 表列，其他名称匹配 properties JSON 键
+ *   - RETURN 变量列表 (省略时返回全部命名变量)，LIMIT 行数
+ */
+
+struct PatternPredicate {
+    QString variable;
+    QString property;
+    QString op;       // "=", "!=", "~", "^="
+    QVariant value;
+};
+
+struct PatternNode {
+    QString variable; // 匿名节点由解析器分配 "_n<i>"
+    QString label;    // 对应 node_type，空表示不限
+};
+
+struct PatternRel {
+    enum Direction { Out, In, Both };
+    Direction direction = Out;
+    QStringList types; // 对应 relation_type，空表示不限
+};
+
+/**
+ * @brief 解析后的逻辑计划：一条由节点和关系交替组成的链
+ */
+struct PatternQuery {
+    QList<PatternNode> nodes;   // 链上第 i 个节点位置
+    QList<PatternRel> rels;     // rels[i] 连接 nodes[i] 与 nodes[i+1]
+    QList<PatternPredicate> predicates;
+    QStringList returns;
+    int limit = 1000;
+
+    // 同名变量出现在多个位置时 (环)，这些位置必须绑定同一个节点
+    QList<int> positionsOf(const QString& variable) const;
+    QList<PatternPredicate> predicatesOf(const QString& variable) const;
+
+    static bool parse(const QString& text, PatternQuery& out, QString* error);
+};
+
+/**
+ * @brief 模式查询的执行结果
+ */
+struct PatternResult {
+    enum Strategy { SqlPushdown, InMemoryTraversal };
+    Strategy strategy = SqlPushdown;
+    QString plan;                 // 计划说明 (含代价估计)，用于展示
+    QStringList columns;          // RETURN 的变量
+    QList<QVector<int>> rows;     // 每行为各列绑定的 nodeId
+    QList<GraphNode> nodes;       // 结果涉及的节点 (去重，批量加载)
+    QList<GraphEdge> edges;       // 结果涉及的关系 (两端均在结果中)
+};
+
+/**
+ * @brief 基于代价的规划与执行
+ *
+ * 从本体统计 (节点类型分布、关系总数) 估算每个位置的基数和链上每一步的中间行数，
+ * 比较 "整条链翻译为一条 SQL JOIN" 与 "加载拓扑后在内存邻接表上回溯匹配" 两种策略的代价。
+ */
+class PatternExecutor {
+public:
+    static PatternResult execute(int ontologyId, const PatternQuery& query, QString* error);
+};
+
+#endif // PATTERNQUERY_H
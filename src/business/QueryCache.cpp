@@ -0,0 +1,130 @@
+#include "QueryCache.h"
+#include <QDebug>
+
+QueryCache::QueryCache(int maxCost, QObject *parent)
+    : QObject(parent), m_cache(maxCost), m_hits(0), m_misses(0) {}
+
+QueryCache::~QueryCache() {
+    // 缓存项析构时要访问标签索引，必须在其他成员销毁之前清空
+    m_cache.clear();
+}
+
+QString QueryCache::key(int ontologyId, const QString& shape, const QStringList& params) {
+    return QString("%1|%2|%3").arg(ontologyId).arg(shape, params.join(','));
+}
+
+const CachedResult* QueryCache::find(const QString& key) const {
+    // QCache::object 会刷新 LRU 顺序，需要非 const 访问
+    const Entry* entry = const_cast<QCache<QString, Entry>&>(m_cache).object(key);
+    if (entry) ++m_hits;
+    else ++m_misses;
+    return entry ? &entry->result : nullptr;
+}
+
+void QueryCache::insert(const QString& key, const CachedResult& result, const QStringList& tags) {
+    int cost = 1 + result.nodes.size() + result.edges.size() + result.ids.size() + result.depthOf.size();
+    if (cost > m_cache.maxCost()) return; // 单个结果超过容量，直接不缓存
+
+    // 同键的旧项和被挤出的项在 insert 内析构并摘除标签，新项的标签之后再登记
+    m_cache.insert(key, new Entry{this, key, result}, cost);
+    for (const QString& tag : tags) {
+        m_tagIndex[tag].insert(key);
+    }
+    m_keyTags[key] = tags;
+    remember(result);
+}
+
+void QueryCache::forget(const QString& key) {
+    for (const QString& tag : m_keyTags.take(key)) {
+        auto it = m_tagIndex.find(tag);
+        if (it == m_tagIndex.end()) continue;
+        it.value().remove(key);
+        if (it.value().isEmpty()) m_tagIndex.erase(it);
+    }
+}
+
+void QueryCache::remember(const CachedResult& result) {
+    for (const auto& node : result.nodes) m_nodeOntology[node.id] = node.ontologyId;
+    if (result.node.id > 0) m_nodeOntology[result.node.id] = result.node.ontologyId;
+    for (const auto& edge : result.edges) m_edgeOntology[edge.id] = edge.ontologyId;
+}
+
+void QueryCache::invalidateTag(const QString& tag) {
+    // 先整体取出：remove 会析构缓存项，并回头修改其他标签的键集合
+    const QSet<QString> keys = m_tagIndex.take(tag);
+    for (const QString& key : keys) {
+        m_cache.remove(key);
+    }
+}
+
+void QueryCache::invalidateOntology(int ontologyId) {
+    invalidateTag(QString("nodes:%1").arg(ontologyId));
+    invalidateTag(QString("edges:%1").arg(ontologyId));
+}
+
+void QueryCache::clear() {
+    m_cache.clear();
+    m_tagIndex.clear();
+    m_keyTags.clear();
+    m_nodeOntology.clear();
+    m_edgeOntology.clear();
+}
+
+void QueryCache::invalidateForUnknownOntology(const QString& kind, int ontologyId) {
+    if (ontologyId > 0) {
+        invalidateTag(QString("%1:%2").arg(kind).arg(ontologyId));
+        return;
+    }
+    QStringList tags;
+    for (auto it = m_tagIndex.constBegin(); it != m_tagIndex.constEnd(); ++it) {
+        if (it.key().startsWith(kind + ":")) tags << it.key();
+    }
+    for (const QString& tag : tags) invalidateTag(tag);
+}
+
+void QueryCache::onNodeAdded(const GraphNode& node) {
+    // 新节点还没有关系，拓扑类结果不受影响
+    invalidateTag(QString("nodes:%1").arg(node.ontologyId));
+    m_nodeOntology[node.id] = node.ontologyId;
+}
+
+void QueryCache::onNodeUpdated(const GraphNode& node) {
+    invalidateTag(QString("node:%1").arg(node.id));
+    invalidateTag(QString("nodes:%1").arg(node.ontologyId));
+}
+
+void QueryCache::onNodeDeleted(int nodeId) {
+    // 删除节点会级联删除关系，节点和拓扑结果都要失效
+    int ontologyId = m_nodeOntology.value(nodeId, -1);
+    invalidateTag(QString("node:%1").arg(nodeId));
+    invalidateForUnknownOntology("nodes", ontologyId);
+    invalidateForUnknownOntology("edges", ontologyId);
+    m_nodeOntology.remove(nodeId);
+}
+
+void QueryCache::onRelationshipAdded(const GraphEdge& edge) {
+    invalidateTag(QString("edges:%1").arg(edge.ontologyId));
+    // 端点原先没有关系时，其相连关系的缓存只挂在 node:<id> 上
+    invalidateTag(QString("node:%1").arg(edge.sourceId));
+    invalidateTag(QString("node:%1").arg(edge.targetId));
+    m_edgeOntology[edge.id] = edge.ontologyId;
+}
+
+void QueryCache::onRelationshipUpdated(const GraphEdge& edge) {
+    invalidateTag(QString("edges:%1").arg(edge.ontologyId));
+}
+
+void QueryCache::onRelationshipDeleted(int edgeId) {
+    invalidateForUnknownOntology("edges", m_edgeOntology.value(edgeId, -1));
+    m_edgeOntology.remove(edgeId);
+}
+
+void QueryCache::onChangeSetCommitted(const GraphChangeSet& changes) {
+    // 同一标签在首次失效后即为空，逐项复用单条变更的处理即可
+    for (int id : changes.deletedEdgeIds) onRelationshipDeleted(id);
+    for (int id : changes.deletedNodeIds) onNodeDeleted(id);
+    for (const auto& node : changes.addedNodes) onNodeAdded(node);
+    for (const auto& node : changes.updatedNodes) onNodeUpdated(node);
+    for (const auto& edge : changes.addedEdges) onRelationshipAdded(edge);
+    for (const auto& edge : changes.updatedEdges) onRelationshipUpdated(edge);
+}
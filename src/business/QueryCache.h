@@ -0,0 +1,87 @@
+#ifndef QUERYCACHE_H
+#define QUERYCACHE_H
+
+#include <QObject>
+#include <QCache>
+#include <QHash>
+#include <QMap>
+#include <QSet>
+#include <QStringList>
+#include "../model/GraphNode.h"
+#include "../model/GraphEdge.h"
+#include "GraphChangeSet.h"
+
+/**
+ * @brief 查询结果缓存项，按查询形态只填充其中一个字段
+ */
+struct CachedResult {
+    QList<GraphNode> nodes;
+    QList<GraphEdge> edges;
+    GraphNode node;
+    QList<int> ids;
+    QMap<int, int> depthOf;
+    bool truncated = false;
+};
+
+/**
+ * @brief QueryEngine 与 Repository 之间的结果缓存
+ *
+ * 基于 QCache 的 LRU 淘汰，成本按结果包含的实体数计算。每个缓存项带若干依赖标签：
+ *   nodes:<本体ID>  节点列表/节点集合
+ *   edges:<本体ID>  关系列表/拓扑 (路径、邻域等)
+ *   node:<节点ID>   单节点及其相连关系 (新关系连到该节点时也失效)
+ * GraphEditor 的变更信号只失效受影响的标签，不清空整个缓存。
+ * 缓存项被 LRU 淘汰或移除时同步从标签索引中摘除，索引规模始终与缓存项数一致。
+ */
+class QueryCache : public QObject {
+    Q_OBJECT
+public:
+    explicit QueryCache(int maxCost = 200000, QObject *parent = nullptr);
+    ~QueryCache();
+
+    // 查询键：本体 + 查询形态 + 参数
+    static QString key(int ontologyId, const QString& shape, const QStringList& params = QStringList());
+
+    const CachedResult* find(const QString& key) const;
+    void insert(const QString& key, const CachedResult& result, const QStringList& tags);
+
+    void invalidateTag(const QString& tag);
+    void invalidateOntology(int ontologyId);
+    void clear();
+
+    int hits() const { return m_hits; }
+    int misses() const { return m_misses; }
+
+public slots:
+    void onNodeAdded(const GraphNode& node);
+    void onNodeUpdated(const GraphNode& node);
+    void onNodeDeleted(int nodeId);
+    void onRelationshipAdded(const GraphEdge& edge);
+    void onRelationshipUpdated(const GraphEdge& edge);
+    void onRelationshipDeleted(int edgeId);
+    void onChangeSetCommitted(const GraphChangeSet& changes);
+
+private:
+    // QCache 淘汰时不通知调用方，由缓存项析构时把自己的键从标签索引中摘除
+    struct Entry {
+        QueryCache* owner;
+        QString key;
+        CachedResult result;
+        ~Entry() { owner->forget(key); }
+    };
+    void forget(const QString& key);
+
+    // 只有 ID 的删除信号：从已缓存结果中学到的归属本体，查不到时失效全部本体
+    void invalidateForUnknownOntology(const QString& kind, int ontologyId);
+    void remember(const CachedResult& result);
+
+    QCache<QString, Entry> m_cache;
+    QHash<QString, QSet<QString>> m_tagIndex;   // 标签 -> 缓存键
+    QHash<QString, QStringList> m_keyTags;      // 缓存键 -> 标签
+    QHash<int, int> m_nodeOntology;             // nodeId -> ontologyId
+    QHash<int, int> m_edgeOntology;             // edgeId -> ontologyId
+    mutable int m_hits;
+    mutable int m_misses;
+};
+
+#endif // QUERYCACHE_H
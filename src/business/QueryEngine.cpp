@@ -1,61 +1,267 @@
 #include "QueryEngine.h"
 #include "../database/NodeRepository.h"
 #include "../database/RelationshipRepository.h"
+#include "GraphEditor.h"
 #include <QQueue>
 #include <QSet>
 #include <QMap>
 
-QueryEngine::QueryEngine(QObject *parent) : QObject(parent) {}
+QueryEngine::QueryEngine(QObject *parent)
+    : QObject(parent), m_cache(new QueryCache(200000, this)),
+      m_nameIndex(new FuzzyNameIndex(this)), m_statistics(new GraphStatistics(this)),
+      m_analytics(new GraphAnalytics(this)), m_nameIndexLoaded(false) {}
+
+void QueryEngine::attachTo(GraphEditor* editor) {
+    connect(editor, &GraphEditor::nodeAdded, m_nameIndex, &FuzzyNameIndex::addNode);
+    connect(editor, &GraphEditor::nodeUpdated, m_nameIndex, &FuzzyNameIndex::updateNode);
+    connect(editor, &GraphEditor::nodeDeleted, m_nameIndex, &FuzzyNameIndex::removeNode);
+
+    // 写穿失效：只丢弃依赖被修改实体的缓存项
+    connect(editor, &GraphEditor::nodeAdded, m_cache, &QueryCache::onNodeAdded);
+    connect(editor, &GraphEditor::nodeUpdated, m_cache, &QueryCache::onNodeUpdated);
+    connect(editor, &GraphEditor::nodeDeleted, m_cache, &QueryCache::onNodeDeleted);
+    connect(editor, &GraphEditor::relationshipAdded, m_cache, &QueryCache::onRelationshipAdded);
+    connect(editor, &GraphEditor::relationshipUpdated, m_cache, &QueryCache::onRelationshipUpdated);
+    connect(editor, &GraphEditor::relationshipDeleted, m_cache, &QueryCache::onRelationshipDeleted);
+    connect(editor, &GraphEditor::changeSetCommitted, m_cache, &QueryCache::onChangeSetCommitted);
+    connect(editor, &GraphEditor::nodeAdded, m_statistics, &GraphStatistics::onNodeAdded);
+    connect(editor, &GraphEditor::nodeUpdated, m_statistics, &GraphStatistics::onNodeUpdated);
+    connect(editor, &GraphEditor::nodeDeleted, m_statistics, &GraphStatistics::onNodeDeleted);
+    connect(editor, &GraphEditor::relationshipAdded, m_statistics, &GraphStatistics::onRelationshipAdded);
+    connect(editor, &GraphEditor::relationshipUpdated, m_statistics, &GraphStatistics::onRelationshipUpdated);
+    connect(editor, &GraphEditor::relationshipDeleted, m_statistics, &GraphStatistics::onRelationshipDeleted);
+    connect(editor, &GraphEditor::changeSetCommitted, m_statistics, &GraphStatistics::onChangeSetCommitted);
+    // 分析结果整体失效，等下次访问时重算
+    connect(editor, &GraphEditor::graphChanged, m_analytics, &GraphAnalytics::invalidate);
+    connect(editor, &GraphEditor::changeSetCommitted, m_nameIndex, [this](const GraphChangeSet& changes) {
+        for (int id : changes.deletedNodeIds) m_nameIndex->removeNode(id);
+        for (const auto& node : changes.addedNodes) m_nameIndex->addNode(node);
+        for (const auto& node : changes.updatedNodes) m_nameIndex->updateNode(node);
+    });
+}
+
+void QueryEngine::ensureNameIndex(int ontologyId) {
+    if (m_nameIndexLoaded && m_nameIndex->ontologyId() == ontologyId) return;
+
+    m_nameIndex->clear();
+    m_nameIndex->setOntologyId(ontologyId);
+    for (const auto& node : NodeRepository::getAllNodes(ontologyId, Projection::Topology)) {
+        m_nameIndex->addNode(node);
+    }
+    m_nameIndexLoaded = true;
+}
+
+QList<FuzzyMatch> QueryEngine::fuzzyFindNodes(int ontologyId, const QString& name, int maxEdits, int limit) {
+    if (ontologyId <= 0 || name.trimmed().isEmpty()) return {};
+    ensureNameIndex(ontologyId);
+    return m_nameIndex->lookup(name, maxEdits, limit);
+}
+
+int QueryEngine::duplicateEditBound(const QString& name) {
+    // 规范化后不足 4 个字符的不做近似匹配 (避免 "C" 与 "R" 这类误合并)，之后每 4 个字符容忍 1 处差异，最多 3 处
+    int len = FuzzyNameIndex::normalize(name).size();
+    if (len < 4) return 0;
+    return qBound(1, len / 4, 3);
+}
 
 QList<GraphNode> QueryEngine::getAllNodes(int ontologyId) {
-    return NodeRepository::getAllNodes(ontologyId);
+    QString key = QueryCache::key(ontologyId, "nodes");
+    if (const CachedResult* hit = m_cache->find(key)) return hit->nodes;
+
+    CachedResult result;
+    result.nodes = NodeRepository::getAllNodes(ontologyId, Projection::Topology);
+    m_cache->insert(key, result, {QString("nodes:%1").arg(ontologyId)});
+    return result.nodes;
 }
 
 QList<GraphEdge> QueryEngine::getAllRelationships(int ontologyId) {
-    return RelationshipRepository::getAllRelationships(ontologyId);
+    QString key = QueryCache::key(ontologyId, "edges");
+    if (const CachedResult* hit = m_cache->find(key)) return hit->edges;
+
+    CachedResult result;
+    result.edges = RelationshipRepository::getAllRelationships(ontologyId);
+    m_cache->insert(key, result, {QString("edges:%1").arg(ontologyId)});
+    return result.edges;
+}
+
+bool QueryEngine::loadSnapshot(int ontologyId, GraphSnapshot& snapshot) {
+    return NodeRepository::fillSnapshot(ontologyId, snapshot)
+        && RelationshipRepository::fillSnapshot(ontologyId, snapshot);
+}
+
+const GraphStatistics* QueryEngine::statistics(int ontologyId) {
+    return m_statistics->refresh(ontologyId) ? m_statistics : nullptr;
+}
+
+const GraphAnalytics* QueryEngine::analytics(int ontologyId) {
+    return m_analytics->refresh(ontologyId) ? m_analytics : nullptr;
+}
+
+const GraphAnalytics* QueryEngine::analyticsAsync(int ontologyId) {
+    return m_analytics->refreshAsync(ontologyId) ? m_analytics : nullptr;
+}
+
+const GraphAnalytics* QueryEngine::communities(int ontologyId) {
+    return m_analytics->refreshCommunities(ontologyId) ? m_analytics : nullptr;
+}
+
+const GraphAnalytics* QueryEngine::communitiesAsync(int ontologyId) {
+    return m_analytics->refreshCommunitiesAsync(ontologyId) ? m_analytics : nullptr;
+}
+
+int QueryEngine::communityOf(int ontologyId, int nodeId) const {
+    if (m_analytics->snapshot().ontologyId() != ontologyId) return -1;
+    return m_analytics->communityOf(nodeId);
 }
 
 GraphNode QueryEngine::getNodeById(int nodeId) {
-    return NodeRepository::getNodeById(nodeId);
+    QString key = QueryCache::key(0, "node", {QString::number(nodeId)});
+    if (const CachedResult* hit = m_cache->find(key)) return hit->node;
+
+    CachedResult result;
+    result.node = NodeRepository::getNodeById(nodeId);
+    // 不存在的节点不缓存，避免之后新增同 ID 时读到空结果
+    if (result.node.isValid()) {
+        m_cache->insert(key, result, {QString("node:%1").arg(nodeId)});
+    }
+    return result.node;
 }
+
 QList<GraphEdge> QueryEngine::getRelatedRelationships(int nodeId) {
-    GraphNode node = getNodeById(nodeId);
-    QList<GraphEdge> allEdges = RelationshipRepository::getAllRelationships(node.ontologyId);
+    QString key = QueryCache::key(0, "related", {QString::number(nodeId)});
+    if (const CachedResult* hit = m_cache->find(key)) return hit->edges;
 
-    QList<GraphEdge> result;
-    for (const auto& edge : allEdges) {
-        if (edge.sourceId == nodeId || edge.targetId == nodeId) {
-            result.append(edge);
-        }
-    }
-    return result;
+    // 只取与该节点相连的关系 (走 source_id / target_id 索引)，不再读入整个本体
+    CachedResult result;
+    result.edges = RelationshipRepository::getEdgesByNode(nodeId);
+
+    // 节点被删除或修改、新关系连到该节点时由 node:<id> 失效；已有关系的修改与删除由所在本体的 edges 标签失效
+    QStringList tags{QString("node:%1").arg(nodeId)};
+    if (!result.edges.isEmpty()) tags << QString("edges:%1").arg(result.edges.first().ontologyId);
+    m_cache->insert(key, result, tags);
+    return result.edges;
 }
 
-QList<GraphNode> QueryEngine::queryByAttribute(const QString& attrName, const QString& attrValue) {
+SubGraph QueryEngine::expandNeighborhood(int centerId, int maxDepth,
+                                         const QStringList& relationTypes, int maxDegree, int maxNodes) {
+    SubGraph result;
+    if (centerId <= 0 || maxDepth < 0) return result;
 
-    QList<GraphNode> allNodes = getAllNodes(1);
-    QList<GraphNode> result;
+    // 缓存键只含中心节点，不为取本体ID单独查一次节点；本体ID在取回子图节点后用于失效标签
+    QString key = QueryCache::key(0, "ego",
+                                  {QString::number(centerId), QString::number(maxDepth),
+                                   relationTypes.join('|'), QString::number(maxDegree), QString::number(maxNodes)});
+    if (const CachedResult* hit = m_cache->find(key)) {
+        result.nodes = hit->nodes;
+        result.edges = hit->edges;
+        result.depthOf = hit->depthOf;
+        result.truncated = hit->truncated;
+        return result;
+    }
+
+    QSet<int> edgeIds;
+    QList<int> frontier{centerId};
+    result.depthOf[centerId] = 0;
 
-    for (const auto& node : allNodes) {
-        if (attrName == "name") {
-            if (node.name.contains(attrValue, Qt::CaseInsensitive)) {
-                result.append(node);
+    auto keepEdge = [&](const GraphEdge& edge) {
+        if (edgeIds.contains(edge.id)) return;
+        edgeIds.insert(edge.id);
+        result.edges.append(edge);
+    };
+
+    // 每层只发一次批量边查询；最后一层 (depth == maxDepth) 只用于补齐层内的边
+    for (int depth = 0; depth <= maxDepth && !frontier.isEmpty(); ++depth) {
+        if (depth == maxDepth) {
+            // 已到最大深度：另一端用 IN 限定在子图内，不取回通往子图外的关系
+            for (const auto& edge : RelationshipRepository::getEdgesBetween(frontier, result.depthOf.keys(), relationTypes)) {
+                keepEdge(edge);
             }
-        } else if (attrName == "type") {
-            if (node.nodeType.contains(attrValue, Qt::CaseInsensitive)) {
-                result.append(node);
+            break;
+        }
+
+        // 超级节点截断：度数先在索引上计数，超限的节点展示但不继续扩展，也不取回它的全部关系
+        QList<int> expand = frontier;
+        QList<int> hubs;
+        if (maxDegree > 0) {
+            QHash<int, int> degree = RelationshipRepository::countEdgesByNodes(frontier, relationTypes);
+            expand.clear();
+            for (int id : frontier) {
+                if (id != centerId && degree.value(id) > maxDegree) hubs.append(id);
+                else expand.append(id);
             }
         }
-        // 可以在这里扩展 JSON 属性的搜索
+
+        QList<int> next;
+        for (const auto& edge : RelationshipRepository::getEdgesByNodes(expand, relationTypes)) {
+            if (edgeIds.contains(edge.id)) continue;
+
+            bool srcKnown = result.depthOf.contains(edge.sourceId);
+            int from = srcKnown && result.depthOf[edge.sourceId] == depth ? edge.sourceId : edge.targetId;
+            int to = (from == edge.sourceId) ? edge.targetId : edge.sourceId;
+
+            if (!result.depthOf.contains(to)) {
+                // 达到节点上限：新节点及通往它的边都不再加入
+                if (maxNodes > 0 && result.depthOf.size() >= maxNodes) {
+                    result.truncated = true;
+                    continue;
+                }
+                result.depthOf[to] = depth + 1;
+                next.append(to);
+            }
+            keepEdge(edge);
+        }
+
+        // 超级节点只补齐两端都在子图内的边
+        if (!hubs.isEmpty()) {
+            for (const auto& edge : RelationshipRepository::getEdgesBetween(hubs, result.depthOf.keys(), relationTypes)) {
+                keepEdge(edge);
+            }
+        }
+        frontier = next;
     }
+
+    // 一次 IN 批量取回所有节点；中心节点不存在时子图为空，不缓存
+    result.nodes = NodeRepository::getNodesByIds(result.depthOf.keys(), Projection::Topology);
+    if (result.nodes.isEmpty()) return result;
+    int ontologyId = result.nodes.first().ontologyId;
+
+    CachedResult cached;
+    cached.nodes = result.nodes;
+    cached.edges = result.edges;
+    cached.depthOf = result.depthOf;
+    cached.truncated = result.truncated;
+    m_cache->insert(key, cached, {QString("nodes:%1").arg(ontologyId), QString("edges:%1").arg(ontologyId)});
     return result;
 }
 
+QList<GraphNode> QueryEngine::queryByAttribute(int ontologyId, const QString& attrName, const QString& attrValue,
+                                               NodeRepository::MatchMode mode) {
+    QString key = QueryCache::key(ontologyId, "attr", {attrName, attrValue, QString::number(mode)});
+    if (const CachedResult* hit = m_cache->find(key)) return hit->nodes;
+
+    CachedResult result;
+    result.nodes = NodeRepository::searchNodes(ontologyId, attrName, attrValue, mode);
+    m_cache->insert(key, result, {QString("nodes:%1").arg(ontologyId)});
+    return result.nodes;
+}
+
+PatternResult QueryEngine::queryPattern(int ontologyId, const QString& text, QString* error) {
+    PatternQuery query;
+    if (!PatternQuery::parse(text, query, error)) {
+        return PatternResult();
+    }
+    return PatternExecutor::execute(ontologyId, query, error);
+}
+
 QList<int> QueryEngine::findPath(int sourceId, int targetId) {
     QList<int> path;
     if (sourceId == targetId) return path;
 
     GraphNode node = getNodeById(sourceId);
+    QString key = QueryCache::key(node.ontologyId, "path",
+                                  {QString::number(sourceId), QString::number(targetId)});
+    if (const CachedResult* hit = m_cache->find(key)) return hit->ids;
+
     QList<GraphEdge> edges = getAllRelationships(node.ontologyId);
     QMap<int, QList<int>> adj;
     for (const auto& edge : edges) {
@@ -98,5 +304,10 @@ QList<int> QueryEngine::findPath(int sourceId, int targetId) {
             path.prepend(curr);
         }
     }
+
+    if (!node.isValid()) return path;
+    CachedResult cached;
+    cached.ids = path;
+    m_cache->insert(key, cached, {QString("edges:%1").arg(node.ontologyId)});
     return path;
 }
\ No newline at end of file
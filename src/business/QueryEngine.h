@@ -3,8 +3,29 @@
 
 #include <QObject>
 #include <QList>
+#include <QMap>
+#include <QStringList>
 #include "../model/GraphNode.h"
 #include "../model/GraphEdge.h"
+#include "../model/GraphSnapshot.h"
+#include "../database/NodeRepository.h"
+#include "FuzzyNameIndex.h"
+#include "PatternQuery.h"
+#include "QueryCache.h"
+#include "GraphStatistics.h"
+#include "GraphAnalytics.h"
+
+class GraphEditor;
+
+/**
+ * @brief 子图查询结果：节点、边以及每个节点距中心的跳数
+ */
+struct SubGraph {
+    QList<GraphNode> nodes;
+    QList<GraphEdge> edges;
+    QMap<int, int> depthOf; // nodeId -> 距中心节点的跳数
+    bool truncated = false; // 达到节点上限，外层未完全展开
+};
 
 class QueryEngine : public QObject
 {
@@ -13,6 +34,7 @@ public:
     explicit QueryEngine(QObject *parent = nullptr);
 
     // --- 1. 全图查询 ---
+    // 返回拓扑投影 (不含 description/properties)，完整数据用 getNodeById 按需读取
     QList<GraphNode> getAllNodes(int ontologyId);
     QList<GraphEdge> getAllRelationships(int ontologyId);
 
@@ -20,16 +42,71 @@ public:
     GraphNode getNodeById(int nodeId);
     // 获取与指定节点相连的所有边
     QList<GraphEdge> getRelatedRelationships(int nodeId);
+    /**
+     * @brief k 跳邻域(ego network)查询，按层广度优先扩展
+     * @param maxDepth 最大跳数
+     * @param relationTypes 只沿这些关系类型扩展，为空表示不限
+     * @param maxDegree 度数超过该值的节点只展示不再继续扩展(避免超级节点爆炸)，度数在 SQL 中计数，<=0 表示不限
+     * @param maxNodes 子图节点数上限，达到后不再加入新节点并置 truncated，<=0 表示不限
+     */
+    SubGraph expandNeighborhood(int centerId, int maxDepth,
+                                const QStringList& relationTypes = QStringList(), int maxDegree = 0,
+                                int maxNodes = 2000);
 
     // --- 3. 属性查询 ---
-    QList<GraphNode> queryByAttribute(const QString& attrName, const QString& attrValue);
+    // 检索条件全部下推到 SQL，并限定在指定本体内
+    QList<GraphNode> queryByAttribute(int ontologyId, const QString& attrName, const QString& attrValue,
+                                      NodeRepository::MatchMode mode = NodeRepository::MatchContains);
 
     // --- 4. 路径查询 ---
     QList<int> findPath(int sourceId, int targetId);
 
+    // --- 5. 模糊名称查询 ---
+    // 基于三元组索引的容错查找，索引按本体懒加载，之后随 GraphEditor 信号增量维护
+    QList<FuzzyMatch> fuzzyFindNodes(int ontologyId, const QString& name, int maxEdits = 2, int limit = 10);
+    // 导入去重时按名称长度放宽的编辑距离上界，只用于找出需要用户确认的候选
+    static int duplicateEditBound(const QString& name);
+
+    // --- 6. 图模式查询 ---
+    // 解析类 Cypher 语句，由代价模型在 SQL 下推与内存遍历之间选择执行方式
+    PatternResult queryPattern(int ontologyId, const QString& text, QString* error = nullptr);
+
+    // --- 7. 紧凑快照 ---
+    // 节点与关系一次读入 GraphSnapshot (含 CSR 邻接)，供统计、分析等批量计算使用，不进入结果缓存
+    bool loadSnapshot(int ontologyId, GraphSnapshot& snapshot);
+
+    // --- 8. 聚合统计 ---
+    // 仪表盘用的类型计数与核心节点，首次访问本体时读取一次拓扑快照，之后随变更信号增量维护；失败返回 nullptr
+    const GraphStatistics* statistics(int ontologyId);
+
+    // --- 9. 结构分析 ---
+    // PageRank / 介数 / 接近度，图发生变化后的首次访问才重新计算 (多线程，大图需数秒)；失败返回 nullptr
+    const GraphAnalytics* analytics(int ontologyId);
+    // 不阻塞的版本：结果过期时在后台重新计算，完成后由返回对象发出 metricsReady；
+    // 返回时可能只有上一次的结果 (isCurrent() 为 false) 或尚无结果。读取快照失败返回 nullptr
+    const GraphAnalytics* analyticsAsync(int ontologyId);
+    // 社区划分 (Louvain)，同样在图变化后的首次访问时重算
+    const GraphAnalytics* communities(int ontologyId);
+    // 不阻塞的版本，完成后由返回对象发出 communitiesReady；期间 communityOf 仍给出上一次的划分
+    const GraphAnalytics* communitiesAsync(int ontologyId);
+    // 只读缓存，不触发计算：尚未划分或节点是之后新增的返回 -1
+    int communityOf(int ontologyId, int nodeId) const;
+
+    // 监听 GraphEditor 的变更信号，保持内部索引与结果缓存与数据库一致
+    void attachTo(GraphEditor* editor);
+
+    QueryCache* cache() const { return m_cache; }
+
 private:
     // 辅助：构建邻接表
     QMap<int, QList<int>> buildAdjacencyList();
+    void ensureNameIndex(int ontologyId);
+
+    QueryCache* m_cache;
+    FuzzyNameIndex* m_nameIndex;
+    GraphStatistics* m_statistics;
+    GraphAnalytics* m_analytics;
+    bool m_nameIndexLoaded;
 };
 
 #endif // QUERYENGINE_H
\ No newline at end of file
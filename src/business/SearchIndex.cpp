@@ -0,0 +1,269 @@
+#include "SearchIndex.h"
+#include "GraphEditor.h"
+#include "../database/NodeRepository.h"
+#include "../database/AttributeRepository.h"
+#include <QtMath>
+#include <QDebug>
+#include <algorithm>
+
+// 前缀展开的词项上限，防止单字母前缀扫遍整个词典
+static const int kMaxPrefixExpansions = 64;
+
+static bool isCjk(QChar ch) {
+    ushort u = ch.unicode();
+    return (u >= 0x4E00 && u <= 0x9FFF)   // 中日韩统一表意文字
+        || (u >= 0x3400 && u <= 0x4DBF)   // 扩展 A
+        || (u >= 0xF900 && u <= 0xFAFF)   // 兼容表意文字
+        || (u >= 0x3040 && u <= 0x30FF)   // 平假名/片假名
+        || (u >= 0xAC00 && u <= 0xD7AF);  // 韩文音节
+}
+
+SearchIndex::SearchIndex(QObject *parent) : QObject(parent), m_ontologyId(-1) {}
+
+QStringList SearchIndex::tokenize(const QString& text) {
+    QStringList tokens;
+    QString word;
+    QString cjkRun;
+
+    auto flushWord = [&]() {
+        if (!word.isEmpty()) {
+            tokens << word.toLower();
+            word.clear();
+        }
+    };
+    auto flushCjk = [&]() {
+        if (cjkRun.size() == 1) {
+            tokens << cjkRun;
+        } else {
+            for (int i = 0; i + 1 < cjkRun.size(); ++i) {
+                tokens << cjkRun.mid(i, 2);
+            }
+        }
+        cjkRun.clear();
+    };
+
+    for (QChar ch : text) {
+        if (isCjk(ch)) {
+            flushWord();
+            cjkRun += ch;
+        } else if (ch.isLetterOrNumber()) {
+            flushCjk();
+            word += ch;
+        } else {
+            flushWord();
+            flushCjk();
+        }
+    }
+    flushWord();
+    flushCjk();
+    return tokens;
+}
+
+void SearchIndex::clear() {
+    m_postings.clear();
+    m_docs.clear();
+}
+
+void SearchIndex::rebuild(int ontologyId) {
+    clear();
+    m_ontologyId = ontologyId;
+
+    QList<GraphNode> nodes = NodeRepository::getAllNodes(ontologyId);
+    for (const auto& node : nodes) {
+        indexNode(node);
+    }
+
+    QList<Attribute> attributes = AttributeRepository::getNodeAttributesByOntology(ontologyId);
+    for (const auto& attr : attributes) {
+        addAttributeText(attr.nodeId, attr.attrValue);
+    }
+
+    qDebug() << "SearchIndex: 索引重建完成，文档数 =" << m_docs.size() << "词项数 =" << m_postings.size();
+}
+
+void SearchIndex::attachTo(GraphEditor* editor) {
+    connect(editor, &GraphEditor::nodeAdded, this, &SearchIndex::indexNode);
+    connect(editor, &GraphEditor::nodeUpdated, this, &SearchIndex::indexNode);
+    connect(editor, &GraphEditor::nodeDeleted, this, &SearchIndex::removeNode);
+    connect(editor, &GraphEditor::changeSetCommitted, this, [this](const GraphChangeSet& changes) {
+        for (int id : changes.deletedNodeIds) removeNode(id);
+        for (const auto& node : changes.addedNodes) indexNode(node);
+        for (const auto& node : changes.updatedNodes) indexNode(node);
+    });
+}
+
+void SearchIndex::indexNode(const GraphNode& node) {
+    if (node.id <= 0) return;
+    if (m_ontologyId > 0 && node.ontologyId > 0 && node.ontologyId != m_ontologyId) return;
+
+    // 更新时先移除旧的词项 (扩展属性不经过 GraphEditor，保留原有属性词项)
+    bool existed = m_docs.contains(node.id);
+    if (existed) {
+        for (const QString& term : m_docs[node.id].terms) {
+            QVector<Posting>& list = m_postings[term];
+            list.erase(std::remove_if(list.begin(), list.end(), [&](const Posting& p) {
+                return p.nodeId == node.id && p.field != FieldAttribute;
+            }), list.end());
+            if (list.isEmpty()) m_postings.remove(term);
+        }
+    }
+
+    DocInfo& doc = m_docs[node.id];
+    doc.name = node.name;
+    doc.nodeType = node.nodeType;
+
+    addField(node.id, FieldName, node.name, 0);
+    addField(node.id, FieldDescription, node.description, 0);
+}
+
+void SearchIndex::addAttributeText(int nodeId, const QString& value) {
+    if (!m_docs.contains(nodeId) || value.isEmpty()) return;
+    DocInfo& doc = m_docs[nodeId];
+    int base = doc.nextAttrPosition;
+    // 不同属性值之间留一个空位，避免跨属性值误判为短语
+    doc.nextAttrPosition += tokenize(value).size() + 1;
+    addField(nodeId, FieldAttribute, value, base);
+}
+
+void SearchIndex::removeNode(int nodeId) {
+    auto it = m_docs.find(nodeId);
+    if (it == m_docs.end()) return;
+
+    for (const QString& term : it->terms) {
+        QVector<Posting>& list = m_postings[term];
+        list.erase(std::remove_if(list.begin(), list.end(), [&](const Posting& p) {
+            return p.nodeId == nodeId;
+        }), list.end());
+        if (list.isEmpty()) m_postings.remove(term);
+    }
+    m_docs.erase(it);
+}
+
+void SearchIndex::addField(int nodeId, Field field, const QString& text, int basePosition) {
+    QStringList tokens = tokenize(text);
+    DocInfo& doc = m_docs[nodeId];
+    for (int i = 0; i < tokens.size(); ++i) {
+        m_postings[tokens[i]].append({nodeId, static_cast<quint8>(field), basePosition + i});
+        doc.terms.insert(tokens[i]);
+    }
+}
+
+double SearchIndex::fieldWeight(quint8 field) {
+    switch (field) {
+    case FieldName:      return 3.0;
+    case FieldAttribute: return 1.5;
+    default:             return 1.0;
+    }
+}
+
+QHash<int, double> SearchIndex::scoreTerm(const QString& term, bool prefix) const {
+    QHash<int, double> scores;
+    double docCount = qMax(1, m_docs.size());
+
+    auto accumulate = [&](const QVector<Posting>& list) {
+        // 统计文档频率用于 idf
+        QSet<int> docsWithTerm;
+        for (const auto& p : list) docsWithTerm.insert(p.nodeId);
+        double idf = qLn(1.0 + docCount / docsWithTerm.size());
+        for (const auto& p : list) scores[p.nodeId] += fieldWeight(p.field) * idf;
+    };
+
+    if (!prefix) {
+        auto it = m_postings.constFind(term);
+        if (it != m_postings.constEnd()) accumulate(it.value());
+        return scores;
+    }
+
+    int expanded = 0;
+    for (auto it = m_postings.lowerBound(term);
+         it != m_postings.constEnd() && it.key().startsWith(term) && expanded < kMaxPrefixExpansions;
+         ++it, ++expanded) {
+        accumulate(it.value());
+    }
+    return scores;
+}
+
+QList<SearchHit> SearchIndex::search(const QString& queryText, int limit) const {
+    QString text = queryText.trimmed();
+    if (text.isEmpty() || m_docs.isEmpty()) return {};
+
+    if (text.size() > 2 && text.startsWith('"') && text.endsWith('"')) {
+        return searchPhrase(tokenize(text.mid(1, text.size() - 2)), limit);
+    }
+
+    QStringList tokens = tokenize(text);
+    if (tokens.isEmpty()) return {};
+
+    // 输入末尾不是空白时，最后一个词视为尚未输完，按前缀匹配
+    bool lastIsPrefix = !queryText.at(queryText.size() - 1).isSpace();
+
+    QHash<int, double> total;
+    for (int i = 0; i < tokens.size(); ++i) {
+        QHash<int, double> termScores = scoreTerm(tokens[i], lastIsPrefix && i == tokens.size() - 1);
+        if (i == 0) {
+            total = termScores;
+        } else {
+            // AND 语义：只保留所有词都命中的文档
+            for (auto it = total.begin(); it != total.end();) {
+                auto hit = termScores.constFind(it.key());
+                if (hit == termScores.constEnd()) {
+                    it = total.erase(it);
+                } else {
+                    it.value() += hit.value();
+                    ++it;
+                }
+            }
+        }
+        if (total.isEmpty()) break;
+    }
+    return collectHits(total, limit);
+}
+
+QList<SearchHit> SearchIndex::searchPhrase(const QStringList& tokens, int limit) const {
+    if (tokens.isEmpty()) return {};
+
+    auto key = [](int nodeId, quint8 field, int position) {
+        return (qint64(nodeId) << 32) | (qint64(field) << 28) | qint64(position);
+    };
+
+    // 后续每个词的 (文档, 字段, 位置) 集合
+    QVector<QSet<qint64>> positions(tokens.size());
+    for (int i = 1; i < tokens.size(); ++i) {
+        auto it = m_postings.constFind(tokens[i]);
+        if (it == m_postings.constEnd()) return {};
+        for (const auto& p : it.value()) positions[i].insert(key(p.nodeId, p.field, p.position));
+    }
+
+    auto first = m_postings.constFind(tokens[0]);
+    if (first == m_postings.constEnd()) return {};
+
+    QHash<int, double> scores;
+    for (const auto& p : first.value()) {
+        bool matched = true;
+        for (int i = 1; i < tokens.size() && matched; ++i) {
+            matched = positions[i].contains(key(p.nodeId, p.field, p.position + i));
+        }
+        if (matched) scores[p.nodeId] += fieldWeight(p.field) * tokens.size();
+    }
+    return collectHits(scores, limit);
+}
+
+QList<SearchHit> SearchIndex::collectHits(const QHash<int, double>& scores, int limit) const {
+    QList<SearchHit> hits;
+    hits.reserve(scores.size());
+    for (auto it = scores.constBegin(); it != scores.constEnd(); ++it) {
+        auto docIt = m_docs.constFind(it.key());
+        if (docIt == m_docs.constEnd()) continue;
+        const DocInfo& doc = docIt.value();
+        // 名称越短越接近精确匹配，作为轻微加权
+        double lengthBoost = 1.0 / (1.0 + 0.05 * doc.name.size());
+        hits.append({it.key(), doc.name, doc.nodeType, it.value() * (1.0 + lengthBoost)});
+    }
+
+    std::sort(hits.begin(), hits.end(), [](const SearchHit& a, const SearchHit& b) {
+        if (a.score != b.score) return a.score > b.score;
+        return a.nodeId < b.nodeId;
+    });
+    if (limit > 0 && hits.size() > limit) hits = hits.mid(0, limit);
+    return hits;
+}
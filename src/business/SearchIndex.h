@@ -0,0 +1,87 @@
+#ifndef SEARCHINDEX_H
+#define SEARCHINDEX_H
+
+#include <QObject>
+#include <QMap>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QStringList>
+#include "../model/GraphNode.h"
+
+class GraphEditor;
+
+/**
+ * @brief 检索命中结果
+ */
+struct SearchHit {
+    int nodeId;
+    QString name;
+    QString nodeType;
+    double score;
+};
+
+/**
+ * @brief 进程内倒排索引，覆盖节点名称、描述和扩展属性值
+ *
+ * 分词规则：中日韩字符按相邻二元组 (bigram) 切分，拉丁字母/数字按单词切分并转小写。
+ * 词典用有序 QMap 保存，支持前缀展开；倒排项记录字段和位置，支持短语查询。
+ * 通过 attachTo() 接入 GraphEditor 的信号增量维护。
+ */
+class SearchIndex : public QObject {
+    Q_OBJECT
+public:
+    enum Field : quint8 { FieldName = 0, FieldDescription = 1, FieldAttribute = 2 };
+
+    explicit SearchIndex(QObject *parent = nullptr);
+
+    // 从数据库全量重建指定本体的索引
+    void rebuild(int ontologyId);
+    void clear();
+
+    // 监听 GraphEditor 的增删改信号，增量维护索引
+    void attachTo(GraphEditor* editor);
+
+    /**
+     * @brief 排序检索
+     * 普通查询：所有词都需命中，最后一个词按前缀匹配 (边输入边搜)；
+     * 用双引号包裹的查询按短语匹配，要求词在同一字段中连续出现。
+     */
+    QList<SearchHit> search(const QString& queryText, int limit = 20) const;
+
+    int documentCount() const { return m_docs.size(); }
+
+    // 分词 (对外公开便于其他模块复用同一规则)
+    static QStringList tokenize(const QString& text);
+
+public slots:
+    void indexNode(const GraphNode& node);
+    void removeNode(int nodeId);
+    void addAttributeText(int nodeId, const QString& value);
+
+private:
+    struct Posting {
+        int nodeId;
+        quint8 field;
+        int position;
+    };
+    struct DocInfo {
+        QString name;
+        QString nodeType;
+        int nextAttrPosition = 0;
+        QSet<QString> terms;
+    };
+
+    void addField(int nodeId, Field field, const QString& text, int basePosition);
+    // 单个查询词的打分：docId -> 分数；prefix 为 true 时展开所有以该词开头的词项
+    QHash<int, double> scoreTerm(const QString& term, bool prefix) const;
+    QList<SearchHit> searchPhrase(const QStringList& tokens, int limit) const;
+    QList<SearchHit> collectHits(const QHash<int, double>& scores, int limit) const;
+    static double fieldWeight(quint8 field);
+
+    int m_ontologyId;
+    QMap<QString, QVector<Posting>> m_postings; // 有序词典，支持前缀扫描
+    QHash<int, DocInfo> m_docs;
+};
+
+#endif // SEARCHINDEX_H
@@ -6,11 +6,9 @@
 #include <QDebug>
 
 bool AttributeRepository::addAttribute(Attribute& attr) {
-    QSqlDatabase db = DatabaseConnection::getDatabase();
-    QSqlQuery query(db);
-
-    query.prepare("INSERT INTO attribute (node_id, relation_id, attr_name, attr_value, attr_type) "
-                  "VALUES (:nid, :rid, :name, :val, :atyp)");
+    QSqlQuery& query = DatabaseConnection::preparedQuery(
+        "INSERT INTO attribute (node_id, relation_id, attr_name, attr_value, attr_type) "
+        "VALUES (:nid, :rid, :name, :val, :atyp)");
 
     if (attr.nodeId > 0) {
         query.bindValue(":nid", attr.nodeId);
@@ -98,19 +96,42 @@ QList<Attribute> AttributeRepository::getAllAttributesByType(const QString& enti
     return attributes;
 }
 
-bool AttributeRepository::deleteAttribute(int attrId) {
+QList<Attribute> AttributeRepository::getNodeAttributesByOntology(int ontologyId) {
+    QList<Attribute> attributes;
     QSqlDatabase db = DatabaseConnection::getDatabase();
     QSqlQuery query(db);
-    query.prepare("DELETE FROM attribute WHERE attr_id = :id");
+
+    query.prepare("SELECT a.attr_id, a.node_id, a.attr_name, a.attr_value, a.attr_type "
+                  "FROM attribute a JOIN node n ON a.node_id = n.node_id "
+                  "WHERE n.ontology_id = :oid");
+    query.bindValue(":oid", ontologyId);
+
+    if (query.exec()) {
+        while (query.next()) {
+            Attribute attr;
+            attr.id = query.value("attr_id").toInt();
+            attr.nodeId = query.value("node_id").toInt();
+            attr.attrName = query.value("attr_name").toString();
+            attr.attrValue = query.value("attr_value").toString();
+            attr.attrType = query.value("attr_type").toString();
+            attributes.append(attr);
+        }
+    } else {
+        qDebug() << "查询本体属性失败:" << query.lastError().text();
+    }
+    return attributes;
+}
+
+bool AttributeRepository::deleteAttribute(int attrId) {
+    QSqlQuery& query = DatabaseConnection::preparedQuery("DELETE FROM attribute WHERE attr_id = :id");
     query.bindValue(":id", attrId);
     return query.exec();
 }
 
 bool AttributeRepository::updateAttribute(const Attribute& attr) {
-    QSqlDatabase db = DatabaseConnection::getDatabase();
-    QSqlQuery query(db);
-    query.prepare("UPDATE attribute SET attr_name = :name, attr_value = :val, attr_type = :atyp "
-                  "WHERE attr_id = :id");
+    QSqlQuery& query = DatabaseConnection::preparedQuery(
+        "UPDATE attribute SET attr_name = :name, attr_value = :val, attr_type = :atyp "
+        "WHERE attr_id = :id");
     query.bindValue(":name", attr.attrName);
     query.bindValue(":val", attr.attrValue);
     query.bindValue(":atyp", attr.attrType);
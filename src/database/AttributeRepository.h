@@ -26,6 +26,9 @@ public:
 
     // 在类中添加静态方法声明
     static QList<Attribute> getAllAttributesByType(const QString& entityType);
+
+    // 获取某个本体下所有节点的扩展属性（用于构建检索索引）
+    static QList<Attribute> getNodeAttributesByOntology(int ontologyId);
 };
 
 #endif
\ No newline at end of file
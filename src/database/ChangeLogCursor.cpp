@@ -0,0 +1,78 @@
+#include "ChangeLogCursor.h"
+#include <QDateTime>
+
+// 空洞等待提交的最长时间，超过视为回滚
+static const qint64 kGapTimeoutMs = 10000;
+
+ChangeLogCursor::ChangeLogCursor() : m_ontologyId(-1), m_lastSeq(0) {}
+
+bool ChangeLogCursor::start(int ontologyId) {
+    reset();
+
+    qint64 seq = ChangeLogRepository::latestSeq(ontologyId);
+    if (seq < 0) return false;
+    startAt(ontologyId, seq);
+    return true;
+}
+
+void ChangeLogCursor::startAt(int ontologyId, qint64 seq) {
+    m_ontologyId = ontologyId;
+    m_lastSeq = seq;
+    m_gaps.clear();
+}
+
+void ChangeLogCursor::reset() {
+    m_ontologyId = -1;
+    m_lastSeq = 0;
+    m_gaps.clear();
+}
+
+qint64 ChangeLogCursor::safePosition() const {
+    qint64 safe = m_lastSeq;
+    for (const auto& gap : m_gaps) safe = qMin(safe, gap.first - 1);
+    return safe;
+}
+
+bool ChangeLogCursor::takeFromGaps(qint64 seq) {
+    for (int i = 0; i < m_gaps.size(); ++i) {
+        SeqGap gap = m_gaps[i];
+        if (seq < gap.first || seq > gap.last) continue;
+
+        m_gaps.removeAt(i);
+        if (gap.first < seq) m_gaps.append({gap.first, seq - 1, gap.seenAt});
+        if (seq < gap.last) m_gaps.append({seq + 1, gap.last, gap.seenAt});
+        return true;
+    }
+    return false;
+}
+
+bool ChangeLogCursor::fetch(int pageSize, QList<ChangeLogEntry>& entries, bool* hasMore) {
+    if (hasMore) *hasMore = false;
+    if (m_ontologyId <= 0) return false;
+
+    // 1. 放弃超时的空洞，确定本次读取的起点
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    qint64 from = m_lastSeq;
+    for (int i = m_gaps.size() - 1; i >= 0; --i) {
+        if (now - m_gaps[i].seenAt > kGapTimeoutMs) m_gaps.removeAt(i);
+        else from = qMin(from, m_gaps[i].first - 1);
+    }
+
+    QList<ChangeLogEntry> page;
+    if (!ChangeLogRepository::fetchSince(from, pageSize, page)) return false;
+
+    // 2. 跳过已处理过的序号，记录新出现的空洞；其他本体的日志只用于推进位置
+    qint64 previousSeq = m_lastSeq;
+    for (const auto& entry : page) {
+        if (entry.seq <= m_lastSeq) {
+            if (!takeFromGaps(entry.seq)) continue;
+        } else {
+            if (entry.seq > m_lastSeq + 1) m_gaps.append({m_lastSeq + 1, entry.seq - 1, now});
+            m_lastSeq = entry.seq;
+        }
+        if (entry.ontologyId == m_ontologyId) entries.append(entry);
+    }
+
+    if (hasMore) *hasMore = page.size() == pageSize && m_lastSeq > previousSeq;
+    return true;
+}
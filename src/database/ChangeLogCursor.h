@@ -0,0 +1,53 @@
+#ifndef CHANGELOGCURSOR_H
+#define CHANGELOGCURSOR_H
+
+#include <QList>
+#include <QtGlobal>
+#include "ChangeLogRepository.h"
+
+/**
+ * @brief change_log 的读取位置，负责序号空洞的跟踪
+ *
+ * AUTO_INCREMENT 的序号按分配顺序而不是提交顺序出现，较小的序号可能稍后才提交；
+ * 因此跳过的序号记为空洞，在超时前的每次拉取都从最早的空洞重新读取。
+ * 回滚留下的序号永远不会出现，超时后放弃。
+ * 序号在所有本体间共用：按全表顺序读取，其他本体的日志只推进位置、不返回，
+ * 这样只有真正缺失的序号才记为空洞。
+ */
+class ChangeLogCursor {
+public:
+    ChangeLogCursor();
+
+    // 从本体当前的最新序号开始，失败返回 false
+    bool start(int ontologyId);
+    // 从指定序号之后开始 (如快照记录的位置)
+    void startAt(int ontologyId, qint64 seq);
+    void reset();
+
+    int ontologyId() const { return m_ontologyId; }
+    qint64 position() const { return m_lastSeq; }
+    // 之前的日志都已读到的位置 (最早空洞之前)，重新打开时从这里开始不会漏掉修改
+    qint64 safePosition() const;
+
+    /**
+     * @brief 拉取一页尚未处理过的本本体日志，按 seq 升序
+     * @param hasMore 整页读满且有进展时置 true，调用方应接着拉下一页 (本页可能全是其他本体的日志)
+     */
+    bool fetch(int pageSize, QList<ChangeLogEntry>& entries, bool* hasMore = nullptr);
+
+private:
+    struct SeqGap {
+        qint64 first;
+        qint64 last;
+        qint64 seenAt;
+    };
+
+    // seq 落在某个空洞内时把它从空洞中移除，返回是否命中
+    bool takeFromGaps(qint64 seq);
+
+    int m_ontologyId;
+    qint64 m_lastSeq;
+    QList<SeqGap> m_gaps;
+};
+
+#endif // CHANGELOGCURSOR_H
@@ -0,0 +1,138 @@
+#include "ChangeLogRepository.h"
+#include "DatabaseConnection.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QStringList>
+#include <QVariant>
+#include <QDebug>
+
+// IN 列表每批的 ID 数，与其他仓库的批量写入一致
+static const int kLogBatchRows = 500;
+
+/**
+ * @brief 以 INSERT ... SELECT 从实体表追加日志
+ * @param selectSql 带 %1 (IN 占位符) 的 SELECT，列顺序为 ontology_id, entity_type, entity_id, op, origin_conn
+ * @param singleSql 单个 ID 的固定语句，走预编译缓存 (单条编辑是最常见的情况)
+ * @param idRepeats IN 列表在 selectSql 中出现的次数
+ */
+static bool appendLog(const QString& selectSql, const QString& singleSql, int idRepeats, const QList<int>& ids) {
+    if (ids.isEmpty()) return true;
+
+    QSqlDatabase db = DatabaseConnection::getDatabase();
+    if (!db.isOpen()) {
+        qCritical() << "ChangeLogRepository: 数据库连接已关闭";
+        return false;
+    }
+
+    if (ids.size() == 1) {
+        QSqlQuery& query = DatabaseConnection::preparedQuery(singleSql);
+        for (int i = 0; i < idRepeats; ++i) query.bindValue(i, ids.first());
+        if (!query.exec()) {
+            qCritical() << "ChangeLogRepository: 写入变更日志失败:" << query.lastError().text();
+            return false;
+        }
+        return true;
+    }
+
+    for (int start = 0; start < ids.size(); start += kLogBatchRows) {
+        int count = qMin(kLogBatchRows, ids.size() - start);
+
+        QStringList placeholders;
+        for (int i = 0; i < count; ++i) placeholders << "?";
+
+        QSqlQuery query(db);
+        query.prepare("INSERT INTO change_log (ontology_id, entity_type, entity_id, op, origin_conn) "
+                      + selectSql.arg(placeholders.join(",")));
+        for (int r = 0; r < idRepeats; ++r) {
+            for (int i = start; i < start + count; ++i) query.addBindValue(ids[i]);
+        }
+
+        if (!query.exec()) {
+            qCritical() << "ChangeLogRepository: 写入变更日志失败:" << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+// --- 写 ---
+
+bool ChangeLogRepository::logNodes(Operation op, const QList<int>& nodeIds) {
+    QString select = QString("SELECT ontology_id, %1, node_id, %2, %3 FROM node ")
+                         .arg(NodeEntity).arg(op).arg(DatabaseConnection::backend().sessionIdExpr());
+    return appendLog(select + "WHERE node_id IN (%1)",
+                     "INSERT INTO change_log (ontology_id, entity_type, entity_id, op, origin_conn) "
+                     + select + "WHERE node_id = ?",
+                     1, nodeIds);
+}
+
+bool ChangeLogRepository::logRelationships(Operation op, const QList<int>& relationIds) {
+    QString select = QString("SELECT ontology_id, %1, relation_id, %2, %3 FROM relationship ")
+                         .arg(RelationshipEntity).arg(op).arg(DatabaseConnection::backend().sessionIdExpr());
+    return appendLog(select + "WHERE relation_id IN (%1)",
+                     "INSERT INTO change_log (ontology_id, entity_type, entity_id, op, origin_conn) "
+                     + select + "WHERE relation_id = ?",
+                     1, relationIds);
+}
+
+bool ChangeLogRepository::logCascadedRelationships(const QList<int>& nodeIds) {
+    // 两端分属不同批的关系会记两次，拉取方按实体归并，不影响结果
+    QString select = QString("SELECT ontology_id, %1, relation_id, %2, %3 FROM relationship ")
+                         .arg(RelationshipEntity).arg(OpDelete).arg(DatabaseConnection::backend().sessionIdExpr());
+    return appendLog(select + "WHERE source_id IN (%1) OR target_id IN (%1)",
+                     "INSERT INTO change_log (ontology_id, entity_type, entity_id, op, origin_conn) "
+                     + select + "WHERE source_id = ? OR target_id = ?",
+                     2, nodeIds);
+}
+
+// --- 读 ---
+
+qint64 ChangeLogRepository::latestSeq(int ontologyId) {
+    QSqlDatabase db = DatabaseConnection::getDatabase();
+    if (!db.isOpen()) {
+        qCritical() << "ChangeLogRepository: 数据库连接已关闭";
+        return -1;
+    }
+
+    QSqlQuery& query = DatabaseConnection::preparedQuery(
+        "SELECT COALESCE(MAX(seq), 0) FROM change_log WHERE ontology_id = :oid");
+    query.bindValue(":oid", ontologyId);
+    if (!query.exec() || !query.next()) {
+        qCritical() << "ChangeLogRepository: 查询最新序号失败:" << query.lastError().text();
+        return -1;
+    }
+    return query.value(0).toLongLong();
+}
+
+bool ChangeLogRepository::fetchSince(qint64 afterSeq, int limit, QList<ChangeLogEntry>& entries) {
+    QSqlDatabase db = DatabaseConnection::getDatabase();
+    if (!db.isOpen()) {
+        qCritical() << "ChangeLogRepository: 数据库连接已关闭";
+        return false;
+    }
+
+    // 序号是全表共用的，不按本体过滤才能区分其他本体的日志与尚未提交的空洞；走主键范围扫描
+    QSqlQuery& query = DatabaseConnection::preparedQuery(
+        QString("SELECT seq, ontology_id, entity_type, entity_id, op, origin_conn = %1 FROM change_log "
+                "WHERE seq > :after ORDER BY seq LIMIT :lim")
+            .arg(DatabaseConnection::backend().sessionIdExpr()));
+    query.bindValue(":after", afterSeq);
+    query.bindValue(":lim", limit);
+
+    if (!query.exec()) {
+        qCritical() << "ChangeLogRepository: 拉取变更日志失败:" << query.lastError().text();
+        return false;
+    }
+
+    while (query.next()) {
+        ChangeLogEntry entry;
+        entry.seq = query.value(0).toLongLong();
+        entry.ontologyId = query.value(1).toInt();
+        entry.entityType = query.value(2).toInt();
+        entry.entityId = query.value(3).toInt();
+        entry.op = query.value(4).toInt();
+        entry.own = query.value(5).toBool();
+        entries.append(entry);
+    }
+    return true;
+}
@@ -0,0 +1,42 @@
+#ifndef CHANGELOGREPOSITORY_H
+#define CHANGELOGREPOSITORY_H
+
+#include <QList>
+#include <QtGlobal>
+
+/**
+ * @brief change_log 表中的一条记录
+ */
+struct ChangeLogEntry {
+    qint64 seq;
+    int ontologyId;
+    int entityType;   // ChangeLogRepository::EntityType
+    int entityId;
+    int op;           // ChangeLogRepository::Operation
+    bool own;         // 由当前会话写入 (会话 ID 见 StorageBackend::sessionIdExpr)
+};
+
+/**
+ * @brief 变更日志仓库，负责 change_log 表
+ * 写入由 NodeRepository / RelationshipRepository 在同一事务内调用，
+ * 日志行的 ontology_id 直接取自实体行，所以新增/修改要在写入之后记录，删除要在写入之前记录。
+ */
+class ChangeLogRepository {
+public:
+    enum EntityType { NodeEntity = 0, RelationshipEntity = 1 };
+    enum Operation { OpInsert = 0, OpUpdate = 1, OpDelete = 2 };
+
+    // --- 写 ---
+    static bool logNodes(Operation op, const QList<int>& nodeIds);
+    static bool logRelationships(Operation op, const QList<int>& relationIds);
+    // 删除节点前调用：记录与这些节点相连、将被外键级联删除的关系
+    static bool logCascadedRelationships(const QList<int>& nodeIds);
+
+    // --- 读 ---
+    // 本体当前的最大序号，客户端在全量加载之前取得，作为增量拉取的起点；失败返回 -1
+    static qint64 latestSeq(int ontologyId);
+    // 按 seq 升序取 seq > afterSeq 的日志，最多 limit 条；包含所有本体，由调用方按 ontologyId 过滤
+    static bool fetchSince(qint64 afterSeq, int limit, QList<ChangeLogEntry>& entries);
+};
+
+#endif // CHANGELOGREPOSITORY_H
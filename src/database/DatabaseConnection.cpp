@@ -1,31 +1,46 @@
 #include "DatabaseConnection.h"
+#include "MemoryGraphStore.h"
 #include <QSqlError>
+#include <QStringList>
 #include <QDebug>
 
 // 静态成员变量初始化
 std::unique_ptr<QSqlDatabase> DatabaseConnection::instance = nullptr;
+std::unique_ptr<StorageBackend> DatabaseConnection::s_backend = nullptr;
+bool DatabaseConnection::s_inTransaction = false;
 
 bool DatabaseConnection::connect(const DatabaseConfig& config) {
-    // 1. 如果 instance 不存在，则初始化 QSqlDatabase 实例
+    // 旧连接上 prepare 的语句在重连后失效
+    clearStatementCache();
+
+    // 1. 切换后端时连接的驱动也要换，先释放旧连接
+    std::unique_ptr<StorageBackend> created = StorageBackend::create(config.backend);
+    if (instance && instance->driverName() != created->driverName()) {
+        disconnect();
+    }
+    s_backend = std::move(created);
+
+    // 2. 如果 instance 不存在，则初始化 QSqlDatabase 实例
     if (!instance) {
         // 创建名为 "KnowledgeGraphConnection" 的连接，避免与默认连接冲突
-        instance = std::make_unique<QSqlDatabase>(QSqlDatabase::addDatabase("QMYSQL", "KG_CONN"));
+        instance = std::make_unique<QSqlDatabase>(QSqlDatabase::addDatabase(s_backend->driverName(), "KG_CONN"));
     }
 
-    // 2. 设置连接参数
-    instance->setHostName(config.hostname);
-    instance->setUserName(config.username);
-    instance->setPassword(config.password);
-    instance->setDatabaseName(config.database);
-    instance->setPort(config.port);
+    // 3. 设置连接参数
+    s_backend->configure(*instance, config);
 
-    // 3. 尝试打开连接
+    // 4. 尝试打开连接，再做会话设置和建表
     if (!instance->open()) {
         qCritical() << "数据库连接失败！错误详情:" << instance->lastError().text();
         return false;
     }
+    if (!s_backend->initializeSession(*instance) || !s_backend->initializeSchema(*instance)) {
+        instance->close();
+        return false;
+    }
 
-    qInfo() << "成功连接到数据库:" << config.database << "于主机:" << config.hostname;
+    qInfo() << "成功连接到数据库:" << config.database << "于主机:" << config.hostname
+            << "驱动:" << s_backend->driverName();
     return true;
 }
 
@@ -42,7 +57,17 @@ bool DatabaseConnection::isConnected() {
     return instance && instance->isOpen();
 }
 
+const StorageBackend& DatabaseConnection::backend() {
+    if (s_backend) return *s_backend;
+    static const std::unique_ptr<StorageBackend> fallback = StorageBackend::create(StorageBackend::MySql);
+    return *fallback;
+}
+
 void DatabaseConnection::disconnect() {
+    // 先释放语句，否则 removeDatabase 会提示连接仍在使用
+    clearStatementCache();
+
+    s_inTransaction = false;
     if (instance) {
         if (instance->isOpen()) {
             instance->close();
@@ -51,4 +76,106 @@ void DatabaseConnection::disconnect() {
         QSqlDatabase::removeDatabase("KG_CONN");
         instance.reset(); // 释放内存
     }
-}
\ No newline at end of file
+}
+
+QHash<QString, QSqlQuery>& DatabaseConnection::statementCache() {
+    static QHash<QString, QSqlQuery>* cache = new QHash<QString, QSqlQuery>();
+    return *cache;
+}
+
+void DatabaseConnection::clearStatementCache() {
+    statementCache().clear();
+}
+
+QSqlQuery& DatabaseConnection::preparedQuery(const QString& sql) {
+    QHash<QString, QSqlQuery>& cache = statementCache();
+    auto it = cache.find(sql);
+
+    if (it != cache.end()) {
+        QSqlQuery& query = it.value();
+        // 上次执行失败 (如连接中断) 的语句不再复用，重新 prepare
+        if (!query.lastError().isValid()) {
+            query.finish(); // 释放上一次的结果集，绑定值由调用方覆盖
+            return query;
+        }
+        cache.erase(it);
+    }
+
+    QSqlQuery query(getDatabase());
+    if (!query.prepare(sql)) {
+        qCritical() << "预编译语句失败:" << query.lastError().text() << "SQL:" << sql;
+    }
+    return cache.insert(sql, query).value();
+}
+
+QSqlDatabase DatabaseConnection::openThreadConnection(const QString& connectionName) {
+    if (!QSqlDatabase::contains(QStringLiteral("KG_CONN"))) {
+        qWarning() << "主连接尚未建立，无法创建后台连接:" << connectionName;
+        return QSqlDatabase();
+    }
+
+    // 按连接名克隆是线程安全的；传 *instance 会在后台线程读取主线程的连接对象
+    QSqlDatabase db = QSqlDatabase::cloneDatabase(QStringLiteral("KG_CONN"), connectionName);
+    if (!db.open()) {
+        qCritical() << "后台数据库连接失败:" << db.lastError().text();
+    } else if (!backend().initializeSession(db)) {
+        db.close();
+    }
+    return db;
+}
+
+void DatabaseConnection::removeThreadConnection(const QString& connectionName) {
+    {
+        QSqlDatabase db = QSqlDatabase::database(connectionName, false);
+        if (db.isOpen()) db.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+}
+
+QString DatabaseConnection::placeholderRows(int rows, int columns) {
+    QStringList holders;
+    for (int c = 0; c < columns; ++c) holders << "?";
+    QString row = "(" + holders.join(",") + ")";
+
+    QStringList all;
+    all.reserve(rows);
+    for (int r = 0; r < rows; ++r) all << row;
+    return all.join(",");
+}
+
+// --- 事务 ---
+
+bool DatabaseConnection::beginTransaction() {
+    if (s_inTransaction) {
+        qWarning() << "主连接已处于事务中，拒绝重复开启";
+        return false;
+    }
+    QSqlDatabase db = getDatabase();
+    if (!db.isOpen() || !db.transaction()) {
+        qCritical() << "开启事务失败:" << db.lastError().text();
+        return false;
+    }
+    s_inTransaction = true;
+    return true;
+}
+
+bool DatabaseConnection::commitTransaction() {
+    if (!s_inTransaction) return false;
+    s_inTransaction = false;
+
+    QSqlDatabase db = getDatabase();
+    if (!db.commit()) {
+        qCritical() << "提交事务失败:" << db.lastError().text();
+        db.rollback();
+        return false;
+    }
+    // 提交的写入已记入 change_log，内存存储下次读取前回放
+    MemoryGraphStore::markStale();
+    return true;
+}
+
+void DatabaseConnection::rollbackTransaction() {
+    if (!s_inTransaction) return;
+    s_inTransaction = false;
+    getDatabase().rollback();
+}
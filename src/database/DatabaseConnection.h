@@ -2,22 +2,26 @@
 #define DATABASECONNECTION_H
 
 #include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QHash>
 #include <QString>
 #include <memory>
+#include "StorageBackend.h"
 
 /**
  * @brief 数据库配置结构体
  */
 class DatabaseConfig {
 public:
+    StorageBackend::Kind backend;
     QString hostname;
     QString username;
     QString password;
-    QString database;
+    QString database;   // MySQL 为库名，SQLite 为库文件路径
     int port;
 
-    // 默认构造函数，设置默认MySQL端口
-    DatabaseConfig() : port(3306) {}
+    // 默认构造函数，默认使用 MySQL 及其默认端口
+    DatabaseConfig() : backend(StorageBackend::MySql), port(3306) {}
 };
 
 /**
@@ -48,12 +52,81 @@ public:
      */
     static bool isConnected();
 
+    /**
+     * @brief 当前存储后端，仓库据此生成各数据库写法不同的 SQL 片段
+     * 尚未连接时返回 MySQL 后端
+     */
+    static const StorageBackend& backend();
+
+    /**
+     * @brief 获取按 SQL 文本缓存的预编译语句
+     * 同一条 SQL 在当前连接上只 prepare 一次，之后只需重新绑定参数再 exec。
+     * 调用方每次都要为全部占位符重新绑定值；在用完结果之前不能再次获取同一条 SQL。
+     * 重连或上次执行出错后，语句会在下次获取时自动重新 prepare。
+     * @param sql 固定的 SQL 文本 (动态拼接的 IN 列表等不要走缓存)
+     */
+    static QSqlQuery& preparedQuery(const QString& sql);
+
+    /**
+     * @brief 丢弃所有缓存的预编译语句 (断开或重连前调用)
+     */
+    static void clearStatementCache();
+
+    /**
+     * @brief 为后台线程克隆一个独立连接 (Qt 的数据库连接不能跨线程使用)
+     * 必须在使用该连接的线程内调用，用完后在同一线程调用 removeThreadConnection
+     * @param connectionName 调用方保证唯一的连接名
+     */
+    static QSqlDatabase openThreadConnection(const QString& connectionName);
+    static void removeThreadConnection(const QString& connectionName);
+
+    /**
+     * @brief 生成多行 VALUES 的占位符，如 rows=2, columns=3 得到 "(?,?,?),(?,?,?)"
+     */
+    static QString placeholderRows(int rows, int columns);
+
+    /**
+     * @brief 主连接上的事务，并记录当前是否处于事务中
+     * MySQL 在事务中再次 BEGIN 会隐式提交前一个事务 (SQLite 则直接报错)，需要嵌套的场合先用 inTransaction() 判断
+     */
+    static bool beginTransaction();
+    static bool commitTransaction();
+    static void rollbackTransaction();
+    static bool inTransaction() { return s_inTransaction; }
+
 private:
+    // 语句缓存有意不随静态析构释放，避免在驱动卸载后析构 QSqlQuery
+    static QHash<QString, QSqlQuery>& statementCache();
+
     // 使用 std::unique_ptr 确保在程序退出时自动清理
     static std::unique_ptr<QSqlDatabase> instance;
+    static std::unique_ptr<StorageBackend> s_backend;
+    static bool s_inTransaction;
 
     // 禁止外部实例化
     DatabaseConnection() = default;
 };
 
+/**
+ * @brief 仓库写操作的局部事务：外层已有事务时并入外层，否则自己开启并负责提交
+ * 保证一次写入与它的变更日志要么都生效、要么都不生效；未 commit() 就析构则回滚
+ */
+class ScopedTransaction {
+public:
+    ScopedTransaction()
+        : m_owned(!DatabaseConnection::inTransaction() && DatabaseConnection::beginTransaction()) {}
+    ~ScopedTransaction() { if (m_owned) DatabaseConnection::rollbackTransaction(); }
+    ScopedTransaction(const ScopedTransaction&) = delete;
+    ScopedTransaction& operator=(const ScopedTransaction&) = delete;
+
+    bool commit() {
+        if (!m_owned) return true;
+        m_owned = false;
+        return DatabaseConnection::commitTransaction();
+    }
+
+private:
+    bool m_owned;
+};
+
 #endif // DATABASECONNECTION_H
\ No newline at end of file
@@ -0,0 +1,1212 @@
+#include "MemoryGraphStore.h"
+#include "DatabaseConnection.h"
+#include "ChangeLogCursor.h"
+#include "RelationshipRepository.h"
+#include "OntologyRepository.h"
+#include "../business/OntologySnapshot.h"
+#include "../model/TypeDictionary.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QCoreApplication>
+#include <QThread>
+#include <QPointer>
+#include <QAtomicInt>
+#include <QVector>
+#include <QSet>
+#include <QDebug>
+#include <functional>
+#include <memory>
+
+// 回放时每页读取的日志行数
+static const int kPageSize = 2000;
+// 回放累计这么多条日志后写一次快照
+static const int kCheckpointChanges = 20000;
+// 墓碑超过该数量且占一半以上时压缩
+static const int kCompactMinDead = 1024;
+// 索引的增量边与墓碑超过该数量且占四分之一以上时整体重建
+static const int kIndexRebuildMin = 1024;
+
+namespace {
+
+// 字符串池：类型、颜色等高度重复的字符串只存一份，下标 0 固定为空串
+class StringPool {
+public:
+    StringPool() { clear(); }
+
+    quint32 intern(const QString& text) {
+        auto it = m_ids.constFind(text);
+        if (it != m_ids.constEnd()) return it.value();
+
+        quint32 id = m_strings.size();
+        m_strings.append(text);
+        m_ids.insert(text, id);
+        return id;
+    }
+
+    const QString& at(quint32 id) const { return m_strings[id]; }
+    int size() const { return m_strings.size(); }
+
+    void clear() {
+        m_strings = {QString()};
+        m_ids.clear();
+        m_ids.insert(QString(), 0);
+    }
+
+private:
+    QVector<QString> m_strings;
+    QHash<QString, quint32> m_ids;
+};
+
+// 节点列，下标即槽位；名称与描述几乎不重复，不进字符串池
+// type 为字符串池下标 (保留原写法)，typeId 为本体类型字典中的ID (分组与过滤用)
+struct NodeColumns {
+    QVector<int> id;
+    QVector<quint32> type;
+    QVector<int> typeId;
+    QVector<quint32> color;
+    QVector<QString> name;
+    QVector<QString> description;
+    QVector<float> posX;
+    QVector<float> posY;
+    QVector<QByteArray> properties;
+    QVector<bool> alive;
+
+    int size() const { return id.size(); }
+
+    void appendFrom(const NodeColumns& from, int slot) {
+        id.append(from.id[slot]);
+        type.append(from.type[slot]);
+        typeId.append(from.typeId[slot]);
+        color.append(from.color[slot]);
+        name.append(from.name[slot]);
+        description.append(from.description[slot]);
+        posX.append(from.posX[slot]);
+        posY.append(from.posY[slot]);
+        properties.append(from.properties[slot]);
+        alive.append(true);
+    }
+};
+
+// 关系列，端点存节点槽位而不是 node_id
+struct EdgeColumns {
+    QVector<int> id;
+    QVector<int> source;
+    QVector<int> target;
+    QVector<quint32> type;
+    QVector<int> typeId;
+    QVector<float> weight;
+    QVector<QByteArray> properties;
+    QVector<bool> alive;
+
+    int size() const { return id.size(); }
+
+    void appendFrom(const EdgeColumns& from, int slot, int newSource, int newTarget) {
+        id.append(from.id[slot]);
+        source.append(newSource);
+        target.append(newTarget);
+        type.append(from.type[slot]);
+        typeId.append(from.typeId[slot]);
+        weight.append(from.weight[slot]);
+        properties.append(from.properties[slot]);
+        alive.append(true);
+    }
+};
+
+struct StoreState {
+    bool enabled = false;
+    int ontologyId = -1;
+    bool stale = false;
+    int bypass = 0;
+    ChangeLogCursor cursor;
+    qint64 snapshotSeq = -1;          // 最近一次写出或读入的快照对应的日志位置
+    int changesSinceCheckpoint = 0;
+
+    StringPool strings;
+    NodeColumns nodes;
+    EdgeColumns edges;
+    QHash<int, int> nodeSlot;         // node_id -> 槽位，只含存活节点
+    QHash<int, int> edgeSlot;         // relation_id -> 槽位
+    int deadNodes = 0;
+    int deadEdges = 0;
+
+    // 派生索引：建立后随增删改就地维护，只有装载、压缩或关系端点变化时置脏，首次读取时整体重建
+    bool indexDirty = true;
+    int indexedNodes = 0;             // CSR 覆盖的节点槽位数，之后新增的节点只有增量邻接
+    QVector<int> outOffsets;          // 槽位 s 的出边为 outEdges[outOffsets[s], outOffsets[s + 1])
+    QVector<int> outEdges;
+    QVector<int> inOffsets;
+    QVector<int> inEdges;
+    QHash<int, QVector<int>> outDelta;          // 节点槽位 -> 重建后新增的出边
+    QHash<int, QVector<int>> inDelta;           // 节点槽位 -> 重建后新增的入边
+    int indexChurn = 0;                         // 重建后累计的增量边与墓碑数
+    QHash<int, QVector<int>> nodesByType;       // 类型ID -> 节点槽位，已删除的节点读取时跳过
+    QHash<QString, int> nodeByName;             // NodeRepository::nameKey -> 节点槽位
+};
+
+StoreState& state() {
+    static StoreState s;
+    return s;
+}
+
+// 回放期间仓库读取直接查库
+struct Bypass {
+    Bypass() { ++state().bypass; }
+    ~Bypass() { --state().bypass; }
+};
+
+void clearData(StoreState& st) {
+    st.strings.clear();
+    st.nodes = NodeColumns();
+    st.edges = EdgeColumns();
+    st.nodeSlot.clear();
+    st.edgeSlot.clear();
+    st.deadNodes = 0;
+    st.deadEdges = 0;
+    st.indexDirty = true;
+    st.indexedNodes = 0;
+    st.outOffsets.clear();
+    st.outEdges.clear();
+    st.inOffsets.clear();
+    st.inEdges.clear();
+    st.outDelta.clear();
+    st.inDelta.clear();
+    st.indexChurn = 0;
+    st.nodesByType.clear();
+    st.nodeByName.clear();
+}
+
+void resetState() {
+    StoreState& st = state();
+    clearData(st);
+    st.ontologyId = -1;
+    st.stale = false;
+    st.cursor.reset();
+    st.snapshotSeq = -1;
+    st.changesSinceCheckpoint = 0;
+}
+
+// --- 写入 ---
+// 索引已建立时就地更新；置脏期间不维护，等首次读取整体重建
+
+// 名称索引中该槽位的旧名称，被同名的其他节点占用时不动
+void unindexName(StoreState& st, int slot) {
+    auto it = st.nodeByName.find(NodeRepository::nameKey(st.nodes.name[slot]));
+    if (it != st.nodeByName.end() && it.value() == slot) st.nodeByName.erase(it);
+}
+
+void putNode(StoreState& st, const GraphNode& node) {
+    NodeColumns& c = st.nodes;
+
+    quint32 type = st.strings.intern(node.nodeType);
+    int typeId = TypeDictionary::forOntology(st.ontologyId).intern(TypeDictionary::NodeTypes, node.nodeType);
+    int slot = st.nodeSlot.value(node.id, -1);
+    if (slot < 0) {
+        slot = c.size();
+        c.id.append(node.id);
+        c.type.append(type);
+        c.typeId.append(typeId);
+        c.color.append(0);
+        c.name.append(node.name);
+        c.description.append(QString());
+        c.posX.append(0.0f);
+        c.posY.append(0.0f);
+        c.properties.append(QByteArray());
+        c.alive.append(true);
+        st.nodeSlot.insert(node.id, slot);
+        if (!st.indexDirty) {
+            st.nodesByType[typeId].append(slot);
+            st.nodeByName.insert(NodeRepository::nameKey(node.name), slot);
+        }
+    } else if (c.type[slot] != type || c.name[slot] != node.name) {
+        if (!st.indexDirty) {
+            if (c.typeId[slot] != typeId) {
+                st.nodesByType[c.typeId[slot]].removeOne(slot);
+                st.nodesByType[typeId].append(slot);
+            }
+            unindexName(st, slot);
+            st.nodeByName.insert(NodeRepository::nameKey(node.name), slot);
+        }
+        c.type[slot] = type;
+        c.typeId[slot] = typeId;
+        c.name[slot] = node.name;
+    }
+
+    // 位置、颜色等只改列值，不影响索引
+    c.color[slot] = st.strings.intern(node.color);
+    c.description[slot] = node.description;
+    c.posX[slot] = node.posX;
+    c.posY[slot] = node.posY;
+    c.properties[slot] = node.properties.toBytes();
+}
+
+// 返回被删除节点的槽位，不在存储中时返回 -1
+int removeNode(StoreState& st, int nodeId) {
+    auto it = st.nodeSlot.find(nodeId);
+    if (it == st.nodeSlot.end()) return -1;
+
+    int slot = it.value();
+    st.nodeSlot.erase(it);
+    if (!st.indexDirty) {
+        unindexName(st, slot);
+        st.indexChurn++;
+    }
+    st.nodes.alive[slot] = false;
+    st.nodes.description[slot].clear();
+    st.nodes.properties[slot].clear();
+    st.deadNodes++;
+    return slot;
+}
+
+void removeEdge(StoreState& st, int relationId) {
+    auto it = st.edgeSlot.find(relationId);
+    if (it == st.edgeSlot.end()) return;
+
+    int slot = it.value();
+    st.edgeSlot.erase(it);
+    st.edges.alive[slot] = false;
+    st.edges.properties[slot].clear();
+    st.deadEdges++;
+    if (!st.indexDirty) st.indexChurn++;
+}
+
+void putEdge(StoreState& st, const GraphEdge& edge) {
+    EdgeColumns& c = st.edges;
+
+    int source = st.nodeSlot.value(edge.sourceId, -1);
+    int target = st.nodeSlot.value(edge.targetId, -1);
+    if (source < 0 || target < 0) {
+        // 外键保证端点存在，这里只防御回放顺序异常
+        qWarning() << "MemoryGraphStore: 关系" << edge.id << "的端点不在存储中，已忽略";
+        removeEdge(st, edge.id);
+        return;
+    }
+
+    quint32 type = st.strings.intern(edge.relationType);
+    int typeId = TypeDictionary::forOntology(st.ontologyId).intern(TypeDictionary::RelationTypes, edge.relationType);
+    int slot = st.edgeSlot.value(edge.id, -1);
+    if (slot < 0) {
+        slot = c.size();
+        c.id.append(edge.id);
+        c.source.append(source);
+        c.target.append(target);
+        c.type.append(type);
+        c.typeId.append(typeId);
+        c.weight.append(0.0f);
+        c.properties.append(QByteArray());
+        c.alive.append(true);
+        st.edgeSlot.insert(edge.id, slot);
+        if (!st.indexDirty) {
+            st.outDelta[source].append(slot);
+            st.inDelta[target].append(slot);
+            st.indexChurn++;
+        }
+    } else if (c.source[slot] != source || c.target[slot] != target || c.type[slot] != type) {
+        // 改类型只改列值；改端点极少见，直接整体重建邻接
+        if (c.source[slot] != source || c.target[slot] != target) st.indexDirty = true;
+        c.source[slot] = source;
+        c.target[slot] = target;
+        c.type[slot] = type;
+        c.typeId[slot] = typeId;
+    }
+
+    c.weight[slot] = edge.weight;
+    c.properties[slot] = edge.properties.toBytes();
+}
+
+// 墓碑过多时重排列，节点槽位变化后关系端点一并重映射
+void compactIfNeeded(StoreState& st) {
+    bool compactNodes = st.deadNodes >= kCompactMinDead && st.deadNodes * 2 > st.nodes.size();
+    bool compactEdges = st.deadEdges >= kCompactMinDead && st.deadEdges * 2 > st.edges.size();
+    if (!compactNodes && !compactEdges) return;
+
+    NodeColumns nodes;
+    QVector<int> remap(st.nodes.size(), -1);
+    for (int s = 0; s < st.nodes.size(); ++s) {
+        if (!st.nodes.alive[s]) continue;
+        remap[s] = nodes.size();
+        nodes.appendFrom(st.nodes, s);
+    }
+
+    EdgeColumns edges;
+    for (int k = 0; k < st.edges.size(); ++k) {
+        if (!st.edges.alive[k]) continue;
+        edges.appendFrom(st.edges, k, remap[st.edges.source[k]], remap[st.edges.target[k]]);
+    }
+
+    st.nodes = nodes;
+    st.edges = edges;
+    st.nodeSlot.clear();
+    st.edgeSlot.clear();
+    for (int s = 0; s < st.nodes.size(); ++s) st.nodeSlot.insert(st.nodes.id[s], s);
+    for (int k = 0; k < st.edges.size(); ++k) st.edgeSlot.insert(st.edges.id[k], k);
+    st.deadNodes = 0;
+    st.deadEdges = 0;
+    st.indexDirty = true;
+}
+
+// --- 派生索引 ---
+
+void ensureIndexes(StoreState& st) {
+    // 增量与墓碑累计过多时整体重建一次，把增量并回 CSR
+    if (!st.indexDirty && st.indexChurn >= kIndexRebuildMin
+        && st.indexChurn * 4 > st.nodeSlot.size() + st.edgeSlot.size()) {
+        st.indexDirty = true;
+    }
+    if (!st.indexDirty) return;
+
+    // 1. 出边/入边 CSR：先计数再前缀和，最后按槽位回填
+    const EdgeColumns& e = st.edges;
+    int nodeCount = st.nodes.size();
+    st.outOffsets.fill(0, nodeCount + 1);
+    st.inOffsets.fill(0, nodeCount + 1);
+    for (int k = 0; k < e.size(); ++k) {
+        if (!e.alive[k]) continue;
+        st.outOffsets[e.source[k] + 1]++;
+        st.inOffsets[e.target[k] + 1]++;
+    }
+    for (int s = 0; s < nodeCount; ++s) {
+        st.outOffsets[s + 1] += st.outOffsets[s];
+        st.inOffsets[s + 1] += st.inOffsets[s];
+    }
+
+    st.outEdges.resize(st.outOffsets[nodeCount]);
+    st.inEdges.resize(st.inOffsets[nodeCount]);
+    QVector<int> outFill = st.outOffsets;
+    QVector<int> inFill = st.inOffsets;
+    for (int k = 0; k < e.size(); ++k) {
+        if (!e.alive[k]) continue;
+        st.outEdges[outFill[e.source[k]]++] = k;
+        st.inEdges[inFill[e.target[k]]++] = k;
+    }
+
+    // 2. 按类型的节点列表与名称索引
+    const NodeColumns& n = st.nodes;
+    st.nodesByType.clear();
+    st.nodeByName.clear();
+    st.nodeByName.reserve(st.nodeSlot.size());
+    for (int s = 0; s < nodeCount; ++s) {
+        if (!n.alive[s]) continue;
+        st.nodesByType[n.typeId[s]].append(s);
+        st.nodeByName.insert(NodeRepository::nameKey(n.name[s]), s);
+    }
+
+    st.outDelta.clear();
+    st.inDelta.clear();
+    st.indexedNodes = nodeCount;
+    st.indexChurn = 0;
+    st.indexDirty = false;
+}
+
+// 槽位的出边 (outgoing) 或入边：CSR 部分加上重建后的增量，已删除的关系跳过；调用前须 ensureIndexes(st)
+template <typename Visit>
+void forEachEdgeOf(const StoreState& st, int slot, bool outgoing, Visit visit) {
+    const QVector<int>& offsets = outgoing ? st.outOffsets : st.inOffsets;
+    const QVector<int>& edges = outgoing ? st.outEdges : st.inEdges;
+    if (slot < st.indexedNodes) {
+        for (int i = offsets[slot]; i < offsets[slot + 1]; ++i) {
+            if (st.edges.alive[edges[i]]) visit(edges[i]);
+        }
+    }
+
+    const QHash<int, QVector<int>>& delta = outgoing ? st.outDelta : st.inDelta;
+    auto it = delta.constFind(slot);
+    if (it == delta.constEnd()) return;
+    for (int k : it.value()) {
+        if (st.edges.alive[k]) visit(k);
+    }
+}
+
+// 删除节点后沿邻接清掉悬空的关系 (数据库由外键级联删除，日志里通常也有对应记录)
+void sweepDanglingEdges(StoreState& st, const QVector<int>& deadSlots) {
+    ensureIndexes(st);
+    auto drop = [&st](int k) { removeEdge(st, st.edges.id[k]); };
+    for (int slot : deadSlots) {
+        forEachEdgeOf(st, slot, true, drop);
+        forEachEdgeOf(st, slot, false, drop);
+    }
+}
+
+// 日志只说明哪些实体变了，状态以数据库当前行为准：取回的行写入，其余ID删除
+void applyChanges(StoreState& st, QSet<int> nodeIds, QSet<int> edgeIds,
+                  const QList<GraphNode>& nodes, const QList<GraphEdge>& edges) {
+    for (const auto& node : nodes) {
+        putNode(st, node);
+        nodeIds.remove(node.id);
+    }
+    QVector<int> deadSlots;
+    for (int id : nodeIds) {
+        int slot = removeNode(st, id);
+        if (slot >= 0) deadSlots.append(slot);
+    }
+    if (!deadSlots.isEmpty()) sweepDanglingEdges(st, deadSlots);
+
+    for (const auto& edge : edges) {
+        putEdge(st, edge);
+        edgeIds.remove(edge.id);
+    }
+    for (int id : edgeIds) removeEdge(st, id);
+}
+
+// --- 读出 ---
+
+GraphNode nodeAt(int slot, Projection projection) {
+    const StoreState& st = state();
+    const NodeColumns& c = st.nodes;
+
+    GraphNode node;
+    node.id = c.id[slot];
+    node.ontologyId = st.ontologyId;
+    node.nodeType = st.strings.at(c.type[slot]);
+    node.typeId = c.typeId[slot];
+    node.name = c.name[slot];
+    node.posX = c.posX[slot];
+    node.posY = c.posY[slot];
+    node.color = st.strings.at(c.color[slot]);
+    if (projection == Projection::Topology) return node;
+
+    node.description = c.description[slot];
+    node.properties = JsonProperties::fromRaw(c.properties[slot]);
+    return node;
+}
+
+GraphEdge edgeAt(int slot, Projection projection) {
+    const StoreState& st = state();
+    const EdgeColumns& c = st.edges;
+
+    GraphEdge edge;
+    edge.id = c.id[slot];
+    edge.ontologyId = st.ontologyId;
+    edge.sourceId = st.nodes.id[c.source[slot]];
+    edge.targetId = st.nodes.id[c.target[slot]];
+    edge.relationType = st.strings.at(c.type[slot]);
+    edge.typeId = c.typeId[slot];
+    edge.weight = c.weight[slot];
+    if (projection == Projection::Topology) return edge;
+
+    edge.properties = JsonProperties::fromRaw(c.properties[slot]);
+    return edge;
+}
+
+QList<GraphNode> allNodes(Projection projection) {
+    const StoreState& st = state();
+    QList<GraphNode> nodes;
+    nodes.reserve(st.nodeSlot.size());
+    for (int s = 0; s < st.nodes.size(); ++s) {
+        if (st.nodes.alive[s]) nodes.append(nodeAt(s, projection));
+    }
+    return nodes;
+}
+
+QList<GraphEdge> allEdges(Projection projection) {
+    const StoreState& st = state();
+    QList<GraphEdge> edges;
+    edges.reserve(st.edgeSlot.size());
+    for (int k = 0; k < st.edges.size(); ++k) {
+        if (st.edges.alive[k]) edges.append(edgeAt(k, projection));
+    }
+    return edges;
+}
+
+// --- 快照文件 ---
+
+// 按数据库区分目录，同一台机器连接不同库时快照互不干扰
+QString snapshotDirectory() {
+    QSqlDatabase db = DatabaseConnection::getDatabase();
+    QByteArray identity = QString("%1|%2|%3|%4")
+                              .arg(db.driverName(), db.hostName())
+                              .arg(db.port())
+                              .arg(db.databaseName())
+                              .toUtf8();
+    QString key = QString::fromLatin1(QCryptographicHash::hash(identity, QCryptographicHash::Sha1).toHex().left(16));
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+         + "/KnowledgeGraphSystem/store/" + key;
+}
+
+QString snapshotPrefix(int ontologyId) {
+    return QString("ontology_%1_").arg(ontologyId);
+}
+
+// 快照文件名为 ontology_<本体ID>_<日志位置>.kgsnap，取位置最大的一份
+bool findSnapshot(const QString& dirPath, int ontologyId, QString& fileName, qint64& seq) {
+    QDir dir(dirPath);
+    QString prefix = snapshotPrefix(ontologyId);
+    static const int kSuffixLength = 7; // ".kgsnap"
+
+    bool found = false;
+    for (const QString& name : dir.entryList({prefix + "*.kgsnap"}, QDir::Files)) {
+        bool ok = false;
+        qint64 value = name.mid(prefix.size(), name.size() - prefix.size() - kSuffixLength).toLongLong(&ok);
+        if (ok && (!found || value > seq)) {
+            fileName = dir.filePath(name);
+            seq = value;
+            found = true;
+        }
+    }
+    return found;
+}
+
+bool readSnapshot(StoreState& st, const QString& fileName) {
+    SnapshotReader reader;
+    QString error;
+    if (!reader.open(fileName, &error)) {
+        qWarning() << "MemoryGraphStore: 快照无法读取:" << error;
+        return false;
+    }
+
+    for (quint32 i = 0; i < reader.nodeCount(); ++i) putNode(st, reader.node(i));
+    for (quint32 k = 0; k < reader.edgeCount(); ++k) putEdge(st, reader.edge(k));
+    return true;
+}
+
+// 与 MySQL CRC32() 相同的 CRC-32 (ISO 3309，反射多项式 0xEDB88320)
+quint32 crc32(const QByteArray& data) {
+    static const QVector<quint32> table = [] {
+        QVector<quint32> t(256);
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 c = i;
+            for (int bit = 0; bit < 8; ++bit) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[int(i)] = c;
+        }
+        return t;
+    }();
+
+    quint32 crc = 0xFFFFFFFFu;
+    for (char ch : data) crc = table[int((crc ^ quint8(ch)) & 0xFF)] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
+
+// 参与校验和的列：浮点坐标、权重与 JSON 在库里和内存里的文本形式不一致，不参与
+const char* const kNodeChecksumColumns =
+    "node_id, COALESCE(name, ''), COALESCE(node_type, ''), COALESCE(description, ''), COALESCE(color, '')";
+const char* const kEdgeChecksumColumns = "relation_id, source_id, target_id, COALESCE(relation_type, '')";
+
+// 按与 StorageBackend::rowChecksum 相同的规则计算内存内容的校验和
+quint64 nodeChecksum(const StoreState& st) {
+    const NodeColumns& c = st.nodes;
+    quint64 sum = 0;
+    for (int s = 0; s < c.size(); ++s) {
+        if (!c.alive[s]) continue;
+        QStringList row{QString::number(c.id[s]), c.name[s], st.strings.at(c.type[s]),
+                        c.description[s], st.strings.at(c.color[s])};
+        sum ^= crc32(row.join('|').toUtf8());
+    }
+    return sum;
+}
+
+quint64 edgeChecksum(const StoreState& st) {
+    const EdgeColumns& c = st.edges;
+    quint64 sum = 0;
+    for (int k = 0; k < c.size(); ++k) {
+        if (!c.alive[k]) continue;
+        QStringList row{QString::number(c.id[k]), QString::number(st.nodes.id[c.source[k]]),
+                        QString::number(st.nodes.id[c.target[k]]), st.strings.at(c.type[k])};
+        sum ^= crc32(row.join('|').toUtf8());
+    }
+    return sum;
+}
+
+// 装载后与数据库核对行数和内容校验和：快照只有在其后的改动都记入日志时才能回放补齐，
+// 日志被清理、有绕过仓库的写入或库被恢复时在这里发现；读库失败时同样不能使用存储
+bool matchesDatabase(QSqlDatabase& db, int ontologyId, const StoreState& st) {
+    const StorageBackend& backend = DatabaseConnection::backend();
+    QString nodeSum = backend.rowChecksum(QString::fromLatin1(kNodeChecksumColumns));
+    QString edgeSum = backend.rowChecksum(QString::fromLatin1(kEdgeChecksumColumns));
+    bool withChecksum = !nodeSum.isEmpty() && !edgeSum.isEmpty();
+
+    QString sql = "SELECT (SELECT COUNT(*) FROM node WHERE ontology_id = ?), "
+                  "(SELECT COUNT(*) FROM relationship WHERE ontology_id = ?)";
+    if (withChecksum) {
+        sql += QString(", (SELECT %1 FROM node WHERE ontology_id = ?), "
+                       "(SELECT %2 FROM relationship WHERE ontology_id = ?)").arg(nodeSum, edgeSum);
+    }
+
+    QSqlQuery query(db);
+    query.prepare(sql);
+    for (int i = 0; i < (withChecksum ? 4 : 2); ++i) query.addBindValue(ontologyId);
+    if (!query.exec() || !query.next()) {
+        qCritical() << "MemoryGraphStore: 核对数据库失败:" << query.lastError().text();
+        return false;
+    }
+
+    if (query.value(0).toInt() != st.nodeSlot.size() || query.value(1).toInt() != st.edgeSlot.size()) return false;
+    if (!withChecksum) return true;
+    return query.value(2).toULongLong() == nodeChecksum(st) && query.value(3).toULongLong() == edgeChecksum(st);
+}
+
+// --- 后台装载 ---
+// 工作线程在独立连接的一个读事务里完成读快照、回放其后的日志、全量读库与核对，
+// 都取自同一个一致性视图；主线程只在完成后整体换入，再回放装载期间的新日志
+
+// 一次装载任务，工作线程填写 built，主线程安装
+struct LoadJob {
+    int ontologyId = -1;
+    QString snapshotDir;              // 快照目录依赖主连接的参数，由主线程事先算好
+    QString connectionName;
+    QAtomicInt cancelled;
+    QElapsedTimer timer;
+
+    StoreState built;
+    qint64 position = -1;             // built 对应的日志位置，安装后从这里回放
+    bool fromSnapshot = false;
+    bool ok = false;
+};
+
+struct Loader {
+    std::shared_ptr<LoadJob> job;     // 进行中的装载，被卸载或新的装载取代时结果作废
+    QPointer<QThread> thread;
+    int serial = 0;
+};
+
+Loader& loader() {
+    static Loader l;
+    return l;
+}
+
+// 按条件读取节点行 (完整投影，列与 NodeRepository 一致)，逐行交给 visit；取消时返回 false
+bool forEachNodeRow(QSqlDatabase& db, const QString& where, const QVariantList& binds, LoadJob& job,
+                    const std::function<void(const GraphNode&)>& visit) {
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare("SELECT node_id, node_type, name, description, pos_x, pos_y, color, properties FROM node WHERE " + where);
+    for (const QVariant& value : binds) query.addBindValue(value);
+    if (!query.exec()) {
+        qCritical() << "MemoryGraphStore: 后台读取节点失败:" << query.lastError().text();
+        return false;
+    }
+
+    while (query.next()) {
+        if (job.cancelled.loadAcquire()) return false;
+        GraphNode node;
+        node.id = query.value(0).toInt();
+        node.ontologyId = job.ontologyId;
+        node.nodeType = query.value(1).toString();
+        node.name = query.value(2).toString();
+        node.description = query.value(3).toString();
+        node.posX = query.value(4).toFloat();
+        node.posY = query.value(5).toFloat();
+        node.color = query.value(6).toString();
+        node.properties = JsonProperties::fromRaw(query.value(7).toByteArray());
+        visit(node);
+    }
+    return true;
+}
+
+bool forEachEdgeRow(QSqlDatabase& db, const QString& where, const QVariantList& binds, LoadJob& job,
+                    const std::function<void(const GraphEdge&)>& visit) {
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare("SELECT relation_id, source_id, target_id, relation_type, weight, properties FROM relationship WHERE " + where);
+    for (const QVariant& value : binds) query.addBindValue(value);
+    if (!query.exec()) {
+        qCritical() << "MemoryGraphStore: 后台读取关系失败:" << query.lastError().text();
+        return false;
+    }
+
+    while (query.next()) {
+        if (job.cancelled.loadAcquire()) return false;
+        GraphEdge edge;
+        edge.id = query.value(0).toInt();
+        edge.ontologyId = job.ontologyId;
+        edge.sourceId = query.value(1).toInt();
+        edge.targetId = query.value(2).toInt();
+        edge.relationType = query.value(3).toString();
+        edge.weight = query.value(4).toFloat();
+        edge.properties = JsonProperties::fromRaw(query.value(5).toByteArray());
+        visit(edge);
+    }
+    return true;
+}
+
+// 按 IN 列表分批取回实体当前行，每批 kPageSize 个
+template <typename Row>
+bool fetchByIds(QSqlDatabase& db, const QString& idColumn, const QList<int>& ids, LoadJob& job, QList<Row>& rows,
+                bool (*forEachRow)(QSqlDatabase&, const QString&, const QVariantList&, LoadJob&,
+                                   const std::function<void(const Row&)>&)) {
+    for (int start = 0; start < ids.size(); start += kPageSize) {
+        int count = qMin(kPageSize, ids.size() - start);
+        QStringList holders;
+        QVariantList binds;
+        for (int i = start; i < start + count; ++i) {
+            holders << "?";
+            binds << ids[i];
+        }
+        QString where = QString("%1 IN (%2)").arg(idColumn, holders.join(","));
+        if (!forEachRow(db, where, binds, job, [&rows](const Row& row) { rows.append(row); })) return false;
+    }
+    return true;
+}
+
+// 把快照位置之后、视图内最新位置之前的日志应用到 built
+bool replayLog(QSqlDatabase& db, LoadJob& job, qint64 afterSeq, qint64 upToSeq) {
+    QSqlQuery log(db);
+    log.setForwardOnly(true);
+    log.prepare("SELECT entity_type, entity_id FROM change_log WHERE ontology_id = ? AND seq > ? AND seq <= ?");
+    log.addBindValue(job.ontologyId);
+    log.addBindValue(afterSeq);
+    log.addBindValue(upToSeq);
+    if (!log.exec()) {
+        qCritical() << "MemoryGraphStore: 后台读取变更日志失败:" << log.lastError().text();
+        return false;
+    }
+
+    QSet<int> nodeIds;
+    QSet<int> edgeIds;
+    while (log.next()) {
+        if (log.value(0).toInt() == ChangeLogRepository::NodeEntity) nodeIds.insert(log.value(1).toInt());
+        else edgeIds.insert(log.value(1).toInt());
+    }
+
+    QList<GraphNode> nodes;
+    QList<GraphEdge> edges;
+    if (!fetchByIds<GraphNode>(db, "node_id", nodeIds.values(), job, nodes, forEachNodeRow)
+        || !fetchByIds<GraphEdge>(db, "relation_id", edgeIds.values(), job, edges, forEachEdgeRow)) {
+        return false;
+    }
+    applyChanges(job.built, nodeIds, edgeIds, nodes, edges);
+    return true;
+}
+
+bool buildStore(QSqlDatabase& db, LoadJob& job) {
+    StoreState& st = job.built;
+    st.ontologyId = job.ontologyId;
+
+    // 1. 本体的日志范围；没有变更日志就无法保持同步，仓库继续直接查库
+    //    序号全表共用，库被重建 (序号从头开始) 要与全表最大序号比较
+    QSqlQuery range(db);
+    range.prepare("SELECT COALESCE(MIN(seq), 0), COALESCE(MAX(seq), 0), "
+                  "(SELECT COALESCE(MAX(seq), 0) FROM change_log) FROM change_log WHERE ontology_id = ?");
+    range.addBindValue(job.ontologyId);
+    if (!range.exec() || !range.next()) {
+        qCritical() << "MemoryGraphStore: 读取日志范围失败:" << range.lastError().text();
+        return false;
+    }
+    qint64 oldest = range.value(0).toLongLong();
+    qint64 latest = range.value(1).toLongLong();
+    qint64 tableLatest = range.value(2).toLongLong();
+
+    // 2. 优先读入快照，回放其后的日志再与数据库核对
+    //    快照之后的日志必须完整：最早的日志已晚于快照 (日志被清理) 时无法补齐
+    QString fileName;
+    qint64 seq = 0;
+    if (findSnapshot(job.snapshotDir, job.ontologyId, fileName, seq)) {
+        if (seq > tableLatest || oldest > seq + 1) {
+            qWarning() << "MemoryGraphStore: 快照之后的变更日志不完整，改为全量读取:" << fileName;
+            QFile::remove(fileName);
+        } else if (readSnapshot(st, fileName) && replayLog(db, job, seq, latest)
+                   && matchesDatabase(db, job.ontologyId, st)) {
+            st.snapshotSeq = seq;
+            job.position = qMax(seq, latest);
+            job.fromSnapshot = true;
+            return true;
+        } else if (!job.cancelled.loadAcquire()) {
+            qWarning() << "MemoryGraphStore: 快照与数据库不一致，改为全量读取:" << fileName;
+            QFile::remove(fileName);
+        }
+        clearData(st);
+    }
+
+    // 3. 全量读库
+    QVariantList binds{job.ontologyId};
+    if (!forEachNodeRow(db, "ontology_id = ?", binds, job, [&st](const GraphNode& node) { putNode(st, node); })
+        || !forEachEdgeRow(db, "ontology_id = ?", binds, job, [&st](const GraphEdge& edge) { putEdge(st, edge); })) {
+        return false;
+    }
+    if (!matchesDatabase(db, job.ontologyId, st)) return false;
+    job.position = latest;
+    return true;
+}
+
+void runLoadJob(LoadJob& job) {
+    {
+        QSqlDatabase db = DatabaseConnection::openThreadConnection(job.connectionName);
+        if (db.isOpen() && db.transaction()) {
+            job.ok = buildStore(db, job);
+            db.rollback(); // 只读事务，结束一致性视图
+        }
+    }
+    DatabaseConnection::removeThreadConnection(job.connectionName);
+}
+
+// 放弃进行中的装载：通知工作线程尽快结束并等它退出，结果不再安装
+void cancelLoad() {
+    Loader& l = loader();
+    if (!l.job) return;
+    l.job->cancelled.storeRelease(1);
+    if (l.thread) l.thread->wait();
+    l.job.reset();
+    l.thread = nullptr;
+}
+
+// 把工作线程建好的列与索引整体换入
+void adoptData(StoreState& st, StoreState& built) {
+    std::swap(st.strings, built.strings);
+    std::swap(st.nodes, built.nodes);
+    std::swap(st.edges, built.edges);
+    std::swap(st.nodeSlot, built.nodeSlot);
+    std::swap(st.edgeSlot, built.edgeSlot);
+    std::swap(st.deadNodes, built.deadNodes);
+    std::swap(st.deadEdges, built.deadEdges);
+    std::swap(st.indexDirty, built.indexDirty);
+    std::swap(st.indexedNodes, built.indexedNodes);
+    std::swap(st.outOffsets, built.outOffsets);
+    std::swap(st.outEdges, built.outEdges);
+    std::swap(st.inOffsets, built.inOffsets);
+    std::swap(st.inEdges, built.inEdges);
+    std::swap(st.outDelta, built.outDelta);
+    std::swap(st.inDelta, built.inDelta);
+    std::swap(st.indexChurn, built.indexChurn);
+    std::swap(st.nodesByType, built.nodesByType);
+    std::swap(st.nodeByName, built.nodeByName);
+}
+
+} // namespace
+
+// --- 装载与持久化 ---
+
+void MemoryGraphStore::setEnabled(bool enabled) {
+    state().enabled = enabled;
+    if (!enabled) unload();
+}
+
+bool MemoryGraphStore::isEnabled() {
+    return state().enabled;
+}
+
+void MemoryGraphStore::load(int ontologyId) {
+    StoreState& st = state();
+    if (!st.enabled || ontologyId <= 0 || MemoryGraphStore::ontologyId() == ontologyId) return;
+    unload();
+
+    Loader& l = loader();
+    auto job = std::make_shared<LoadJob>();
+    job->ontologyId = ontologyId;
+    job->snapshotDir = snapshotDirectory();
+    job->connectionName = QString("KG_STORE_%1").arg(++l.serial);
+    job->timer.start();
+
+    QThread* thread = QThread::create([job]() { runLoadJob(*job); });
+    // 回到主线程安装；期间已被卸载或被新的装载取代时丢弃结果
+    QObject::connect(thread, &QThread::finished, qApp, [job]() {
+        Loader& l = loader();
+        if (l.job != job) return;
+        l.job.reset();
+        l.thread = nullptr;
+
+        if (!job->ok) {
+            qWarning() << "MemoryGraphStore: 装载本体" << job->ontologyId << "失败，继续直接查库";
+            return;
+        }
+
+        // 装载期间提交的修改都在日志里，回放之后才开始应答
+        StoreState& st = state();
+        resetState();
+        adoptData(st, job->built);
+        st.ontologyId = job->ontologyId;
+        st.snapshotSeq = job->built.snapshotSeq;
+        st.cursor.startAt(job->ontologyId, job->position);
+        if (!catchUp()) {
+            qWarning() << "MemoryGraphStore: 装载本体" << job->ontologyId << "后回放日志失败，继续直接查库";
+            resetState();
+            return;
+        }
+
+        qInfo() << "MemoryGraphStore: 已装载本体" << job->ontologyId << (job->fromSnapshot ? "(快照)" : "(全量读库)")
+                << st.nodeSlot.size() << "个节点," << st.edgeSlot.size() << "条关系, 耗时" << job->timer.elapsed() << "ms";
+    });
+    QObject::connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+    l.job = job;
+    l.thread = thread;
+    thread->start();
+}
+
+void MemoryGraphStore::unload() {
+    cancelLoad();
+    StoreState& st = state();
+    if (st.ontologyId <= 0) return;
+
+    // 先回放已提交的修改，快照才能对应到最新位置
+    if (st.stale) catchUp();
+    if (st.snapshotSeq != st.cursor.safePosition()) checkpoint();
+    resetState();
+}
+
+bool MemoryGraphStore::isLoaded() {
+    return state().ontologyId > 0;
+}
+
+int MemoryGraphStore::ontologyId() {
+    const Loader& l = loader();
+    return l.job ? l.job->ontologyId : state().ontologyId;
+}
+
+bool MemoryGraphStore::checkpoint() {
+    StoreState& st = state();
+    if (st.ontologyId <= 0) return false;
+
+    // 回放过的日志都已反映在内存里，快照位置取最早空洞之前，重新打开时空洞内的日志会再回放一次
+    qint64 seq = st.cursor.safePosition();
+    QString dirPath = snapshotDirectory();
+    QDir().mkpath(dirPath);
+    QString fileName = QString("%1/%2%3.kgsnap").arg(dirPath, snapshotPrefix(st.ontologyId)).arg(seq);
+
+    Ontology ontology = OntologyRepository::getOntologyById(st.ontologyId);
+    QString error;
+    if (!SnapshotWriter::write(fileName, ontology, allNodes(Projection::Full), allEdges(Projection::Full), &error)) {
+        qWarning() << "MemoryGraphStore: 写快照失败:" << error;
+        return false;
+    }
+
+    // 新快照落盘后再删旧的，中途退出时至少留下一份可用的
+    QDir dir(dirPath);
+    for (const QString& name : dir.entryList({snapshotPrefix(st.ontologyId) + "*.kgsnap"}, QDir::Files)) {
+        if (dir.filePath(name) != fileName) dir.remove(name);
+    }
+
+    st.snapshotSeq = seq;
+    st.changesSinceCheckpoint = 0;
+    return true;
+}
+
+void MemoryGraphStore::markStale() {
+    StoreState& st = state();
+    if (st.ontologyId > 0) st.stale = true;
+}
+
+bool MemoryGraphStore::ensureCurrent() {
+    StoreState& st = state();
+    // 事务中读取要看到本事务未提交的写入，只能查库
+    if (st.ontologyId <= 0 || st.bypass > 0 || DatabaseConnection::inTransaction()) return false;
+    if (st.stale && !catchUp()) return false;
+    return true;
+}
+
+bool MemoryGraphStore::catchUp() {
+    StoreState& st = state();
+    Bypass bypass;
+
+    // 1. 读完所有新日志再一起应用，避免关系先于其端点节点出现
+    QSet<int> nodeIds;
+    QSet<int> edgeIds;
+    int entryCount = 0;
+    bool hasMore = true;
+    while (hasMore) {
+        QList<ChangeLogEntry> entries;
+        if (!st.cursor.fetch(kPageSize, entries, &hasMore)) return false;
+        for (const auto& entry : entries) {
+            if (entry.entityType == ChangeLogRepository::NodeEntity) nodeIds.insert(entry.entityId);
+            else edgeIds.insert(entry.entityId);
+        }
+        entryCount += entries.size();
+    }
+
+    // 2. 取回这些实体的当前行再应用
+    QList<GraphNode> nodes;
+    QList<GraphEdge> edges;
+    if (!nodeIds.isEmpty()) nodes = NodeRepository::getNodesByIds(nodeIds.values(), Projection::Full);
+    if (!edgeIds.isEmpty()) edges = RelationshipRepository::getRelationshipsByIds(edgeIds.values(), Projection::Full);
+    applyChanges(st, nodeIds, edgeIds, nodes, edges);
+
+    compactIfNeeded(st);
+    st.stale = false;
+
+    // 3. 定期写快照，缩短下次打开时需要回放的日志
+    st.changesSinceCheckpoint += entryCount;
+    if (st.changesSinceCheckpoint >= kCheckpointChanges) checkpoint();
+    return true;
+}
+
+// --- 仓库读取 ---
+
+bool MemoryGraphStore::serves(int ontologyId) {
+    return ontologyId > 0 && state().ontologyId == ontologyId && ensureCurrent();
+}
+
+bool MemoryGraphStore::findNode(int nodeId, GraphNode& node) {
+    if (!ensureCurrent()) return false;
+    int slot = state().nodeSlot.value(nodeId, -1);
+    if (slot < 0) return false;
+    node = nodeAt(slot, Projection::Full);
+    return true;
+}
+
+QList<GraphNode> MemoryGraphStore::takeNodes(QList<int>& nodeIds, Projection projection) {
+    QList<GraphNode> found;
+    if (!ensureCurrent()) return found;
+
+    const StoreState& st = state();
+    QList<int> missing;
+    QSet<int> seen;
+    for (int id : nodeIds) {
+        if (seen.contains(id)) continue;
+        seen.insert(id);
+
+        int slot = st.nodeSlot.value(id, -1);
+        if (slot < 0) missing.append(id);
+        else found.append(nodeAt(slot, projection));
+    }
+    nodeIds = missing;
+    return found;
+}
+
+QList<GraphNode> MemoryGraphStore::nodes(Projection projection) {
+    return allNodes(projection);
+}
+
+QList<GraphNode> MemoryGraphStore::nodesByType(const QString& type, Projection projection) {
+    QList<GraphNode> nodes;
+    int typeId = TypeDictionary::forOntology(state().ontologyId).find(TypeDictionary::NodeTypes, type);
+    if (typeId < 0) return nodes;
+
+    ensureIndexes(state());
+    const StoreState& st = state();
+    for (int slot : st.nodesByType.value(typeId)) {
+        if (st.nodes.alive[slot]) nodes.append(nodeAt(slot, projection));
+    }
+    return nodes;
+}
+
+QList<GraphNode> MemoryGraphStore::searchNodes(const QString& column, const QString& value,
+                                               NodeRepository::MatchMode mode) {
+    const StoreState& st = state();
+    const NodeColumns& c = st.nodes;
+    enum { NameColumn, TypeColumn, DescriptionColumn } which =
+        column == "type" ? TypeColumn : (column == "description" ? DescriptionColumn : NameColumn);
+
+    QList<GraphNode> nodes;
+    for (int s = 0; s < c.size(); ++s) {
+        if (!c.alive[s]) continue;
+
+        const QString& text = (which == NameColumn) ? c.name[s]
+                            : (which == TypeColumn) ? st.strings.at(c.type[s]) : c.description[s];
+        bool matched = false;
+        switch (mode) {
+        case NodeRepository::MatchExact:    matched = text.compare(value, Qt::CaseInsensitive) == 0; break;
+        case NodeRepository::MatchPrefix:   matched = text.startsWith(value, Qt::CaseInsensitive); break;
+        case NodeRepository::MatchContains: matched = text.contains(value, Qt::CaseInsensitive); break;
+        }
+        if (matched) nodes.append(nodeAt(s, Projection::Full));
+    }
+    return nodes;
+}
+
+void MemoryGraphStore::nodeIdsByNames(const QStringList& names, QHash<QString, int>& idByName) {
+    ensureIndexes(state());
+    const StoreState& st = state();
+    for (const QString& name : names) {
+        QString key = NodeRepository::nameKey(name);
+        int slot = st.nodeByName.value(key, -1);
+        if (slot >= 0) idByName.insert(key, st.nodes.id[slot]);
+    }
+}
+
+bool MemoryGraphStore::findEdge(int relationId, GraphEdge& edge) {
+    if (!ensureCurrent()) return false;
+    int slot = state().edgeSlot.value(relationId, -1);
+    if (slot < 0) return false;
+    edge = edgeAt(slot, Projection::Full);
+    return true;
+}
+
+QList<GraphEdge> MemoryGraphStore::takeEdges(QList<int>& relationIds, Projection projection) {
+    QList<GraphEdge> found;
+    if (!ensureCurrent()) return found;
+
+    const StoreState& st = state();
+    QList<int> missing;
+    QSet<int> seen;
+    for (int id : relationIds) {
+        if (seen.contains(id)) continue;
+        seen.insert(id);
+
+        int slot = st.edgeSlot.value(id, -1);
+        if (slot < 0) missing.append(id);
+        else found.append(edgeAt(slot, projection));
+    }
+    relationIds = missing;
+    return found;
+}
+
+void MemoryGraphStore::fillSnapshotNodes(GraphSnapshot& snapshot) {
+    const StoreState& st = state();
+    const NodeColumns& c = st.nodes;
+    snapshot.reserve(st.nodeSlot.size(), st.edgeSlot.size());
+    for (int s = 0; s < c.size(); ++s) {
+        if (!c.alive[s]) continue;
+        snapshot.addNode(c.id[s], c.typeId[s], c.name[s], c.posX[s], c.posY[s], st.strings.at(c.color[s]));
+    }
+}
+
+void MemoryGraphStore::fillSnapshotEdges(GraphSnapshot& snapshot) {
+    const StoreState& st = state();
+    const EdgeColumns& c = st.edges;
+    for (int s = 0; s < c.size(); ++s) {
+        if (!c.alive[s]) continue;
+        snapshot.addEdge(c.id[s], st.nodes.id[c.source[s]], st.nodes.id[c.target[s]], c.typeId[s], c.weight[s]);
+    }
+}
+
+QList<GraphEdge> MemoryGraphStore::edges(Projection projection) {
+    return allEdges(projection);
+}
+
+bool MemoryGraphStore::edgesOfNodes(const QList<int>& nodeIds, const QStringList& relationTypes,
+                                    Projection projection, QList<GraphEdge>& edges) {
+    if (!ensureCurrent()) return false;
+
+    const StoreState& st = state();
+    QVector<int> slots;
+    slots.reserve(nodeIds.size());
+    for (int id : nodeIds) {
+        int slot = st.nodeSlot.value(id, -1);
+        if (slot < 0) return false;
+        slots.append(slot);
+    }
+    ensureIndexes(state());
+
+    // 类型过滤先换算成类型ID，逐条比较的只是整数
+    QSet<int> allowedTypes;
+    if (!relationTypes.isEmpty()) {
+        const TypeDictionary& types = TypeDictionary::forOntology(st.ontologyId);
+        for (const QString& type : relationTypes) {
+            int typeId = types.find(TypeDictionary::RelationTypes, type);
+            if (typeId >= 0) allowedTypes.insert(typeId);
+        }
+        if (allowedTypes.isEmpty()) return true;
+    }
+
+    // 两端都在 nodeIds 中的关系会被访问两次，按槽位去重
+    QSet<int> seen;
+    auto collect = [&](int k) {
+        if (!allowedTypes.isEmpty() && !allowedTypes.contains(st.edges.typeId[k])) return;
+        if (seen.contains(k)) return;
+        seen.insert(k);
+        edges.append(edgeAt(k, projection));
+    };
+    for (int slot : slots) {
+        forEachEdgeOf(st, slot, true, collect);
+        forEachEdgeOf(st, slot, false, collect);
+    }
+    return true;
+}
+
+bool MemoryGraphStore::edgeExists(int sourceId, int targetId, const QString& type, bool& exists) {
+    if (!ensureCurrent()) return false;
+
+    const StoreState& st = state();
+    int source = st.nodeSlot.value(sourceId, -1);
+    if (source < 0) return false;
+    exists = false;
+    int typeId = TypeDictionary::forOntology(st.ontologyId).find(TypeDictionary::RelationTypes, type);
+    if (typeId < 0) return true;
+
+    ensureIndexes(state());
+    forEachEdgeOf(st, source, true, [&](int k) {
+        if (st.edges.typeId[k] == typeId && st.nodes.id[st.edges.target[k]] == targetId) exists = true;
+    });
+    return true;
+}
@@ -0,0 +1,83 @@
+#ifndef MEMORYGRAPHSTORE_H
+#define MEMORYGRAPHSTORE_H
+
+#include <QList>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include "../model/GraphNode.h"
+#include "../model/GraphEdge.h"
+#include "../model/GraphSnapshot.h"
+#include "NodeRepository.h"
+#include "Projection.h"
+
+/**
+ * @brief 常驻内存的列式图存储，装载后 NodeRepository / RelationshipRepository 的读操作直接由它应答
+ *
+ * 一次只装载当前打开的本体：
+ *   - 节点、关系按列存放，类型与颜色驻留在字符串池中只存一份下标；删除只打墓碑，墓碑过半时压缩
+ *   - 出边/入边 CSR 邻接、按类型的节点列表和名称索引随增删改就地维护：新增关系记入增量邻接，
+ *     删除只打墓碑，增量与墓碑累计过多时才整体重建
+ * 持久化仍以数据库为准，change_log 充当预写日志：仓库写入提交后存储被标记为过期，
+ * 下次读取前用 ChangeLogCursor 回放新日志，按实体取回数据库当前行。
+ * 回放累计到一定数量以及卸载时写出 .kgsnap 快照，文件名记下对应的日志位置；
+ * 再次打开同一本体时读入快照并回放之后的日志，不必全量读库；快照之后的日志已被清理，
+ * 或回放后行数、内容校验和与数据库不符时丢弃快照改为全量读库。
+ *
+ * 事务进行中、本体未装载 (包括后台装载尚未完成) 或实体不在存储中时读操作返回 false / 留下未命中的ID，
+ * 调用方照常走 SQL。接口只在主线程使用；装载在后台线程的独立连接上进行，完成后回到主线程换入。
+ */
+class MemoryGraphStore {
+public:
+    // --- 装载与持久化 ---
+    // 默认关闭 (启动时设置 KG_MEMORY_STORE=1 开启)；关闭后 load() 不再装载，已装载的本体随之卸载
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+
+    // 在后台线程装载本体 (优先快照 + 日志回放，否则全量读库)，立即返回；已装载其他本体时先卸载
+    static void load(int ontologyId);
+    // 有未写入快照的修改时先写快照，再释放内存
+    static void unload();
+    static bool isLoaded();
+    // 已装载或正在装载的本体
+    static int ontologyId();
+
+    // 把当前内容写成快照并删除该本体的旧快照
+    static bool checkpoint();
+    // 数据库已提交新的修改，下次读取前回放日志
+    static void markStale();
+
+    // --- 仓库读取 ---
+    // 本体已装载且当前可以直接应答
+    static bool serves(int ontologyId);
+
+    static bool findNode(int nodeId, GraphNode& node);
+    // 从 nodeIds 中取出存储里有的节点，未命中的ID留在 nodeIds 中由调用方查库
+    static QList<GraphNode> takeNodes(QList<int>& nodeIds, Projection projection);
+    static QList<GraphNode> nodes(Projection projection);
+    static QList<GraphNode> nodesByType(const QString& type, Projection projection);
+    // column 为 name/type/description，按数据库默认排序规则不区分大小写
+    static QList<GraphNode> searchNodes(const QString& column, const QString& value, NodeRepository::MatchMode mode);
+    static void nodeIdsByNames(const QStringList& names, QHash<QString, int>& idByName);
+
+    // 按槽位顺序把存活节点/关系追加到快照，调用前须 serves() 为真
+    static void fillSnapshotNodes(GraphSnapshot& snapshot);
+    static void fillSnapshotEdges(GraphSnapshot& snapshot);
+
+    static bool findEdge(int relationId, GraphEdge& edge);
+    static QList<GraphEdge> takeEdges(QList<int>& relationIds, Projection projection);
+    static QList<GraphEdge> edges(Projection projection);
+    // 与一组节点相连的关系，任一节点不在存储中时返回 false
+    static bool edgesOfNodes(const QList<int>& nodeIds, const QStringList& relationTypes,
+                             Projection projection, QList<GraphEdge>& edges);
+    static bool edgeExists(int sourceId, int targetId, const QString& type, bool& exists);
+
+private:
+    // 过期时先回放日志；不能应答时返回 false
+    static bool ensureCurrent();
+    static bool catchUp();
+
+    MemoryGraphStore() = default;
+};
+
+#endif // MEMORYGRAPHSTORE_H
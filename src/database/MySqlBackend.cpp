@@ -0,0 +1,45 @@
+#include "MySqlBackend.h"
+#include "DatabaseConnection.h"
+#include <QRandomGenerator>
+
+MySqlBackend::MySqlBackend()
+    : m_sessionId(QRandomGenerator::global()->bounded(Q_INT64_C(1) << 48)) {}
+
+void MySqlBackend::configure(QSqlDatabase& db, const DatabaseConfig& config) const {
+    db.setHostName(config.hostname);
+    db.setUserName(config.username);
+    db.setPassword(config.password);
+    db.setDatabaseName(config.database);
+    db.setPort(config.port);
+}
+
+bool MySqlBackend::initializeSession(QSqlDatabase& db) const {
+    Q_UNUSED(db);
+    return true;
+}
+
+bool MySqlBackend::initializeSchema(QSqlDatabase& db) const {
+    Q_UNUSED(db);
+    return true;
+}
+
+QString MySqlBackend::keepExistingOnConflict(const QString& keyColumn) const {
+    // 把主键赋给自己，不修改任何列
+    return QString(" ON DUPLICATE KEY UPDATE %1 = %1").arg(keyColumn);
+}
+
+QString MySqlBackend::rowValueList(int rows, int columns) const {
+    return DatabaseConnection::placeholderRows(rows, columns);
+}
+
+QString MySqlBackend::jsonText(const QString& column) const {
+    return QString("IF(JSON_VALID(%1), JSON_UNQUOTE(JSON_EXTRACT(%1, ?)), NULL)").arg(column);
+}
+
+QString MySqlBackend::sessionIdExpr() const {
+    return QString::number(m_sessionId);
+}
+
+QString MySqlBackend::rowChecksum(const QString& columns) const {
+    return QString("COALESCE(BIT_XOR(CRC32(CONCAT_WS('|', %1))), 0)").arg(columns);
+}
@@ -0,0 +1,33 @@
+#ifndef MYSQLBACKEND_H
+#define MYSQLBACKEND_H
+
+#include "StorageBackend.h"
+
+/**
+ * @brief MySQL 后端 (QMYSQL)，多用户共享的服务器库
+ */
+class MySqlBackend : public StorageBackend {
+public:
+    MySqlBackend();
+
+    Kind kind() const override { return MySql; }
+    QString driverName() const override { return "QMYSQL"; }
+
+    void configure(QSqlDatabase& db, const DatabaseConfig& config) const override;
+    bool initializeSession(QSqlDatabase& db) const override;
+    bool initializeSchema(QSqlDatabase& db) const override;
+
+    QString keepExistingOnConflict(const QString& keyColumn) const override;
+    QString insertIgnore() const override { return "INSERT IGNORE"; }
+    QString rowValueList(int rows, int columns) const override;
+    QString jsonText(const QString& column) const override;
+    QString sessionIdExpr() const override;
+    QString rowChecksum(const QString& columns) const override;
+
+private:
+    // 不用 CONNECTION_ID()：断线重连后连接号会被服务器重新分配给其他客户端，
+    // 与 SQLite 后端一样用进程内随机数标识本会话，重连后保持不变
+    qint64 m_sessionId;
+};
+
+#endif // MYSQLBACKEND_H
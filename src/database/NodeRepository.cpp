@@ -1,13 +1,40 @@
 #include "NodeRepository.h"
 #include "DatabaseConnection.h"
+#include "ChangeLogRepository.h"
+#include "MemoryGraphStore.h"
+#include "../model/TypeDictionary.h"
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QVariant>
 #include <QJsonDocument>
+#include <QStringList>
+#include <QMap>
 #include <QDebug>
 
 // --- 内部辅助函数声明 ---
-static GraphNode mapQueryToNode(const QSqlQuery& query);
+static GraphNode mapQueryToNode(const QSqlQuery& query, Projection projection = Projection::Full);
+static QString nodeColumns(Projection projection, const QString& alias = QString());
+
+// properties JSON 中已建生成列+索引的热点键，命中时直接查生成列
+static const QMap<QString, QString> kHotJsonColumns = {
+    {"alias", "prop_alias"},
+    {"category", "prop_category"}
+};
+// 生成列只保存前 255 个字符 (见 init.sql)，更长的值要回退到 JSON 表达式
+static const int kHotColumnWidth = 255;
+
+// 动态拼接的 IN 列表每批最多的 ID 数
+static const int kInListBatch = 500;
+
+// 转义 LIKE 通配符，避免用户输入的 % _ 被当作模式
+// 转义符用 '!' 并在 SQL 中显式写 ESCAPE '!'：MySQL 与 SQLite 对反斜杠的默认处理不同
+QString NodeRepository::escapeLike(const QString& value) {
+    QString escaped = value;
+    escaped.replace("!", "!!");
+    escaped.replace("%", "!%");
+    escaped.replace("_", "!_");
+    return escaped;
+}
 
 bool NodeRepository::addNode(GraphNode& node) {
     int newId = -1;
@@ -39,10 +66,11 @@ bool NodeRepository::executeInsert(const GraphNode& node, int& outId) {
         return false;
     }
 
-    QSqlQuery query(db);
-
-    query.prepare("INSERT INTO node (ontology_id, node_type, name, description, pos_x, pos_y, color, properties) "
-                  "VALUES (:oid, :type, :name, :desc, :x, :y, :color, :props)");
+    // 写入与变更日志在同一事务内
+    ScopedTransaction tx;
+    QSqlQuery& query = DatabaseConnection::preparedQuery(
+        "INSERT INTO node (ontology_id, node_type, name, description, pos_x, pos_y, color, properties) "
+        "VALUES (:oid, :type, :name, :desc, :x, :y, :color, :props)");
 
     query.bindValue(":oid", node.ontologyId);
     query.bindValue(":type", node.nodeType);
@@ -52,25 +80,22 @@ bool NodeRepository::executeInsert(const GraphNode& node, int& outId) {
     query.bindValue(":y", node.posY);
     query.bindValue(":color", node.color);
 
-    // 处理 JSON 字段
-    QJsonDocument doc(node.properties);
-    if (doc.isNull()) {
-        qWarning() << "NodeRepository: 节点properties序列化失败";
-        return false;
-    }
-    query.bindValue(":props", QString(doc.toJson(QJsonDocument::Compact)));
+    // 处理 JSON 字段：未修改的 properties 直接写回原始字节，不重新序列化
+    query.bindValue(":props", QString::fromUtf8(node.properties.toBytes()));
 
     if (!query.exec()) {
         qCritical() << "NodeRepository: 插入节点失败:" << query.lastError().text();
         return false;
     }
 
-    outId = query.lastInsertId().toInt();
-    if (outId <= 0) {
+    int newId = query.lastInsertId().toInt();
+    if (newId <= 0) {
         qCritical() << "NodeRepository: 获取自增ID失败";
         return false;
     }
 
+    if (!ChangeLogRepository::logNodes(ChangeLogRepository::OpInsert, {newId}) || !tx.commit()) return false;
+    outId = newId;
     return true;
 }
 
@@ -87,8 +112,14 @@ bool NodeRepository::deleteNode(int nodeId) {
         return false;
     }
 
-    QSqlQuery query(db);
-    query.prepare("DELETE FROM node WHERE node_id = :id");
+    // 日志取自待删除的行，必须先于删除写入；相连的关系会被级联删除，一并记录
+    ScopedTransaction tx;
+    if (!ChangeLogRepository::logNodes(ChangeLogRepository::OpDelete, {nodeId})
+        || !ChangeLogRepository::logCascadedRelationships({nodeId})) {
+        return false;
+    }
+
+    QSqlQuery& query = DatabaseConnection::preparedQuery("DELETE FROM node WHERE node_id = :id");
     query.bindValue(":id", nodeId);
 
     if (!query.exec()) {
@@ -103,7 +134,7 @@ bool NodeRepository::deleteNode(int nodeId) {
         return false;
     }
 
-    return true;
+    return tx.commit();
 }
 
 bool NodeRepository::updateNode(const GraphNode& node) {
@@ -127,11 +158,11 @@ bool NodeRepository::updateNode(const GraphNode& node) {
         return false;
     }
 
-    QSqlQuery query(db);
-
-    query.prepare("UPDATE node SET node_type = :type, name = :name, description = :desc, "
-                  "pos_x = :x, pos_y = :y, color = :color, properties = :props "
-                  "WHERE node_id = :id");
+    ScopedTransaction tx;
+    QSqlQuery& query = DatabaseConnection::preparedQuery(
+        "UPDATE node SET node_type = :type, name = :name, description = :desc, "
+        "pos_x = :x, pos_y = :y, color = :color, properties = :props "
+        "WHERE node_id = :id");
 
     query.bindValue(":type", node.nodeType);
     query.bindValue(":name", node.name);
@@ -141,12 +172,8 @@ bool NodeRepository::updateNode(const GraphNode& node) {
     query.bindValue(":color", node.color);
     query.bindValue(":id", node.id);
 
-    QJsonDocument doc(node.properties);
-    if (doc.isNull()) {
-        qWarning() << "NodeRepository: 节点properties序列化失败";
-        return false;
-    }
-    query.bindValue(":props", QString(doc.toJson(QJsonDocument::Compact)));
+    // 未修改的 properties 直接写回原始字节，不重新序列化
+    query.bindValue(":props", QString::fromUtf8(node.properties.toBytes()));
 
     if (!query.exec()) {
         qCritical() << "NodeRepository: 更新失败:" << query.lastError().text();
@@ -160,16 +187,18 @@ bool NodeRepository::updateNode(const GraphNode& node) {
         return false;
     }
 
-    return true;
+    if (!ChangeLogRepository::logNodes(ChangeLogRepository::OpUpdate, {node.id})) return false;
+    return tx.commit();
 }
 
-QList<GraphNode> NodeRepository::getAllNodes(int ontologyId) {
+QList<GraphNode> NodeRepository::getAllNodes(int ontologyId, Projection projection) {
     QList<GraphNode> nodes;
 
     if (ontologyId <= 0) {
         qWarning() << "NodeRepository: 无效的ontologyId =" << ontologyId;
         return nodes;
     }
+    if (MemoryGraphStore::serves(ontologyId)) return MemoryGraphStore::nodes(projection);
 
     QSqlDatabase db = DatabaseConnection::getDatabase();
     if (!db.isOpen()) {
@@ -178,8 +207,9 @@ QList<GraphNode> NodeRepository::getAllNodes(int ontologyId) {
     }
 
     QSqlQuery query(db);
+    query.setForwardOnly(true);
 
-    query.prepare("SELECT * FROM node WHERE ontology_id = :oid");
+    query.prepare(QString("SELECT %1 FROM node WHERE ontology_id = :oid").arg(nodeColumns(projection)));
     query.bindValue(":oid", ontologyId);
 
     if (!query.exec()) {
@@ -188,12 +218,52 @@ QList<GraphNode> NodeRepository::getAllNodes(int ontologyId) {
     }
 
     while (query.next()) {
-        nodes.append(mapQueryToNode(query));
+        nodes.append(mapQueryToNode(query, projection));
     }
 
     return nodes;
 }
 
+bool NodeRepository::fillSnapshot(int ontologyId, GraphSnapshot& snapshot) {
+    snapshot.reset(ontologyId);
+
+    if (ontologyId <= 0) {
+        qWarning() << "NodeRepository: 无效的ontologyId =" << ontologyId;
+        return false;
+    }
+    if (MemoryGraphStore::serves(ontologyId)) {
+        MemoryGraphStore::fillSnapshotNodes(snapshot);
+        return true;
+    }
+
+    QSqlDatabase db = DatabaseConnection::getDatabase();
+    if (!db.isOpen()) {
+        qCritical() << "NodeRepository: 数据库连接已关闭";
+        return false;
+    }
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare("SELECT node_id, node_type, name, pos_x, pos_y, color FROM node WHERE ontology_id = :oid");
+    query.bindValue(":oid", ontologyId);
+
+    if (!query.exec()) {
+        qCritical() << "NodeRepository: 读取节点快照失败:" << query.lastError().text();
+        return false;
+    }
+
+    TypeDictionary& types = TypeDictionary::forOntology(ontologyId);
+    while (query.next()) {
+        snapshot.addNode(query.value(0).toInt(),
+                         types.intern(TypeDictionary::NodeTypes, query.value(1).toString()),
+                         query.value(2).toString(),
+                         query.value(3).toFloat(),
+                         query.value(4).toFloat(),
+                         query.value(5).toString());
+    }
+    return true;
+}
+
 // ===== 问题1修复: 实现完整的字段映射 =====
 GraphNode NodeRepository::getNodeById(int nodeId) {
     if (nodeId <= 0) {
@@ -201,14 +271,17 @@ GraphNode NodeRepository::getNodeById(int nodeId) {
         return GraphNode();
     }
 
+    GraphNode stored;
+    if (MemoryGraphStore::findNode(nodeId, stored)) return stored;
+
     QSqlDatabase db = DatabaseConnection::getDatabase();
     if (!db.isOpen()) {
         qCritical() << "NodeRepository: 数据库连接已关闭";
         return GraphNode();
     }
 
-    QSqlQuery query(db);
-    query.prepare("SELECT * FROM node WHERE node_id = :id");
+    static const QString sql = QString("SELECT %1 FROM node WHERE node_id = :id").arg(nodeColumns(Projection::Full));
+    QSqlQuery& query = DatabaseConnection::preparedQuery(sql);
     query.bindValue(":id", nodeId);
 
     if (!query.exec()) {
@@ -225,13 +298,14 @@ GraphNode NodeRepository::getNodeById(int nodeId) {
     return GraphNode();
 }
 
-QList<GraphNode> NodeRepository::getNodesByType(int ontologyId, const QString& type) {
+QList<GraphNode> NodeRepository::getNodesByType(int ontologyId, const QString& type, Projection projection) {
     QList<GraphNode> nodes;
 
     if (ontologyId <= 0 || type.isEmpty()) {
         qWarning() << "NodeRepository: 无效的参数 ontologyId =" << ontologyId << ", type =" << type;
         return nodes;
     }
+    if (MemoryGraphStore::serves(ontologyId)) return MemoryGraphStore::nodesByType(type, projection);
 
     QSqlDatabase db = DatabaseConnection::getDatabase();
     if (!db.isOpen()) {
@@ -239,9 +313,8 @@ QList<GraphNode> NodeRepository::getNodesByType(int ontologyId, const QString& t
         return nodes;
     }
 
-    QSqlQuery query(db);
-
-    query.prepare("SELECT * FROM node WHERE ontology_id = :oid AND node_type = :type");
+    QSqlQuery& query = DatabaseConnection::preparedQuery(
+        QString("SELECT %1 FROM node WHERE ontology_id = :oid AND node_type = :type").arg(nodeColumns(projection)));
     query.bindValue(":oid", ontologyId);
     query.bindValue(":type", type);
 
@@ -250,6 +323,125 @@ QList<GraphNode> NodeRepository::getNodesByType(int ontologyId, const QString& t
         return nodes;
     }
 
+    while (query.next()) {
+        nodes.append(mapQueryToNode(query, projection));
+    }
+
+    return nodes;
+}
+
+QList<GraphNode> NodeRepository::getNodesByIds(const QList<int>& ids, Projection projection) {
+    // 内存存储命中的直接返回，只为未命中的ID查库
+    QList<int> nodeIds = ids;
+    QList<GraphNode> nodes = MemoryGraphStore::takeNodes(nodeIds, projection);
+    if (nodeIds.isEmpty()) return nodes;
+
+    QSqlDatabase db = DatabaseConnection::getDatabase();
+    if (!db.isOpen()) {
+        qCritical() << "NodeRepository: 数据库连接已关闭";
+        return nodes;
+    }
+
+    // 按占位符拼接 IN 列表，值仍然通过绑定传入；每批最多 kInListBatch 个
+    for (int start = 0; start < nodeIds.size(); start += kInListBatch) {
+        int count = qMin(kInListBatch, nodeIds.size() - start);
+        QStringList placeholders;
+        for (int i = 0; i < count; ++i) placeholders << "?";
+
+        QSqlQuery query(db);
+        query.setForwardOnly(true);
+        query.prepare(QString("SELECT %1 FROM node WHERE node_id IN (%2)")
+                          .arg(nodeColumns(projection), placeholders.join(",")));
+        for (int i = start; i < start + count; ++i) query.addBindValue(nodeIds[i]);
+
+        if (!query.exec()) {
+            qCritical() << "NodeRepository: 批量查询节点失败:" << query.lastError().text();
+            return nodes;
+        }
+
+        while (query.next()) {
+            nodes.append(mapQueryToNode(query, projection));
+        }
+    }
+
+    return nodes;
+}
+
+QList<GraphNode> NodeRepository::searchNodes(int ontologyId, const QString& attrName,
+                                            const QString& attrValue, MatchMode mode) {
+    QList<GraphNode> nodes;
+
+    if (ontologyId <= 0 || attrName.isEmpty()) {
+        qWarning() << "NodeRepository: 无效的检索参数 ontologyId =" << ontologyId << ", attrName =" << attrName;
+        return nodes;
+    }
+
+    // 内存存储只覆盖 node 表自身的列，扩展属性仍要查 attribute 表
+    bool columnAttr = attrName == "name" || attrName == "type" || attrName == "description";
+    if (columnAttr && MemoryGraphStore::serves(ontologyId)) {
+        return MemoryGraphStore::searchNodes(attrName, attrValue, mode);
+    }
+
+    QSqlDatabase db = DatabaseConnection::getDatabase();
+    if (!db.isOpen()) {
+        qCritical() << "NodeRepository: 数据库连接已关闭";
+        return nodes;
+    }
+
+    // 根据匹配方式生成比较运算符和绑定值
+    QString op = (mode == MatchExact) ? "= ?" : "LIKE ? ESCAPE '!'";
+    QString pattern;
+    switch (mode) {
+    case MatchExact:    pattern = attrValue; break;
+    case MatchPrefix:   pattern = escapeLike(attrValue) + "%"; break;
+    case MatchContains: pattern = "%" + escapeLike(attrValue) + "%"; break;
+    }
+
+    QString select = QString("SELECT %1 FROM node n WHERE n.ontology_id = ? AND ").arg(nodeColumns(Projection::Full, "n"));
+    QString sql = select;
+    QVariantList binds{ontologyId};
+
+    if (attrName == "name") {
+        sql += "n.name " + op;
+        binds << pattern;
+    } else if (attrName == "type") {
+        sql += "n.node_type " + op;
+        binds << pattern;
+    } else if (attrName == "description") {
+        sql += "n.description " + op;
+        binds << pattern;
+    } else {
+        // 扩展属性：拆成两个分支再 UNION，OR 连接会让两边的索引都用不上
+        // 分支一走 attribute 的 (attr_name, attr_value) 索引
+        sql += "n.node_id IN (SELECT a.node_id FROM attribute a WHERE a.attr_name = ? AND a.attr_value " + op + ")";
+        binds << attrName << pattern;
+
+        // 分支二查 properties JSON：常用键走 (ontology_id, 生成列) 索引
+        // 生成列是截断后的前缀：包含匹配可能命中被截掉的部分，不能走生成列
+        sql += " UNION " + select;
+        binds << ontologyId;
+        bool useHotColumn = kHotJsonColumns.contains(attrName) && mode != MatchContains
+                            && attrValue.size() < kHotColumnWidth;
+        if (useHotColumn) {
+            sql += QString("n.%1 %2").arg(kHotJsonColumns.value(attrName), op);
+        } else {
+            QString key = attrName;
+            key.replace("\\", "\\\\").replace("\"", "\\\"");
+            sql += DatabaseConnection::backend().jsonText("n.properties") + " " + op;
+            binds << QString("$.\"%1\"").arg(key);
+        }
+        binds << pattern;
+    }
+
+    QSqlQuery query(db);
+    query.prepare(sql);
+    for (const QVariant& value : binds) query.addBindValue(value);
+
+    if (!query.exec()) {
+        qCritical() << "NodeRepository: 属性检索失败:" << query.lastError().text();
+        return nodes;
+    }
+
     while (query.next()) {
         nodes.append(mapQueryToNode(query));
     }
@@ -257,31 +449,222 @@ QList<GraphNode> NodeRepository::getNodesByType(int ontologyId, const QString& t
     return nodes;
 }
 
+// --- 批量合并 ---
+
+// 单条语句的最大行数，避免超出 max_allowed_packet 与占位符上限
+static const int kMergeBatchRows = 500;
+
+bool NodeRepository::getNodeIdsByNames(int ontologyId, const QStringList& names, QHash<QString, int>& idByName) {
+    if (MemoryGraphStore::serves(ontologyId)) {
+        MemoryGraphStore::nodeIdsByNames(names, idByName);
+        return true;
+    }
+
+    QSqlDatabase db = DatabaseConnection::getDatabase();
+    if (!db.isOpen()) {
+        qCritical() << "NodeRepository: 数据库连接已关闭";
+        return false;
+    }
+
+    for (int start = 0; start < names.size(); start += kMergeBatchRows) {
+        int count = qMin(kMergeBatchRows, names.size() - start);
+        QStringList placeholders;
+        for (int i = 0; i < count; ++i) placeholders << "?";
+
+        QSqlQuery query(db);
+        query.setForwardOnly(true);
+        query.prepare(QString("SELECT node_id, name FROM node WHERE ontology_id = ? AND name IN (%1)")
+                          .arg(placeholders.join(",")));
+        query.addBindValue(ontologyId);
+        for (int i = start; i < start + count; ++i) query.addBindValue(names[i]);
+
+        if (!query.exec()) {
+            qCritical() << "NodeRepository: 按名称查询节点失败:" << query.lastError().text();
+            return false;
+        }
+        while (query.next()) {
+            idByName.insert(nameKey(query.value(1).toString()), query.value(0).toInt());
+        }
+    }
+    return true;
+}
+
+bool NodeRepository::upsertNodes(int ontologyId, QList<GraphNode>& nodes, QSet<int>& insertedIds) {
+    if (nodes.isEmpty()) return true;
+
+    QSqlDatabase db = DatabaseConnection::getDatabase();
+    if (!db.isOpen()) {
+        qCritical() << "NodeRepository: 数据库连接已关闭";
+        return false;
+    }
+
+    QStringList names;
+    names.reserve(nodes.size());
+    for (const auto& node : nodes) names << node.name;
+
+    // 1. 记下合并前已存在的名称，用来区分新插入的节点
+    QHash<QString, int> existing;
+    if (!getNodeIdsByNames(ontologyId, names, existing)) return false;
+
+    // 2. 多行写入，重名的行由唯一键吸收
+    for (int start = 0; start < nodes.size(); start += kMergeBatchRows) {
+        int count = qMin(kMergeBatchRows, nodes.size() - start);
+
+        QSqlQuery query(db);
+        query.prepare("INSERT INTO node (ontology_id, node_type, name, description, pos_x, pos_y, color, properties) "
+                      "VALUES " + DatabaseConnection::placeholderRows(count, 8)
+                      + DatabaseConnection::backend().keepExistingOnConflict("node_id"));
+        for (int i = start; i < start + count; ++i) {
+            const GraphNode& node = nodes[i];
+            query.addBindValue(ontologyId);
+            query.addBindValue(node.nodeType);
+            query.addBindValue(node.name);
+            query.addBindValue(node.description);
+            query.addBindValue(node.posX);
+            query.addBindValue(node.posY);
+            query.addBindValue(node.color);
+            query.addBindValue(QString::fromUtf8(node.properties.toBytes()));
+        }
+
+        if (!query.exec()) {
+            qCritical() << "NodeRepository: 批量合并节点失败:" << query.lastError().text();
+            return false;
+        }
+    }
+
+    // 3. 自增 ID 在多行插入中不保证连续，按唯一键取回
+    QHash<QString, int> idByName;
+    if (!getNodeIdsByNames(ontologyId, names, idByName)) return false;
+
+    for (auto& node : nodes) {
+        QString key = nameKey(node.name);
+        node.id = idByName.value(key, -1);
+        node.ontologyId = ontologyId;
+        if (node.id > 0 && !existing.contains(key)) insertedIds.insert(node.id);
+    }
+    return ChangeLogRepository::logNodes(ChangeLogRepository::OpInsert, insertedIds.values());
+}
+
+// --- 批量删除/恢复 ---
+
+bool NodeRepository::deleteNodes(const QList<int>& nodeIds) {
+    if (nodeIds.isEmpty()) return true;
+
+    QSqlDatabase db = DatabaseConnection::getDatabase();
+    if (!db.isOpen()) {
+        qCritical() << "NodeRepository: 数据库连接已关闭";
+        return false;
+    }
+
+    // 日志取自待删除的行，必须先于删除写入
+    if (!ChangeLogRepository::logNodes(ChangeLogRepository::OpDelete, nodeIds)
+        || !ChangeLogRepository::logCascadedRelationships(nodeIds)) {
+        return false;
+    }
+
+    int deleted = 0;
+    for (int start = 0; start < nodeIds.size(); start += kMergeBatchRows) {
+        int count = qMin(kMergeBatchRows, nodeIds.size() - start);
+
+        QStringList placeholders;
+        for (int i = 0; i < count; ++i) placeholders << "?";
+
+        QSqlQuery query(db);
+        query.prepare(QString("DELETE FROM node WHERE node_id IN (%1)").arg(placeholders.join(",")));
+        for (int i = start; i < start + count; ++i) query.addBindValue(nodeIds[i]);
+
+        if (!query.exec()) {
+            qCritical() << "NodeRepository: 批量删除节点失败:" << query.lastError().text();
+            return false;
+        }
+        deleted += query.numRowsAffected();
+    }
+
+    if (deleted != nodeIds.size()) {
+        qWarning() << "NodeRepository: 批量删除节点失败 - 期望删除" << nodeIds.size()
+                   << "行，实际删除" << deleted << "行";
+        return false;
+    }
+    return true;
+}
+
+bool NodeRepository::restoreNodes(const QList<GraphNode>& nodes) {
+    if (nodes.isEmpty()) return true;
+
+    QSqlDatabase db = DatabaseConnection::getDatabase();
+    if (!db.isOpen()) {
+        qCritical() << "NodeRepository: 数据库连接已关闭";
+        return false;
+    }
+
+    for (int start = 0; start < nodes.size(); start += kMergeBatchRows) {
+        int count = qMin(kMergeBatchRows, nodes.size() - start);
+
+        // 显式写入原 node_id，关系端点和界面中的引用保持有效
+        QSqlQuery query(db);
+        query.prepare("INSERT INTO node (node_id, ontology_id, node_type, name, description, pos_x, pos_y, color, properties) "
+                      "VALUES " + DatabaseConnection::placeholderRows(count, 9));
+        for (int i = start; i < start + count; ++i) {
+            const GraphNode& node = nodes[i];
+            query.addBindValue(node.id);
+            query.addBindValue(node.ontologyId);
+            query.addBindValue(node.nodeType);
+            query.addBindValue(node.name);
+            query.addBindValue(node.description);
+            query.addBindValue(node.posX);
+            query.addBindValue(node.posY);
+            query.addBindValue(node.color);
+            query.addBindValue(QString::fromUtf8(node.properties.toBytes()));
+        }
+
+        if (!query.exec()) {
+            qCritical() << "NodeRepository: 批量恢复节点失败:" << query.lastError().text();
+            return false;
+        }
+    }
+
+    QList<int> ids;
+    for (const auto& node : nodes) ids.append(node.id);
+    return ChangeLogRepository::logNodes(ChangeLogRepository::OpInsert, ids);
+}
+
 /**
  * @brief 核心映射函数：将QSqlQuery结果映射到GraphNode对象
  * 消除代码重复，保证字段映射的一致性（问题1的关键修复）
  */
-static GraphNode mapQueryToNode(const QSqlQuery& query) {
+static GraphNode mapQueryToNode(const QSqlQuery& query, Projection projection) {
     GraphNode node;
     node.id = query.value("node_id").toInt();
     node.ontologyId = query.value("ontology_id").toInt();
     node.nodeType = query.value("node_type").toString();
+    TypeDictionary::resolve(node); // 类型字符串改为共享字典中的实例
     node.name = query.value("name").toString();
-    node.description = query.value("description").toString();
     node.posX = query.value("pos_x").toFloat();
     node.posY = query.value("pos_y").toFloat();
     node.color = query.value("color").toString();
 
-    // 安全的JSON反序列化
-    QByteArray jsonBytes = query.value("properties").toByteArray();
-    if (!jsonBytes.isEmpty()) {
-        QJsonDocument doc = QJsonDocument::fromJson(jsonBytes);
-        if (!doc.isNull()) {
-            node.properties = doc.object();
-        } else {
-            qWarning() << "NodeRepository: JSON反序列化失败，节点ID =" << node.id;
-        }
-    }
+    // 拓扑投影不包含大字段，也就不需要 JSON 解析
+    if (projection == Projection::Topology) return node;
+
+    node.description = query.value("description").toString();
+
+    // 只保存原始字节，JSON 解析推迟到首次访问 properties
+    node.properties = JsonProperties::fromRaw(query.value("properties").toByteArray());
 
     return node;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief 按投影生成 SELECT 列表，显式列名也避免取回 prop_* 生成列
+ */
+static QString nodeColumns(Projection projection, const QString& alias) {
+    static const QStringList topology = {"node_id", "ontology_id", "node_type", "name", "pos_x", "pos_y", "color"};
+    static const QStringList full = topology + QStringList{"description", "properties"};
+
+    const QStringList& columns = (projection == Projection::Topology) ? topology : full;
+    if (alias.isEmpty()) return columns.join(", ");
+
+    QStringList qualified;
+    for (const QString& column : columns) qualified << alias + "." + column;
+    return qualified.join(", ");
+}
@@ -3,13 +3,21 @@
 
 #include <QList>
 #include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QSet>
 #include "../model/GraphNode.h"
+#include "../model/GraphSnapshot.h"
+#include "Projection.h"
 
 /**
  * @brief 节点仓库类，负责 node 表的所有数据库操作
  */
 class NodeRepository {
 public:
+    // 属性检索的匹配方式：精确/前缀可以走索引，包含(%v%)只能扫描本体内的行
+    enum MatchMode { MatchExact, MatchPrefix, MatchContains };
+
     // --- 增 ---
     static bool addNode(GraphNode& node);
 
@@ -21,8 +29,48 @@ public:
 
     // --- 查 ---
     static GraphNode getNodeById(int nodeId);
-    static QList<GraphNode> getAllNodes(int ontologyId);
-    static QList<GraphNode> getNodesByType(int ontologyId, const QString& type);
+    // 批量读取可用 Projection::Topology 跳过 description/properties 列
+    static QList<GraphNode> getAllNodes(int ontologyId, Projection projection = Projection::Full);
+    /**
+     * @brief 以拓扑投影把本体的全部节点读入 snapshot (先 reset)，逐行直接写入紧凑记录，不构造 GraphNode
+     */
+    static bool fillSnapshot(int ontologyId, GraphSnapshot& snapshot);
+    static QList<GraphNode> getNodesByType(int ontologyId, const QString& type,
+                                           Projection projection = Projection::Full);
+    // 批量按ID查询，一次 WHERE node_id IN (...) 取回，避免逐个查询的 N+1 问题
+    static QList<GraphNode> getNodesByIds(const QList<int>& nodeIds, Projection projection = Projection::Full);
+    /**
+     * @brief 在本体内按属性检索节点，条件全部下推到 SQL
+     * attrName 为 name/type/description 时匹配 node 表的列；
+     * 其他名称同时匹配 attribute 表 (attr_name, attr_value) 和 properties JSON 中的同名键
+     */
+    static QList<GraphNode> searchNodes(int ontologyId, const QString& attrName,
+                                        const QString& attrValue, MatchMode mode = MatchContains);
+
+    // --- 批量合并 ---
+    /**
+     * @brief 按唯一键 unique_node (ontology_id, name) 批量合并节点，调用方负责事务
+     * 多行 INSERT ... ON DUPLICATE KEY UPDATE，已存在的同名节点保持不变。
+     * 成功后 nodes 中每项的 id 回填为库中的实际 ID，本次新插入的 ID 记入 insertedIds
+     */
+    static bool upsertNodes(int ontologyId, QList<GraphNode>& nodes, QSet<int>& insertedIds);
+
+    /**
+     * @brief 按名称批量取节点 ID，结果以 nameKey() 为键
+     */
+    static bool getNodeIdsByNames(int ontologyId, const QStringList& names, QHash<QString, int>& idByName);
+
+    // --- 批量删除/恢复 (撤销重做用，调用方负责事务) ---
+    // 按 IN 列表分批删除，相连的关系与属性由外键级联删除；要求全部ID都存在
+    static bool deleteNodes(const QList<int>& nodeIds);
+    // 按原 node_id 多行写回已删除的节点
+    static bool restoreNodes(const QList<GraphNode>& nodes);
+
+    // MySQL 默认排序规则不区分大小写，按名称比较时统一折叠
+    static QString nameKey(const QString& name) { return name.trimmed().toCaseFolded(); }
+
+    // 转义 LIKE 通配符 (转义符为 '!'，LIKE 条件须带 ESCAPE '!')，供其他拼接 LIKE 条件的模块复用
+    static QString escapeLike(const QString& value);
 
 private:
     // 内部辅助函数：执行具体的 SQL 绑定逻辑
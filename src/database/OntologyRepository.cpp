@@ -1,5 +1,6 @@
 #include "OntologyRepository.h"
 #include "DatabaseConnection.h"
+#include "MemoryGraphStore.h"
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QDebug>
@@ -11,18 +12,21 @@ void OntologyRepository::initDatabase() {
 
     QSqlQuery query(db);
 
-    bool success = query.exec(
-        "CREATE TABLE IF NOT EXISTS ontology ("
-        "ontology_id INTEGER PRIMARY KEY AUTO_INCREMENT, "
-        "name VARCHAR(100) UNIQUE, "
-        "description TEXT, "
-        "version VARCHAR(20) DEFAULT '1.0', "
-        "created_at DATETIME DEFAULT CURRENT_TIMESTAMP, "
-        "updated_at DATETIME DEFAULT CURRENT_TIMESTAMP)"
-    );
-
-    if (!success) {
-        qDebug() << "Init ontology table info:" << query.lastError().text();
+    // SQLite 后端在连接时已按完整表结构建表，这里的 MySQL 语法只用于 MySQL
+    if (DatabaseConnection::backend().kind() == StorageBackend::MySql) {
+        bool success = query.exec(
+            "CREATE TABLE IF NOT EXISTS ontology ("
+            "ontology_id INTEGER PRIMARY KEY AUTO_INCREMENT, "
+            "name VARCHAR(100) UNIQUE, "
+            "description TEXT, "
+            "version VARCHAR(20) DEFAULT '1.0', "
+            "created_at DATETIME DEFAULT CURRENT_TIMESTAMP, "
+            "updated_at DATETIME DEFAULT CURRENT_TIMESTAMP)"
+        );
+
+        if (!success) {
+            qDebug() << "Init ontology table info:" << query.lastError().text();
+        }
     }
 
     // 插入默认数据
@@ -82,29 +86,30 @@ bool OntologyRepository::deleteOntology(int id) {
     QSqlDatabase db = DatabaseConnection::getDatabase();
     if (!db.isOpen()) return false;
 
-    db.transaction();
-    QSqlQuery query(db);
-
-
-    // 1. 删除关系 (relationship 表)
-    query.prepare("DELETE FROM relationship WHERE ontology_id = :id");
-    query.bindValue(":id", id);
-    query.exec();
-
-    // 2. 删除节点 (node 表)
-    query.prepare("DELETE FROM node WHERE ontology_id = :id");
-    query.bindValue(":id", id);
-    query.exec();
+    // 经 DatabaseConnection 开启事务，期间其他仓库写入会并入本事务，提交后内存存储随之标记过期
+    if (!DatabaseConnection::beginTransaction()) return false;
 
-    // 3. 删除本体 (ontology 表)
-    query.prepare("DELETE FROM ontology WHERE ontology_id = :id");
-    query.bindValue(":id", id);
-    bool success = query.exec();
-
-    if (success) db.commit();
-    else db.rollback();
+    // 1. 删除关系 (relationship 表) 2. 删除节点 (node 表) 3. 删除本体 (ontology 表)，任一步失败整体回滚
+    static const char* const kStatements[] = {
+        "DELETE FROM relationship WHERE ontology_id = :id",
+        "DELETE FROM node WHERE ontology_id = :id",
+        "DELETE FROM ontology WHERE ontology_id = :id"
+    };
+    QSqlQuery query(db);
+    for (const char* sql : kStatements) {
+        query.prepare(sql);
+        query.bindValue(":id", id);
+        if (!query.exec()) {
+            qCritical() << "OntologyRepository: 删除本体失败:" << query.lastError().text();
+            DatabaseConnection::rollbackTransaction();
+            return false;
+        }
+    }
 
-    return success;
+    if (!DatabaseConnection::commitTransaction()) return false;
+    // 被删除的本体不能继续由内存存储提供
+    if (MemoryGraphStore::ontologyId() == id) MemoryGraphStore::unload();
+    return true;
 }
 
 Ontology OntologyRepository::getOntologyById(int id) {
@@ -0,0 +1,12 @@
+#ifndef PROJECTION_H
+#define PROJECTION_H
+
+/**
+ * @brief 仓库读取时的列投影
+ * Topology 只取渲染、遍历和统计需要的列 (ID、类型、名称、坐标、权重等)，
+ * 不读取 description / properties 大字段，也不做 JSON 解析；
+ * Full 读取实体的全部业务列。
+ */
+enum class Projection { Topology, Full };
+
+#endif // PROJECTION_H
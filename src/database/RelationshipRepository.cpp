@@ -1,13 +1,30 @@
 #include "RelationshipRepository.h"
 #include "DatabaseConnection.h"
+#include "ChangeLogRepository.h"
+#include "MemoryGraphStore.h"
+#include "../model/TypeDictionary.h"
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QVariant>
+#include <QHash>
+#include <QSet>
 #include <QJsonDocument>
 #include <QDebug>
 
 // --- 内部辅助函数声明 ---
-static GraphEdge mapQueryToEdge(const QSqlQuery& query);
+static GraphEdge mapQueryToEdge(const QSqlQuery& query, Projection projection = Projection::Full);
+
+// 拓扑投影只取遍历与渲染需要的列，不取 properties 大字段
+static const char* const kEdgeTopologyColumns = "relation_id, ontology_id, source_id, target_id, relation_type, weight";
+static const char* const kEdgeFullColumns =
+    "relation_id, ontology_id, source_id, target_id, relation_type, weight, properties";
+
+// 动态拼接的 IN 列表每批最多的 ID 数
+static const int kInListBatch = 500;
+
+static QString edgeColumns(Projection projection) {
+    return QString::fromLatin1(projection == Projection::Topology ? kEdgeTopologyColumns : kEdgeFullColumns);
+}
 
 bool RelationshipRepository::addRelationship(GraphEdge& edge) {
     // ===== 问题5修复: 输入参数验证 =====
@@ -33,10 +50,11 @@ bool RelationshipRepository::addRelationship(GraphEdge& edge) {
         return false;
     }
 
-    QSqlQuery query(db);
-
-    query.prepare("INSERT INTO relationship (ontology_id, source_id, target_id, relation_type, weight, properties) "
-                  "VALUES (:oid, :sid, :tid, :type, :weight, :props)");
+    // 写入与变更日志在同一事务内
+    ScopedTransaction tx;
+    QSqlQuery& query = DatabaseConnection::preparedQuery(
+        "INSERT INTO relationship (ontology_id, source_id, target_id, relation_type, weight, properties) "
+        "VALUES (:oid, :sid, :tid, :type, :weight, :props)");
 
     query.bindValue(":oid", edge.ontologyId);
     query.bindValue(":sid", edge.sourceId);
@@ -44,25 +62,22 @@ bool RelationshipRepository::addRelationship(GraphEdge& edge) {
     query.bindValue(":type", edge.relationType);
     query.bindValue(":weight", edge.weight);
 
-    // 处理 JSON 字段
-    QJsonDocument doc(edge.properties);
-    if (doc.isNull()) {
-        qWarning() << "RelationshipRepository: 关系properties序列化失败";
-        return false;
-    }
-    query.bindValue(":props", QString(doc.toJson(QJsonDocument::Compact)));
+    // 处理 JSON 字段：未修改的 properties 直接写回原始字节，不重新序列化
+    query.bindValue(":props", QString::fromUtf8(edge.properties.toBytes()));
 
     if (!query.exec()) {
         qCritical() << "RelationshipRepository: 创建关系失败:" << query.lastError().text();
         return false;
     }
 
-    edge.id = query.lastInsertId().toInt();
-    if (edge.id <= 0) {
+    int newId = query.lastInsertId().toInt();
+    if (newId <= 0) {
         qCritical() << "RelationshipRepository: 获取自增ID失败";
         return false;
     }
 
+    if (!ChangeLogRepository::logRelationships(ChangeLogRepository::OpInsert, {newId}) || !tx.commit()) return false;
+    edge.id = newId;
     return true;
 }
 
@@ -79,8 +94,11 @@ bool RelationshipRepository::deleteRelationship(int relationId) {
         return false;
     }
 
-    QSqlQuery query(db);
-    query.prepare("DELETE FROM relationship WHERE relation_id = :id");
+    // 日志取自待删除的行，必须先于删除写入
+    ScopedTransaction tx;
+    if (!ChangeLogRepository::logRelationships(ChangeLogRepository::OpDelete, {relationId})) return false;
+
+    QSqlQuery& query = DatabaseConnection::preparedQuery("DELETE FROM relationship WHERE relation_id = :id");
     query.bindValue(":id", relationId);
 
     if (!query.exec()) {
@@ -95,7 +113,7 @@ bool RelationshipRepository::deleteRelationship(int relationId) {
         return false;
     }
 
-    return true;
+    return tx.commit();
 }
 
 bool RelationshipRepository::updateRelationship(const GraphEdge& edge) {
@@ -115,21 +133,17 @@ bool RelationshipRepository::updateRelationship(const GraphEdge& edge) {
         return false;
     }
 
-    QSqlQuery query(db);
-
-    query.prepare("UPDATE relationship SET relation_type = :type, weight = :weight, properties = :props "
-                  "WHERE relation_id = :id");
+    ScopedTransaction tx;
+    QSqlQuery& query = DatabaseConnection::preparedQuery(
+        "UPDATE relationship SET relation_type = :type, weight = :weight, properties = :props "
+        "WHERE relation_id = :id");
 
     query.bindValue(":type", edge.relationType);
     query.bindValue(":weight", edge.weight);
     query.bindValue(":id", edge.id);
 
-    QJsonDocument doc(edge.properties);
-    if (doc.isNull()) {
-        qWarning() << "RelationshipRepository: 关系properties序列化失败";
-        return false;
-    }
-    query.bindValue(":props", QString(doc.toJson(QJsonDocument::Compact)));
+    // 未修改的 properties 直接写回原始字节，不重新序列化
+    query.bindValue(":props", QString::fromUtf8(edge.properties.toBytes()));
 
     if (!query.exec()) {
         qCritical() << "RelationshipRepository: 更新失败:" << query.lastError().text();
@@ -143,16 +157,18 @@ bool RelationshipRepository::updateRelationship(const GraphEdge& edge) {
         return false;
     }
 
-    return true;
+    if (!ChangeLogRepository::logRelationships(ChangeLogRepository::OpUpdate, {edge.id})) return false;
+    return tx.commit();
 }
 
-QList<GraphEdge> RelationshipRepository::getEdgesByOntology(int ontologyId) {
+QList<GraphEdge> RelationshipRepository::getEdgesByOntology(int ontologyId, Projection projection) {
     QList<GraphEdge> edges;
 
     if (ontologyId <= 0) {
         qWarning() << "RelationshipRepository: 无效的ontologyId =" << ontologyId;
         return edges;
     }
+    if (MemoryGraphStore::serves(ontologyId)) return MemoryGraphStore::edges(projection);
 
     QSqlDatabase db = DatabaseConnection::getDatabase();
     if (!db.isOpen()) {
@@ -161,8 +177,9 @@ QList<GraphEdge> RelationshipRepository::getEdgesByOntology(int ontologyId) {
     }
 
     QSqlQuery query(db);
+    query.setForwardOnly(true);
 
-    query.prepare("SELECT * FROM relationship WHERE ontology_id = :oid");
+    query.prepare(QString("SELECT %1 FROM relationship WHERE ontology_id = :oid").arg(edgeColumns(projection)));
     query.bindValue(":oid", ontologyId);
 
     if (!query.exec()) {
@@ -171,19 +188,61 @@ QList<GraphEdge> RelationshipRepository::getEdgesByOntology(int ontologyId) {
     }
 
     while (query.next()) {
-        edges.append(mapQueryToEdge(query));
+        edges.append(mapQueryToEdge(query, projection));
     }
 
     return edges;
 }
 
-QList<GraphEdge> RelationshipRepository::getEdgesByNode(int nodeId) {
+bool RelationshipRepository::fillSnapshot(int ontologyId, GraphSnapshot& snapshot) {
+    if (ontologyId <= 0 || snapshot.ontologyId() != ontologyId) {
+        qWarning() << "RelationshipRepository: 快照与本体不匹配 ontologyId =" << ontologyId;
+        return false;
+    }
+    if (MemoryGraphStore::serves(ontologyId)) {
+        MemoryGraphStore::fillSnapshotEdges(snapshot);
+        snapshot.buildAdjacency();
+        return true;
+    }
+
+    QSqlDatabase db = DatabaseConnection::getDatabase();
+    if (!db.isOpen()) {
+        qCritical() << "RelationshipRepository: 数据库连接已关闭";
+        return false;
+    }
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare("SELECT relation_id, source_id, target_id, relation_type, weight "
+                  "FROM relationship WHERE ontology_id = :oid");
+    query.bindValue(":oid", ontologyId);
+
+    if (!query.exec()) {
+        qCritical() << "RelationshipRepository: 读取关系快照失败:" << query.lastError().text();
+        return false;
+    }
+
+    TypeDictionary& types = TypeDictionary::forOntology(ontologyId);
+    while (query.next()) {
+        // 两次查询之间被删除的节点不在快照中，其关系随之丢弃
+        snapshot.addEdge(query.value(0).toInt(),
+                         query.value(1).toInt(),
+                         query.value(2).toInt(),
+                         types.intern(TypeDictionary::RelationTypes, query.value(3).toString()),
+                         query.value(4).toFloat());
+    }
+    snapshot.buildAdjacency();
+    return true;
+}
+
+QList<GraphEdge> RelationshipRepository::getEdgesByNode(int nodeId, Projection projection) {
     QList<GraphEdge> edges;
 
     if (nodeId <= 0) {
         qWarning() << "RelationshipRepository: 无效的nodeId =" << nodeId;
         return edges;
     }
+    if (MemoryGraphStore::edgesOfNodes({nodeId}, QStringList(), projection, edges)) return edges;
 
     QSqlDatabase db = DatabaseConnection::getDatabase();
     if (!db.isOpen()) {
@@ -191,10 +250,9 @@ QList<GraphEdge> RelationshipRepository::getEdgesByNode(int nodeId) {
         return edges;
     }
 
-    QSqlQuery query(db);
-
     // 查询该节点作为起点或终点的所有关系
-    query.prepare("SELECT * FROM relationship WHERE source_id = :id OR target_id = :id");
+    QSqlQuery& query = DatabaseConnection::preparedQuery(
+        QString("SELECT %1 FROM relationship WHERE source_id = :id OR target_id = :id").arg(edgeColumns(projection)));
     query.bindValue(":id", nodeId);
 
     if (!query.exec()) {
@@ -203,7 +261,226 @@ QList<GraphEdge> RelationshipRepository::getEdgesByNode(int nodeId) {
     }
 
     while (query.next()) {
-        edges.append(mapQueryToEdge(query));
+        edges.append(mapQueryToEdge(query, projection));
+    }
+
+    return edges;
+}
+
+QList<GraphEdge> RelationshipRepository::getEdgesByNodes(const QList<int>& nodeIds, const QStringList& relationTypes,
+                                                         Projection projection) {
+    QList<GraphEdge> edges;
+    if (nodeIds.isEmpty()) return edges;
+    if (MemoryGraphStore::edgesOfNodes(nodeIds, relationTypes, projection, edges)) return edges;
+
+    QSqlDatabase db = DatabaseConnection::getDatabase();
+    if (!db.isOpen()) {
+        qCritical() << "RelationshipRepository: 数据库连接已关闭";
+        return edges;
+    }
+
+    QString typeFilter;
+    if (!relationTypes.isEmpty()) {
+        QStringList typeHolders;
+        for (int i = 0; i < relationTypes.size(); ++i) typeHolders << "?";
+        typeFilter = QString(" AND relation_type IN (%1)").arg(typeHolders.join(","));
+    }
+
+    // 起点、终点各查一次，每个 ID 只绑定一次且两条语句都能走单列索引；
+    // IN 列表按批切分，两端都在本次节点中的关系会被查到两次，按 ID 去重
+    QSet<int> seen;
+    for (int start = 0; start < nodeIds.size(); start += kInListBatch) {
+        int count = qMin(kInListBatch, nodeIds.size() - start);
+        QStringList idHolders;
+        for (int i = 0; i < count; ++i) idHolders << "?";
+
+        for (const char* column : {"source_id", "target_id"}) {
+            // 拓扑查询只需要 ID 与类型，不取 properties 大字段
+            QSqlQuery query(db);
+            query.setForwardOnly(true);
+            query.prepare(QString("SELECT %1 FROM relationship WHERE %2 IN (%3)%4")
+                              .arg(edgeColumns(projection), QLatin1String(column), idHolders.join(","), typeFilter));
+            for (int i = start; i < start + count; ++i) query.addBindValue(nodeIds[i]);
+            for (const QString& type : relationTypes) query.addBindValue(type);
+
+            if (!query.exec()) {
+                qCritical() << "RelationshipRepository: 批量查询关系失败:" << query.lastError().text();
+                return edges;
+            }
+
+            while (query.next()) {
+                GraphEdge edge = mapQueryToEdge(query, projection);
+                if (!seen.contains(edge.id)) {
+                    seen.insert(edge.id);
+                    edges.append(edge);
+                }
+            }
+        }
+    }
+
+    return edges;
+}
+
+QHash<int, int> RelationshipRepository::countEdgesByNodes(const QList<int>& nodeIds, const QStringList& relationTypes) {
+    QHash<int, int> degree;
+    if (nodeIds.isEmpty()) return degree;
+
+    QList<GraphEdge> cached;
+    if (MemoryGraphStore::edgesOfNodes(nodeIds, relationTypes, Projection::Topology, cached)) {
+        QSet<int> wanted;
+        for (int id : nodeIds) wanted.insert(id);
+        for (const auto& edge : cached) {
+            if (wanted.contains(edge.sourceId)) degree[edge.sourceId]++;
+            if (wanted.contains(edge.targetId)) degree[edge.targetId]++;
+        }
+        return degree;
+    }
+
+    QSqlDatabase db = DatabaseConnection::getDatabase();
+    if (!db.isOpen()) {
+        qCritical() << "RelationshipRepository: 数据库连接已关闭";
+        return degree;
+    }
+
+    QString typeFilter;
+    if (!relationTypes.isEmpty()) {
+        QStringList typeHolders;
+        for (int i = 0; i < relationTypes.size(); ++i) typeHolders << "?";
+        typeFilter = QString(" AND relation_type IN (%1)").arg(typeHolders.join(","));
+    }
+
+    // 只在索引上计数，不取回关系行；起点、终点分开分组，各自走单列索引
+    for (int start = 0; start < nodeIds.size(); start += kInListBatch) {
+        int count = qMin(kInListBatch, nodeIds.size() - start);
+        QStringList idHolders;
+        for (int i = 0; i < count; ++i) idHolders << "?";
+
+        for (const char* column : {"source_id", "target_id"}) {
+            QSqlQuery query(db);
+            query.setForwardOnly(true);
+            query.prepare(QString("SELECT %1, COUNT(*) FROM relationship WHERE %1 IN (%2)%3 GROUP BY %1")
+                              .arg(QLatin1String(column), idHolders.join(","), typeFilter));
+            for (int i = start; i < start + count; ++i) query.addBindValue(nodeIds[i]);
+            for (const QString& type : relationTypes) query.addBindValue(type);
+
+            if (!query.exec()) {
+                qCritical() << "RelationshipRepository: 统计节点度数失败:" << query.lastError().text();
+                return degree;
+            }
+
+            while (query.next()) {
+                degree[query.value(0).toInt()] += query.value(1).toInt();
+            }
+        }
+    }
+
+    return degree;
+}
+
+QList<GraphEdge> RelationshipRepository::getEdgesBetween(const QList<int>& nodeIds, const QList<int>& otherIds,
+                                                         const QStringList& relationTypes, Projection projection) {
+    QList<GraphEdge> edges;
+    if (nodeIds.isEmpty() || otherIds.isEmpty()) return edges;
+
+    QList<GraphEdge> cached;
+    if (MemoryGraphStore::edgesOfNodes(nodeIds, relationTypes, projection, cached)) {
+        QSet<int> sides, others;
+        for (int id : nodeIds) sides.insert(id);
+        for (int id : otherIds) others.insert(id);
+        for (const auto& edge : cached) {
+            if ((sides.contains(edge.sourceId) && others.contains(edge.targetId))
+                || (sides.contains(edge.targetId) && others.contains(edge.sourceId))) {
+                edges.append(edge);
+            }
+        }
+        return edges;
+    }
+
+    QSqlDatabase db = DatabaseConnection::getDatabase();
+    if (!db.isOpen()) {
+        qCritical() << "RelationshipRepository: 数据库连接已关闭";
+        return edges;
+    }
+
+    QString typeFilter;
+    if (!relationTypes.isEmpty()) {
+        QStringList typeHolders;
+        for (int i = 0; i < relationTypes.size(); ++i) typeHolders << "?";
+        typeFilter = QString(" AND relation_type IN (%1)").arg(typeHolders.join(","));
+    }
+
+    // 与 getEdgesByNodes 相同按起点、终点各查一次，另一端再用 IN 限定，超级节点的其余关系不会被取回；
+    // 两侧都按批切分，同一条关系可能在不同批次中重复出现，按 ID 去重
+    QSet<int> seen;
+    for (int start = 0; start < nodeIds.size(); start += kInListBatch) {
+        int count = qMin(kInListBatch, nodeIds.size() - start);
+        QStringList idHolders;
+        for (int i = 0; i < count; ++i) idHolders << "?";
+
+        for (int otherStart = 0; otherStart < otherIds.size(); otherStart += kInListBatch) {
+            int otherCount = qMin(kInListBatch, otherIds.size() - otherStart);
+            QStringList otherHolders;
+            for (int i = 0; i < otherCount; ++i) otherHolders << "?";
+
+            for (bool fromSource : {true, false}) {
+                QSqlQuery query(db);
+                query.setForwardOnly(true);
+                query.prepare(QString("SELECT %1 FROM relationship WHERE %2 IN (%3) AND %4 IN (%5)%6")
+                                  .arg(edgeColumns(projection),
+                                       QLatin1String(fromSource ? "source_id" : "target_id"), idHolders.join(","),
+                                       QLatin1String(fromSource ? "target_id" : "source_id"), otherHolders.join(","),
+                                       typeFilter));
+                for (int i = start; i < start + count; ++i) query.addBindValue(nodeIds[i]);
+                for (int i = otherStart; i < otherStart + otherCount; ++i) query.addBindValue(otherIds[i]);
+                for (const QString& type : relationTypes) query.addBindValue(type);
+
+                if (!query.exec()) {
+                    qCritical() << "RelationshipRepository: 批量查询关系失败:" << query.lastError().text();
+                    return edges;
+                }
+
+                while (query.next()) {
+                    GraphEdge edge = mapQueryToEdge(query, projection);
+                    if (!seen.contains(edge.id)) {
+                        seen.insert(edge.id);
+                        edges.append(edge);
+                    }
+                }
+            }
+        }
+    }
+
+    return edges;
+}
+
+QList<GraphEdge> RelationshipRepository::getRelationshipsByIds(const QList<int>& ids, Projection projection) {
+    // 内存存储命中的直接返回，只为未命中的ID查库
+    QList<int> relationIds = ids;
+    QList<GraphEdge> edges = MemoryGraphStore::takeEdges(relationIds, projection);
+    if (relationIds.isEmpty()) return edges;
+
+    QSqlDatabase db = DatabaseConnection::getDatabase();
+    if (!db.isOpen()) {
+        qCritical() << "RelationshipRepository: 数据库连接已关闭";
+        return edges;
+    }
+
+    QStringList placeholders;
+    for (int i = 0; i < relationIds.size(); ++i) placeholders << "?";
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare(QString("SELECT %1 FROM relationship WHERE relation_id IN (%2)")
+                      .arg(edgeColumns(projection), placeholders.join(",")));
+    for (int id : relationIds) query.addBindValue(id);
+
+    if (!query.exec()) {
+        qCritical() << "RelationshipRepository: 批量查询关系失败:" << query.lastError().text();
+        return edges;
+    }
+
+    while (query.next()) {
+        edges.append(mapQueryToEdge(query, projection));
     }
 
     return edges;
@@ -215,14 +492,17 @@ GraphEdge RelationshipRepository::getRelationshipById(int relationId) {
         return GraphEdge();
     }
 
+    GraphEdge stored;
+    if (MemoryGraphStore::findEdge(relationId, stored)) return stored;
+
     QSqlDatabase db = DatabaseConnection::getDatabase();
     if (!db.isOpen()) {
         qCritical() << "RelationshipRepository: 数据库连接已关闭";
         return GraphEdge();
     }
 
-    QSqlQuery query(db);
-    query.prepare("SELECT * FROM relationship WHERE relation_id = :id");
+    static const QString sql = QString("SELECT %1 FROM relationship WHERE relation_id = :id").arg(kEdgeFullColumns);
+    QSqlQuery& query = DatabaseConnection::preparedQuery(sql);
     query.bindValue(":id", relationId);
 
     if (!query.exec()) {
@@ -240,59 +520,32 @@ GraphEdge RelationshipRepository::getRelationshipById(int relationId) {
 }
 
 
-static GraphEdge mapQueryToEdge(const QSqlQuery& query) {
+static GraphEdge mapQueryToEdge(const QSqlQuery& query, Projection projection) {
     GraphEdge edge;
     edge.id = query.value("relation_id").toInt();
     edge.ontologyId = query.value("ontology_id").toInt();
     edge.sourceId = query.value("source_id").toInt();
     edge.targetId = query.value("target_id").toInt();
     edge.relationType = query.value("relation_type").toString();
+    TypeDictionary::resolve(edge);
     edge.weight = query.value("weight").toFloat();
 
-    // 安全的JSON反序列化
-    QByteArray jsonData = query.value("properties").toByteArray();
-    if (!jsonData.isEmpty()) {
-        QJsonDocument doc = QJsonDocument::fromJson(jsonData);
-        if (!doc.isNull()) {
-            edge.properties = doc.object();
-        } else {
-            qWarning() << "RelationshipRepository: JSON反序列化失败，关系ID =" << edge.id;
-        }
-    }
+    if (projection == Projection::Topology) return edge;
+
+    // 只保存原始字节，JSON 解析推迟到首次访问 properties
+    edge.properties = JsonProperties::fromRaw(query.value("properties").toByteArray());
 
     return edge;
 }
 
-// src/database/RelationshipRepository.cpp
-
 QList<GraphEdge> RelationshipRepository::getAllRelationships(int ontologyId) {
-    QList<GraphEdge> edges;
-
-    QSqlDatabase db = DatabaseConnection::getDatabase();
-
-    QSqlQuery query(db);
-    query.prepare("SELECT relation_id, source_id, target_id, relation_type, weight FROM relationship WHERE ontology_id = ?");
-    query.addBindValue(ontologyId);
-
-    if (query.exec()) {
-        while (query.next()) {
-            GraphEdge edge;
-            edge.id = query.value("relation_id").toInt();
-            edge.sourceId = query.value("source_id").toInt();
-            edge.targetId = query.value("target_id").toInt();
-            edge.relationType = query.value("relation_type").toString();
-            edge.weight = query.value("weight").toFloat();
-            edge.ontologyId = ontologyId;
-            edges.append(edge);
-        }
-    } else {
-        // 如果出错，打印出来方便调试
-        qCritical() << "加载关系失败 (SQL错误):" << query.lastError().text();
-    }
-    return edges;
+    return getEdgesByOntology(ontologyId, Projection::Topology);
 }
 
 bool RelationshipRepository::relationshipExists(int sourceId, int targetId, const QString& type) {
+    bool exists = false;
+    if (MemoryGraphStore::edgeExists(sourceId, targetId, type, exists)) return exists;
+
     QSqlDatabase db = DatabaseConnection::getDatabase();
     QSqlQuery query(db);
 
@@ -306,4 +559,179 @@ bool RelationshipRepository::relationshipExists(int sourceId, int targetId, cons
         return query.value(0).toInt() > 0;
     }
     return false;
-}
\ No newline at end of file
+}
+
+// --- 批量合并 ---
+
+static const int kMergeBatchRows = 500;
+
+// 关系类型同样按不区分大小写的排序规则比较
+static QString edgeKey(int sourceId, int targetId, const QString& relationType) {
+    return QString("%1|%2|%3").arg(sourceId).arg(targetId).arg(relationType.toCaseFolded());
+}
+
+// 按 (source_id, target_id, relation_type) 元组批量取回关系 ID
+static bool selectEdgeIds(QSqlDatabase& db, int ontologyId, const QList<GraphEdge>& edges, QHash<QString, int>& idByKey) {
+    for (int start = 0; start < edges.size(); start += kMergeBatchRows) {
+        int count = qMin(kMergeBatchRows, edges.size() - start);
+
+        QSqlQuery query(db);
+        query.setForwardOnly(true);
+        query.prepare("SELECT relation_id, source_id, target_id, relation_type FROM relationship "
+                      "WHERE ontology_id = ? AND (source_id, target_id, relation_type) IN ("
+                      + DatabaseConnection::backend().rowValueList(count, 3) + ")");
+        query.addBindValue(ontologyId);
+        for (int i = start; i < start + count; ++i) {
+            query.addBindValue(edges[i].sourceId);
+            query.addBindValue(edges[i].targetId);
+            query.addBindValue(edges[i].relationType);
+        }
+
+        if (!query.exec()) {
+            qCritical() << "RelationshipRepository: 批量查询关系失败:" << query.lastError().text();
+            return false;
+        }
+        while (query.next()) {
+            idByKey.insert(edgeKey(query.value(1).toInt(), query.value(2).toInt(), query.value(3).toString()),
+                           query.value(0).toInt());
+        }
+    }
+    return true;
+}
+
+bool RelationshipRepository::upsertRelationships(int ontologyId, QList<GraphEdge>& edges, QSet<int>& insertedIds) {
+    if (edges.isEmpty()) return true;
+
+    QSqlDatabase db = DatabaseConnection::getDatabase();
+    if (!db.isOpen()) {
+        qCritical() << "RelationshipRepository: 数据库连接已关闭";
+        return false;
+    }
+
+    // 1. 已存在的关系直接回填 ID，只写入缺少的部分 (同批内的重复也只写一次)
+    QHash<QString, int> existing;
+    if (!selectEdgeIds(db, ontologyId, edges, existing)) return false;
+
+    QList<GraphEdge> missing;
+    QSet<QString> missingKeys;
+    for (const auto& edge : edges) {
+        QString key = edgeKey(edge.sourceId, edge.targetId, edge.relationType);
+        if (existing.contains(key) || missingKeys.contains(key)) continue;
+        missingKeys.insert(key);
+        missing.append(edge);
+    }
+
+    // 2. 多行写入，并发写入造成的重复由唯一键吸收
+    for (int start = 0; start < missing.size(); start += kMergeBatchRows) {
+        int count = qMin(kMergeBatchRows, missing.size() - start);
+
+        QSqlQuery query(db);
+        query.prepare("INSERT INTO relationship (ontology_id, source_id, target_id, relation_type, weight, properties) "
+                      "VALUES " + DatabaseConnection::placeholderRows(count, 6)
+                      + DatabaseConnection::backend().keepExistingOnConflict("relation_id"));
+        for (int i = start; i < start + count; ++i) {
+            const GraphEdge& edge = missing[i];
+            query.addBindValue(ontologyId);
+            query.addBindValue(edge.sourceId);
+            query.addBindValue(edge.targetId);
+            query.addBindValue(edge.relationType);
+            query.addBindValue(edge.weight);
+            query.addBindValue(QString::fromUtf8(edge.properties.toBytes()));
+        }
+
+        if (!query.exec()) {
+            qCritical() << "RelationshipRepository: 批量合并关系失败:" << query.lastError().text();
+            return false;
+        }
+    }
+
+    // 3. 取回新关系的 ID
+    QHash<QString, int> inserted;
+    if (!selectEdgeIds(db, ontologyId, missing, inserted)) return false;
+
+    for (auto& edge : edges) {
+        QString key = edgeKey(edge.sourceId, edge.targetId, edge.relationType);
+        edge.ontologyId = ontologyId;
+        edge.id = existing.value(key, inserted.value(key, -1));
+        if (inserted.contains(key)) insertedIds.insert(edge.id);
+    }
+    return ChangeLogRepository::logRelationships(ChangeLogRepository::OpInsert, insertedIds.values());
+}
+
+// --- 批量删除/恢复 ---
+
+bool RelationshipRepository::deleteRelationships(const QList<int>& relationIds) {
+    if (relationIds.isEmpty()) return true;
+
+    QSqlDatabase db = DatabaseConnection::getDatabase();
+    if (!db.isOpen()) {
+        qCritical() << "RelationshipRepository: 数据库连接已关闭";
+        return false;
+    }
+
+    // 日志取自待删除的行，必须先于删除写入
+    if (!ChangeLogRepository::logRelationships(ChangeLogRepository::OpDelete, relationIds)) return false;
+
+    int deleted = 0;
+    for (int start = 0; start < relationIds.size(); start += kMergeBatchRows) {
+        int count = qMin(kMergeBatchRows, relationIds.size() - start);
+
+        QStringList placeholders;
+        for (int i = 0; i < count; ++i) placeholders << "?";
+
+        QSqlQuery query(db);
+        query.prepare(QString("DELETE FROM relationship WHERE relation_id IN (%1)").arg(placeholders.join(",")));
+        for (int i = start; i < start + count; ++i) query.addBindValue(relationIds[i]);
+
+        if (!query.exec()) {
+            qCritical() << "RelationshipRepository: 批量删除关系失败:" << query.lastError().text();
+            return false;
+        }
+        deleted += query.numRowsAffected();
+    }
+
+    if (deleted != relationIds.size()) {
+        qWarning() << "RelationshipRepository: 批量删除关系失败 - 期望删除" << relationIds.size()
+                   << "行，实际删除" << deleted << "行";
+        return false;
+    }
+    return true;
+}
+
+bool RelationshipRepository::restoreRelationships(const QList<GraphEdge>& edges) {
+    if (edges.isEmpty()) return true;
+
+    QSqlDatabase db = DatabaseConnection::getDatabase();
+    if (!db.isOpen()) {
+        qCritical() << "RelationshipRepository: 数据库连接已关闭";
+        return false;
+    }
+
+    for (int start = 0; start < edges.size(); start += kMergeBatchRows) {
+        int count = qMin(kMergeBatchRows, edges.size() - start);
+
+        // 显式写入原 relation_id，界面与缓存中的引用保持有效
+        QSqlQuery query(db);
+        query.prepare("INSERT INTO relationship (relation_id, ontology_id, source_id, target_id, relation_type, weight, properties) "
+                      "VALUES " + DatabaseConnection::placeholderRows(count, 7));
+        for (int i = start; i < start + count; ++i) {
+            const GraphEdge& edge = edges[i];
+            query.addBindValue(edge.id);
+            query.addBindValue(edge.ontologyId);
+            query.addBindValue(edge.sourceId);
+            query.addBindValue(edge.targetId);
+            query.addBindValue(edge.relationType);
+            query.addBindValue(edge.weight);
+            query.addBindValue(QString::fromUtf8(edge.properties.toBytes()));
+        }
+
+        if (!query.exec()) {
+            qCritical() << "RelationshipRepository: 批量恢复关系失败:" << query.lastError().text();
+            return false;
+        }
+    }
+
+    QList<int> ids;
+    for (const auto& edge : edges) ids.append(edge.id);
+    return ChangeLogRepository::logRelationships(ChangeLogRepository::OpInsert, ids);
+}
@@ -2,7 +2,12 @@
 #define RELATIONSHIPREPOSITORY_H
 
 #include <QList>
+#include <QStringList>
+#include <QSet>
+#include <QHash>
 #include "../model/GraphEdge.h"
+#include "../model/GraphSnapshot.h"
+#include "Projection.h"
 
 class RelationshipRepository {
 public:
@@ -16,18 +21,50 @@ public:
     static bool updateRelationship(const GraphEdge& edge);
 
     // --- 查 ---
-    // 获取整个本体（项目）下的所有边，用于全图渲染
-    static QList<GraphEdge> getEdgesByOntology(int ontologyId);
+    // 获取整个本体（项目）下的所有边，全图渲染用 Projection::Topology，导出用 Full
+    static QList<GraphEdge> getEdgesByOntology(int ontologyId, Projection projection = Projection::Full);
     
+    // 把本体的全部关系追加到已由 NodeRepository::fillSnapshot 填好节点的 snapshot，并建立 CSR 邻接
+    static bool fillSnapshot(int ontologyId, GraphSnapshot& snapshot);
+
     // 获取与某个节点相关的所有边（起点或终点），用于局部查询
-    static QList<GraphEdge> getEdgesByNode(int nodeId);
+    static QList<GraphEdge> getEdgesByNode(int nodeId, Projection projection = Projection::Full);
+
+    // 获取与一组节点相关的所有边（批量 IN 查询），relationTypes 为空表示不过滤类型
+    // 默认拓扑投影，撤销删除等需要完整快照时传 Projection::Full
+    static QList<GraphEdge> getEdgesByNodes(const QList<int>& nodeIds, const QStringList& relationTypes = QStringList(),
+                                            Projection projection = Projection::Topology);
+
+    // 一组节点各自的关系数 (按类型过滤后)，只在索引上 COUNT，不取回关系行；没有关系的节点不出现在结果中
+    static QHash<int, int> countEdgesByNodes(const QList<int>& nodeIds, const QStringList& relationTypes = QStringList());
+
+    // 一端在 nodeIds、另一端在 otherIds 中的关系，用于只补齐子图内部的边
+    static QList<GraphEdge> getEdgesBetween(const QList<int>& nodeIds, const QList<int>& otherIds,
+                                            const QStringList& relationTypes = QStringList(),
+                                            Projection projection = Projection::Topology);
 
     // 根据ID获取单条关系
     static GraphEdge getRelationshipById(int relationId);
+    // 批量按ID查询，不存在的ID直接缺省
+    static QList<GraphEdge> getRelationshipsByIds(const QList<int>& relationIds, Projection projection = Projection::Full);
 
+    // 本体内所有边的拓扑投影 (不含 properties)，等价于 getEdgesByOntology(id, Projection::Topology)
     static QList<GraphEdge> getAllRelationships(int ontologyId);
 
     static bool relationshipExists(int sourceId, int targetId, const QString& type);
+
+    // --- 批量合并 ---
+    /**
+     * @brief 按唯一键 unique_relationship (ontology_id, source_id, target_id, relation_type) 批量合并关系，调用方负责事务
+     * 已存在的关系保持不变；成功后 edges 中每项的 id 回填，本次新插入的 ID 记入 insertedIds
+     */
+    static bool upsertRelationships(int ontologyId, QList<GraphEdge>& edges, QSet<int>& insertedIds);
+
+    // --- 批量删除/恢复 (撤销重做用，调用方负责事务) ---
+    // 按 IN 列表分批删除，要求全部ID都存在
+    static bool deleteRelationships(const QList<int>& relationIds);
+    // 按原 relation_id 多行写回已删除的关系
+    static bool restoreRelationships(const QList<GraphEdge>& edges);
 };
 
 #endif
\ No newline at end of file
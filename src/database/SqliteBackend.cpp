@@ -0,0 +1,176 @@
+#include "SqliteBackend.h"
+#include "DatabaseConnection.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QStringList>
+#include <QVariant>
+#include <QFileInfo>
+#include <QDir>
+#include <QRandomGenerator>
+#include <QDebug>
+
+// 与 database/init.sql 相同的表结构，按 SQLite 语法改写
+static const char* const kSchema[] = {
+    "CREATE TABLE IF NOT EXISTS ontology ("
+    " ontology_id INTEGER PRIMARY KEY AUTOINCREMENT,"
+    " name VARCHAR(255) NOT NULL UNIQUE,"
+    " description TEXT,"
+    " version VARCHAR(50) NOT NULL DEFAULT '1.0',"
+    " created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,"
+    " updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP)",
+
+    // 代替 MySQL 的 ON UPDATE CURRENT_TIMESTAMP (递归触发默认关闭，不会自触发)
+    "CREATE TRIGGER IF NOT EXISTS trg_ontology_updated AFTER UPDATE ON ontology "
+    "BEGIN UPDATE ontology SET updated_at = CURRENT_TIMESTAMP WHERE ontology_id = NEW.ontology_id; END",
+
+    "CREATE TABLE IF NOT EXISTS node ("
+    " node_id INTEGER PRIMARY KEY AUTOINCREMENT,"
+    " ontology_id INTEGER NOT NULL REFERENCES ontology(ontology_id) ON DELETE CASCADE,"
+    " node_type VARCHAR(100) NOT NULL,"
+    " name VARCHAR(255) NOT NULL COLLATE NOCASE,"
+    " description TEXT,"
+    " pos_x REAL DEFAULT 0,"
+    " pos_y REAL DEFAULT 0,"
+    " color VARCHAR(20) DEFAULT '#3498db',"
+    " properties TEXT,"
+    " prop_alias TEXT GENERATED ALWAYS AS"
+    "  (CASE WHEN json_valid(properties) THEN json_extract(properties, '$.alias') END) VIRTUAL,"
+    " prop_category TEXT GENERATED ALWAYS AS"
+    "  (CASE WHEN json_valid(properties) THEN json_extract(properties, '$.category') END) VIRTUAL,"
+    " created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,"
+    " UNIQUE (ontology_id, name))",
+    "CREATE INDEX IF NOT EXISTS idx_node_type ON node (ontology_id, node_type)",
+    "CREATE INDEX IF NOT EXISTS idx_node_alias ON node (ontology_id, prop_alias)",
+    "CREATE INDEX IF NOT EXISTS idx_node_category ON node (ontology_id, prop_category)",
+
+    "CREATE TABLE IF NOT EXISTS relationship ("
+    " relation_id INTEGER PRIMARY KEY AUTOINCREMENT,"
+    " ontology_id INTEGER NOT NULL REFERENCES ontology(ontology_id) ON DELETE CASCADE,"
+    " source_id INTEGER NOT NULL REFERENCES node(node_id) ON DELETE CASCADE,"
+    " target_id INTEGER NOT NULL REFERENCES node(node_id) ON DELETE CASCADE,"
+    " relation_type VARCHAR(100) NOT NULL COLLATE NOCASE,"
+    " weight REAL DEFAULT 1.0,"
+    " properties TEXT,"
+    " UNIQUE (ontology_id, source_id, target_id, relation_type))",
+    // 外键列在 SQLite 中不会自动建索引，级联删除和按端点查询都需要
+    "CREATE INDEX IF NOT EXISTS idx_relationship_source ON relationship (source_id)",
+    "CREATE INDEX IF NOT EXISTS idx_relationship_target ON relationship (target_id)",
+
+    "CREATE TABLE IF NOT EXISTS attribute ("
+    " attr_id INTEGER PRIMARY KEY AUTOINCREMENT,"
+    " node_id INTEGER DEFAULT NULL REFERENCES node(node_id) ON DELETE CASCADE,"
+    " relation_id INTEGER DEFAULT NULL REFERENCES relationship(relation_id) ON DELETE CASCADE,"
+    " attr_name VARCHAR(255) NOT NULL,"
+    " attr_value TEXT,"
+    " attr_type VARCHAR(50),"
+    " CHECK ((node_id IS NOT NULL AND relation_id IS NULL) OR (node_id IS NULL AND relation_id IS NOT NULL)))",
+    "CREATE INDEX IF NOT EXISTS idx_attr_name_value ON attribute (attr_name, attr_value)",
+    "CREATE INDEX IF NOT EXISTS idx_attr_node ON attribute (node_id)",
+    "CREATE INDEX IF NOT EXISTS idx_attr_relation ON attribute (relation_id)",
+
+    "CREATE TABLE IF NOT EXISTS change_log ("
+    " seq INTEGER PRIMARY KEY AUTOINCREMENT,"
+    " ontology_id INTEGER NOT NULL REFERENCES ontology(ontology_id) ON DELETE CASCADE,"
+    " entity_type INTEGER NOT NULL,"
+    " entity_id INTEGER NOT NULL,"
+    " op INTEGER NOT NULL,"
+    " origin_conn INTEGER NOT NULL,"
+    " changed_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP)",
+    "CREATE INDEX IF NOT EXISTS idx_change_ontology_seq ON change_log (ontology_id, seq)",
+
+    "CREATE TABLE IF NOT EXISTS users ("
+    " user_id INTEGER PRIMARY KEY AUTOINCREMENT,"
+    " username VARCHAR(50) NOT NULL UNIQUE,"
+    " password VARCHAR(255) NOT NULL,"
+    " is_admin BOOLEAN DEFAULT 0,"
+    " can_view BOOLEAN DEFAULT 1,"
+    " can_edit BOOLEAN DEFAULT 0,"
+    " can_delete BOOLEAN DEFAULT 0,"
+    " created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,"
+    " status VARCHAR(20) DEFAULT 'APPROVED')"
+};
+
+// 每个连接都要设置的参数；journal_mode 写入文件头，对后续连接同样生效
+static const char* const kSessionPragmas[] = {
+    "PRAGMA journal_mode = WAL",
+    "PRAGMA synchronous = NORMAL",      // WAL 下只在检查点 fsync，掉电最多丢最后几个事务
+    "PRAGMA foreign_keys = ON",         // 级联删除依赖外键，SQLite 默认关闭
+    "PRAGMA busy_timeout = 5000",       // 与后台线程连接争用写锁时等待而不是立即失败
+    "PRAGMA temp_store = MEMORY",
+    "PRAGMA cache_size = -65536",       // 64 MB 页缓存
+    "PRAGMA mmap_size = 268435456"      // 256 MB 内存映射读
+};
+
+SqliteBackend::SqliteBackend()
+    : m_sessionId(QRandomGenerator::global()->bounded(Q_INT64_C(1) << 48)) {}
+
+void SqliteBackend::configure(QSqlDatabase& db, const DatabaseConfig& config) const {
+    // database 字段即库文件路径，目录不存在时先创建
+    QFileInfo info(config.database);
+    QDir().mkpath(info.absolutePath());
+    db.setDatabaseName(info.absoluteFilePath());
+}
+
+bool SqliteBackend::initializeSession(QSqlDatabase& db) const {
+    QSqlQuery query(db);
+    if (!query.exec("SELECT sqlite_version()") || !query.next()) {
+        qCritical() << "SqliteBackend: 无法读取 SQLite 版本:" << query.lastError().text();
+        return false;
+    }
+    QStringList parts = query.value(0).toString().split('.');
+    int major = parts.value(0).toInt();
+    int minor = parts.value(1).toInt();
+    if (major < 3 || (major == 3 && minor < 32)) {
+        qCritical() << "SqliteBackend: 需要 SQLite 3.32 以上，当前版本" << query.value(0).toString();
+        return false;
+    }
+
+    for (const char* pragma : kSessionPragmas) {
+        if (!query.exec(QString::fromLatin1(pragma))) {
+            qCritical() << "SqliteBackend: 设置失败" << pragma << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SqliteBackend::initializeSchema(QSqlDatabase& db) const {
+    if (!db.transaction()) {
+        qCritical() << "SqliteBackend: 无法开启建表事务:" << db.lastError().text();
+        return false;
+    }
+    QSqlQuery query(db);
+    for (const char* statement : kSchema) {
+        if (!query.exec(QString::fromUtf8(statement))) {
+            qCritical() << "SqliteBackend: 建表失败:" << query.lastError().text();
+            db.rollback();
+            return false;
+        }
+    }
+    return db.commit();
+}
+
+QString SqliteBackend::keepExistingOnConflict(const QString& keyColumn) const {
+    Q_UNUSED(keyColumn);
+    return " ON CONFLICT DO NOTHING";
+}
+
+QString SqliteBackend::rowValueList(int rows, int columns) const {
+    // SQLite 的行值 IN 右侧必须是子查询，用 VALUES 构造
+    return "VALUES " + DatabaseConnection::placeholderRows(rows, columns);
+}
+
+QString SqliteBackend::jsonText(const QString& column) const {
+    // json_extract 对字符串直接返回去掉引号的文本；非法 JSON 会报错，先用 CASE 挡住
+    return QString("CASE WHEN json_valid(%1) THEN json_extract(%1, ?) END").arg(column);
+}
+
+QString SqliteBackend::sessionIdExpr() const {
+    return QString::number(m_sessionId);
+}
+
+QString SqliteBackend::rowChecksum(const QString& columns) const {
+    // SQLite 没有 CRC32 也没有按位异或的聚合，不做内容核对
+    Q_UNUSED(columns);
+    return QString();
+}
@@ -0,0 +1,35 @@
+#ifndef SQLITEBACKEND_H
+#define SQLITEBACKEND_H
+
+#include "StorageBackend.h"
+
+/**
+ * @brief 嵌入式 SQLite 后端 (QSQLITE)，单用户/离线使用，本地磁盘延迟
+ *
+ * 表结构与 database/init.sql 一致 (首次打开时创建)；WAL 日志模式，读写互不阻塞，
+ * 后台线程连接可以与主连接并发读。要求 SQLite 3.32 以上 (生成列、ON CONFLICT、JSON 函数)。
+ */
+class SqliteBackend : public StorageBackend {
+public:
+    SqliteBackend();
+
+    Kind kind() const override { return Sqlite; }
+    QString driverName() const override { return "QSQLITE"; }
+
+    void configure(QSqlDatabase& db, const DatabaseConfig& config) const override;
+    bool initializeSession(QSqlDatabase& db) const override;
+    bool initializeSchema(QSqlDatabase& db) const override;
+
+    QString keepExistingOnConflict(const QString& keyColumn) const override;
+    QString insertIgnore() const override { return "INSERT OR IGNORE"; }
+    QString rowValueList(int rows, int columns) const override;
+    QString jsonText(const QString& column) const override;
+    QString sessionIdExpr() const override;
+    QString rowChecksum(const QString& columns) const override;
+
+private:
+    // SQLite 没有连接号，用进程内随机数代替 (同一文件上每个进程各不相同)
+    qint64 m_sessionId;
+};
+
+#endif // SQLITEBACKEND_H
@@ -0,0 +1,11 @@
+#include "StorageBackend.h"
+#include "MySqlBackend.h"
+#include "SqliteBackend.h"
+
+std::unique_ptr<StorageBackend> StorageBackend::create(Kind kind) {
+    switch (kind) {
+    case Sqlite: return std::make_unique<SqliteBackend>();
+    case MySql:
+    default:     return std::make_unique<MySqlBackend>();
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef STORAGEBACKEND_H
+#define STORAGEBACKEND_H
+
+#include <QSqlDatabase>
+#include <QString>
+#include <memory>
+
+class DatabaseConfig;
+
+/**
+ * @brief 存储后端接口：驱动、连接初始化、建表以及 SQL 方言差异
+ *
+ * 仓库层继续写标准 SQL，只有各数据库写法不同的少数片段 (冲突时保留旧行、
+ * 行值 IN 列表、JSON 取值、会话标识) 通过当前后端生成。
+ * 当前后端由 DatabaseConnection::connect 按 DatabaseConfig::backend 创建。
+ */
+class StorageBackend {
+public:
+    enum Kind { MySql, Sqlite };
+
+    virtual ~StorageBackend() = default;
+
+    static std::unique_ptr<StorageBackend> create(Kind kind);
+
+    virtual Kind kind() const = 0;
+    virtual QString driverName() const = 0;
+
+    // --- 连接 ---
+    // 把配置写入连接 (主机/文件路径等)，在 open() 之前调用
+    virtual void configure(QSqlDatabase& db, const DatabaseConfig& config) const = 0;
+    // open() 之后的会话级设置，主连接和后台线程连接都要调用
+    virtual bool initializeSession(QSqlDatabase& db) const = 0;
+    // 确保表结构存在；MySQL 由 database/init.sql 建库，这里什么也不做
+    virtual bool initializeSchema(QSqlDatabase& db) const = 0;
+
+    // --- 方言 ---
+    // 多行 INSERT 末尾的子句：唯一键冲突时保留已有行、不报错
+    virtual QString keepExistingOnConflict(const QString& keyColumn) const = 0;
+    // "INSERT IGNORE" 一类的前缀，冲突行被跳过
+    virtual QString insertIgnore() const = 0;
+    // 行值 IN 的右侧，如 (a, b) IN (<这里>)，rows 行 columns 列占位符
+    virtual QString rowValueList(int rows, int columns) const = 0;
+    // 取 JSON 列中一个路径的文本值，路径以一个 ? 占位符绑定；列内容不是合法 JSON 时为 NULL
+    virtual QString jsonText(const QString& column) const = 0;
+    // 标识当前会话的 SQL 表达式 (重连后不变)，变更日志据此区分自己的写入
+    virtual QString sessionIdExpr() const = 0;
+    // 内容校验和的聚合表达式：每行把 columns 以 '|' 连接后取 CRC32，再对所有行按位异或；不支持时返回空串
+    virtual QString rowChecksum(const QString& columns) const = 0;
+};
+
+#endif // STORAGEBACKEND_H
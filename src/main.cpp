@@ -7,6 +7,7 @@
 #include <QStyleFactory>
 #include <QRandomGenerator>
 #include "database/DatabaseConnection.h"
+#include "database/MemoryGraphStore.h"
 #include "database/OntologyRepository.h"
 #include "database/NodeRepository.h"         // 新增
 #include "database/RelationshipRepository.h" // 新增
@@ -72,7 +73,7 @@ QString loadStyleSheet() {
 
 void generateTestData(int ontologyId) {
     // 保护机制：如果当前图谱已经有超过 50 个节点，说明已经有数据了，直接跳过，防止重复插入
-    if (NodeRepository::getAllNodes(ontologyId).size() > 50) {
+    if (NodeRepository::getAllNodes(ontologyId, Projection::Topology).size() > 50) {
         qDebug() << "检测到已存在大量数据，跳过测试数据生成。";
         return;
     }
@@ -142,6 +143,18 @@ int main(int argc, char *argv[]) {
     config.password = "123456";
     config.database = "DatabaseKnowledgeGraph";
 
+    // 设置 KG_SQLITE_DB=<库文件路径> 时改用嵌入式 SQLite，单机/离线使用无需 MySQL 服务
+    QString sqlitePath = qEnvironmentVariable("KG_SQLITE_DB");
+    if (!sqlitePath.isEmpty()) {
+        config.backend = StorageBackend::Sqlite;
+        config.database = sqlitePath;
+    }
+
+    // 设置 KG_MEMORY_STORE=1 时打开项目后在后台把整个本体装入内存，装载完成后读操作不再往返数据库
+    if (qEnvironmentVariable("KG_MEMORY_STORE") == "1") {
+        MemoryGraphStore::setEnabled(true);
+    }
+
     if (!DatabaseConnection::connect(config)) {
         QMessageBox::critical(nullptr, "Error", "无法连接到数据库！");
         return -1;
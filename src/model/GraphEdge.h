@@ -3,6 +3,7 @@
 
 #include <QString>
 #include <QJsonObject>
+#include "JsonProperties.h"
 
 class GraphEdge {
 public:
@@ -11,10 +12,11 @@ public:
     int sourceId;           // 对应 source_id
     int targetId;           // 对应 target_id
     QString relationType;   // 对应 relation_type
+    int typeId;             // 本体类型字典中的ID，由 TypeDictionary::resolve 填写，-1 表示未解析
     float weight;           // 对应 weight
-    QJsonObject properties; // 对应 properties (JSON)
+    JsonProperties properties; // 对应 properties (JSON)，首次访问时才解析
 
-    GraphEdge() : id(-1), ontologyId(-1), sourceId(-1), targetId(-1), weight(1.0f) {}
+    GraphEdge() : id(-1), ontologyId(-1), sourceId(-1), targetId(-1), typeId(-1), weight(1.0f) {}
 
     QJsonObject toJson() const;
     static GraphEdge fromJson(const QJsonObject& json);
@@ -3,20 +3,22 @@
 
 #include <QString>
 #include <QJsonObject>
+#include "JsonProperties.h"
 
 class GraphNode {
 public:
     int id;                 // 对应 node_id
     int ontologyId;         // 对应 ontology_id
     QString nodeType;       // 对应 node_type
+    int typeId;             // 本体类型字典中的ID，由 TypeDictionary::resolve 填写，-1 表示未解析
     QString name;           // 对应 name
     QString description;    // 对应 description
     float posX;             // 对应 pos_x
     float posY;             // 对应 pos_y
     QString color;          // 对应 color
-    QJsonObject properties; // 对应 properties (JSON)
+    JsonProperties properties; // 对应 properties (JSON)，首次访问时才解析
 
-    GraphNode() : id(-1), ontologyId(-1), posX(0.0f), posY(0.0f), color("#3498db") {}
+    GraphNode() : id(-1), ontologyId(-1), typeId(-1), posX(0.0f), posY(0.0f), color("#3498db") {}
 
     bool isValid() const {
         return id > 0 && ontologyId > 0 && !name.isEmpty() && !nodeType.isEmpty();
@@ -0,0 +1,195 @@
+#ifndef GRAPHSNAPSHOT_H
+#define GRAPHSNAPSHOT_H
+
+#include <QString>
+#include <QStringView>
+#include <QVector>
+#include <QHash>
+
+/**
+ * @brief 整个本体的紧凑只读副本，供分析、布局等批量计算使用
+ *
+ * 与 QList<GraphNode> 不同，节点和关系各是一段连续的定长记录，不含 QString / JSON 成员；
+ * 名称与颜色的字符连续存放在同一个字符串区 (arena) 中，记录里只存 (偏移, 长度)，颜色按写法去重。
+ * 关系端点直接存节点在 nodes() 中的下标，buildAdjacency() 之后可按 CSR 遍历出边/入边。
+ * 由 NodeRepository::fillSnapshot / RelationshipRepository::fillSnapshot 从查询结果直接填充，
+ * 只含拓扑投影所需的列 (不含 description / properties)。
+ */
+class GraphSnapshot {
+public:
+    // 字符串区中的一段
+    struct StringRef {
+        int offset = 0;
+        int length = 0;
+    };
+
+    struct NodeRecord {
+        int id;             // node_id
+        int typeId;         // TypeDictionary 中的节点类型ID
+        StringRef name;
+        StringRef color;
+        float posX;
+        float posY;
+    };
+
+    struct EdgeRecord {
+        int id;             // relation_id
+        int typeId;         // TypeDictionary 中的关系类型ID
+        int source;         // 起点在 nodes() 中的下标
+        int target;         // 终点在 nodes() 中的下标
+        float weight;
+    };
+
+    GraphSnapshot() : m_ontologyId(-1), m_adjacencyBuilt(false) {}
+
+    // 清空并指定所属本体；预估规模时可先 reserve
+    void reset(int ontologyId) {
+        m_ontologyId = ontologyId;
+        m_nodes.clear();
+        m_edges.clear();
+        m_arena.clear();
+        m_colorRefs.clear();
+        m_indexById.clear();
+        clearAdjacency();
+    }
+
+    void reserve(int nodeCount, int edgeCount, int averageNameLength = 12) {
+        m_nodes.reserve(nodeCount);
+        m_edges.reserve(edgeCount);
+        m_arena.reserve(nodeCount * averageNameLength);
+        m_indexById.reserve(nodeCount);
+    }
+
+    // --- 填充 ---
+    // 返回节点下标；同一 node_id 重复加入时覆盖原记录
+    int addNode(int id, int typeId, const QString& name, float posX, float posY, const QString& color) {
+        NodeRecord record;
+        record.id = id;
+        record.typeId = typeId;
+        record.name = store(name);
+        record.color = internColor(color);
+        record.posX = posX;
+        record.posY = posY;
+
+        auto it = m_indexById.constFind(id);
+        if (it != m_indexById.constEnd()) {
+            m_nodes[it.value()] = record;
+            return it.value();
+        }
+        m_indexById.insert(id, m_nodes.size());
+        m_nodes.append(record);
+        return m_nodes.size() - 1;
+    }
+
+    // 端点须已加入；端点不在快照中 (如另一端已被删除) 时丢弃并返回 false
+    bool addEdge(int id, int sourceId, int targetId, int typeId, float weight) {
+        int source = nodeIndex(sourceId);
+        int target = nodeIndex(targetId);
+        if (source < 0 || target < 0) return false;
+
+        m_edges.append({id, typeId, source, target, weight});
+        clearAdjacency();
+        return true;
+    }
+
+    // 按 CSR 整理出边/入边，关系全部加入后调用一次
+    void buildAdjacency() {
+        int n = m_nodes.size();
+        m_outOffsets.fill(0, n + 1);
+        m_inOffsets.fill(0, n + 1);
+        for (const EdgeRecord& e : m_edges) {
+            m_outOffsets[e.source + 1]++;
+            m_inOffsets[e.target + 1]++;
+        }
+        for (int i = 0; i < n; ++i) {
+            m_outOffsets[i + 1] += m_outOffsets[i];
+            m_inOffsets[i + 1] += m_inOffsets[i];
+        }
+
+        m_outEdges.resize(m_edges.size());
+        m_inEdges.resize(m_edges.size());
+        QVector<int> outPos = m_outOffsets;
+        QVector<int> inPos = m_inOffsets;
+        for (int e = 0; e < m_edges.size(); ++e) {
+            m_outEdges[outPos[m_edges[e].source]++] = e;
+            m_inEdges[inPos[m_edges[e].target]++] = e;
+        }
+        m_adjacencyBuilt = true;
+    }
+
+    // --- 读取 ---
+    int ontologyId() const { return m_ontologyId; }
+    int nodeCount() const { return m_nodes.size(); }
+    int edgeCount() const { return m_edges.size(); }
+    bool isEmpty() const { return m_nodes.isEmpty(); }
+
+    const QVector<NodeRecord>& nodes() const { return m_nodes; }
+    const QVector<EdgeRecord>& edges() const { return m_edges; }
+    const NodeRecord& node(int index) const { return m_nodes[index]; }
+    const EdgeRecord& edge(int index) const { return m_edges[index]; }
+
+    // node_id -> 下标，不在快照中返回 -1
+    int nodeIndex(int nodeId) const { return m_indexById.value(nodeId, -1); }
+
+    // 视图指向快照内部，快照修改或销毁后失效；需要长期保存时用 name()
+    QStringView nameView(int index) const { return text(m_nodes[index].name); }
+    QString name(int index) const { return nameView(index).toString(); }
+    QString color(int index) const { return text(m_nodes[index].color).toString(); }
+
+    // CSR 邻接，须先 buildAdjacency()；下标 i 的出边为 outEdges()[outOffsets()[i] .. outOffsets()[i + 1])
+    bool hasAdjacency() const { return m_adjacencyBuilt; }
+    const QVector<int>& outOffsets() const { return m_outOffsets; }
+    const QVector<int>& outEdges() const { return m_outEdges; }
+    const QVector<int>& inOffsets() const { return m_inOffsets; }
+    const QVector<int>& inEdges() const { return m_inEdges; }
+
+    int outDegree(int index) const { return m_outOffsets[index + 1] - m_outOffsets[index]; }
+    int inDegree(int index) const { return m_inOffsets[index + 1] - m_inOffsets[index]; }
+    int degree(int index) const { return outDegree(index) + inDegree(index); }
+
+private:
+    StringRef store(const QString& value) {
+        StringRef ref;
+        ref.offset = m_arena.size();
+        ref.length = value.size();
+        m_arena.append(value);
+        return ref;
+    }
+
+    // 颜色只有少数几种写法，相同写法共用一段
+    StringRef internColor(const QString& color) {
+        auto it = m_colorRefs.constFind(color);
+        if (it != m_colorRefs.constEnd()) return it.value();
+        StringRef ref = store(color);
+        m_colorRefs.insert(color, ref);
+        return ref;
+    }
+
+    QStringView text(const StringRef& ref) const {
+        return QStringView(m_arena.constData() + ref.offset, ref.length);
+    }
+
+    void clearAdjacency() {
+        if (!m_adjacencyBuilt) return;
+        m_outOffsets.clear();
+        m_outEdges.clear();
+        m_inOffsets.clear();
+        m_inEdges.clear();
+        m_adjacencyBuilt = false;
+    }
+
+    int m_ontologyId;
+    QVector<NodeRecord> m_nodes;
+    QVector<EdgeRecord> m_edges;
+    QString m_arena;                          // 所有名称与颜色的字符
+    QHash<QString, StringRef> m_colorRefs;
+    QHash<int, int> m_indexById;              // node_id -> 下标
+
+    bool m_adjacencyBuilt;
+    QVector<int> m_outOffsets;
+    QVector<int> m_outEdges;                  // 关系下标，按起点分组
+    QVector<int> m_inOffsets;
+    QVector<int> m_inEdges;                   // 关系下标，按终点分组
+};
+
+#endif // GRAPHSNAPSHOT_H
@@ -0,0 +1,82 @@
+#ifndef JSONPROPERTIES_H
+#define JSONPROPERTIES_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QJsonValue>
+#include <QDebug>
+
+/**
+ * @brief properties JSON 字段的延迟解析包装
+ *
+ * 从数据库读出时只保存原始 UTF-8 字节，第一次访问对象内容时才解析；
+ * 从未修改过的实体写回时直接返回原始字节，不再重新序列化。
+ * 可以像 QJsonObject 一样直接赋值。拷贝是隐式共享的，代价很小。
+ * 注意：const 访问也可能触发解析，同一个对象不要跨线程并发读取。
+ */
+class JsonProperties {
+public:
+    JsonProperties() : m_parsed(true), m_dirty(false) {}
+    JsonProperties(const QJsonObject& object) : m_object(object), m_parsed(true), m_dirty(true) {}
+
+    // 数据库读出的原始字节，解析推迟到首次访问
+    static JsonProperties fromRaw(const QByteArray& raw) {
+        JsonProperties props;
+        props.m_raw = raw;
+        props.m_parsed = raw.isEmpty();
+        return props;
+    }
+
+    const QJsonObject& object() const {
+        if (!m_parsed) {
+            QJsonParseError error;
+            QJsonDocument doc = QJsonDocument::fromJson(m_raw, &error);
+            if (doc.isObject()) {
+                m_object = doc.object();
+            } else {
+                qWarning() << "JsonProperties: JSON反序列化失败:" << error.errorString();
+            }
+            m_parsed = true;
+        }
+        return m_object;
+    }
+
+    QJsonValue value(const QString& key) const { return object().value(key); }
+    bool contains(const QString& key) const { return object().contains(key); }
+    bool isEmpty() const { return object().isEmpty(); }
+
+    void insert(const QString& key, const QJsonValue& value) {
+        object();
+        m_object.insert(key, value);
+        m_dirty = true;
+    }
+
+    void remove(const QString& key) {
+        object();
+        m_object.remove(key);
+        m_dirty = true;
+    }
+
+    /**
+     * @brief 写回数据库用的字节
+     * 未修改时原样返回读入的字节 (解析失败的内容也原样保留，不会被清空)
+     */
+    QByteArray toBytes() const {
+        if (!m_dirty && !m_raw.isEmpty()) return m_raw;
+        return QJsonDocument(object()).toJson(QJsonDocument::Compact);
+    }
+
+    bool isParsed() const { return m_parsed; }
+    bool isModified() const { return m_dirty; }
+
+    operator QJsonObject() const { return object(); }
+
+private:
+    QByteArray m_raw;
+    mutable QJsonObject m_object;
+    mutable bool m_parsed;
+    bool m_dirty;
+};
+
+#endif // JSONPROPERTIES_H
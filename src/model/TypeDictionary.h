@@ -0,0 +1,106 @@
+#ifndef TYPEDICTIONARY_H
+#define TYPEDICTIONARY_H
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include "GraphNode.h"
+#include "GraphEdge.h"
+
+/**
+ * @brief 本体内的类型字典：节点类型、关系类型各自编号为从 0 开始的小整数
+ *
+ * 一个本体通常只有几十种类型。实体由仓库读出或经 GraphEditor 通知时调用 resolve()，
+ * 填写 typeId 并让 nodeType/relationType 与字典共享同一份字符串 (隐式共享，不再各存一份)，
+ * 统计分组和类型过滤因此可以按整数进行，字符串只在显示时取用。
+ * 与数据库默认排序规则一致，只有大小写不同的类型归为同一 ID，显示名取首次出现的写法。
+ * ID 只在本次运行内有效，不写入数据库；字典只增不减，各线程可以同时使用。
+ */
+class TypeDictionary {
+public:
+    enum Kind { NodeTypes = 0, RelationTypes = 1 };
+
+    // 每个本体一份，首次访问时创建，进程内常驻
+    static TypeDictionary& forOntology(int ontologyId) {
+        static QMutex mutex;
+        static QHash<int, TypeDictionary*> dictionaries;
+        QMutexLocker locker(&mutex);
+        TypeDictionary*& dict = dictionaries[ontologyId];
+        if (!dict) dict = new TypeDictionary();
+        return *dict;
+    }
+
+    // 按实体的 nodeType/relationType 重新填写 typeId，修改类型后需要再次调用
+    static void resolve(GraphNode& node) {
+        if (node.ontologyId <= 0) { node.typeId = -1; return; }
+        node.typeId = forOntology(node.ontologyId).intern(NodeTypes, node.nodeType, &node.nodeType);
+    }
+
+    static void resolve(GraphEdge& edge) {
+        if (edge.ontologyId <= 0) { edge.typeId = -1; return; }
+        edge.typeId = forOntology(edge.ontologyId).intern(RelationTypes, edge.relationType, &edge.relationType);
+    }
+
+    /**
+     * @brief 取得类型 ID，新类型即时编号；空类型返回 -1
+     * @param shared 非空时改为指向字典中写法相同的字符串实例
+     */
+    int intern(Kind kind, const QString& name, QString* shared = nullptr) {
+        if (name.isEmpty()) return -1;
+
+        QMutexLocker locker(&m_mutex);
+        Table& table = m_tables[kind];
+
+        // 同样写法已出现过时不必折叠大小写
+        auto exact = table.exactIds.constFind(name);
+        if (exact == table.exactIds.constEnd()) {
+            QString key = name.toCaseFolded();
+            int id = table.foldedIds.value(key, -1);
+            if (id < 0) {
+                id = table.names.size();
+                table.names.append(name);
+                table.foldedIds.insert(key, id);
+            }
+            exact = table.exactIds.insert(name, id);
+        }
+
+        int id = exact.value();
+        if (shared) *shared = exact.key();
+        return id;
+    }
+
+    // 已编号的类型 ID，未出现过返回 -1
+    int find(Kind kind, const QString& name) const {
+        QMutexLocker locker(&m_mutex);
+        const Table& table = m_tables[kind];
+        auto exact = table.exactIds.constFind(name);
+        if (exact != table.exactIds.constEnd()) return exact.value();
+        return table.foldedIds.value(name.toCaseFolded(), -1);
+    }
+
+    QString name(Kind kind, int id) const {
+        QMutexLocker locker(&m_mutex);
+        return m_tables[kind].names.value(id);
+    }
+
+    int count(Kind kind) const {
+        QMutexLocker locker(&m_mutex);
+        return m_tables[kind].names.size();
+    }
+
+private:
+    struct Table {
+        QVector<QString> names;          // ID -> 显示名
+        QHash<QString, int> foldedIds;   // 折叠大小写后的名称 -> ID
+        QHash<QString, int> exactIds;    // 出现过的每种写法 -> ID
+    };
+
+    TypeDictionary() = default;
+
+    mutable QMutex m_mutex;
+    Table m_tables[2];
+};
+
+#endif // TYPEDICTIONARY_H
@@ -68,12 +68,13 @@ void SimpleRingChart::paintEvent(QPaintEvent *event) {
 // =================== 仪表盘主界面实现 ===================
 
 DashboardDialog::DashboardDialog(int ontologyId, QueryEngine* engine, QWidget *parent)
-    : QDialog(parent), m_ontologyId(ontologyId), m_engine(engine)
+    : QDialog(parent), m_ontologyId(ontologyId), m_engine(engine), m_analytics(nullptr)
 {
     setWindowTitle("项目数据仪表盘 (Data Dashboard)");
-    resize(750, 600); // 稍微加大窗口以容纳图表
+    resize(750, 800); // 稍微加大窗口以容纳图表和关键实体表
     setupUI();
     loadData();
+    loadKeyEntities();
 }
 
 DashboardDialog::~DashboardDialog() {}
@@ -150,6 +151,26 @@ void DashboardDialog::setupUI() {
     contentLayout->addWidget(edgeGroup);
     mainLayout->addLayout(contentLayout);
 
+    // --- 3. 底部：结构分析得出的关键实体 ---
+    QGroupBox* keyGroup = new QGroupBox("关键实体 (PageRank / 介数 / 接近度)", this);
+    QVBoxLayout* keyLayout = new QVBoxLayout(keyGroup);
+    m_keyTable = new QTableWidget(this);
+    m_keyTable->setColumnCount(4);
+    m_keyTable->setHorizontalHeaderLabels({"实体", "PageRank", "介数中心性", "接近中心性"});
+    m_keyTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    for (int col = 1; col < 4; ++col) {
+        m_keyTable->horizontalHeader()->setSectionResizeMode(col, QHeaderView::ResizeToContents);
+    }
+    m_keyTable->verticalHeader()->setVisible(false);
+    m_keyTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_keyTable->setSelectionMode(QAbstractItemView::NoSelection);
+    m_lblKeyStatus = new QLabel(this);
+    m_lblKeyStatus->setStyleSheet("color: #EBCB8B; font-size: 12px;");
+    m_lblKeyStatus->hide();
+    keyLayout->addWidget(m_keyTable);
+    keyLayout->addWidget(m_lblKeyStatus);
+    mainLayout->addWidget(keyGroup);
+
     // --- Nord 主题深度美化 ---
     this->setStyleSheet(R"(
         QDialog { background-color: #2E3440; color: #D8DEE9; }
@@ -188,40 +209,23 @@ void DashboardDialog::setupUI() {
 void DashboardDialog::loadData() {
     if (!m_engine) return;
 
-    QList<GraphNode> nodes = m_engine->getAllNodes(m_ontologyId);
-    QList<GraphEdge> edges = m_engine->getAllRelationships(m_ontologyId);
+    // 聚合由 QueryEngine 增量维护：只在首次打开该本体时读取一次拓扑快照，之后不再查库
+    const GraphStatistics* stats = m_engine->statistics(m_ontologyId);
+    if (!stats) return;
 
-    int totalNodes = nodes.size();
-    int totalEdges = edges.size();
+    int totalNodes = stats->nodeCount();
+    int totalEdges = stats->edgeCount();
 
     m_lblTotalNodes->setText(QString::number(totalNodes));
     m_lblTotalEdges->setText(QString::number(totalEdges));
 
-    // 计算度数最高的核心节点（关联关系最多的节点）
-    QMap<int, int> nodeDegrees;
-    for (const auto& edge : edges) {
-        nodeDegrees[edge.sourceId]++;
-        nodeDegrees[edge.targetId]++;
-    }
-
-    int maxDegree = 0;
-    int maxNodeId = -1;
-    for (auto it = nodeDegrees.begin(); it != nodeDegrees.end(); ++it) {
-        if (it.value() > maxDegree) {
-            maxDegree = it.value();
-            maxNodeId = it.key();
-        }
-    }
-
+    // 度数最高的核心节点（关联关系最多的节点），只需按ID读取它的名称
+    int maxDegree = stats->hubDegree();
     QString coreNodeName = "无数据";
-    if (maxNodeId != -1) {
-        for (const auto& node : nodes) {
-            if (node.id == maxNodeId) {
-                // 缩短超长名称
-                coreNodeName = node.name.length() > 8 ? node.name.left(8) + "..." : node.name;
-                break;
-            }
-        }
+    if (stats->hubNodeId() != -1) {
+        QString name = m_engine->getNodeById(stats->hubNodeId()).name;
+        // 缩短超长名称
+        coreNodeName = name.length() > 8 ? name.left(8) + "..." : name;
     }
     m_lblCoreNode->setText(coreNodeName);
     if(maxDegree > 0) {
@@ -229,8 +233,7 @@ void DashboardDialog::loadData() {
     }
 
     // --- 统计节点分布 ---
-    QMap<QString, int> nodeTypeCounts;
-    for (const auto& node : nodes) nodeTypeCounts[node.nodeType]++;
+    QMap<QString, int> nodeTypeCounts = stats->nodeTypeCounts();
 
     m_nodeChart->setData(nodeTypeCounts); // 渲染环形图
     m_nodeTable->setRowCount(nodeTypeCounts.size());
@@ -255,8 +258,7 @@ void DashboardDialog::loadData() {
     }
 
     // --- 统计关系分布 ---
-    QMap<QString, int> edgeTypeCounts;
-    for (const auto& edge : edges) edgeTypeCounts[edge.relationType]++;
+    QMap<QString, int> edgeTypeCounts = stats->edgeTypeCounts();
 
     m_edgeChart->setData(edgeTypeCounts); // 渲染环形图
     m_edgeTable->setRowCount(edgeTypeCounts.size());
@@ -277,4 +279,57 @@ void DashboardDialog::loadData() {
         m_edgeTable->setCellWidget(row, 2, pBar);
         row++;
     }
-}
\ No newline at end of file
+}
+
+void DashboardDialog::loadKeyEntities() {
+    if (!m_engine) return;
+
+    // 中心性在后台线程计算，不阻塞打开仪表盘：先显示上一次的结果并标明已过期，算完后再刷新
+    m_analytics = m_engine->analyticsAsync(m_ontologyId);
+    if (!m_analytics) return;
+    connect(m_analytics, &GraphAnalytics::metricsReady, this, [this](int ontologyId) {
+        if (ontologyId != m_ontologyId) return;
+        // 计算期间图又发生了变化时，在显示旧结果的同时再算一次
+        if (!m_analytics->isCurrent(m_ontologyId)) m_engine->analyticsAsync(m_ontologyId);
+        showKeyEntities();
+    });
+    showKeyEntities();
+}
+
+void DashboardDialog::showKeyEntities() {
+    const GraphAnalytics* analytics = m_analytics;
+    if (!analytics->hasMetrics(m_ontologyId)) {
+        m_keyTable->setRowCount(0);
+        m_lblKeyStatus->setText("⏳ 正在后台计算关键实体…");
+        m_lblKeyStatus->show();
+        return;
+    }
+    if (analytics->isCurrent(m_ontologyId)) {
+        m_lblKeyStatus->hide();
+    } else {
+        m_lblKeyStatus->setText("⚠ 图已变化，以下为上一次的结果，正在后台重新计算…");
+        m_lblKeyStatus->show();
+    }
+
+    const GraphSnapshot& graph = analytics->snapshot();
+    QList<int> top = analytics->topNodes(GraphAnalytics::PageRank, 10);
+
+    m_keyTable->setRowCount(top.size());
+    for (int row = 0; row < top.size(); ++row) {
+        int index = top[row];
+        m_keyTable->setItem(row, 0, new QTableWidgetItem(graph.name(index)));
+        m_keyTable->setItem(row, 1, new QTableWidgetItem(
+            QString::number(analytics->score(GraphAnalytics::PageRank, index), 'f', 5)));
+        m_keyTable->setItem(row, 2, new QTableWidgetItem(
+            QString::number(analytics->score(GraphAnalytics::Betweenness, index), 'f', 4)));
+        m_keyTable->setItem(row, 3, new QTableWidgetItem(
+            QString::number(analytics->score(GraphAnalytics::Closeness, index), 'f', 4)));
+    }
+
+    // 抽样时介数与接近度是估计值
+    bool sampled = analytics->sampleCount() < graph.nodeCount();
+    m_keyTable->setToolTip(QString("基于 %1 个节点、%2 条关系计算，耗时 %3 ms%4")
+                               .arg(graph.nodeCount()).arg(graph.edgeCount()).arg(analytics->elapsedMs())
+                               .arg(sampled ? QString("；介数与接近度由 %1 个抽样源点估计").arg(analytics->sampleCount())
+                                            : QString()));
+}
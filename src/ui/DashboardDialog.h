@@ -6,6 +6,7 @@
 #include <QWidget>
 
 class QueryEngine;
+class GraphAnalytics;
 class QTableWidget;
 class QLabel;
 
@@ -35,6 +36,8 @@ public:
 private:
     void setupUI();
     void loadData();
+    void loadKeyEntities();
+    void showKeyEntities();
     QWidget* createStatCard(const QString& title, QLabel*& valueLabel, const QString& icon);
 
     int m_ontologyId;
@@ -50,6 +53,9 @@ private:
 
     QTableWidget* m_nodeTable;
     QTableWidget* m_edgeTable;
+    QTableWidget* m_keyTable;     // 按 PageRank 排序的关键实体
+    QLabel* m_lblKeyStatus;       // 关键实体的计算状态 (计算中 / 已过期)
+    const GraphAnalytics* m_analytics;
 };
 
 #endif // DASHBOARDDIALOG_H
\ No newline at end of file
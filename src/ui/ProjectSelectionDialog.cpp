@@ -5,6 +5,8 @@
 #include "../database/RelationshipRepository.h"
 #include "../model/GraphNode.h"
 #include "../model/GraphEdge.h"
+#include "../business/OntologySnapshot.h"
+#include "../business/JsonLinesTransfer.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QInputDialog>
@@ -17,6 +19,8 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QSqlQuery>
+#include <QThread>
+#include <QProgressDialog>
 
 ProjectSelectionDialog::ProjectSelectionDialog(QWidget *parent)
     : QDialog(parent), m_selectedId(-1)
@@ -193,13 +197,23 @@ void ProjectSelectionDialog::onExportProject() {
     int projectId = item->data(Qt::UserRole).toInt();
     QString projectName = item->data(Qt::UserRole + 1).toString();
 
-    QString fileName = QFileDialog::getSaveFileName(this, "导出项目", projectName + "_导出.json", "JSON 文件 (*.json)");
+    QString fileName = QFileDialog::getSaveFileName(this, "导出项目", projectName + "_导出.json",
+                                                    "JSON 文件 (*.json);;JSON Lines 流式文件 (*.jsonl);;图谱快照 (*.kgsnap)");
     if (fileName.isEmpty()) return;
 
+    if (fileName.endsWith(".kgsnap", Qt::CaseInsensitive)) {
+        exportSnapshot(projectId, projectName, fileName);
+        return;
+    }
+    if (fileName.endsWith(".jsonl", Qt::CaseInsensitive)) {
+        exportJsonLines(projectId, projectName, fileName);
+        return;
+    }
+
     // 获取项目信息和图谱数据
     Ontology onto = OntologyRepository::getOntologyById(projectId);
-    QList<GraphNode> nodes = NodeRepository::getAllNodes(projectId);
-    QList<GraphEdge> edges = RelationshipRepository::getAllRelationships(projectId);
+    QList<GraphNode> nodes = NodeRepository::getAllNodes(projectId, Projection::Full);
+    QList<GraphEdge> edges = RelationshipRepository::getEdgesByOntology(projectId, Projection::Full);
 
     QJsonObject rootObj;
 
@@ -221,7 +235,7 @@ void ProjectSelectionDialog::onExportProject() {
         nodeObj["posX"] = node.posX;
         nodeObj["posY"] = node.posY;
         nodeObj["color"] = node.color;
-        nodeObj["properties"] = node.properties;
+        nodeObj["properties"] = node.properties.object();
         nodesArray.append(nodeObj);
     }
     rootObj["nodes"] = nodesArray;
@@ -234,7 +248,7 @@ void ProjectSelectionDialog::onExportProject() {
         edgeObj["targetId"] = edge.targetId;
         edgeObj["relationType"] = edge.relationType;
         edgeObj["weight"] = edge.weight;
-        edgeObj["properties"] = edge.properties;
+        edgeObj["properties"] = edge.properties.object();
         edgesArray.append(edgeObj);
     }
     rootObj["edges"] = edgesArray;
@@ -254,9 +268,20 @@ void ProjectSelectionDialog::onExportProject() {
 }
 
 void ProjectSelectionDialog::onImportProject() {
-    QString fileName = QFileDialog::getOpenFileName(this, "导入项目", "", "JSON 文件 (*.json)");
+    QString fileName = QFileDialog::getOpenFileName(this, "导入项目", "",
+                                                    "图谱项目 (*.json *.jsonl *.kgsnap);;JSON 文件 (*.json);;"
+                                                    "JSON Lines 流式文件 (*.jsonl);;图谱快照 (*.kgsnap)");
     if (fileName.isEmpty()) return;
 
+    if (fileName.endsWith(".kgsnap", Qt::CaseInsensitive)) {
+        importSnapshot(fileName);
+        return;
+    }
+    if (fileName.endsWith(".jsonl", Qt::CaseInsensitive)) {
+        importJsonLines(fileName);
+        return;
+    }
+
     QFile file(fileName);
     if (!file.open(QIODevice::ReadOnly)) {
         QMessageBox::warning(this, "错误", "无法读取文件！");
@@ -279,34 +304,9 @@ void ProjectSelectionDialog::onImportProject() {
     QString baseName = projectObj["name"].toString("导入的图谱项目");
     QString desc = projectObj["description"].toString("从外部 JSON 文件导入");
 
-    // --- 防重名处理：如果项目名称已存在，自动添加后缀 ---
-    QString finalName = baseName;
-    int counter = 1;
-    QList<Ontology> existingOntos = OntologyRepository::getAllOntologies();
-    auto nameExists = [&](const QString& name) {
-        for (const auto& o : existingOntos) {
-            if (o.name == name) return true;
-        }
-        return false;
-    };
-    while (nameExists(finalName)) {
-        finalName = baseName + "_" + QString::number(counter++);
-    }
-
-    // 1. 在数据库中创建一个全新的项目
-    QSqlDatabase db = DatabaseConnection::getDatabase();
-    QSqlQuery query(db);
-    query.prepare("INSERT INTO ontology (name, description) VALUES (:name, :desc)");
-    query.bindValue(":name", finalName);
-    query.bindValue(":desc", desc);
-
-    if (!query.exec()) {
-        QMessageBox::warning(this, "错误", "在数据库中创建项目失败！");
-        return;
-    }
-
-    // 拿到新创建的项目的专属 ID
-    int newProjectId = query.lastInsertId().toInt();
+    QString finalName;
+    int newProjectId = createImportedProject(baseName, desc, finalName);
+    if (newProjectId <= 0) return;
 
     // 2. 导入节点和连线 (包含关键的 ID 映射)
     QMap<int, int> idMapping;
@@ -358,4 +358,207 @@ void ProjectSelectionDialog::onImportProject() {
     loadProjects();
     QMessageBox::information(this, "导入完成",
         QString("成功导入为新项目 [%1]！\n包含 %2 个节点，%3 条连线。").arg(finalName).arg(importedNodes).arg(importedEdges));
-}
\ No newline at end of file
+}
+
+int ProjectSelectionDialog::createImportedProject(const QString& baseName, const QString& desc, QString& finalName) {
+    // --- 防重名处理：如果项目名称已存在，自动添加后缀 ---
+    finalName = baseName;
+    int counter = 1;
+    QList<Ontology> existingOntos = OntologyRepository::getAllOntologies();
+    auto nameExists = [&](const QString& name) {
+        for (const auto& o : existingOntos) {
+            if (o.name == name) return true;
+        }
+        return false;
+    };
+    while (nameExists(finalName)) {
+        finalName = baseName + "_" + QString::number(counter++);
+    }
+
+    // 1. 在数据库中创建一个全新的项目
+    QSqlDatabase db = DatabaseConnection::getDatabase();
+    QSqlQuery query(db);
+    query.prepare("INSERT INTO ontology (name, description) VALUES (:name, :desc)");
+    query.bindValue(":name", finalName);
+    query.bindValue(":desc", desc);
+
+    if (!query.exec()) {
+        QMessageBox::warning(this, "错误", "在数据库中创建项目失败！");
+        return -1;
+    }
+
+    // 拿到新创建的项目的专属 ID
+    return query.lastInsertId().toInt();
+}
+
+void ProjectSelectionDialog::exportSnapshot(int projectId, const QString& projectName, const QString& fileName) {
+    Ontology onto = OntologyRepository::getOntologyById(projectId);
+    QList<GraphNode> nodes = NodeRepository::getAllNodes(projectId, Projection::Full);
+    QList<GraphEdge> edges = RelationshipRepository::getEdgesByOntology(projectId, Projection::Full);
+
+    QString error;
+    if (!SnapshotWriter::write(fileName, onto, nodes, edges, &error)) {
+        QMessageBox::warning(this, "错误", "导出快照失败：" + error);
+        return;
+    }
+    QMessageBox::information(this, "导出成功",
+        QString("项目 [%1] 已导出为二进制快照！\n共包含 %2 个实体，%3 条关系。")
+        .arg(projectName).arg(nodes.size()).arg(edges.size()));
+}
+
+void ProjectSelectionDialog::importSnapshot(const QString& fileName) {
+    QProgressDialog* progress = new QProgressDialog("正在导入快照...", "取消", 0, 100, this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(300);
+
+    // 快照在后台连接上按批多行写入，GUI 线程只负责进度和结果
+    SnapshotImporter* worker = new SnapshotImporter(fileName);
+    QThread* thread = new QThread;
+    worker->moveToThread(thread);
+    beginTransfer(thread, [worker]() { worker->cancel(); });
+
+    connect(thread, &QThread::started, worker, &SnapshotImporter::run);
+    connect(worker, &SnapshotImporter::progress, progress, [progress](qint64 done, qint64 total) {
+        progress->setValue(total > 0 ? int(done * 100 / total) : 0);
+    });
+    connect(progress, &QProgressDialog::canceled, this, [this]() { if (m_cancelTransfer) m_cancelTransfer(); });
+    connect(worker, &SnapshotImporter::finished, this,
+            [this, progress](bool ok, int, const QString& projectName, int nodes, int edges, const QString& error) {
+        progress->disconnect(this);
+        progress->close();
+        progress->deleteLater();
+        if (endTransfer()) return;
+
+        if (ok) {
+            loadProjects();
+            QMessageBox::information(this, "导入完成",
+                QString("成功导入为新项目 [%1]！\n包含 %2 个节点，%3 条连线。").arg(projectName).arg(nodes).arg(edges));
+        } else {
+            QMessageBox::warning(this, "导入失败", "导入已全部撤销：" + error);
+        }
+    });
+    connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+
+    thread->start();
+}
+
+void ProjectSelectionDialog::exportJsonLines(int projectId, const QString& projectName, const QString& fileName) {
+    QProgressDialog* progress = new QProgressDialog("正在导出项目...", "取消", 0, 100, this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(300);
+
+    JsonLinesExporter* worker = new JsonLinesExporter(projectId, fileName);
+    QThread* thread = new QThread;
+    worker->moveToThread(thread);
+    // worker 线程正忙于传输，取消标志直接在 GUI 线程设置；线程要等 endTransfer() 才退出，worker 在此之前一直有效
+    beginTransfer(thread, [worker]() { worker->cancel(); });
+
+    connect(thread, &QThread::started, worker, &JsonLinesExporter::run);
+    connect(worker, &JsonLinesExporter::progress, progress, [progress](qint64 done, qint64 total) {
+        progress->setValue(total > 0 ? int(done * 100 / total) : 0);
+    });
+    connect(progress, &QProgressDialog::canceled, this, [this]() { if (m_cancelTransfer) m_cancelTransfer(); });
+    connect(worker, &JsonLinesExporter::finished, this,
+            [this, progress, projectName](bool ok, int nodes, int edges, const QString& error) {
+        progress->disconnect(this);
+        progress->close();
+        progress->deleteLater();
+        if (endTransfer()) return;
+
+        if (ok) {
+            QMessageBox::information(this, "导出成功",
+                QString("项目 [%1] 导出成功！\n共包含 %2 个实体，%3 条关系。").arg(projectName).arg(nodes).arg(edges));
+        } else {
+            QMessageBox::warning(this, "导出失败", "导出未完成：" + error);
+        }
+    });
+    connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+
+    thread->start();
+}
+
+void ProjectSelectionDialog::importJsonLines(const QString& fileName) {
+    QProgressDialog* progress = new QProgressDialog("正在导入项目...", "取消", 0, 100, this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(300);
+
+    JsonLinesImporter* worker = new JsonLinesImporter(fileName);
+    QThread* thread = new QThread;
+    worker->moveToThread(thread);
+    beginTransfer(thread, [worker]() { worker->cancel(); });
+
+    connect(thread, &QThread::started, worker, &JsonLinesImporter::run);
+    connect(worker, &JsonLinesImporter::progress, progress, [progress](qint64 bytesRead, qint64 totalBytes) {
+        progress->setValue(totalBytes > 0 ? int(bytesRead * 100 / totalBytes) : 0);
+    });
+    connect(progress, &QProgressDialog::canceled, this, [this]() { if (m_cancelTransfer) m_cancelTransfer(); });
+    connect(worker, &JsonLinesImporter::finished, this,
+            [this, progress](bool ok, int ontologyId, const QString& projectName,
+                             int nodes, int edges, const QString& error) {
+        progress->disconnect(this);
+        progress->close();
+        progress->deleteLater();
+        if (endTransfer()) return;
+
+        loadProjects();
+        if (ok) {
+            QMessageBox::information(this, "导入完成",
+                QString("成功导入为新项目 [%1]！\n包含 %2 个节点，%3 条连线。").arg(projectName).arg(nodes).arg(edges));
+        } else if (ontologyId > 0) {
+            QMessageBox::warning(this, "导入中断",
+                QString("项目 [%1] 只导入了部分数据 (%2 个节点，%3 条连线)：%4")
+                .arg(projectName).arg(nodes).arg(edges).arg(error));
+        } else {
+            QMessageBox::warning(this, "导入失败", error);
+        }
+    });
+    connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+
+    thread->start();
+}
+
+// --- 后台传输的生命周期 ---
+
+void ProjectSelectionDialog::beginTransfer(QThread* thread, const std::function<void()>& cancel) {
+    m_transferThread = thread;
+    m_cancelTransfer = cancel;
+}
+
+bool ProjectSelectionDialog::endTransfer() {
+    if (m_transferThread) m_transferThread->quit();
+    m_transferThread = nullptr;
+    m_cancelTransfer = nullptr;
+    if (!m_closeAfterTransfer) return false;
+
+    m_closeAfterTransfer = false;
+    QDialog::done(m_closeResult);
+    return true;
+}
+
+void ProjectSelectionDialog::done(int result) {
+    if (m_transferThread && m_transferThread->isRunning()) {
+        if (m_closeAfterTransfer) return;   // 已在等待取消完成
+        if (QMessageBox::question(this, "传输进行中", "项目导入/导出尚未完成，是否取消并关闭？")
+            != QMessageBox::Yes) {
+            return;
+        }
+        // 已写入的数据保持原样，关闭推迟到 worker 报告结束之后
+        m_closeAfterTransfer = true;
+        m_closeResult = result;
+        if (m_cancelTransfer) m_cancelTransfer();
+        return;
+    }
+    QDialog::done(result);
+}
+
+ProjectSelectionDialog::~ProjectSelectionDialog() {
+    // 走到这里说明没有经过 done() (如父窗口直接销毁)，取消后同步等待线程退出
+    if (m_transferThread) {
+        if (m_cancelTransfer) m_cancelTransfer();
+        m_transferThread->quit();
+        m_transferThread->wait();
+    }
+}
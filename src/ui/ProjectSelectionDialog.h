@@ -5,6 +5,9 @@
 #include <QListWidget>
 #include <QPushButton>
 #include <QLabel>
+#include <QPointer>
+#include <QThread>
+#include <functional>
 // 移除了不必要的动画相关头文件
 
 class ProjectSelectionDialog : public QDialog
@@ -12,9 +15,15 @@ class ProjectSelectionDialog : public QDialog
     Q_OBJECT
 public:
     explicit ProjectSelectionDialog(QWidget *parent = nullptr);
+    // 后台传输仍在进行时取消并等待线程结束
+    ~ProjectSelectionDialog() override;
     int getSelectedOntologyId() const;
     QString getSelectedOntologyName() const;
 
+public slots:
+    // 后台传输进行中时先询问，确认后取消传输，待线程结束再关闭
+    void done(int result) override;
+
 private slots:
     void loadProjects();
     void onCreateProject();
@@ -27,6 +36,17 @@ private slots:
 
 private:
     void setupUI();
+    // 以不重名的名称新建导入目标项目，返回新项目 ID，失败返回 -1
+    int createImportedProject(const QString& baseName, const QString& desc, QString& finalName);
+    void exportSnapshot(int projectId, const QString& projectName, const QString& fileName);
+    void importSnapshot(const QString& fileName);
+    // JSON Lines 流式导入导出，在后台线程执行并显示进度
+    void exportJsonLines(int projectId, const QString& projectName, const QString& fileName);
+    void importJsonLines(const QString& fileName);
+    // 登记正在进行的传输线程及其取消方式；线程不挂在对话框下，由 finished 自行 deleteLater
+    void beginTransfer(QThread* thread, const std::function<void()>& cancel);
+    // worker 的 finished 回调开头调用，让线程退出；因关闭对话框而取消时完成关闭并返回 true
+    bool endTransfer();
     // 移除了 setupAnimations() 和 triggerShake()
 
     QListWidget* m_projectList;
@@ -40,6 +60,11 @@ private:
 
     int m_selectedId;
     QString m_selectedName;
+
+    QPointer<QThread> m_transferThread;
+    std::function<void()> m_cancelTransfer;
+    bool m_closeAfterTransfer = false;
+    int m_closeResult = QDialog::Rejected;
 };
 
 #endif // PROJECTSELECTIONDIALOG_H
@@ -8,13 +8,14 @@
 #include <QLabel>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
+#include "../database/NodeRepository.h"
 
 class QueryDialog : public QDialog {
     Q_OBJECT
 public:
     explicit QueryDialog(QWidget* parent = nullptr) : QDialog(parent) {
         setWindowTitle("属性查询");
-        resize(300, 150);
+        resize(300, 180);
 
         QVBoxLayout* layout = new QVBoxLayout(this);
 
@@ -22,11 +23,24 @@ public:
         QHBoxLayout* h1 = new QHBoxLayout();
         h1->addWidget(new QLabel("属性名:", this));
         attrNameCombo = new QComboBox(this);
-        attrNameCombo->addItem("name"); // 目前支持按名称
-        attrNameCombo->addItem("type"); // 和类型查询
+        attrNameCombo->addItem("name");
+        attrNameCombo->addItem("type");
+        attrNameCombo->addItem("description");
+        // 可直接输入扩展属性名或 properties 中的 JSON 键
+        attrNameCombo->setEditable(true);
         h1->addWidget(attrNameCombo);
         layout->addLayout(h1);
 
+        // 匹配方式 (精确/前缀可走索引)
+        QHBoxLayout* h3 = new QHBoxLayout();
+        h3->addWidget(new QLabel("匹配:", this));
+        matchModeCombo = new QComboBox(this);
+        matchModeCombo->addItem("包含", NodeRepository::MatchContains);
+        matchModeCombo->addItem("前缀", NodeRepository::MatchPrefix);
+        matchModeCombo->addItem("精确", NodeRepository::MatchExact);
+        h3->addWidget(matchModeCombo);
+        layout->addLayout(h3);
+
         // 属性值输入
         QHBoxLayout* h2 = new QHBoxLayout();
         h2->addWidget(new QLabel("属性值:", this));
@@ -63,11 +77,15 @@ public:
         )");
     }
 
-    QString getAttrName() const { return attrNameCombo->currentText(); }
+    QString getAttrName() const { return attrNameCombo->currentText().trimmed(); }
     QString getAttrValue() const { return attrValueEdit->text(); }
+    NodeRepository::MatchMode getMatchMode() const {
+        return static_cast<NodeRepository::MatchMode>(matchModeCombo->currentData().toInt());
+    }
 
 private:
     QComboBox* attrNameCombo;
+    QComboBox* matchModeCombo;
     QLineEdit* attrValueEdit;
     QPushButton* okButton;
     QPushButton* cancelButton;
@@ -16,7 +16,7 @@
 #include <QtMath>
 
 VisualNode::VisualNode(int id, QString name, QString type, qreal x, qreal y)
-    : m_id(id), m_name(name), m_nodeType(type)
+    : m_id(id), m_name(name), m_nodeType(type), m_community(-1)
 {
     int radius = 35;
     setRect(-radius, -radius, radius * 2, radius * 2);
@@ -122,7 +122,15 @@ void VisualNode::paint(QPainter *painter, const QStyleOptionGraphicsItem *option
         "#88C0D0", // 冰蓝
         "#81A1C1"  // 灰蓝
     };
-    QColor baseColor(nordColors[m_id % nordColors.size()]);
+    // 同一社区同色：前几个 (最大的) 社区用调色板，其余按黄金角旋转色相，保持同样的低饱和度
+    QColor baseColor;
+    if (m_community < 0) {
+        baseColor = QColor(nordColors[m_id % nordColors.size()]);
+    } else if (m_community < nordColors.size()) {
+        baseColor = QColor(nordColors[m_community]);
+    } else {
+        baseColor = QColor::fromHsv(int(m_community * 137.508) % 360, 90, 200);
+    }
 
     // ========== 1. 扁平化节点本体 ==========
     painter->setBrush(baseColor);
@@ -137,6 +145,13 @@ void VisualNode::paint(QPainter *painter, const QStyleOptionGraphicsItem *option
         painter->drawEllipse(QPointF(0, 0), coreRadius + 6, coreRadius + 6);
     }
 }
+
+void VisualNode::setCommunity(int community) {
+    if (m_community == community) return;
+    m_community = community;
+    update();
+}
+
 int VisualNode::getMass() const {
     int seed = m_id * 137;
     int style = seed % 3; // 不用哈希，仅依赖ID生成样式
@@ -18,6 +18,10 @@ public:
     // 获取节点 ID
     int getId() const { return m_id; }
 
+    // 所属社区 (由 QueryEngine::communityOf 给出)，-1 表示未知，此时按 ID 取色
+    void setCommunity(int community);
+    int getCommunity() const { return m_community; }
+
     // UserType 是 Qt 预留的起始值，+1 避免冲突
     enum { Type = UserType + 1 };
     int type() const override { return Type; }
@@ -34,6 +38,7 @@ private:
     int m_id;
     QString m_name;
     QString m_nodeType;
+    int m_community;
 
     struct EdgeInfo {
         QGraphicsLineItem* line;
@@ -1,15 +1,12 @@
 #include "aitextimportdialog.h"
+#include "../business/AIExtractionPipeline.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QNetworkRequest>
 #include <QMessageBox>
 #include <QUrl>
-#include <QSslConfiguration>
-#include <QSslSocket>
 
-AITextImportDialog::AITextImportDialog(QWidget *parent) : QDialog(parent) {
+AITextImportDialog::AITextImportDialog(QWidget *parent)
+    : QDialog(parent), m_pipeline(new AIExtractionPipeline(this)), m_nodeCount(0), m_edgeCount(0) {
     setWindowTitle("AI 智能文本知识抽取");
     resize(600, 500);
 
@@ -25,6 +22,13 @@ AITextImportDialog::AITextImportDialog(QWidget *parent) : QDialog(parent) {
     keyLayout->addWidget(m_apiKeyInput);
     mainLayout->addLayout(keyLayout);
 
+    // 接口地址，兼容 OpenAI chat/completions 协议即可，调试时可指向本地模拟服务
+    QHBoxLayout *endpointLayout = new QHBoxLayout();
+    endpointLayout->addWidget(new QLabel("接口地址: ", this));
+    m_endpointInput = new QLineEdit(AIExtractionPipeline::kDefaultEndpoint, this);
+    endpointLayout->addWidget(m_endpointInput);
+    mainLayout->addLayout(endpointLayout);
+
     // 2. 文本输入区
     mainLayout->addWidget(new QLabel("请输入文本 :", this));
     m_textInput = new QTextEdit(this);
@@ -43,9 +47,18 @@ AITextImportDialog::AITextImportDialog(QWidget *parent) : QDialog(parent) {
     bottomLayout->addWidget(m_btnStart);
     mainLayout->addLayout(bottomLayout);
 
-    // 网络管理器
-    m_networkManager = new QNetworkAccessManager(this);
-    connect(m_networkManager, &QNetworkAccessManager::finished, this, &AITextImportDialog::onNetworkReply);
+    // 抽取流水线：流式解析出的实体直接转发给主窗口入库
+    connect(m_pipeline, &AIExtractionPipeline::chunkExtracted, this, [this](QJsonArray nodes, QJsonArray edges) {
+        m_nodeCount += nodes.size();
+        m_edgeCount += edges.size();
+        m_statusLabel->setText(QString("抽取中: 已发现 %1 个节点, %2 条关系").arg(m_nodeCount).arg(m_edgeCount));
+        emit dataExtracted(nodes, edges);
+    });
+    connect(m_pipeline, &AIExtractionPipeline::progress, this, &AITextImportDialog::onExtractionProgress);
+    connect(m_pipeline, &AIExtractionPipeline::finished, this, &AITextImportDialog::onExtractionFinished);
+    connect(m_pipeline, &AIExtractionPipeline::failed, this, &AITextImportDialog::onExtractionFailed);
+    // 中途关闭窗口时停止剩余请求
+    connect(this, &QDialog::rejected, m_pipeline, &AIExtractionPipeline::cancel);
     connect(m_btnStart, &QPushButton::clicked, this, &AITextImportDialog::onStartExtraction);
 
     // 沿用 Nord 风格
@@ -62,93 +75,51 @@ AITextImportDialog::AITextImportDialog(QWidget *parent) : QDialog(parent) {
 void AITextImportDialog::onStartExtraction() {
     QString apiKey = m_apiKeyInput->text().trimmed();
     QString text = m_textInput->toPlainText().trimmed();
+    QUrl endpoint(m_endpointInput->text().trimmed());
 
     if (apiKey.isEmpty() || text.isEmpty()) {
         QMessageBox::warning(this, "提示", "API Key 和文本内容不能为空！");
         return;
     }
+    if (!endpoint.isValid() || endpoint.scheme().isEmpty()) {
+        QMessageBox::warning(this, "提示", "接口地址无效！");
+        return;
+    }
 
     m_btnStart->setEnabled(false);
     m_btnStart->setText("正在思考与提取中...");
     m_statusLabel->setText("正在请求大模型，请稍候...");
+    m_nodeCount = 0;
+    m_edgeCount = 0;
 
-    // 1. 组装发送的请求 JSON
-    QJsonObject systemMsg;
-    systemMsg["role"] = "system";
-    systemMsg["content"] = "你是一个知识图谱专家。请从用户提供的文本中提取实体作为节点，提取实体间的关系作为连线。"
-                           "你必须严格返回合法的JSON格式，且绝对不要包含Markdown代码块符号(如```json)。"
-                           "JSON的格式必须为: {\"nodes\": [{\"name\":\"实体名\", \"nodeType\":\"类型(如概念/实体/方法)\", \"description\":\"一句话描述\"}], "
-                           "\"edges\": [{\"sourceName\":\"起点实体名\", \"targetName\":\"终点实体名\", \"relationType\":\"关系词\"}]}";
-
-    QJsonObject userMsg;
-    userMsg["role"] = "user";
-    userMsg["content"] = text;
-
-    QJsonArray messages;
-    messages.append(systemMsg);
-    messages.append(userMsg);
-
-    QJsonObject requestBody;
-    requestBody["model"] = "Qwen/Qwen2.5-7B-Instruct";
-    requestBody["messages"] = messages;
-    requestBody["response_format"] = QJsonObject{{"type", "json_object"}};
-
-    // 2. 核心修复：直接创建 Request 并设置 URL，去掉那个会误报的 isValid() 检查
-    QNetworkRequest request;
-    request.setUrl(QUrl("https://api.siliconflow.cn/v1/chat/completions"));
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    request.setRawHeader("Authorization", ("Bearer " + apiKey).toUtf8());
-
-    // 3. 增加 SSL 兼容配置，跳过 Linux 下可能存在的本地证书校验问题
-    QSslConfiguration sslConfig = QSslConfiguration::defaultConfiguration();
-    sslConfig.setPeerVerifyMode(QSslSocket::VerifyNone);
-    sslConfig.setProtocol(QSsl::AnyProtocol);
-    request.setSslConfiguration(sslConfig);
-
-    // 4. 发送请求
-    m_networkManager->post(request, QJsonDocument(requestBody).toJson());
+    m_pipeline->setEndpoint(endpoint);
+    m_pipeline->setApiKey(apiKey);
+    m_pipeline->start(text);
 }
-void AITextImportDialog::onNetworkReply(QNetworkReply* reply) {
-    m_btnStart->setEnabled(true);
-    m_btnStart->setText("智能抽取并导入");
 
-    if (reply->error() != QNetworkReply::NoError) {
-        m_statusLabel->setText("请求失败！");
-        QMessageBox::critical(this, "网络错误", reply->errorString());
-        reply->deleteLater();
-        return;
-    }
-
-    QByteArray responseData = reply->readAll();
-    QJsonDocument jsonDoc = QJsonDocument::fromJson(responseData);
-    QJsonObject jsonObj = jsonDoc.object();
+void AITextImportDialog::onExtractionProgress(int finishedChunks, int totalChunks) {
+    m_statusLabel->setText(QString("已完成 %1/%2 段: 发现 %3 个节点, %4 条关系")
+                               .arg(finishedChunks).arg(totalChunks).arg(m_nodeCount).arg(m_edgeCount));
+}
 
-    // 提取大模型的回答内容
-    QString aiContent = jsonObj["choices"].toArray()[0].toObject()["message"].toObject()["content"].toString();
-    
-    // 清理可能误带的 Markdown 代码块标签
-    if (aiContent.startsWith("```json")) aiContent.remove(0, 7);
-    if (aiContent.startsWith("```")) aiContent.remove(0, 3);
-    if (aiContent.endsWith("```")) aiContent.chop(3);
-
-    QJsonDocument resultDoc = QJsonDocument::fromJson(aiContent.toUtf8());
-    if (resultDoc.isNull() || !resultDoc.isObject()) {
-        m_statusLabel->setText("解析失败！");
-        QMessageBox::warning(this, "解析错误", "大模型返回的格式不符合要求，请重试！");
-        reply->deleteLater();
-        return;
+void AITextImportDialog::onExtractionFinished(int nodeCount, int edgeCount, int failedChunks) {
+    m_btnStart->setEnabled(true);
+    m_btnStart->setText("智能抽取并导入");
+    QString summary = QString("提取成功: 发现 %1 个节点, %2 条关系").arg(nodeCount).arg(edgeCount);
+    if (m_pipeline->cacheHits() > 0) summary += QString(" (%1 段命中缓存)").arg(m_pipeline->cacheHits());
+    m_statusLabel->setText(summary);
+
+    if (failedChunks > 0) {
+        QMessageBox::warning(this, "部分失败", QString("有 %1 个文本分段多次重试后仍未成功，其余结果已导入。").arg(failedChunks));
+    } else {
+        QMessageBox::information(this, "成功", "提取完毕，已导入画板！");
     }
-
-    QJsonObject resultObj = resultDoc.object();
-    QJsonArray nodes = resultObj["nodes"].toArray();
-    QJsonArray edges = resultObj["edges"].toArray();
-
-    m_statusLabel->setText(QString("提取成功: 发现 %1 个节点, %2 条关系").arg(nodes.size()).arg(edges.size()));
-    
-    // 将数据发送给主窗口处理入库
-    emit dataExtracted(nodes, edges);
-    
-    QMessageBox::information(this, "成功", "提取完毕，即将导入画板！");
     accept(); // 关闭窗口
-    reply->deleteLater();
-}
\ No newline at end of file
+}
+
+void AITextImportDialog::onExtractionFailed(const QString& error) {
+    m_btnStart->setEnabled(true);
+    m_btnStart->setText("智能抽取并导入");
+    m_statusLabel->setText("请求失败！");
+    QMessageBox::critical(this, "网络错误", error);
+}
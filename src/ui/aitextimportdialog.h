@@ -5,30 +5,35 @@
 #include <QTextEdit>
 #include <QLineEdit>
 #include <QPushButton>
-#include <QNetworkAccessManager>
-#include <QNetworkReply>
 #include <QJsonArray>
 #include <QLabel>
 
+class AIExtractionPipeline;
+
 class AITextImportDialog : public QDialog {
     Q_OBJECT
 public:
     explicit AITextImportDialog(QWidget *parent = nullptr);
 
     signals:
-        // 当 AI 成功解析并提取出数据后，触发此信号给主窗口
+        // 每个分段抽取完成后触发一次，只包含去重后新出现的实体，主窗口可边抽取边入库
         void dataExtracted(QJsonArray nodes, QJsonArray edges);
 
 private slots:
     void onStartExtraction();
-    void onNetworkReply(QNetworkReply* reply);
+    void onExtractionProgress(int finishedChunks, int totalChunks);
+    void onExtractionFinished(int nodeCount, int edgeCount, int failedChunks);
+    void onExtractionFailed(const QString& error);
 
 private:
     QTextEdit* m_textInput;
     QLineEdit* m_apiKeyInput;
+    QLineEdit* m_endpointInput;
     QPushButton* m_btnStart;
     QLabel* m_statusLabel;
-    QNetworkAccessManager* m_networkManager;
+    AIExtractionPipeline* m_pipeline;
+    int m_nodeCount;
+    int m_edgeCount;
 };
 
 #endif // AITEXTIMPORTDIALOG_H
\ No newline at end of file
@@ -11,8 +11,12 @@
 #include "../database/RelationshipRepository.h"
 #include "../business/ForceDirectedLayout.h"
 #include "../database/DatabaseConnection.h"
+#include "../database/MemoryGraphStore.h"
 #include "../business/GraphEditor.h"
 #include "../business/QueryEngine.h"
+#include "../business/SearchIndex.h"
+#include "../business/GraphUndoStack.h"
+#include "../business/ChangeFeed.h"
 #include <QGraphicsTextItem>
 #include <QCoreApplication>
 #include <QDebug>
@@ -26,8 +30,10 @@
 #include <QToolBar>
 #include <QtMath>
 #include <QRandomGenerator>
+#include <QSet>
 #include <QContextMenuEvent>
 #include <QMenu>
+#include <QKeySequence>
 #include <QDockWidget>
 #include <QGroupBox>
 #include <QVBoxLayout>
@@ -39,6 +45,12 @@
 #include <QFrame>
 #include <QTextEdit>
 #include <QPushButton>
+#include <QInputDialog>
+#include <QLineEdit>
+#include <QCompleter>
+#include <QStringListModel>
+#include <QListWidget>
+#include <QDialogButtonBox>
 
 QWidget* createSliderRow(QWidget* parent, const QString& labelText, int min, int max, int val, const QString& suffix, std::function<void(int)> callback) {
     QWidget* widget = new QWidget(parent);
@@ -85,6 +97,11 @@ MainWindow::MainWindow(int ontologyId, QString ontologyName,User currentUser, QW
     // 1. 初始化后端
     m_graphEditor = new GraphEditor(this);
     m_queryEngine = new QueryEngine(this);
+    m_searchIndex = new SearchIndex(this);
+    m_searchIndex->attachTo(m_graphEditor);
+    m_queryEngine->attachTo(m_graphEditor);
+    m_undoStack = new GraphUndoStack(m_graphEditor, this);
+    m_changeFeed = new ChangeFeed(m_graphEditor, this);
     // 2. 初始化可视化场景
     m_scene = new QGraphicsScene(this);
     m_scene->setSceneRect(-5000, -5000, 10000, 10000);
@@ -184,10 +201,16 @@ MainWindow::MainWindow(int ontologyId, QString ontologyName,User currentUser, QW
 }
 
 MainWindow::~MainWindow() {
+    // 退出前把内存存储写成快照，下次打开免去全量读库
+    MemoryGraphStore::unload();
     delete ui;
 }
 
 void MainWindow::loadInitialData() {
+    // 先记下日志位置再全量加载，加载期间他人的修改由增量同步补上
+    m_changeFeed->start(m_currentOntologyId);
+    MemoryGraphStore::load(m_currentOntologyId);
+    m_searchIndex->rebuild(m_currentOntologyId);
     onQueryFullGraph();
 }
 
@@ -196,6 +219,14 @@ void MainWindow::setupConnections() {
     connect(ui->actionDelete, &QAction::triggered, this, &MainWindow::onActionDeleteTriggered);
     QAction* actionAIImport = ui->menu_E->addAction("智能文本导入");
     connect(actionAIImport, &QAction::triggered, this, &MainWindow::onActionAIImportTriggered);
+    m_actionUndo = ui->menu_E->addAction("撤销");
+    m_actionUndo->setShortcut(QKeySequence::Undo);
+    m_actionRedo = ui->menu_E->addAction("重做");
+    m_actionRedo->setShortcut(QKeySequence::Redo);
+    connect(m_actionUndo, &QAction::triggered, this, &MainWindow::onActionUndoTriggered);
+    connect(m_actionRedo, &QAction::triggered, this, &MainWindow::onActionRedoTriggered);
+    connect(m_undoStack, &GraphUndoStack::stateChanged, this, &MainWindow::onUndoStateChanged);
+    onUndoStateChanged();
     // 节点相关信号
     connect(m_graphEditor, &GraphEditor::nodeAdded, this, &MainWindow::onNodeAdded);
     connect(m_graphEditor, &GraphEditor::graphChanged, this, &MainWindow::onGraphChanged);
@@ -207,6 +238,7 @@ void MainWindow::setupConnections() {
     connect(m_graphEditor, &GraphEditor::relationshipDeleted, this, &MainWindow::onRelationshipDeleted);
     connect(m_graphEditor, &GraphEditor::nodeUpdated, this, &MainWindow::onNodeUpdated);
     connect(m_graphEditor, &GraphEditor::relationshipUpdated, this, &MainWindow::onRelationshipUpdated);
+    connect(m_graphEditor, &GraphEditor::changeSetCommitted, this, &MainWindow::onChangeSetCommitted);
 
 }
 
@@ -248,15 +280,30 @@ void MainWindow::onActionDeleteTriggered() {
     QList<QGraphicsItem*> selectedSceneItems = m_scene->selectedItems();
     if (!selectedSceneItems.isEmpty()) {
         if (QMessageBox::question(this, "确认删除", "确定要删除选中的实体及其关联吗？") == QMessageBox::Yes) {
-            for(auto item : selectedSceneItems) {
+            // 先记下 ID：场景项会在提交后统一移除
+            QSet<int> nodeIds;
+            QList<VisualEdge*> edges;
+            for (auto item : selectedSceneItems) {
                 if (item->type() == VisualNode::Type) {
-                    int id = item->data(0).toInt();
-                    m_graphEditor->deleteNode(id);
+                    nodeIds.insert(item->data(0).toInt());
                 } else if (item->type() == VisualEdge::Type) {
-                    VisualEdge* edge = qgraphicsitem_cast<VisualEdge*>(item);
-                    m_graphEditor->deleteRelationship(edge->getId());
+                    edges.append(qgraphicsitem_cast<VisualEdge*>(item));
                 }
             }
+
+            // 一个事务删除，提交时只刷新一次界面，也只产生一条撤销记录
+            GraphEditor::BatchGuard batch(m_graphEditor, "删除选中项");
+            for (VisualEdge* edge : edges) {
+                // 端点也在删除之列的关系会被级联删除
+                VisualNode* src = edge->getSourceNode();
+                VisualNode* dst = edge->getDestNode();
+                if ((src && nodeIds.contains(src->getId())) || (dst && nodeIds.contains(dst->getId()))) continue;
+                m_graphEditor->deleteRelationship(edge->getId());
+            }
+            m_graphEditor->deleteNodes(nodeIds.values());
+            if (batch.isActive() && !batch.commit()) {
+                QMessageBox::warning(this, "删除失败", "删除未能提交，数据已恢复。");
+            }
         }
         return; // 处理完毕退出
     }
@@ -613,6 +660,24 @@ void MainWindow::setupToolbar() {
     actPath->setToolTip("先选中两个节点，然后点击此按钮");
     connect(actPath, &QAction::triggered, this, &MainWindow::onQueryPath);
 
+    QAction* actPattern = toolbar->addAction("模式查询");
+    actPattern->setToolTip("输入图模式语句，例如 (a:Database)-[:使用]->(b) WHERE a.name ~ 'SQL' RETURN a,b");
+    connect(actPattern, &QAction::triggered, this, &MainWindow::onQueryPattern);
+
+    // 边输入边搜：由内存倒排索引支撑，不访问数据库
+    m_searchEdit = new QLineEdit(toolbar);
+    m_searchEdit->setPlaceholderText("搜索实体 (支持前缀，\"短语\")");
+    m_searchEdit->setClearButtonEnabled(true);
+    m_searchEdit->setMaximumWidth(260);
+    m_searchModel = new QStringListModel(this);
+    m_searchCompleter = new QCompleter(m_searchModel, this);
+    m_searchCompleter->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+    m_searchEdit->setCompleter(m_searchCompleter);
+    toolbar->addWidget(m_searchEdit);
+    connect(m_searchEdit, &QLineEdit::textEdited, this, &MainWindow::onSearchTextEdited);
+    connect(m_searchCompleter, QOverload<const QString&>::of(&QCompleter::activated),
+            this, &MainWindow::onSearchHitActivated);
+
     toolbar->addSeparator();
 
     // 属性面板切换按钮 ---
@@ -646,6 +711,10 @@ void MainWindow::onQueryFullGraph() {
     // 1. 获取数据
     QList<GraphNode> nodes = m_queryEngine->getAllNodes(m_currentOntologyId);
     QList<GraphEdge> edges = m_queryEngine->getAllRelationships(m_currentOntologyId);
+    // 社区划分在后台计算 (图未变化时直接取缓存)：drawNode 先按上一次的划分着色，算完后由 onCommunitiesReady 刷新
+    if (const GraphAnalytics* analytics = m_queryEngine->communitiesAsync(m_currentOntologyId)) {
+        connect(analytics, &GraphAnalytics::communitiesReady, this, &MainWindow::onCommunitiesReady, Qt::UniqueConnection);
+    }
 
     // 2. 清空视图
     m_scene->clear();
@@ -655,7 +724,7 @@ void MainWindow::onQueryFullGraph() {
     m_timer->start(30);
     // 3. 添加所有节点和边
     for (const auto& node : nodes) {
-        // 全图模式：随机位置，让力导向算法去跑
+        // 全图模式：先给随机位置，节点全部加入后再按社区分区摆放，让力导向算法去跑
         drawNode(node.id, node.name, node.nodeType, rand() % 800 - 400, rand() % 600 - 300);
         // 同时更新列表
         QTreeWidgetItem *item = new QTreeWidgetItem(ui->propertyPanel);
@@ -682,6 +751,7 @@ void MainWindow::onQueryFullGraph() {
             dst->addEdge(vEdge, false);
         }
     }
+    m_layout->seedByCommunity();
 
     ui->statusbar->showMessage(QString("全图模式：已加载 %1 个节点").arg(nodes.size()));
 }
@@ -703,46 +773,40 @@ void MainWindow::onQuerySingleNode() {
         return;
     }
 
-    // 1. 查询数据
-    GraphNode centerNode = m_queryEngine->getNodeById(centerId);
-    QList<GraphEdge> relatedEdges = m_queryEngine->getRelatedRelationships(centerId);
+    bool ok = false;
+    int depth = QInputDialog::getInt(this, "邻域查询", "扩展跳数 (k-hop):", 1, 1, 5, 1, &ok);
+    if (!ok) return;
+
+    // 1. 查询数据：按层批量扩展，节点一次 IN 查询取回
+    SubGraph sub = m_queryEngine->expandNeighborhood(centerId, depth);
 
     // 2. 暂停力导向 (静态布局)
     m_timer->stop();
     m_scene->clear();
     m_layout->clear(); // 清空算法中的数据引用
 
-    // 3. 绘制中心节点
-    drawNode(centerNode.id, centerNode.name, centerNode.nodeType, 0, 0);
-
-    // 4. 绘制周围节点 (圆形布局)
-    QSet<int> addedNodes;
-    addedNodes.insert(centerId);
-
-    int count = relatedEdges.size();
-    double radius = 200.0;
-    double angleStep = (2 * M_PI) / (count > 0 ? count : 1);
-    int currentIdx = 0;
-
-    for (const auto& edge : relatedEdges) {
-        int neighborId = (edge.sourceId == centerId) ? edge.targetId : edge.sourceId;
-
-        if (!addedNodes.contains(neighborId)) {
-            GraphNode neighbor = m_queryEngine->getNodeById(neighborId);
-
-            // 计算坐标
-            double x = radius * cos(currentIdx * angleStep);
-            double y = radius * sin(currentIdx * angleStep);
+    // 3. 同心圆布局：第 d 跳的节点放在半径 d*200 的圆上
+    QMap<int, QList<const GraphNode*>> rings;
+    for (const auto& node : sub.nodes) {
+        rings[sub.depthOf.value(node.id)].append(&node);
+    }
 
-            drawNode(neighbor.id, neighbor.name, neighbor.nodeType, x, y);
-            addedNodes.insert(neighborId);
-            currentIdx++;
+    QHash<int, VisualNode*> visualById;
+    for (auto it = rings.begin(); it != rings.end(); ++it) {
+        const QList<const GraphNode*>& ring = it.value();
+        double radius = 200.0 * it.key();
+        double angleStep = (2 * M_PI) / (ring.size() > 0 ? ring.size() : 1);
+        for (int i = 0; i < ring.size(); ++i) {
+            const GraphNode* node = ring[i];
+            double x = radius * cos(i * angleStep);
+            double y = radius * sin(i * angleStep);
+            visualById[node->id] = drawNode(node->id, node->name, node->nodeType, x, y);
         }
     }
 
-    for (const auto& edge : relatedEdges) {
-        VisualNode* src = qgraphicsitem_cast<VisualNode*>(findItemById(edge.sourceId));
-        VisualNode* dst = qgraphicsitem_cast<VisualNode*>(findItemById(edge.targetId));
+    for (const auto& edge : sub.edges) {
+        VisualNode* src = visualById.value(edge.sourceId);
+        VisualNode* dst = visualById.value(edge.targetId);
 
         if (src && dst) {
             VisualEdge* vEdge = new VisualEdge(edge.id, edge.sourceId, edge.targetId, edge.relationType, src, dst);
@@ -753,7 +817,9 @@ void MainWindow::onQuerySingleNode() {
     }
 
     ui->graphicsView->centerOn(0, 0);
-    ui->statusbar->showMessage(QString("单节点查询：ID %1").arg(centerId));
+    QString message = QString("邻域查询：ID %1，%2 跳内共 %3 个节点").arg(centerId).arg(depth).arg(sub.nodes.size());
+    if (sub.truncated) message += "（邻域过大，已截断）";
+    ui->statusbar->showMessage(message);
 }
 
 // --- 3. 属性查询 ---
@@ -763,7 +829,8 @@ void MainWindow::onQueryAttribute() {
         QString name = dialog.getAttrName();
         QString value = dialog.getAttrValue();
 
-        QList<GraphNode> results = m_queryEngine->queryByAttribute(name, value);
+        QList<GraphNode> results = m_queryEngine->queryByAttribute(m_currentOntologyId, name, value,
+                                                                   dialog.getMatchMode());
 
         if (results.isEmpty()) {
             QMessageBox::information(this, "结果", "未找到匹配节点");
@@ -868,14 +935,65 @@ void MainWindow::onQueryPath() {
     ui->graphicsView->centerOn(x/2, 0);
 }
 
+// --- 5. 模式查询 ---
+void MainWindow::onQueryPattern() {
+    bool ok = false;
+    QString text = QInputDialog::getMultiLineText(this, "模式查询",
+        "图模式语句 (节点 (变量:类型)，关系 -[:类型]->，条件运算符 = != ~ ^=)：",
+        "(a)-[]->(b) WHERE a.name ~ '' RETURN a,b LIMIT 200", &ok);
+    if (!ok || text.trimmed().isEmpty()) return;
+
+    QString error;
+    PatternResult result = m_queryEngine->queryPattern(m_currentOntologyId, text, &error);
+    if (!error.isEmpty()) {
+        QMessageBox::warning(this, "模式查询", error);
+        return;
+    }
+    if (result.rows.isEmpty()) {
+        QMessageBox::information(this, "结果", "没有匹配的子图\n" + result.plan);
+        return;
+    }
+
+    // 结果子图交给力导向布局展开
+    m_scene->clear();
+    m_layout->clear();
+    ui->propertyPanel->clear();
+    m_timer->start(30);
+
+    QHash<int, VisualNode*> visualById;
+    for (const auto& node : result.nodes) {
+        visualById[node.id] = drawNode(node.id, node.name, node.nodeType, rand() % 600 - 300, rand() % 400 - 200);
+        QTreeWidgetItem *item = new QTreeWidgetItem(ui->propertyPanel);
+        item->setText(0, QString::number(node.id));
+        item->setText(1, node.name);
+        item->setText(2, node.nodeType);
+    }
+    for (const auto& edge : result.edges) {
+        VisualNode* src = visualById.value(edge.sourceId);
+        VisualNode* dst = visualById.value(edge.targetId);
+        if (src && dst) {
+            VisualEdge* vEdge = new VisualEdge(edge.id, edge.sourceId, edge.targetId, edge.relationType, src, dst);
+            m_scene->addItem(vEdge);
+            m_layout->addEdge(vEdge);
+            src->addEdge(vEdge, true);
+            dst->addEdge(vEdge, false);
+        }
+    }
+
+    ui->statusbar->showMessage(QString("模式查询：%1 行，%2 个节点 | %3")
+                                   .arg(result.rows.size()).arg(result.nodes.size()).arg(result.plan));
+}
+
 // 辅助绘图函数
-void MainWindow::drawNode(int id, QString name, QString type, double x, double y) {
+VisualNode* MainWindow::drawNode(int id, QString name, QString type, double x, double y) {
     VisualNode *vNode = new VisualNode(id, name, type, x, y);
+    vNode->setCommunity(m_queryEngine->communityOf(m_currentOntologyId, id));
     m_scene->addItem(vNode);
     // 只有在全图模式下才加入 m_layout，静态模式不需要
     if (m_timer->isActive()) {
         m_layout->addNode(vNode);
     }
+    return vNode;
 }
 
 void MainWindow::onSwitchOntology(int ontologyId, QString name) {
@@ -884,7 +1002,13 @@ void MainWindow::onSwitchOntology(int ontologyId, QString name) {
     m_currentOntologyId = ontologyId;
     this->setWindowTitle(QString("知识图谱系统 - 当前项目: %1").arg(name));
 
+    // 撤销历史只属于原来的本体
+    m_undoStack->clear();
+    m_changeFeed->start(m_currentOntologyId);
+    MemoryGraphStore::load(m_currentOntologyId);
+
     // 重新查询全图
+    m_searchIndex->rebuild(m_currentOntologyId);
     onQueryFullGraph();
 }
 
@@ -1025,6 +1149,44 @@ void MainWindow::showNodeDetails(int nodeId) {
 }
 
 
+void MainWindow::onSearchTextEdited(const QString& text) {
+    QList<SearchHit> hits = m_searchIndex->search(text, 20);
+
+    QStringList items;
+    m_searchHitIds.clear();
+    for (const auto& hit : hits) {
+        QString label = QString("%1  [%2]  #%3").arg(hit.name, hit.nodeType).arg(hit.nodeId);
+        items << label;
+        m_searchHitIds[label] = hit.nodeId;
+    }
+
+    // 全文检索无结果时退回到容错匹配，处理拼写错误
+    if (items.isEmpty() && !text.trimmed().isEmpty()) {
+        for (const auto& match : m_queryEngine->fuzzyFindNodes(m_currentOntologyId, text, 2, 10)) {
+            QString label = QString("您是否要找: %1  #%2").arg(match.name).arg(match.nodeId);
+            items << label;
+            m_searchHitIds[label] = match.nodeId;
+        }
+    }
+    m_searchModel->setStringList(items);
+    if (!items.isEmpty()) m_searchCompleter->complete();
+}
+
+void MainWindow::onSearchHitActivated(const QString& text) {
+    int nodeId = m_searchHitIds.value(text, -1);
+    if (nodeId <= 0) return;
+
+    // 画布上有该节点则选中并居中，否则直接弹出详情
+    QGraphicsItem* item = findItemById(nodeId);
+    if (item) {
+        m_scene->clearSelection();
+        item->setSelected(true);
+        ui->graphicsView->centerOn(item);
+    } else {
+        showNodeDetails(nodeId);
+    }
+}
+
 void MainWindow::onOpenDashboard() {
     DashboardDialog dialog(m_currentOntologyId, m_queryEngine, this);
     dialog.exec();
@@ -1043,60 +1205,254 @@ void MainWindow::onActionAIImportTriggered() {
 }
 
 void MainWindow::handleAIExtractedData(QJsonArray aiNodes, QJsonArray aiEdges) {
-    // 1. 获取当前项目的所有现有节点，防止重复插入
-    QList<GraphNode> existingNodes = m_queryEngine->getAllNodes(m_currentOntologyId);
-    QMap<QString, int> nameToIdMap;
-    for (const auto& n : existingNodes) {
-        nameToIdMap[n.name] = n.id;
-    }
-
-    // 2. 导入新节点
-    int newNodesCount = 0;
+    // 1. 只差大小写的实体 (如 "MySQL" 与 "MySql") 直接映射到已有节点；
+    //    其余编辑距离内的近似名称 (如 "Spark" 与 "Spack") 交给用户确认，未确认的按新实体交给批量合并
+    QList<GraphNode> nodes;
+    QHash<QString, int> aliases;
+    QList<QPair<QString, FuzzyMatch>> nearMisses;
     for (int i = 0; i < aiNodes.size(); ++i) {
         QJsonObject nObj = aiNodes[i].toObject();
-        QString name = nObj["name"].toString();
+        QString name = nObj["name"].toString().trimmed();
         if (name.isEmpty()) continue;
 
-        if (!nameToIdMap.contains(name)) {
-            GraphNode newNode;
-            newNode.ontologyId = m_currentOntologyId;
-            newNode.name = name;
-            newNode.nodeType = nObj["nodeType"].toString("自动提取概念");
-            newNode.description = nObj["description"].toString();
-            // 在屏幕中心附近随机散布
-            newNode.posX = QRandomGenerator::global()->bounded(400) - 200;
-            newNode.posY = QRandomGenerator::global()->bounded(400) - 200;
-
-            if (m_graphEditor->addNode(newNode)) {
-                nameToIdMap[name] = newNode.id; // 记录数据库生成的真实 ID
-                newNodesCount++;
+        int bound = QueryEngine::duplicateEditBound(name);
+        if (bound > 0) {
+            QList<FuzzyMatch> similar = m_queryEngine->fuzzyFindNodes(m_currentOntologyId, name, bound, 1);
+            if (!similar.isEmpty() && similar.first().name != name) {
+                if (similar.first().name.toCaseFolded() == name.toCaseFolded()) {
+                    qInfo() << "AI 导入: 合并同名实体" << name << "->" << similar.first().name;
+                    aliases[name] = similar.first().nodeId;
+                    continue;
+                }
+                nearMisses.append(qMakePair(name, similar.first()));
+            }
+        }
+
+        GraphNode newNode;
+        newNode.ontologyId = m_currentOntologyId;
+        newNode.name = name;
+        newNode.nodeType = nObj["nodeType"].toString("自动提取概念");
+        newNode.description = nObj["description"].toString();
+        // 在屏幕中心附近随机散布
+        newNode.posX = QRandomGenerator::global()->bounded(400) - 200;
+        newNode.posY = QRandomGenerator::global()->bounded(400) - 200;
+        nodes.append(newNode);
+    }
+
+    if (!nearMisses.isEmpty()) {
+        QDialog confirm(this);
+        confirm.setWindowTitle("确认合并近似实体");
+        QVBoxLayout* layout = new QVBoxLayout(&confirm);
+        layout->addWidget(new QLabel("以下实体与图谱中已有的实体名称相近，勾选的将合并到已有实体，其余作为新实体导入：", &confirm));
+        QListWidget* list = new QListWidget(&confirm);
+        for (const auto& miss : nearMisses) {
+            QListWidgetItem* item = new QListWidgetItem(
+                QString("%1  →  %2 (ID %3)").arg(miss.first, miss.second.name).arg(miss.second.nodeId), list);
+            item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+            item->setCheckState(Qt::Unchecked);
+        }
+        layout->addWidget(list);
+        QDialogButtonBox* buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &confirm);
+        connect(buttons, &QDialogButtonBox::accepted, &confirm, &QDialog::accept);
+        connect(buttons, &QDialogButtonBox::rejected, &confirm, &QDialog::reject);
+        layout->addWidget(buttons);
+
+        // 取消表示全部不合并，仍然导入
+        if (confirm.exec() == QDialog::Accepted) {
+            for (int i = 0; i < nearMisses.size(); ++i) {
+                if (list->item(i)->checkState() != Qt::Checked) continue;
+                qInfo() << "AI 导入: 合并近似实体" << nearMisses[i].first << "->" << nearMisses[i].second.name;
+                aliases[nearMisses[i].first] = nearMisses[i].second.nodeId;
+            }
+            for (int i = nodes.size() - 1; i >= 0; --i) {
+                if (aliases.contains(nodes[i].name)) nodes.removeAt(i);
             }
         }
     }
 
-    // 3. 导入新连线
-    int newEdgesCount = 0;
+    // 2. 关系端点按名称交给合并逻辑解析，端点在图谱中找不到的关系会被丢弃
+    QList<GraphEditor::NamedEdge> edges;
     for (int i = 0; i < aiEdges.size(); ++i) {
         QJsonObject eObj = aiEdges[i].toObject();
-        QString srcName = eObj["sourceName"].toString();
-        QString tgtName = eObj["targetName"].toString();
-        QString relType = eObj["relationType"].toString("关联");
-
-        // 必须起点和终点都在图谱中存在，才能连线
-        if (nameToIdMap.contains(srcName) && nameToIdMap.contains(tgtName)) {
-            GraphEdge newEdge;
-            newEdge.ontologyId = m_currentOntologyId;
-            newEdge.sourceId = nameToIdMap[srcName];
-            newEdge.targetId = nameToIdMap[tgtName];
-            newEdge.relationType = relType;
-
-            if (m_graphEditor->addRelationship(newEdge)) {
-                newEdgesCount++;
-            }
+        edges.append({eObj["sourceName"].toString(), eObj["targetName"].toString(),
+                      eObj["relationType"].toString("关联")});
+    }
+
+    // 3. 一个事务写入，界面由 changeSetCommitted 增量更新
+    QList<GraphNode> addedNodes;
+    QList<GraphEdge> addedEdges;
+    if (!m_graphEditor->mergeEntities(m_currentOntologyId, nodes, edges, aliases, addedNodes, addedEdges)) {
+        ui->statusbar->showMessage("AI 导入失败：写入数据库出错", 5000);
+        return;
+    }
+    ui->statusbar->showMessage(QString("AI 导入完成：新增 %1 个节点，%2 条关系").arg(addedNodes.size()).arg(addedEdges.size()), 5000);
+}
+
+void MainWindow::onCommunitiesReady(int ontologyId) {
+    if (ontologyId != m_currentOntologyId) return;
+
+    bool changed = false;
+    foreach(QGraphicsItem* item, m_scene->items()) {
+        if (item->type() != VisualNode::Type) continue;
+        VisualNode* vNode = qgraphicsitem_cast<VisualNode*>(item);
+        int community = m_queryEngine->communityOf(ontologyId, vNode->getId());
+        if (vNode->getCommunity() == community) continue;
+        vNode->setCommunity(community);
+        changed = true;
+    }
+    // 划分与之前一致时不打乱正在收敛的布局
+    if (changed && m_timer->isActive()) m_layout->seedByCommunity();
+}
+
+void MainWindow::onChangeSetCommitted(const GraphChangeSet& changes) {
+    // 整批变更只扫描一次场景和列表
+    QHash<int, VisualNode*> visualNodes;
+    QList<VisualEdge*> visualEdges;
+    foreach (QGraphicsItem* item, m_scene->items()) {
+        if (item->type() == VisualNode::Type) {
+            VisualNode* vn = qgraphicsitem_cast<VisualNode*>(item);
+            visualNodes[vn->getId()] = vn;
+        } else if (item->type() == VisualEdge::Type) {
+            visualEdges.append(qgraphicsitem_cast<VisualEdge*>(item));
         }
     }
 
-    // 4. 刷新全图，力导向算法会自动把这些新节点炸开排好
-    onQueryFullGraph();
-    ui->statusbar->showMessage(QString("AI 导入完成：新增 %1 个节点，%2 条关系").arg(newNodesCount).arg(newEdgesCount), 5000);
-}
\ No newline at end of file
+    // 1. 删除：被删除的关系，以及与被删除节点相连的关系
+    QSet<int> deletedEdges;
+    for (int id : changes.deletedEdgeIds) deletedEdges.insert(id);
+    QSet<VisualNode*> deletedNodes;
+    for (int id : changes.deletedNodeIds) {
+        if (VisualNode* vn = visualNodes.take(id)) deletedNodes.insert(vn);
+    }
+    QHash<int, VisualEdge*> edgesById;
+    for (VisualEdge* edge : visualEdges) {
+        if (deletedEdges.contains(edge->getId())
+            || deletedNodes.contains(edge->getSourceNode()) || deletedNodes.contains(edge->getDestNode())) {
+            if (edge->getSourceNode()) edge->getSourceNode()->removeEdge(edge);
+            if (edge->getDestNode()) edge->getDestNode()->removeEdge(edge);
+            if (m_layout) m_layout->removeEdge(edge);
+            m_scene->removeItem(edge);
+            delete edge;
+        } else {
+            edgesById[edge->getId()] = edge;
+        }
+    }
+    for (VisualNode* vn : deletedNodes) {
+        if (m_layout) m_layout->removeNode(vn);
+        m_scene->removeItem(vn);
+        delete vn;
+    }
+
+    QSet<int> deletedNodeIds;
+    for (int id : changes.deletedNodeIds) deletedNodeIds.insert(id);
+    QHash<int, GraphNode> updatedNodes;
+    for (const auto& node : changes.updatedNodes) updatedNodes[node.id] = node;
+    for (int i = ui->propertyPanel->topLevelItemCount() - 1; i >= 0; --i) {
+        QTreeWidgetItem* item = ui->propertyPanel->topLevelItem(i);
+        int id = item->text(0).toInt();
+        if (deletedNodeIds.contains(id)) {
+            delete ui->propertyPanel->takeTopLevelItem(i);
+        } else if (updatedNodes.contains(id)) {
+            item->setText(1, updatedNodes[id].name);
+            item->setText(2, updatedNodes[id].nodeType);
+        }
+    }
+
+    // 2. 新增：全图模式下全部画出，力导向算法会把新节点排开；
+    //    静态视图 (邻域、路径、模式查询结果) 不能换成全图，只补上与屏幕上节点相连的实体，其余提示视图已过期；
+    //    其他客户端的新增不往静态视图里加，只给出提示，免得轮询把正在查看的结果改掉
+    bool fullGraph = m_timer->isActive();
+    auto listNode = [this](const GraphNode& node) {
+        QTreeWidgetItem *item = new QTreeWidgetItem(ui->propertyPanel);
+        item->setText(0, QString::number(node.id));
+        item->setText(1, node.name);
+        item->setText(2, node.nodeType);
+    };
+    // 静态视图没有布局算法，新节点放在相连的已有节点附近
+    auto drawNear = [&](const GraphNode& node, VisualNode* anchor) {
+        double angle = QRandomGenerator::global()->bounded(2.0 * M_PI);
+        QPointF pos = anchor->pos() + QPointF(90 * qCos(angle), 90 * qSin(angle));
+        VisualNode* vn = drawNode(node.id, node.name, node.nodeType, pos.x(), pos.y());
+        visualNodes[node.id] = vn;
+        listNode(node);
+        return vn;
+    };
+
+    QHash<int, GraphNode> unplacedNodes;
+    for (const auto& node : changes.addedNodes) {
+        if (node.ontologyId != m_currentOntologyId) continue;
+        if (!fullGraph) {
+            unplacedNodes.insert(node.id, node);
+            continue;
+        }
+        visualNodes[node.id] = drawNode(node.id, node.name, node.nodeType, node.posX, node.posY);
+        listNode(node);
+    }
+
+    int hidden = 0;
+    for (const auto& edge : changes.addedEdges) {
+        if (edge.ontologyId != m_currentOntologyId) continue;
+        VisualNode* src = visualNodes.value(edge.sourceId);
+        VisualNode* dst = visualNodes.value(edge.targetId);
+        if (!fullGraph && !changes.external) {
+            if (!src && dst && unplacedNodes.contains(edge.sourceId)) src = drawNear(unplacedNodes.take(edge.sourceId), dst);
+            if (!dst && src && unplacedNodes.contains(edge.targetId)) dst = drawNear(unplacedNodes.take(edge.targetId), src);
+        }
+        if (!src || !dst || (!fullGraph && changes.external)) {
+            if (!fullGraph) hidden++;
+            continue;
+        }
+        VisualEdge* vEdge = new VisualEdge(edge.id, edge.sourceId, edge.targetId, edge.relationType, src, dst);
+        m_scene->addItem(vEdge);
+        if (fullGraph) m_layout->addEdge(vEdge);
+        src->addEdge(vEdge, true);
+        dst->addEdge(vEdge, false);
+    }
+    hidden += unplacedNodes.size();
+
+    // 3. 修改
+    for (const auto& node : changes.updatedNodes) {
+        if (VisualNode* vn = visualNodes.value(node.id)) vn->updateData(node.name, node.nodeType);
+    }
+    for (const auto& edge : changes.updatedEdges) {
+        if (VisualEdge* ve = edgesById.value(edge.id)) ve->updateData(edge.relationType);
+    }
+
+    updateStatusBar();
+    if (hidden > 0) {
+        ui->statusbar->showMessage(QString("视图已过期：%1 项新增实体不在当前查询结果中，重新查询后可见").arg(hidden));
+    }
+}
+
+void MainWindow::onActionUndoTriggered() {
+    if (!m_currentUser.isAdmin && !m_currentUser.canEdit) {
+        QMessageBox::warning(this, "权限不足", "您没有修改图谱数据的权限！");
+        return;
+    }
+    QString text = m_undoStack->undoText();
+    if (m_undoStack->undo()) {
+        ui->statusbar->showMessage("已撤销: " + text, 2000);
+    } else {
+        QMessageBox::warning(this, "撤销失败", "数据已被其他操作修改，无法撤销，历史记录已清空。");
+    }
+}
+
+void MainWindow::onActionRedoTriggered() {
+    if (!m_currentUser.isAdmin && !m_currentUser.canEdit) {
+        QMessageBox::warning(this, "权限不足", "您没有修改图谱数据的权限！");
+        return;
+    }
+    QString text = m_undoStack->redoText();
+    if (m_undoStack->redo()) {
+        ui->statusbar->showMessage("已重做: " + text, 2000);
+    } else {
+        QMessageBox::warning(this, "重做失败", "数据已被其他操作修改，无法重做，历史记录已清空。");
+    }
+}
+
+void MainWindow::onUndoStateChanged() {
+    m_actionUndo->setEnabled(m_undoStack->canUndo());
+    m_actionRedo->setEnabled(m_undoStack->canRedo());
+    m_actionUndo->setText(m_undoStack->canUndo() ? "撤销 " + m_undoStack->undoText() : "撤销");
+    m_actionRedo->setText(m_undoStack->canRedo() ? "重做 " + m_undoStack->redoText() : "重做");
+}
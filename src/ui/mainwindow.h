@@ -11,6 +11,7 @@
 #include <QJsonDocument>
 #include <QFile>
 #include <QFileDialog>
+#include <QHash>
 #include <QJsonArray>
 #include "../business/GraphEditor.h" // 引入业务层
 #include "../model/User.h"
@@ -23,6 +24,13 @@ class VisualNode;
 class VisualEdge;
 class QGraphicsItem;
 class QueryEngine;
+class SearchIndex;
+class GraphUndoStack;
+class ChangeFeed;
+class QAction;
+class QLineEdit;
+class QCompleter;
+class QStringListModel;
 class OntologyDock;
 
 QT_BEGIN_NAMESPACE
@@ -59,6 +67,9 @@ private slots:
 
     void onActionAddRelationshipTriggered();
     void onRelationshipAdded(const GraphEdge& edge);
+    void onChangeSetCommitted(const GraphChangeSet& changes);
+    // 后台社区划分完成后重新着色，全图模式下按社区重新分区摆放
+    void onCommunitiesReady(int ontologyId);
     // onActionDeleteRelationshipTriggered 已经移到上面 public 了
     void onRelationshipDeleted(int edgeId);
 
@@ -67,6 +78,7 @@ private slots:
     void onQuerySingleNode(); // 单节点查询 (右键或工具栏触发)
     void onQueryAttribute();  // 属性查询
     void onQueryPath();       // 路径查询
+    void onQueryPattern();    // 模式查询 (类 Cypher 语句)
 
     void onTogglePropertyPanel();
     void onSwitchOntology(int ontologyId, QString name);
@@ -74,7 +86,12 @@ private slots:
     void onRelationshipUpdated(const GraphEdge& edge);
     void onOpenDashboard();
     void onActionAIImportTriggered();
+    void onActionUndoTriggered();
+    void onActionRedoTriggered();
+    void onUndoStateChanged();
     void handleAIExtractedData(QJsonArray aiNodes, QJsonArray aiEdges);
+    void onSearchTextEdited(const QString& text);
+    void onSearchHitActivated(const QString& text);
 private:
     Ui::MainWindow *ui;
     GraphEditor *m_graphEditor;
@@ -83,6 +100,15 @@ private:
     ForceDirectedLayout* m_layout;
     QTimer* m_timer;
     QueryEngine* m_queryEngine;
+    SearchIndex* m_searchIndex;
+    GraphUndoStack* m_undoStack;
+    ChangeFeed* m_changeFeed;
+    QAction* m_actionUndo;
+    QAction* m_actionRedo;
+    QLineEdit* m_searchEdit;
+    QCompleter* m_searchCompleter;
+    QStringListModel* m_searchModel;
+    QHash<QString, int> m_searchHitIds; // 补全项文本 -> 节点ID
     bool m_hasClickPos = false;
     QPointF m_clickPos;
     QGraphicsItem* findItemById(int nodeId);
@@ -92,7 +118,7 @@ private:
     void loadInitialData();
     void setupConnections();
     void setupToolbar();
-    void drawNode(int id, QString name, QString type, double x, double y);
+    VisualNode* drawNode(int id, QString name, QString type, double x, double y);
     void drawEdge(const GraphEdge& edge);
     void createControlPanel();
 };
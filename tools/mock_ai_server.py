@@ -0,0 +1,186 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+AI 知识抽取的本地模拟服务 (兼容 OpenAI chat/completions 协议)
+
+用于在没有真实模型和 API Key 的情况下检查 AIExtractionPipeline 的分段并发、乱序完成与重试：
+  - 每个请求随机延迟，后发出的分段可能先返回
+  - 按分段内容的哈希稳定地注入失败：首次请求返回 503 或 429 (带 Retry-After)，重试后成功
+  - 从分段文本中取出英文单词作为实体，同一句内相邻实体之间连一条“相关”关系，结果可复现
+  - 请求带 "stream": true 时按 SSE 逐段返回 (text/event-stream)，每个事件只携带几个字符的 delta；
+    --cut-every N 会在约每 N 个分段的首次请求中途断开流，用于检查未闭合流的重试与去重
+  - 每个请求结束时打印当前在途数、历史最大在途数与该分段的第几次尝试，Ctrl+C 退出时打印汇总
+
+用法：
+  python3 tools/mock_ai_server.py [--port 8765] [--delay 0.2-1.5] [--fail-every 3] [--cut-every 4] [--no-stream]
+然后在“AI 智能文本知识抽取”对话框中把接口地址填为 http://127.0.0.1:8765/v1/chat/completions，
+API Key 任意填写。对照终端输出确认：最大在途数等于流水线的并发上限，失败分段的重试次数与注入一致，
+且最终导入的实体与逐段抽取的并集相同。
+"""
+
+import argparse
+import hashlib
+import json
+import random
+import re
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+SENTENCE_BREAK = re.compile(r"[。！？；.!?;\n]+")
+ENTITY = re.compile(r"[A-Za-z][A-Za-z0-9+#]+")
+
+
+class Stats:
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.in_flight = 0
+        self.max_in_flight = 0
+        self.requests = 0
+        self.attempts = {}     # 分段哈希 -> 已收到的请求次数
+        self.completed = []    # 按完成先后记录的分段哈希
+
+    def begin(self, chunk_id):
+        with self.lock:
+            self.requests += 1
+            self.in_flight += 1
+            self.max_in_flight = max(self.max_in_flight, self.in_flight)
+            self.attempts[chunk_id] = self.attempts.get(chunk_id, 0) + 1
+            return self.attempts[chunk_id]
+
+    def end(self, chunk_id, ok):
+        with self.lock:
+            self.in_flight -= 1
+            if ok:
+                self.completed.append(chunk_id)
+
+
+def extract(text):
+    """按句切分，句内的英文单词作为实体，相邻实体之间连一条关系"""
+    nodes = []
+    edges = []
+    seen = set()
+    for sentence in SENTENCE_BREAK.split(text):
+        names = ENTITY.findall(sentence)
+        for name in names:
+            if name.lower() not in seen:
+                seen.add(name.lower())
+                nodes.append({"name": name, "nodeType": "模拟实体", "description": "由本地模拟服务生成"})
+        for a, b in zip(names, names[1:]):
+            if a.lower() != b.lower():
+                edges.append({"sourceName": a, "targetName": b, "relationType": "相关"})
+    return {"nodes": nodes, "edges": edges}
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+    options = None
+    stats = None
+
+    def log_message(self, fmt, *args):
+        pass
+
+    def send_json(self, status, payload, headers=None):
+        body = json.dumps(payload, ensure_ascii=False).encode("utf-8")
+        self.send_response(status)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(body)))
+        for key, value in (headers or {}).items():
+            self.send_header(key, value)
+        self.end_headers()
+        self.wfile.write(body)
+
+    def send_stream(self, content, cut):
+        """按 SSE 发出回答，cut 为 True 时只发出前一半且不发 [DONE]"""
+        self.send_response(200)
+        self.send_header("Content-Type", "text/event-stream")
+        self.send_header("Cache-Control", "no-cache")
+        self.send_header("Connection", "close")
+        self.end_headers()
+        self.close_connection = True
+
+        step = self.options.stream_step
+        end = len(content) // 2 if cut else len(content)
+        for start in range(0, end, step):
+            delta = {"choices": [{"index": 0, "delta": {"content": content[start:min(start + step, end)]}}]}
+            self.wfile.write(b"data: " + json.dumps(delta, ensure_ascii=False).encode("utf-8") + b"\n\n")
+            self.wfile.flush()
+            time.sleep(self.options.stream_interval)
+        if not cut:
+            self.wfile.write(b"data: [DONE]\n\n")
+            self.wfile.flush()
+
+    def do_POST(self):
+        length = int(self.headers.get("Content-Length", 0))
+        request = json.loads(self.rfile.read(length) or b"{}")
+        text = next((m.get("content", "") for m in request.get("messages", []) if m.get("role") == "user"), "")
+        digest = hashlib.sha1(text.encode("utf-8")).hexdigest()
+        chunk_id = digest[:8]
+
+        attempt = self.stats.begin(chunk_id)
+        ok = False
+        try:
+            low, high = self.options.delay
+            time.sleep(random.uniform(low, high))
+
+            # 按哈希稳定地挑出部分分段，首次请求失败；一半返回 503，一半返回 429
+            fail_every = self.options.fail_every
+            if fail_every > 0 and int(digest, 16) % fail_every == 0 and attempt == 1:
+                if int(digest, 16) % 2 == 0:
+                    self.send_json(503, {"error": {"message": "模拟服务暂时不可用"}})
+                else:
+                    self.send_json(429, {"error": {"message": "模拟限流"}}, {"Retry-After": "1"})
+                print(f"[{chunk_id}] 第 {attempt} 次请求: 注入失败, 在途 {self.stats.in_flight}")
+                return
+
+            content = json.dumps(extract(text), ensure_ascii=False)
+            if request.get("stream") and not self.options.no_stream:
+                # 与失败注入错开取模，避免同一批分段既返回错误又被断流
+                cut_every = self.options.cut_every
+                cut = cut_every > 0 and (int(digest, 16) // 7) % cut_every == 0 and attempt == 1
+                self.send_stream(content, cut)
+                ok = not cut
+                print(f"[{chunk_id}] 第 {attempt} 次请求: {'流中途断开' if cut else '流式成功'}, "
+                      f"在途 {self.stats.in_flight}, 最大在途 {self.stats.max_in_flight}")
+                return
+
+            self.send_json(200, {"choices": [{"index": 0, "message": {"role": "assistant", "content": content}}]})
+            ok = True
+            print(f"[{chunk_id}] 第 {attempt} 次请求: 成功, 在途 {self.stats.in_flight}, "
+                  f"最大在途 {self.stats.max_in_flight}")
+        finally:
+            self.stats.end(chunk_id, ok)
+
+
+def parse_range(value):
+    low, _, high = value.partition("-")
+    return float(low), float(high or low)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="AI 知识抽取本地模拟服务")
+    parser.add_argument("--port", type=int, default=8765)
+    parser.add_argument("--delay", type=parse_range, default=(0.2, 1.5), help="每个请求的随机延迟秒数，如 0.2-1.5")
+    parser.add_argument("--fail-every", type=int, default=3, help="约每 N 个分段注入一次首请求失败，0 表示不注入")
+    parser.add_argument("--cut-every", type=int, default=4, help="约每 N 个分段在首次流式请求中途断流，0 表示不断流")
+    parser.add_argument("--stream-step", type=int, default=8, help="每个 SSE 事件携带的字符数")
+    parser.add_argument("--stream-interval", type=float, default=0.02, help="SSE 事件之间的间隔秒数")
+    parser.add_argument("--no-stream", action="store_true", help="忽略 stream 参数，总是整包返回 (检查退回整包解析)")
+    options = parser.parse_args()
+
+    Handler.options = options
+    Handler.stats = Stats()
+    server = ThreadingHTTPServer(("127.0.0.1", options.port), Handler)
+    print(f"模拟服务已启动: http://127.0.0.1:{options.port}/v1/chat/completions")
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        stats = Handler.stats
+        retried = sum(1 for n in stats.attempts.values() if n > 1)
+        print(f"\n共 {stats.requests} 个请求, {len(stats.attempts)} 个分段, {retried} 个分段经过重试, "
+              f"最大在途 {stats.max_in_flight}")
+        print("完成顺序: " + " ".join(stats.completed))
+
+
+if __name__ == "__main__":
+    main()